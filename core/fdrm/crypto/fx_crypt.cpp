@@ -154,12 +154,22 @@ void CRYPT_ArcFourSetup(CRYPT_rc4_context* s,
 }
 
 void CRYPT_ArcFourCrypt(CRYPT_rc4_context* s, uint8_t* data, uint32_t length) {
+  // Writes to |data| may alias |s| as far as the compiler knows, so work on
+  // locals to keep the state in registers.
+  int32_t x = s->x;
+  int32_t y = s->y;
+  int32_t* m = s->m;
   for (uint32_t i = 0; i < length; ++i) {
-    s->x = (s->x + 1) & 0xFF;
-    s->y = (s->y + s->m[s->x]) & 0xFF;
-    std::swap(s->m[s->x], s->m[s->y]);
-    data[i] ^= s->m[(s->m[s->x] + s->m[s->y]) & 0xFF];
+    x = (x + 1) & 0xFF;
+    int32_t mx = m[x];
+    y = (y + mx) & 0xFF;
+    int32_t my = m[y];
+    m[x] = my;
+    m[y] = mx;
+    data[i] ^= m[(mx + my) & 0xFF];
   }
+  s->x = x;
+  s->y = y;
 }
 
 void CRYPT_ArcFourCryptBlock(uint8_t* pData,
@@ -74,6 +74,9 @@ void CRYPT_AESEncrypt(CRYPT_aes_context* context,
                       uint8_t* dest,
                       const uint8_t* src,
                       uint32_t size);
+// Lets tests and benchmarks switch AES-NI decryption off and on. Returns
+// whether it is used from now on, which also needs CPU support.
+bool CRYPT_AESSetHardwareEnabled(bool bEnabled);
 
 void CRYPT_MD5Start(CRYPT_md5_context* context);
 void CRYPT_MD5Update(CRYPT_md5_context* context,
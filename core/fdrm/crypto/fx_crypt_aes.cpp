@@ -6,6 +6,24 @@
 
 #include "core/fdrm/crypto/fx_crypt.h"
 
+#include <atomic>
+
+// AES-NI is picked at run time, so it is built whenever the compiler can
+// target it.
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+#if defined(__GNUC__) || defined(__clang__)
+#define AES_USE_AESNI
+#define AESNI_TARGET __attribute__((target("aes,sse2")))
+#include <cpuid.h>
+#include <wmmintrin.h>
+#elif defined(_MSC_VER)
+#define AES_USE_AESNI
+#define AESNI_TARGET
+#include <intrin.h>
+#endif
+#endif
+
 #define mulby2(x) (((x & 0x7F) << 1) ^ (x & 0x80 ? 0x1B : 0))
 #define GET_32BIT_MSB_FIRST(cp)                    \
   (((unsigned long)(unsigned char)(cp)[3]) |       \
@@ -750,6 +768,98 @@ void aes_setup(CRYPT_aes_context* ctx,
 void aes_decrypt(CRYPT_aes_context* ctx, unsigned int* block) {
   ctx->decrypt(ctx, block);
 }
+
+#ifdef AES_USE_AESNI
+// Cleared by CRYPT_AESSetHardwareEnabled() to measure the table code.
+std::atomic<bool> g_aesni_enabled(true);
+
+bool cpu_has_aesni() {
+#if defined(__GNUC__) || defined(__clang__)
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    return false;
+#else
+  int info[4];
+  __cpuid(info, 1);
+  unsigned int ecx = info[2];
+#endif
+  return !!(ecx & (1 << 25));
+}
+
+bool use_aesni() {
+  static const bool has_aesni = cpu_has_aesni();
+  return has_aesni && g_aesni_enabled.load(std::memory_order_relaxed);
+}
+
+unsigned int byte_swap(unsigned int x) {
+  return (x >> 24) | ((x >> 8) & 0xFF00) | ((x << 8) & 0xFF0000) | (x << 24);
+}
+
+// The context keeps blocks and keys as words with the first byte on top.
+AESNI_TARGET __m128i aesni_load_words(const unsigned int* words) {
+  return _mm_set_epi32(byte_swap(words[3]), byte_swap(words[2]),
+                       byte_swap(words[1]), byte_swap(words[0]));
+}
+
+AESNI_TARGET void aesni_store_words(__m128i value, unsigned int* words) {
+  unsigned char bytes[16];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes), value);
+  for (int i = 0; i < 4; i++)
+    words[i] = GET_32BIT_MSB_FIRST(bytes + 4 * i);
+}
+
+// |ctx->invkeysched| is already the key schedule of the equivalent inverse
+// cipher that AESDEC implements. CBC decryption has no chain between blocks,
+// so four are kept in flight to hide the latency of each round.
+AESNI_TARGET void aesni_decrypt_cbc(unsigned char* dest,
+                                    const unsigned char* src,
+                                    int len,
+                                    CRYPT_aes_context* ctx) {
+  __m128i keys[MAX_NR + 1];
+  const int Nr = ctx->Nr;
+  for (int i = 0; i <= Nr; i++)
+    keys[i] = aesni_load_words(ctx->invkeysched + 4 * i);
+  __m128i iv = aesni_load_words(ctx->iv);
+  const __m128i* in = reinterpret_cast<const __m128i*>(src);
+  __m128i* out = reinterpret_cast<__m128i*>(dest);
+  for (; len >= 64; len -= 64, in += 4, out += 4) {
+    __m128i c0 = _mm_loadu_si128(in);
+    __m128i c1 = _mm_loadu_si128(in + 1);
+    __m128i c2 = _mm_loadu_si128(in + 2);
+    __m128i c3 = _mm_loadu_si128(in + 3);
+    __m128i x0 = _mm_xor_si128(c0, keys[0]);
+    __m128i x1 = _mm_xor_si128(c1, keys[0]);
+    __m128i x2 = _mm_xor_si128(c2, keys[0]);
+    __m128i x3 = _mm_xor_si128(c3, keys[0]);
+    for (int i = 1; i < Nr; i++) {
+      x0 = _mm_aesdec_si128(x0, keys[i]);
+      x1 = _mm_aesdec_si128(x1, keys[i]);
+      x2 = _mm_aesdec_si128(x2, keys[i]);
+      x3 = _mm_aesdec_si128(x3, keys[i]);
+    }
+    x0 = _mm_aesdeclast_si128(x0, keys[Nr]);
+    x1 = _mm_aesdeclast_si128(x1, keys[Nr]);
+    x2 = _mm_aesdeclast_si128(x2, keys[Nr]);
+    x3 = _mm_aesdeclast_si128(x3, keys[Nr]);
+    _mm_storeu_si128(out, _mm_xor_si128(x0, iv));
+    _mm_storeu_si128(out + 1, _mm_xor_si128(x1, c0));
+    _mm_storeu_si128(out + 2, _mm_xor_si128(x2, c1));
+    _mm_storeu_si128(out + 3, _mm_xor_si128(x3, c2));
+    iv = c3;
+  }
+  for (; len > 0; len -= 16, in++, out++) {
+    __m128i c = _mm_loadu_si128(in);
+    __m128i x = _mm_xor_si128(c, keys[0]);
+    for (int i = 1; i < Nr; i++)
+      x = _mm_aesdec_si128(x, keys[i]);
+    x = _mm_aesdeclast_si128(x, keys[Nr]);
+    _mm_storeu_si128(out, _mm_xor_si128(x, iv));
+    iv = c;
+  }
+  aesni_store_words(iv, ctx->iv);
+}
+#endif  // AES_USE_AESNI
+
 void aes_decrypt_cbc(unsigned char* dest,
                      const unsigned char* src,
                      int len,
@@ -757,6 +867,12 @@ void aes_decrypt_cbc(unsigned char* dest,
   unsigned int iv[4], x[4], ct[4];
   int i;
   ASSERT((len & 15) == 0);
+#ifdef AES_USE_AESNI
+  if (ctx->Nb == 4 && use_aesni()) {
+    aesni_decrypt_cbc(dest, src, len, ctx);
+    return;
+  }
+#endif
   memcpy(iv, ctx->iv, sizeof(iv));
   while (len > 0) {
     for (i = 0; i < 4; i++) {
@@ -829,3 +945,12 @@ void CRYPT_AESEncrypt(CRYPT_aes_context* context,
                       uint32_t len) {
   aes_encrypt_cbc(dest, src, len, context);
 }
+
+bool CRYPT_AESSetHardwareEnabled(bool bEnabled) {
+#ifdef AES_USE_AESNI
+  g_aesni_enabled.store(bEnabled, std::memory_order_relaxed);
+  return use_aesni();
+#else
+  return false;
+#endif
+}
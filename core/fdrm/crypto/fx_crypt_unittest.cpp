@@ -6,8 +6,10 @@
 
 #include "core/fdrm/crypto/fx_crypt.h"
 
+#include <chrono>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "core/fxcrt/fx_basic.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -19,6 +21,47 @@ std::string CRYPT_MD5String(const char* str) {
   return GenerateMD5Base16(reinterpret_cast<const uint8_t*>(str), strlen(str));
 }
 
+// Encrypts |size| bytes of made up data with |key|, returning the plain text
+// in |plain| and the cipher text in |cipher|.
+void MakeAESCipherText(const uint8_t* key,
+                       uint32_t key_len,
+                       uint32_t size,
+                       std::vector<uint8_t>* plain,
+                       std::vector<uint8_t>* cipher) {
+  const uint8_t kIV[16] = {};
+  plain->resize(size);
+  for (uint32_t i = 0; i < size; ++i)
+    (*plain)[i] = static_cast<uint8_t>(i * 7 + i / 256);
+
+  CRYPT_aes_context context;
+  CRYPT_AESSetKey(&context, 16, key, key_len, true);
+  CRYPT_AESSetIV(&context, kIV);
+  cipher->resize(size);
+  CRYPT_AESEncrypt(&context, cipher->data(), plain->data(), size);
+}
+
+// Decrypts |cipher| with |key| |rounds| times, returning the plain text in
+// |plain| and the seconds taken.
+double DecryptAES(const uint8_t* key,
+                  uint32_t key_len,
+                  const std::vector<uint8_t>& cipher,
+                  int rounds,
+                  std::vector<uint8_t>* plain) {
+  const uint8_t kIV[16] = {};
+  plain->resize(cipher.size());
+  CRYPT_aes_context context;
+  CRYPT_AESSetKey(&context, 16, key, key_len, false);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; ++i) {
+    CRYPT_AESSetIV(&context, kIV);
+    CRYPT_AESDecrypt(&context, plain->data(), cipher.data(),
+                     static_cast<uint32_t>(cipher.size()));
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
 void CheckArcFourContext(const CRYPT_rc4_context& context,
                          int32_t expected_x,
                          int32_t expected_y,
@@ -484,3 +527,135 @@ TEST(FXCRYPT, CRYPT_ArcFourCrypt) {
     CheckArcFourContext(context, 15, 68, kPermutation);
   }
 }
+
+TEST(FXCRYPT, AESCBCDecrypt) {
+  // Examples F.2.2 and F.2.6 from NIST SP 800-38A.
+  const uint8_t kIV[16] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+                           0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+  const uint8_t kPlain[64] = {
+      0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e,
+      0x11, 0x73, 0x93, 0x17, 0x2a, 0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03,
+      0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51, 0x30,
+      0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19,
+      0x1a, 0x0a, 0x52, 0xef, 0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b,
+      0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10};
+  const uint8_t kKey128[16] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae,
+                               0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88,
+                               0x09, 0xcf, 0x4f, 0x3c};
+  const uint8_t kCipher128[64] = {
+      0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46, 0xce, 0xe9, 0x8e,
+      0x9b, 0x12, 0xe9, 0x19, 0x7d, 0x50, 0x86, 0xcb, 0x9b, 0x50, 0x72,
+      0x19, 0xee, 0x95, 0xdb, 0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2, 0x73,
+      0xbe, 0xd6, 0xb8, 0xe3, 0xc1, 0x74, 0x3b, 0x71, 0x16, 0xe6, 0x9e,
+      0x22, 0x22, 0x95, 0x16, 0x3f, 0xf1, 0xca, 0xa1, 0x68, 0x1f, 0xac,
+      0x09, 0x12, 0x0e, 0xca, 0x30, 0x75, 0x86, 0xe1, 0xa7};
+  const uint8_t kKey256[32] = {
+      0x60, 0x3d, 0xeb, 0x10, 0x15, 0xca, 0x71, 0xbe, 0x2b, 0x73, 0xae,
+      0xf0, 0x85, 0x7d, 0x77, 0x81, 0x1f, 0x35, 0x2c, 0x07, 0x3b, 0x61,
+      0x08, 0xd7, 0x2d, 0x98, 0x10, 0xa3, 0x09, 0x14, 0xdf, 0xf4};
+  const uint8_t kCipher256[64] = {
+      0xf5, 0x8c, 0x4c, 0x04, 0xd6, 0xe5, 0xf1, 0xba, 0x77, 0x9e, 0xab,
+      0xfb, 0x5f, 0x7b, 0xfb, 0xd6, 0x9c, 0xfc, 0x4e, 0x96, 0x7e, 0xdb,
+      0x80, 0x8d, 0x67, 0x9f, 0x77, 0x7b, 0xc6, 0x70, 0x2c, 0x7d, 0x39,
+      0xf2, 0x33, 0x69, 0xa9, 0xd9, 0xba, 0xcf, 0xa5, 0x30, 0xe2, 0x63,
+      0x04, 0x23, 0x14, 0x61, 0xb2, 0xeb, 0x05, 0xe2, 0xc3, 0x9b, 0xe9,
+      0xfc, 0xda, 0x6c, 0x19, 0x07, 0x8c, 0x6a, 0x9d, 0x1b};
+  struct {
+    const uint8_t* key;
+    uint32_t key_len;
+    const uint8_t* cipher;
+  } const kTests[] = {{kKey128, 16, kCipher128}, {kKey256, 32, kCipher256}};
+
+  for (const auto& test : kTests) {
+    CRYPT_aes_context context;
+    uint8_t actual[64];
+    CRYPT_AESSetKey(&context, 16, test.key, test.key_len, true);
+    CRYPT_AESSetIV(&context, kIV);
+    CRYPT_AESEncrypt(&context, actual, kPlain, 64);
+    for (size_t i = 0; i < 64; ++i)
+      EXPECT_EQ(test.cipher[i], actual[i]) << " at byte " << i;
+
+    CRYPT_AESSetKey(&context, 16, test.key, test.key_len, false);
+    CRYPT_AESSetIV(&context, kIV);
+    CRYPT_AESDecrypt(&context, actual, test.cipher, 64);
+    for (size_t i = 0; i < 64; ++i)
+      EXPECT_EQ(kPlain[i], actual[i]) << " at byte " << i;
+
+    // The chain carries over between calls.
+    CRYPT_AESSetIV(&context, kIV);
+    for (size_t offset = 0; offset < 64; offset += 16)
+      CRYPT_AESDecrypt(&context, actual + offset, test.cipher + offset, 16);
+    for (size_t i = 0; i < 64; ++i)
+      EXPECT_EQ(kPlain[i], actual[i]) << " at byte " << i;
+  }
+}
+
+TEST(FXCRYPT, AESCBCDecryptInPlace) {
+  const uint8_t kKey[16] = {'0', '1', '2', '3', '4', '5', '6', '7',
+                            '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+  const uint8_t kIV[16] = {};
+  const uint32_t kSize = 16 * 1027;
+  std::vector<uint8_t> plain(kSize);
+  for (uint32_t i = 0; i < kSize; ++i)
+    plain[i] = static_cast<uint8_t>(i * 7 + i / 256);
+
+  CRYPT_aes_context context;
+  CRYPT_AESSetKey(&context, 16, kKey, sizeof(kKey), true);
+  CRYPT_AESSetIV(&context, kIV);
+  std::vector<uint8_t> data(kSize);
+  CRYPT_AESEncrypt(&context, data.data(), plain.data(), kSize);
+  EXPECT_NE(plain, data);
+
+  CRYPT_AESSetKey(&context, 16, kKey, sizeof(kKey), false);
+  CRYPT_AESSetIV(&context, kIV);
+  CRYPT_AESDecrypt(&context, data.data(), data.data(), kSize);
+  EXPECT_EQ(plain, data);
+}
+
+TEST(FXCRYPT, AESCBCDecryptWithAndWithoutHardware) {
+  const uint8_t kKey[32] = {'0', '1', '2', '3', '4', '5', '6', '7',
+                            '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+                            'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n',
+                            'o', 'p', 'q', 'r', 's', 't', 'u', 'v'};
+  for (uint32_t key_len : {16, 24, 32}) {
+    std::vector<uint8_t> plain;
+    std::vector<uint8_t> cipher;
+    MakeAESCipherText(kKey, key_len, 16 * 1027, &plain, &cipher);
+
+    std::vector<uint8_t> actual;
+    CRYPT_AESSetHardwareEnabled(false);
+    DecryptAES(kKey, key_len, cipher, 1, &actual);
+    EXPECT_EQ(plain, actual) << key_len;
+
+    CRYPT_AESSetHardwareEnabled(true);
+    DecryptAES(kKey, key_len, cipher, 1, &actual);
+    EXPECT_EQ(plain, actual) << key_len;
+  }
+}
+
+// Compares the decryption throughput of AES-NI against the table code. Run
+// with --gtest_also_run_disabled_tests --gtest_filter=*AESCBCDecryptSpeed.
+TEST(FXCRYPT, DISABLED_AESCBCDecryptSpeed) {
+  const uint8_t kKey[16] = {'0', '1', '2', '3', '4', '5', '6', '7',
+                            '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+  const uint32_t kSize = 4 * 1024 * 1024;
+  const int kRounds = 16;
+  std::vector<uint8_t> plain;
+  std::vector<uint8_t> cipher;
+  MakeAESCipherText(kKey, sizeof(kKey), kSize, &plain, &cipher);
+
+  std::vector<uint8_t> actual;
+  const double megabytes = static_cast<double>(kSize) * kRounds / 1048576;
+  CRYPT_AESSetHardwareEnabled(false);
+  double seconds = DecryptAES(kKey, sizeof(kKey), cipher, kRounds, &actual);
+  EXPECT_EQ(plain, actual);
+  printf("AES-128-CBC decrypt, tables: %.1f MB/s\n", megabytes / seconds);
+
+  if (CRYPT_AESSetHardwareEnabled(true)) {
+    seconds = DecryptAES(kKey, sizeof(kKey), cipher, kRounds, &actual);
+    EXPECT_EQ(plain, actual);
+    printf("AES-128-CBC decrypt, AES-NI: %.1f MB/s\n", megabytes / seconds);
+  } else {
+    printf("AES-NI is not available.\n");
+  }
+}
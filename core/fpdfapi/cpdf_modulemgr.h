@@ -52,6 +52,10 @@ class CPDF_ModuleMgr {
     return m_pUnsupportInfoAdapter.get();
   }
 
+  // Directory for CPDF_XRefCache files, or empty if caching is off.
+  void SetXRefCacheDir(const CFX_ByteString& dir) { m_XRefCacheDir = dir; }
+  const CFX_ByteString& GetXRefCacheDir() const { return m_XRefCacheDir; }
+
   void LoadEmbeddedGB1CMaps();
   void LoadEmbeddedCNS1CMaps();
   void LoadEmbeddedJapan1CMaps();
@@ -71,6 +75,7 @@ class CPDF_ModuleMgr {
   CCodec_ModuleMgr* m_pCodecModule;
   std::unique_ptr<CPDF_PageModule> m_pPageModule;
   std::unique_ptr<CFSDK_UnsupportInfo_Adapter> m_pUnsupportInfoAdapter;
+  CFX_ByteString m_XRefCacheDir;
 };
 
 #endif  // CORE_FPDFAPI_CPDF_MODULEMGR_H_
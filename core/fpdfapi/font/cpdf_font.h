@@ -8,6 +8,7 @@
 #define CORE_FPDFAPI_FONT_CPDF_FONT_H_
 
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include "core/fpdfapi/parser/cpdf_stream_acc.h"
@@ -83,6 +84,12 @@ class CPDF_Font {
   const CFX_Font* GetFont() const { return &m_Font; }
   CFX_Font* GetFontFallback(int position);
 
+  // Held while using the state that the font loads lazily, such as its face
+  // and glyph caches, fallback fonts and Type 3 glyphs, since the pages that
+  // share a font may draw with it from several threads. It is recursive, so
+  // that Type 3 glyphs can use the font they belong to.
+  std::recursive_mutex* GetMutex() const { return &m_Mutex; }
+
  protected:
   CPDF_Font();
 
@@ -115,6 +122,9 @@ class CPDF_Font {
   int m_Ascent;
   int m_Descent;
   int m_ItalicAngle;
+
+ private:
+  mutable std::recursive_mutex m_Mutex;
 };
 
 #endif  // CORE_FPDFAPI_FONT_CPDF_FONT_H_
@@ -6,6 +6,7 @@
 
 #include "core/fpdfapi/font/cpdf_type3font.h"
 
+#include <mutex>
 #include <utility>
 
 #include "core/fpdfapi/font/cpdf_type3char.h"
@@ -89,6 +90,7 @@ void CPDF_Type3Font::CheckType3FontMetrics() {
 }
 
 CPDF_Type3Char* CPDF_Type3Font::LoadChar(uint32_t charcode) {
+  std::lock_guard<std::recursive_mutex> lock(*GetMutex());
   if (m_CharLoadingDepth >= FPDF_MAX_TYPE3_FORM_LEVEL)
     return nullptr;
 
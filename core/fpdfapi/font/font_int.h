@@ -9,6 +9,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <vector>
 
@@ -124,6 +125,8 @@ class CPDF_CMapManager {
   std::unique_ptr<CPDF_CID2UnicodeMap> LoadCID2UnicodeMap(CIDSet charset,
                                                           bool bPromptCJK);
 
+  // Shared by every document, which may be loaded on different threads.
+  std::mutex m_Mutex;
   std::map<CFX_ByteString, CFX_RetainPtr<CPDF_CMap>> m_CMaps;
   std::unique_ptr<CPDF_CID2UnicodeMap> m_CID2UnicodeMaps[6];
 };
@@ -222,6 +225,7 @@ class CPDF_FontGlobals {
   } m_EmbeddedToUnicodes[CIDSET_NUM_SETS];
 
  private:
+  std::mutex m_Mutex;
   std::map<CPDF_Document*, std::unique_ptr<CFX_StockFontArray>> m_StockMap;
 };
 
@@ -78,6 +78,7 @@ CPDF_FontGlobals::CPDF_FontGlobals() {
 CPDF_FontGlobals::~CPDF_FontGlobals() {}
 
 CPDF_Font* CPDF_FontGlobals::Find(CPDF_Document* pDoc, uint32_t index) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
   auto it = m_StockMap.find(pDoc);
   if (it == m_StockMap.end())
     return nullptr;
@@ -87,12 +88,14 @@ CPDF_Font* CPDF_FontGlobals::Find(CPDF_Document* pDoc, uint32_t index) {
 CPDF_Font* CPDF_FontGlobals::Set(CPDF_Document* pDoc,
                                  uint32_t index,
                                  std::unique_ptr<CPDF_Font> pFont) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
   if (!pdfium::ContainsKey(m_StockMap, pDoc))
     m_StockMap[pDoc] = pdfium::MakeUnique<CFX_StockFontArray>();
   return m_StockMap[pDoc]->SetFont(index, std::move(pFont));
 }
 
 void CPDF_FontGlobals::Clear(CPDF_Document* pDoc) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
   m_StockMap.erase(pDoc);
 }
 
@@ -275,13 +275,15 @@ CPDF_CMapManager::~CPDF_CMapManager() {}
 CFX_RetainPtr<CPDF_CMap> CPDF_CMapManager::GetPredefinedCMap(
     const CFX_ByteString& name,
     bool bPromptCJK) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
   auto it = m_CMaps.find(name);
   if (it != m_CMaps.end())
     return it->second;
 
   CFX_RetainPtr<CPDF_CMap> pCMap = LoadPredefinedCMap(name, bPromptCJK);
+  // The key outlives |name|'s document, so it must not share its buffer.
   if (!name.IsEmpty())
-    m_CMaps[name] = pCMap;
+    m_CMaps[CFX_ByteString(name.AsStringC())] = pCMap;
 
   return pCMap;
 }
@@ -300,6 +302,7 @@ CFX_RetainPtr<CPDF_CMap> CPDF_CMapManager::LoadPredefinedCMap(
 
 CPDF_CID2UnicodeMap* CPDF_CMapManager::GetCID2UnicodeMap(CIDSet charset,
                                                          bool bPromptCJK) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
   if (!m_CID2UnicodeMaps[charset])
     m_CID2UnicodeMaps[charset] = LoadCID2UnicodeMap(charset, bPromptCJK);
 
@@ -8,8 +8,11 @@
 
 #include <algorithm>
 #include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <utility>
+#include <vector>
 
 #include "core/fpdfapi/cpdf_modulemgr.h"
 #include "core/fpdfapi/page/cpdf_docpagedata.h"
@@ -62,6 +65,13 @@ const uint8_t g_sRGBSamples2[] = {
     250, 250, 251, 251, 251, 252, 252, 253, 253, 254, 254, 255, 255,
 };
 
+// Entries in CPDF_ImageColorCache for samples of three or four components.
+const int kImageColorCacheBits = 12;
+const uint32_t kImageColorCacheSize = 1 << kImageColorCacheBits;
+
+// Marks a filled-in CPDF_ImageColorCache entry.
+const uint32_t kCachedColor = 1 << 24;
+
 class CPDF_CalGray : public CPDF_ColorSpace {
  public:
   explicit CPDF_CalGray(CPDF_Document* pDoc);
@@ -167,6 +177,8 @@ class CPDF_ICCBasedCS : public CPDF_ColorSpace {
 
   CFX_MaybeOwned<CPDF_ColorSpace> m_pAlterCS;
   CFX_RetainPtr<CPDF_IccProfile> m_pProfile;
+  // Filled in once, by whichever thread first translates a large image.
+  mutable std::once_flag m_CacheOnce;
   uint8_t* m_pCache;
   float* m_pRanges;
 };
@@ -191,6 +203,34 @@ class CPDF_IndexedCS : public CPDF_ColorSpace {
   float* m_pCompMinMax;
 };
 
+// Memoizes the colours of 8-bit image samples for colour spaces that are
+// slow to convert, such as those with a tint transform. Samples of one or two
+// components index a table of every colour. Samples of three or four
+// components go through a direct-mapped cache keyed on the sample bytes.
+class CPDF_ImageColorCache {
+ public:
+  CPDF_ImageColorCache();
+  ~CPDF_ImageColorCache();
+
+  // Returns false if |pCS| has too many components to cache, or if another
+  // thread is using the cache. The caller then converts each pixel itself,
+  // which gives the same colours.
+  bool TranslateImageLine(const CPDF_ColorSpace* pCS,
+                          bool bStdConversion,
+                          uint8_t* dest_buf,
+                          const uint8_t* src_buf,
+                          int pixels);
+
+ private:
+  std::mutex m_Mutex;
+  uint32_t m_nComponents;
+  bool m_bStdConversion;
+  // BGR bytes of each colour, with kCachedColor set once it is filled in.
+  std::vector<uint32_t> m_Colors;
+  // The sample bytes each cache entry holds, for three or four components.
+  std::vector<uint32_t> m_Keys;
+};
+
 class CPDF_SeparationCS : public CPDF_ColorSpace {
  public:
   explicit CPDF_SeparationCS(CPDF_Document* pDoc);
@@ -203,10 +243,17 @@ class CPDF_SeparationCS : public CPDF_ColorSpace {
                        float* max) const override;
   bool v_Load(CPDF_Document* pDoc, CPDF_Array* pArray) override;
   bool GetRGB(float* pBuf, float* R, float* G, float* B) const override;
+  void TranslateImageLine(uint8_t* pDestBuf,
+                          const uint8_t* pSrcBuf,
+                          int pixels,
+                          int image_width,
+                          int image_height,
+                          bool bTransMask) const override;
   void EnableStdConversion(bool bEnabled) override;
 
   std::unique_ptr<CPDF_ColorSpace> m_pAltCS;
   std::unique_ptr<CPDF_Function> m_pFunc;
+  mutable CPDF_ImageColorCache m_ColorCache;
   enum { None, All, Colorant } m_Type;
 };
 
@@ -222,10 +269,17 @@ class CPDF_DeviceNCS : public CPDF_ColorSpace {
                        float* max) const override;
   bool v_Load(CPDF_Document* pDoc, CPDF_Array* pArray) override;
   bool GetRGB(float* pBuf, float* R, float* G, float* B) const override;
+  void TranslateImageLine(uint8_t* pDestBuf,
+                          const uint8_t* pSrcBuf,
+                          int pixels,
+                          int image_width,
+                          int image_height,
+                          bool bTransMask) const override;
   void EnableStdConversion(bool bEnabled) override;
 
   std::unique_ptr<CPDF_ColorSpace> m_pAltCS;
   std::unique_ptr<CPDF_Function> m_pFunc;
+  mutable CPDF_ImageColorCache m_ColorCache;
 };
 
 class Vector_3by1 {
@@ -347,6 +401,13 @@ void XYZ_to_sRGB_WhitePoint(float X,
   *B = RGB_Conversion(RGB.c);
 }
 
+// How many times each colour space has standard conversion switched on by
+// the current thread.
+std::map<const CPDF_ColorSpace*, uint32_t>& StdConversionCounts() {
+  static thread_local std::map<const CPDF_ColorSpace*, uint32_t> s_Counts;
+  return s_Counts;
+}
+
 }  // namespace
 
 CPDF_ColorSpace* CPDF_ColorSpace::ColorspaceFromName(
@@ -561,10 +622,20 @@ CPDF_ColorSpace* CPDF_ColorSpace::GetBaseCS() const {
 }
 
 void CPDF_ColorSpace::EnableStdConversion(bool bEnabled) {
-  if (bEnabled)
-    m_dwStdConversion++;
-  else if (m_dwStdConversion)
-    m_dwStdConversion--;
+  std::map<const CPDF_ColorSpace*, uint32_t>& counts = StdConversionCounts();
+  if (bEnabled) {
+    counts[this]++;
+    return;
+  }
+  auto it = counts.find(this);
+  if (it != counts.end() && --it->second == 0)
+    counts.erase(it);
+}
+
+bool CPDF_ColorSpace::IsStdConversionEnabled() const {
+  const std::map<const CPDF_ColorSpace*, uint32_t>& counts =
+      StdConversionCounts();
+  return !counts.empty() && pdfium::ContainsKey(counts, this);
 }
 
 CPDF_ColorSpace::CPDF_ColorSpace(CPDF_Document* pDoc,
@@ -573,8 +644,7 @@ CPDF_ColorSpace::CPDF_ColorSpace(CPDF_Document* pDoc,
     : m_pDocument(pDoc),
       m_Family(family),
       m_nComponents(nComponents),
-      m_pArray(nullptr),
-      m_dwStdConversion(0) {}
+      m_pArray(nullptr) {}
 
 CPDF_ColorSpace::~CPDF_ColorSpace() {}
 
@@ -907,7 +977,6 @@ bool CPDF_ICCBasedCS::GetRGB(float* pBuf, float* R, float* G, float* B) const {
   if (m_pProfile->transform()) {
     float rgb[3];
     CCodec_IccModule* pIccModule = CPDF_ModuleMgr::Get()->GetIccModule();
-    pIccModule->SetComponents(m_nComponents);
     pIccModule->Translate(m_pProfile->transform(), pBuf, rgb);
     *R = rgb[0];
     *G = rgb[1];
@@ -962,7 +1031,7 @@ void CPDF_ICCBasedCS::TranslateImageLine(uint8_t* pDestBuf,
       CPDF_ModuleMgr::Get()->GetIccModule()->TranslateScanline(
           m_pProfile->transform(), pDestBuf, pSrcBuf, pixels);
     } else {
-      if (!m_pCache) {
+      std::call_once(m_CacheOnce, [this, nMaxColors]() {
         ((CPDF_ICCBasedCS*)this)->m_pCache = FX_Alloc2D(uint8_t, nMaxColors, 3);
         uint8_t* temp_src = FX_Alloc2D(uint8_t, nMaxColors, m_nComponents);
         uint8_t* pSrc = temp_src;
@@ -978,7 +1047,7 @@ void CPDF_ICCBasedCS::TranslateImageLine(uint8_t* pDestBuf,
         CPDF_ModuleMgr::Get()->GetIccModule()->TranslateScanline(
             m_pProfile->transform(), m_pCache, temp_src, nMaxColors);
         FX_Free(temp_src);
-      }
+      });
       for (int i = 0; i < pixels; i++) {
         int index = 0;
         for (uint32_t c = 0; c < m_nComponents; c++) {
@@ -1179,6 +1248,68 @@ CPDF_ColorSpace* CPDF_PatternCS::GetBaseCS() const {
   return m_pBaseCS;
 }
 
+CPDF_ImageColorCache::CPDF_ImageColorCache()
+    : m_nComponents(0), m_bStdConversion(false) {}
+
+CPDF_ImageColorCache::~CPDF_ImageColorCache() {}
+
+bool CPDF_ImageColorCache::TranslateImageLine(const CPDF_ColorSpace* pCS,
+                                              bool bStdConversion,
+                                              uint8_t* dest_buf,
+                                              const uint8_t* src_buf,
+                                              int pixels) {
+  uint32_t nComponents = pCS->CountComponents();
+  if (nComponents == 0 || nComponents > 4)
+    return false;
+
+  std::unique_lock<std::mutex> lock(m_Mutex, std::try_to_lock);
+  if (!lock.owns_lock())
+    return false;
+
+  if (m_nComponents != nComponents || m_bStdConversion != bStdConversion) {
+    m_nComponents = nComponents;
+    m_bStdConversion = bStdConversion;
+    m_Colors.assign(
+        nComponents <= 2 ? 1 << (8 * nComponents) : kImageColorCacheSize, 0);
+    m_Keys.assign(nComponents <= 2 ? 0 : kImageColorCacheSize, 0);
+  }
+
+  float src[4];
+  for (int i = 0; i < pixels; i++) {
+    uint32_t key = 0;
+    for (uint32_t j = 0; j < nComponents; j++)
+      key = (key << 8) | src_buf[j];
+
+    uint32_t index = key;
+    if (nComponents > 2) {
+      index = (key * 2654435761u) >> (32 - kImageColorCacheBits);
+      if (m_Keys[index] != key)
+        m_Colors[index] = 0;
+    }
+    uint32_t color = m_Colors[index];
+    if (!(color & kCachedColor)) {
+      for (uint32_t j = 0; j < nComponents; j++)
+        src[j] = static_cast<float>(src_buf[j]) / 255;
+      float R = 0;
+      float G = 0;
+      float B = 0;
+      pCS->GetRGB(src, &R, &G, &B);
+      uint8_t blue = static_cast<int32_t>(B * 255);
+      uint8_t green = static_cast<int32_t>(G * 255);
+      uint8_t red = static_cast<int32_t>(R * 255);
+      color = kCachedColor | blue | green << 8 | red << 16;
+      m_Colors[index] = color;
+      if (nComponents > 2)
+        m_Keys[index] = key;
+    }
+    src_buf += nComponents;
+    *dest_buf++ = color & 0xff;
+    *dest_buf++ = (color >> 8) & 0xff;
+    *dest_buf++ = (color >> 16) & 0xff;
+  }
+  return true;
+}
+
 CPDF_SeparationCS::CPDF_SeparationCS(CPDF_Document* pDoc)
     : CPDF_ColorSpace(pDoc, PDFCS_SEPARATION, 1) {}
 
@@ -1251,6 +1382,20 @@ bool CPDF_SeparationCS::GetRGB(float* pBuf,
   return false;
 }
 
+void CPDF_SeparationCS::TranslateImageLine(uint8_t* pDestBuf,
+                                           const uint8_t* pSrcBuf,
+                                           int pixels,
+                                           int image_width,
+                                           int image_height,
+                                           bool bTransMask) const {
+  if (!m_ColorCache.TranslateImageLine(this, IsStdConversionEnabled(), pDestBuf,
+                                       pSrcBuf, pixels)) {
+    CPDF_ColorSpace::TranslateImageLine(pDestBuf, pSrcBuf, pixels,
+                                        image_width, image_height,
+                                        bTransMask);
+  }
+}
+
 void CPDF_SeparationCS::EnableStdConversion(bool bEnabled) {
   CPDF_ColorSpace::EnableStdConversion(bEnabled);
   if (m_pAltCS)
@@ -1302,6 +1447,20 @@ bool CPDF_DeviceNCS::GetRGB(float* pBuf, float* R, float* G, float* B) const {
   return m_pAltCS->GetRGB(results, R, G, B);
 }
 
+void CPDF_DeviceNCS::TranslateImageLine(uint8_t* pDestBuf,
+                                        const uint8_t* pSrcBuf,
+                                        int pixels,
+                                        int image_width,
+                                        int image_height,
+                                        bool bTransMask) const {
+  if (!m_ColorCache.TranslateImageLine(this, IsStdConversionEnabled(), pDestBuf,
+                                       pSrcBuf, pixels)) {
+    CPDF_ColorSpace::TranslateImageLine(pDestBuf, pSrcBuf, pixels,
+                                        image_width, image_height,
+                                        bTransMask);
+  }
+}
+
 void CPDF_DeviceNCS::EnableStdConversion(bool bEnabled) {
   CPDF_ColorSpace::EnableStdConversion(bEnabled);
   if (m_pAltCS) {
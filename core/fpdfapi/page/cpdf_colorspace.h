@@ -64,6 +64,9 @@ class CPDF_ColorSpace {
   CPDF_Array*& GetArray() { return m_pArray; }
   virtual CPDF_ColorSpace* GetBaseCS() const;
 
+  // Switches this colour space, and those it is based on, to the standard
+  // device conversions. This only affects the calling thread, since colour
+  // spaces are shared with documents that other threads may be rendering.
   virtual void EnableStdConversion(bool bEnabled);
 
   CPDF_Document* const m_pDocument;
@@ -80,10 +83,11 @@ class CPDF_ColorSpace {
                          float* k) const;
   virtual bool v_SetCMYK(float* pBuf, float c, float m, float y, float k) const;
 
+  bool IsStdConversionEnabled() const;
+
   int m_Family;
   uint32_t m_nComponents;
   CPDF_Array* m_pArray;
-  uint32_t m_dwStdConversion;
 };
 
 namespace std {
@@ -0,0 +1,227 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/page/cpdf_colorspace.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/fpdfapi/cpdf_modulemgr.h"
+#include "core/fpdfapi/parser/cpdf_array.h"
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fpdfapi/parser/cpdf_name.h"
+#include "core/fpdfapi/parser/cpdf_number.h"
+#include "core/fpdfapi/parser/cpdf_stream.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/base/ptr_util.h"
+
+namespace {
+
+// Returns a PostScript function of |nInputs| inputs giving CMYK outputs that
+// depend on every input.
+std::unique_ptr<CPDF_Stream> MakeTintTransform(int nInputs) {
+  static const char* const kOps[] = {"", "dup mul ", "0.5 mul 0.25 add ",
+                                     "0.3 mul "};
+  std::string program = "{ ";
+  for (int i = 0; i < 4; i++) {
+    int input = i % nInputs;
+    program += std::to_string(nInputs - 1 - input + i) + " index " + kOps[i];
+  }
+  program += std::to_string(nInputs + 4) + " 4 roll ";
+  for (int i = 0; i < nInputs; i++)
+    program += "pop ";
+  program += "}";
+
+  auto pDict = pdfium::MakeUnique<CPDF_Dictionary>();
+  pDict->SetNewFor<CPDF_Number>("FunctionType", 4);
+  CPDF_Array* pDomain = pDict->SetNewFor<CPDF_Array>("Domain");
+  for (int i = 0; i < nInputs; i++) {
+    pDomain->AddNew<CPDF_Number>(0);
+    pDomain->AddNew<CPDF_Number>(1);
+  }
+  CPDF_Array* pRange = pDict->SetNewFor<CPDF_Array>("Range");
+  for (int i = 0; i < 4; i++) {
+    pRange->AddNew<CPDF_Number>(0);
+    pRange->AddNew<CPDF_Number>(1);
+  }
+  auto pStream = pdfium::MakeUnique<CPDF_Stream>();
+  pStream->InitStream(reinterpret_cast<const uint8_t*>(program.c_str()),
+                      program.size(), std::move(pDict));
+  return pStream;
+}
+
+// Returns [/Separation /Spot /DeviceCMYK f] for one component, otherwise
+// [/DeviceN [...] /DeviceCMYK f].
+std::unique_ptr<CPDF_Array> MakeTintSpaceArray(int nComponents,
+                                               bool bSeparation) {
+  auto pArray = pdfium::MakeUnique<CPDF_Array>();
+  if (bSeparation) {
+    pArray->AddNew<CPDF_Name>("Separation");
+    pArray->AddNew<CPDF_Name>("Spot");
+  } else {
+    pArray->AddNew<CPDF_Name>("DeviceN");
+    CPDF_Array* pNames = pArray->AddNew<CPDF_Array>();
+    for (int i = 0; i < nComponents; i++)
+      pNames->AddNew<CPDF_Name>("Spot" + CFX_ByteString::FormatInteger(i));
+  }
+  pArray->AddNew<CPDF_Name>("DeviceCMYK");
+  pArray->Add(MakeTintTransform(nComponents));
+  return pArray;
+}
+
+// Converts |src| one pixel at a time with GetRGB(), the way
+// CPDF_ColorSpace::TranslateImageLine() does.
+std::vector<uint8_t> TranslatePerPixel(const CPDF_ColorSpace* pCS,
+                                       const std::vector<uint8_t>& src) {
+  uint32_t nComponents = pCS->CountComponents();
+  std::vector<uint8_t> dest;
+  std::vector<float> values(nComponents);
+  for (size_t i = 0; i < src.size(); i += nComponents) {
+    for (uint32_t j = 0; j < nComponents; j++)
+      values[j] = static_cast<float>(src[i + j]) / 255;
+    float R = 0;
+    float G = 0;
+    float B = 0;
+    pCS->GetRGB(values.data(), &R, &G, &B);
+    dest.push_back(static_cast<int32_t>(B * 255));
+    dest.push_back(static_cast<int32_t>(G * 255));
+    dest.push_back(static_cast<int32_t>(R * 255));
+  }
+  return dest;
+}
+
+std::vector<uint8_t> TranslateLine(const CPDF_ColorSpace* pCS,
+                                   const std::vector<uint8_t>& src) {
+  int pixels = src.size() / pCS->CountComponents();
+  std::vector<uint8_t> dest(pixels * 3);
+  pCS->TranslateImageLine(dest.data(), src.data(), pixels, pixels, 1, false);
+  return dest;
+}
+
+// Returns |pixels| samples of |nComponents| bytes from a fixed pseudo-random
+// sequence, with neighbouring pixels often repeated like in real images.
+std::vector<uint8_t> MakeSamples(int nComponents, int pixels) {
+  std::vector<uint8_t> src;
+  uint32_t seed = 12345;
+  for (int i = 0; i < pixels; i++) {
+    seed = seed * 1103515245 + 12345;
+    if (i > 0 && (seed >> 28) < 4) {
+      src.insert(src.end(), src.end() - nComponents, src.end());
+      continue;
+    }
+    for (int j = 0; j < nComponents; j++) {
+      seed = seed * 1103515245 + 12345;
+      src.push_back(seed >> 24);
+    }
+  }
+  return src;
+}
+
+}  // namespace
+
+class CPDF_ColorSpaceTest : public testing::Test {
+ protected:
+  void SetUp() override { CPDF_ModuleMgr::Get()->InitPageModule(); }
+
+  void TearDown() override { CPDF_ModuleMgr::Destroy(); }
+};
+
+TEST_F(CPDF_ColorSpaceTest, TranslateImageLineSeparation) {
+  std::unique_ptr<CPDF_Array> pArray = MakeTintSpaceArray(1, true);
+  std::unique_ptr<CPDF_ColorSpace> pCS =
+      CPDF_ColorSpace::Load(nullptr, pArray.get());
+  ASSERT_TRUE(pCS);
+  ASSERT_EQ(PDFCS_SEPARATION, pCS->GetFamily());
+
+  std::vector<uint8_t> src;
+  for (int i = 0; i < 256; i++)
+    src.push_back(255 - i);
+  std::vector<uint8_t> expected = TranslatePerPixel(pCS.get(), src);
+  EXPECT_EQ(expected, TranslateLine(pCS.get(), src));
+  // The second pass reads every colour back from the table.
+  EXPECT_EQ(expected, TranslateLine(pCS.get(), src));
+}
+
+TEST_F(CPDF_ColorSpaceTest, TranslateImageLineDeviceN) {
+  for (int nComponents = 1; nComponents <= 4; nComponents++) {
+    std::unique_ptr<CPDF_Array> pArray = MakeTintSpaceArray(nComponents, false);
+    std::unique_ptr<CPDF_ColorSpace> pCS =
+        CPDF_ColorSpace::Load(nullptr, pArray.get());
+    ASSERT_TRUE(pCS);
+    ASSERT_EQ(PDFCS_DEVICEN, pCS->GetFamily());
+    ASSERT_EQ(static_cast<uint32_t>(nComponents), pCS->CountComponents());
+
+    std::vector<uint8_t> src;
+    if (nComponents == 2) {
+      // Every sample of the 65536-entry table.
+      for (int i = 0; i < 65536; i++) {
+        src.push_back(i >> 8);
+        src.push_back(i & 0xff);
+      }
+    } else {
+      src = MakeSamples(nComponents, 1000);
+    }
+    std::vector<uint8_t> expected = TranslatePerPixel(pCS.get(), src);
+    EXPECT_EQ(expected, TranslateLine(pCS.get(), src)) << nComponents;
+    EXPECT_EQ(expected, TranslateLine(pCS.get(), src)) << nComponents;
+  }
+}
+
+TEST_F(CPDF_ColorSpaceTest, TranslateImageLineCollidingKeys) {
+  // Three and four components share a cache of 4096 entries, so a line of
+  // more distinct samples than that must hit some entries with several keys.
+  // Translating it forwards and backwards makes each key replace another.
+  for (int nComponents = 3; nComponents <= 4; nComponents++) {
+    std::unique_ptr<CPDF_Array> pArray = MakeTintSpaceArray(nComponents, false);
+    std::unique_ptr<CPDF_ColorSpace> pCS =
+        CPDF_ColorSpace::Load(nullptr, pArray.get());
+    ASSERT_TRUE(pCS);
+
+    std::vector<uint8_t> src;
+    for (int i = 0; i < 6000; i++) {
+      src.push_back(i & 0xff);
+      src.push_back((i >> 8) * 9);
+      src.push_back(i * 7);
+      if (nComponents == 4)
+        src.push_back(255 - (i >> 4));
+    }
+    std::vector<uint8_t> reversed;
+    for (size_t i = src.size(); i > 0; i -= nComponents)
+      reversed.insert(reversed.end(), src.begin() + i - nComponents,
+                      src.begin() + i);
+
+    std::vector<uint8_t> expected = TranslatePerPixel(pCS.get(), src);
+    std::vector<uint8_t> expected_reversed =
+        TranslatePerPixel(pCS.get(), reversed);
+    EXPECT_EQ(expected, TranslateLine(pCS.get(), src)) << nComponents;
+    EXPECT_EQ(expected_reversed, TranslateLine(pCS.get(), reversed))
+        << nComponents;
+    EXPECT_EQ(expected, TranslateLine(pCS.get(), src)) << nComponents;
+  }
+}
+
+TEST_F(CPDF_ColorSpaceTest, TranslateImageLineStdConversion) {
+  for (int nComponents = 1; nComponents <= 4; nComponents++) {
+    std::unique_ptr<CPDF_Array> pArray =
+        MakeTintSpaceArray(nComponents, nComponents == 1);
+    std::unique_ptr<CPDF_ColorSpace> pCS =
+        CPDF_ColorSpace::Load(nullptr, pArray.get());
+    ASSERT_TRUE(pCS);
+
+    std::vector<uint8_t> src = MakeSamples(nComponents, 500);
+    std::vector<uint8_t> expected = TranslatePerPixel(pCS.get(), src);
+    EXPECT_EQ(expected, TranslateLine(pCS.get(), src)) << nComponents;
+
+    // The DeviceCMYK alternate converts differently now, so colours
+    // remembered from before must not be reused.
+    pCS->EnableStdConversion(true);
+    std::vector<uint8_t> expected_std = TranslatePerPixel(pCS.get(), src);
+    EXPECT_NE(expected, expected_std) << nComponents;
+    EXPECT_EQ(expected_std, TranslateLine(pCS.get(), src)) << nComponents;
+
+    pCS->EnableStdConversion(false);
+    EXPECT_EQ(expected, TranslateLine(pCS.get(), src)) << nComponents;
+  }
+}
@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <utility>
 
@@ -50,6 +51,7 @@ CPDF_DocPageData::~CPDF_DocPageData() {
 }
 
 void CPDF_DocPageData::Clear(bool bForceRelease) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   m_bForceClear = bForceRelease;
 
   for (auto& it : m_PatternMap) {
@@ -106,6 +108,7 @@ void CPDF_DocPageData::Clear(bool bForceRelease) {
 }
 
 CPDF_Font* CPDF_DocPageData::GetFont(CPDF_Dictionary* pFontDict) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   if (!pFontDict)
     return nullptr;
 
@@ -132,6 +135,7 @@ CPDF_Font* CPDF_DocPageData::GetFont(CPDF_Dictionary* pFontDict) {
 
 CPDF_Font* CPDF_DocPageData::GetStandardFont(const CFX_ByteString& fontName,
                                              CPDF_FontEncoding* pEncoding) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   if (fontName.IsEmpty())
     return nullptr;
 
@@ -175,6 +179,7 @@ CPDF_Font* CPDF_DocPageData::GetStandardFont(const CFX_ByteString& fontName,
 }
 
 void CPDF_DocPageData::ReleaseFont(const CPDF_Dictionary* pFontDict) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   if (!pFontDict)
     return;
 
@@ -197,6 +202,7 @@ void CPDF_DocPageData::ReleaseFont(const CPDF_Dictionary* pFontDict) {
 CPDF_ColorSpace* CPDF_DocPageData::GetColorSpace(
     CPDF_Object* pCSObj,
     const CPDF_Dictionary* pResources) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   std::set<CPDF_Object*> visited;
   return GetColorSpaceImpl(pCSObj, pResources, &visited);
 }
@@ -282,6 +288,7 @@ CPDF_ColorSpace* CPDF_DocPageData::GetColorSpaceImpl(
 }
 
 CPDF_ColorSpace* CPDF_DocPageData::GetCopiedColorSpace(CPDF_Object* pCSObj) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   if (!pCSObj)
     return nullptr;
 
@@ -293,6 +300,7 @@ CPDF_ColorSpace* CPDF_DocPageData::GetCopiedColorSpace(CPDF_Object* pCSObj) {
 }
 
 void CPDF_DocPageData::ReleaseColorSpace(const CPDF_Object* pColorSpace) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   if (!pColorSpace)
     return;
 
@@ -316,6 +324,7 @@ void CPDF_DocPageData::ReleaseColorSpace(const CPDF_Object* pColorSpace) {
 CPDF_Pattern* CPDF_DocPageData::GetPattern(CPDF_Object* pPatternObj,
                                            bool bShading,
                                            const CFX_Matrix& matrix) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   if (!pPatternObj)
     return nullptr;
 
@@ -357,6 +366,7 @@ CPDF_Pattern* CPDF_DocPageData::GetPattern(CPDF_Object* pPatternObj,
 }
 
 void CPDF_DocPageData::ReleasePattern(const CPDF_Object* pPatternObj) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   if (!pPatternObj)
     return;
 
@@ -377,6 +387,7 @@ void CPDF_DocPageData::ReleasePattern(const CPDF_Object* pPatternObj) {
 }
 
 CFX_RetainPtr<CPDF_Image> CPDF_DocPageData::GetImage(uint32_t dwStreamObjNum) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   ASSERT(dwStreamObjNum);
   auto it = m_ImageMap.find(dwStreamObjNum);
   if (it != m_ImageMap.end())
@@ -388,6 +399,7 @@ CFX_RetainPtr<CPDF_Image> CPDF_DocPageData::GetImage(uint32_t dwStreamObjNum) {
 }
 
 void CPDF_DocPageData::MaybePurgeImage(uint32_t dwStreamObjNum) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   ASSERT(dwStreamObjNum);
   auto it = m_ImageMap.find(dwStreamObjNum);
   if (it != m_ImageMap.end() && it->second->HasOneRef())
@@ -396,6 +408,7 @@ void CPDF_DocPageData::MaybePurgeImage(uint32_t dwStreamObjNum) {
 
 CFX_RetainPtr<CPDF_IccProfile> CPDF_DocPageData::GetIccProfile(
     CPDF_Stream* pProfileStream) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   if (!pProfileStream)
     return nullptr;
 
@@ -417,13 +430,14 @@ CFX_RetainPtr<CPDF_IccProfile> CPDF_DocPageData::GetIccProfile(
       return it_copied_stream->second;
   }
   auto pProfile = pdfium::MakeRetain<CPDF_IccProfile>(
-      pProfileStream, pAccessor->GetData(), pAccessor->GetSize());
+      pProfileStream, pAccessor->GetData(), pAccessor->GetSize(), bsDigest);
   m_IccProfileMap[pProfileStream] = pProfile;
   m_HashProfileMap[bsDigest] = pProfileStream;
   return pProfile;
 }
 
 void CPDF_DocPageData::MaybePurgeIccProfile(CPDF_Stream* pProfileStream) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   ASSERT(pProfileStream);
   auto it = m_IccProfileMap.find(pProfileStream);
   if (it != m_IccProfileMap.end() && it->second->HasOneRef())
@@ -432,6 +446,7 @@ void CPDF_DocPageData::MaybePurgeIccProfile(CPDF_Stream* pProfileStream) {
 
 CFX_RetainPtr<CPDF_StreamAcc> CPDF_DocPageData::GetFontFileStreamAcc(
     CPDF_Stream* pFontStream) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   ASSERT(pFontStream);
   auto it = m_FontFileMap.find(pFontStream);
   if (it != m_FontFileMap.end())
@@ -451,6 +466,7 @@ CFX_RetainPtr<CPDF_StreamAcc> CPDF_DocPageData::GetFontFileStreamAcc(
 
 void CPDF_DocPageData::MaybePurgeFontFileStreamAcc(
     const CPDF_Stream* pFontStream) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   if (!pFontStream)
     return;
 
@@ -461,6 +477,7 @@ void CPDF_DocPageData::MaybePurgeFontFileStreamAcc(
 
 CPDF_CountedColorSpace* CPDF_DocPageData::FindColorSpacePtr(
     CPDF_Object* pCSObj) const {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   if (!pCSObj)
     return nullptr;
 
@@ -470,6 +487,7 @@ CPDF_CountedColorSpace* CPDF_DocPageData::FindColorSpacePtr(
 
 CPDF_CountedPattern* CPDF_DocPageData::FindPatternPtr(
     CPDF_Object* pPatternObj) const {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   if (!pPatternObj)
     return nullptr;
 
@@ -8,6 +8,7 @@
 #define CORE_FPDFAPI_PAGE_CPDF_DOCPAGEDATA_H_
 
 #include <map>
+#include <mutex>
 #include <set>
 
 #include "core/fpdfapi/page/cpdf_countedobject.h"
@@ -24,6 +25,8 @@ class CPDF_Object;
 class CPDF_Stream;
 class CPDF_StreamAcc;
 
+// Caches the fonts, colour spaces, patterns, images and ICC profiles that the
+// pages of a document share. It is safe to use from several threads.
 class CPDF_DocPageData {
  public:
   explicit CPDF_DocPageData(CPDF_Document* pPDFDoc);
@@ -59,6 +62,10 @@ class CPDF_DocPageData {
   CPDF_CountedColorSpace* FindColorSpacePtr(CPDF_Object* pCSObj) const;
   CPDF_CountedPattern* FindPatternPtr(CPDF_Object* pPatternObj) const;
 
+  // Held while loading a cached object. It is recursive, since loading one
+  // object can load others, such as the base of an indexed colour space.
+  std::recursive_mutex* GetMutex() const { return &m_Mutex; }
+
  private:
   using CPDF_CountedFont = CPDF_CountedObject<CPDF_Font>;
 
@@ -67,6 +74,7 @@ class CPDF_DocPageData {
                                      std::set<CPDF_Object*>* pVisited);
 
   CPDF_Document* const m_pPDFDoc;
+  mutable std::recursive_mutex m_Mutex;
   bool m_bForceClear;
   std::map<CFX_ByteString, CPDF_Stream*> m_HashProfileMap;
   std::map<const CPDF_Object*, CPDF_CountedColorSpace*> m_ColorSpaceMap;
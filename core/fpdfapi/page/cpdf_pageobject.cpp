@@ -6,7 +6,9 @@
 
 #include "core/fpdfapi/page/cpdf_pageobject.h"
 
-CPDF_PageObject::CPDF_PageObject() {}
+#include "core/fpdfapi/page/cpdf_pageobjectholder.h"
+
+CPDF_PageObject::CPDF_PageObject() : m_pHolder(nullptr) {}
 
 CPDF_PageObject::~CPDF_PageObject() {}
 
@@ -97,3 +99,8 @@ FX_RECT CPDF_PageObject::GetBBox(const CFX_Matrix* pMatrix) const {
   }
   return rect.GetOuterRect();
 }
+
+void CPDF_PageObject::SetEdited() {
+  if (m_pHolder)
+    m_pHolder->SetEdited();
+}
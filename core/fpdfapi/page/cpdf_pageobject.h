@@ -15,6 +15,7 @@
 class CPDF_TextObject;
 class CPDF_PathObject;
 class CPDF_ImageObject;
+class CPDF_PageObjectHolder;
 class CPDF_ShadingObject;
 class CPDF_FormObject;
 
@@ -57,6 +58,13 @@ class CPDF_PageObject : public CPDF_GraphicStates {
   }
   FX_RECT GetBBox(const CFX_Matrix* pMatrix) const;
 
+  // The holder whose object list owns this object, if any.
+  CPDF_PageObjectHolder* GetHolder() const { return m_pHolder; }
+  void SetHolder(CPDF_PageObjectHolder* pHolder) { m_pHolder = pHolder; }
+
+  // Tells the holder, if any, that this object has been changed.
+  void SetEdited();
+
   float m_Left;
   float m_Right;
   float m_Top;
@@ -69,6 +77,8 @@ class CPDF_PageObject : public CPDF_GraphicStates {
  private:
   CPDF_PageObject(const CPDF_PageObject& src) = delete;
   void operator=(const CPDF_PageObject& src) = delete;
+
+  CPDF_PageObjectHolder* m_pHolder;
 };
 
 #endif  // CORE_FPDFAPI_PAGE_CPDF_PAGEOBJECT_H_
@@ -7,11 +7,14 @@
 #include "core/fpdfapi/page/cpdf_pageobjectholder.h"
 
 #include <algorithm>
+#include <utility>
 
 #include "core/fpdfapi/page/cpdf_contentparser.h"
 #include "core/fpdfapi/page/cpdf_pageobject.h"
 #include "core/fpdfapi/page/pageint.h"
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fxcrt/cfx_rectindex.h"
+#include "third_party/base/ptr_util.h"
 
 CPDF_PageObjectHolder::CPDF_PageObjectHolder(CPDF_Document* pDoc,
                                              CPDF_Dictionary* pFormDict)
@@ -22,7 +25,9 @@ CPDF_PageObjectHolder::CPDF_PageObjectHolder(CPDF_Document* pDoc,
       m_pResources(nullptr),
       m_Transparency(0),
       m_bBackgroundAlphaNeeded(false),
-      m_ParseState(CONTENT_NOT_PARSED) {}
+      m_EditGeneration(0),
+      m_ParseState(CONTENT_NOT_PARSED),
+      m_ObjectIndexGeneration(0) {}
 
 CPDF_PageObjectHolder::~CPDF_PageObjectHolder() {}
 
@@ -38,6 +43,18 @@ void CPDF_PageObjectHolder::ContinueParse(IFX_Pause* pPause) {
   m_pParser.reset();
 }
 
+void CPDF_PageObjectHolder::AppendPageObject(
+    std::unique_ptr<CPDF_PageObject> pPageObj) {
+  pPageObj->SetHolder(this);
+  m_PageObjectList.push_back(std::move(pPageObj));
+}
+
+void CPDF_PageObjectHolder::SetEdited() {
+  // Skips zero on wrapping around, which would mean unedited.
+  if (++m_EditGeneration == 0)
+    m_EditGeneration = 1;
+}
+
 void CPDF_PageObjectHolder::AddImageMaskBoundingBox(const CFX_FloatRect& box) {
   m_MaskBoundingBoxes.push_back(box);
 }
@@ -45,6 +62,7 @@ void CPDF_PageObjectHolder::AddImageMaskBoundingBox(const CFX_FloatRect& box) {
 void CPDF_PageObjectHolder::Transform(const CFX_Matrix& matrix) {
   for (auto& pObj : m_PageObjectList)
     pObj->Transform(matrix);
+  SetEdited();
 }
 
 CFX_FloatRect CPDF_PageObjectHolder::CalcBoundingBox() const {
@@ -64,6 +82,31 @@ CFX_FloatRect CPDF_PageObjectHolder::CalcBoundingBox() const {
   return CFX_FloatRect(left, bottom, right, top);
 }
 
+const CFX_RectIndex* CPDF_PageObjectHolder::GetObjectIndex() const {
+  if (!IsParsed() || m_PageObjectList.size() < CFX_RectIndex::kMinRects)
+    return nullptr;
+
+  std::lock_guard<std::mutex> lock(m_ObjectIndexMutex);
+  if (m_pObjectIndex && m_ObjectIndexGeneration == m_EditGeneration &&
+      m_pObjectIndex->size() == m_PageObjectList.size()) {
+    return m_pObjectIndex.get();
+  }
+
+  std::vector<CFX_FloatRect> boxes;
+  boxes.reserve(m_PageObjectList.size());
+  for (const auto& pObj : m_PageObjectList) {
+    CFX_FloatRect box;
+    if (pObj) {
+      box = CFX_FloatRect(pObj->m_Left, pObj->m_Bottom, pObj->m_Right,
+                          pObj->m_Top);
+    }
+    boxes.push_back(box);
+  }
+  m_pObjectIndex = pdfium::MakeUnique<CFX_RectIndex>(boxes);
+  m_ObjectIndexGeneration = m_EditGeneration;
+  return m_pObjectIndex.get();
+}
+
 void CPDF_PageObjectHolder::LoadTransInfo() {
   if (!m_pFormDict) {
     return;
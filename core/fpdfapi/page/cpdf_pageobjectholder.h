@@ -8,6 +8,7 @@
 #define CORE_FPDFAPI_PAGE_CPDF_PAGEOBJECTHOLDER_H_
 
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include "core/fpdfapi/page/cpdf_pageobjectlist.h"
@@ -15,6 +16,7 @@
 #include "core/fxcrt/fx_system.h"
 
 class IFX_Pause;
+class CFX_RectIndex;
 class CPDF_Dictionary;
 class CPDF_Stream;
 class CPDF_Document;
@@ -42,6 +44,16 @@ class CPDF_PageObjectHolder {
     m_bBackgroundAlphaNeeded = needed;
   }
 
+  // Appends |pPageObj| to the object list and makes this its holder.
+  void AppendPageObject(std::unique_ptr<CPDF_PageObject> pPageObj);
+
+  // Bumped by every change made to the objects, or to the page they belong
+  // to, after parsing, so that anything derived from them can tell when it
+  // is out of date. Zero as long as they match what the contents give.
+  uint32_t GetEditGeneration() const { return m_EditGeneration; }
+  bool IsEdited() const { return m_EditGeneration != 0; }
+  void SetEdited();
+
   bool HasImageMask() const { return !m_MaskBoundingBoxes.empty(); }
   const std::vector<CFX_FloatRect>& GetMaskBoundingBoxes() const {
     return m_MaskBoundingBoxes;
@@ -50,6 +62,13 @@ class CPDF_PageObjectHolder {
   void Transform(const CFX_Matrix& matrix);
   CFX_FloatRect CalcBoundingBox() const;
 
+  // Returns an index of the object bounding boxes by position in the page
+  // object list, building it on first use and again after edits. Returns
+  // null while the contents are being parsed, or when there are too few
+  // objects to need one. Forms of patterns are shared between pages, so
+  // several threads may ask at once.
+  const CFX_RectIndex* GetObjectIndex() const;
+
   CPDF_Dictionary* m_pFormDict;
   CPDF_Stream* m_pFormStream;
   CPDF_Document* m_pDocument;
@@ -64,10 +83,14 @@ class CPDF_PageObjectHolder {
   void LoadTransInfo();
 
   bool m_bBackgroundAlphaNeeded;
+  uint32_t m_EditGeneration;
   std::vector<CFX_FloatRect> m_MaskBoundingBoxes;
   ParseState m_ParseState;
   std::unique_ptr<CPDF_ContentParser> m_pParser;
   CPDF_PageObjectList m_PageObjectList;
+  mutable std::mutex m_ObjectIndexMutex;
+  mutable std::unique_ptr<CFX_RectIndex> m_pObjectIndex;
+  mutable uint32_t m_ObjectIndexGeneration;
 };
 
 #endif  // CORE_FPDFAPI_PAGE_CPDF_PAGEOBJECTHOLDER_H_
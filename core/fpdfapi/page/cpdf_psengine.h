@@ -71,7 +71,11 @@ class CPDF_PSProc {
   ~CPDF_PSProc();
 
   bool Parse(CPDF_SimpleParser* parser, int depth);
-  bool Execute(CPDF_PSEngine* pEngine);
+  bool Execute(CPDF_PSEngine* pEngine) const;
+
+  const std::vector<std::unique_ptr<CPDF_PSOP>>& GetOperators() const {
+    return m_Operators;
+  }
 
  private:
   static const int kMaxDepth = 128;
@@ -85,11 +89,19 @@ class CPDF_PSEngine {
 
   bool Parse(const char* str, int size);
   bool Execute();
+  // Interprets the parsed program on a stack of its own, holding |nInputs|
+  // values to start with. Returns false if fewer than |nOutputs| values are
+  // left, otherwise stores the topmost ones in |results|, deepest first.
+  bool Run(const float* inputs,
+           uint32_t nInputs,
+           float* results,
+           uint32_t nOutputs) const;
   bool DoOperator(PDF_PSOP op);
   void Reset() { m_StackCount = 0; }
   void Push(float value);
   float Pop();
   uint32_t GetStackSize() const { return m_StackCount; }
+  const CPDF_PSProc& GetMainProc() const { return m_MainProc; }
 
  private:
   float m_Stack[PSENGINE_STACKSIZE];
@@ -97,4 +109,62 @@ class CPDF_PSEngine {
   CPDF_PSProc m_MainProc;
 };
 
+// A PostScript calculator program compiled for a given number of inputs.
+// The stack depth is resolved at compile time, so stack slots become
+// registers, operators on constants are folded, and only branches on
+// computed values remain. The results match those of CPDF_PSEngine::Run().
+// A compiled program is not modified by running it, so several threads may
+// run it at once.
+class CPDF_PSProgram {
+ public:
+  CPDF_PSProgram();
+  ~CPDF_PSProgram();
+
+  // Returns false if the program cannot be compiled, because its stack
+  // depth depends on the inputs. Such programs have to be interpreted.
+  bool Compile(const CPDF_PSProc& proc, uint32_t nInputs, uint32_t nOutputs);
+
+  // Returns false, like CPDF_PSEngine, if the program leaves fewer than
+  // |nOutputs| values on the stack.
+  bool Run(const float* inputs, float* results) const;
+
+  // Runs the program for |count| sets of inputs and results, each stored
+  // one after another.
+  bool RunBatch(const float* inputs, float* results, uint32_t count) const;
+
+ private:
+  enum class OpType : uint8_t {
+    kConst,
+    kMove,
+    kUnary,
+    kBinary,
+    kJumpIfZero,
+    kJump
+  };
+
+  struct Instruction {
+    OpType type;
+    PDF_PSOP op;
+    uint32_t dest;
+    uint32_t src1;
+    uint32_t src2;
+    float value;
+  };
+
+  struct Output {
+    bool bConst;
+    float value;
+    uint32_t reg;
+  };
+
+  friend class CPDF_PSCompiler;
+
+  uint32_t m_nInputs;
+  uint32_t m_nRegisters;
+  bool m_bEnoughOutputs;
+  bool m_bHasJumps;
+  std::vector<Instruction> m_Instructions;
+  std::vector<Output> m_Outputs;
+};
+
 #endif  // CORE_FPDFAPI_PAGE_CPDF_PSENGINE_H_
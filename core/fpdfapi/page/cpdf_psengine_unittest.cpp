@@ -0,0 +1,266 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/page/cpdf_psengine.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "core/fpdfapi/page/pageint.h"
+#include "core/fpdfapi/parser/cpdf_array.h"
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fpdfapi/parser/cpdf_number.h"
+#include "core/fpdfapi/parser/cpdf_stream.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/base/ptr_util.h"
+
+namespace {
+
+const float kRangeLimit = 10;
+
+// Returns a type 4 function stream running |program| on |nInputs| inputs in
+// [0, 1], with |nOutputs| results in [-kRangeLimit, kRangeLimit].
+std::unique_ptr<CPDF_Stream> MakePSFunctionStream(const char* program,
+                                                  uint32_t nInputs,
+                                                  uint32_t nOutputs) {
+  auto pDict = pdfium::MakeUnique<CPDF_Dictionary>();
+  pDict->SetNewFor<CPDF_Number>("FunctionType", 4);
+  CPDF_Array* pDomain = pDict->SetNewFor<CPDF_Array>("Domain");
+  for (uint32_t i = 0; i < nInputs; i++) {
+    pDomain->AddNew<CPDF_Number>(0);
+    pDomain->AddNew<CPDF_Number>(1);
+  }
+  CPDF_Array* pRange = pDict->SetNewFor<CPDF_Array>("Range");
+  for (uint32_t i = 0; i < nOutputs; i++) {
+    pRange->AddNew<CPDF_Number>(-kRangeLimit);
+    pRange->AddNew<CPDF_Number>(kRangeLimit);
+  }
+  auto pStream = pdfium::MakeUnique<CPDF_Stream>();
+  pStream->InitStream(reinterpret_cast<const uint8_t*>(program),
+                      strlen(program), std::move(pDict));
+  return pStream;
+}
+
+// Tint transforms taken from Separation and DeviceN colour spaces in
+// real documents.
+const struct {
+  const char* name;
+  const char* program;
+  uint32_t nInputs;
+  uint32_t nOutputs;
+} kTintTransforms[] = {
+    {"separation to cmyk",
+     "{dup 0 mul exch dup 0.68 mul exch dup 0.99 mul exch 0.12 mul}", 1, 4},
+    {"separation to rgb",
+     "{dup 1 exch sub 0.2 mul 1 exch sub exch dup 1 exch sub 0.6 mul 1 exch "
+     "sub exch 1 exch sub 0.9 mul 1 exch sub}",
+     1, 3},
+    {"devicen to cmyk",
+     "{2 copy 0.9 mul exch 0.1 mul add dup 1 gt {pop 1} if 3 1 roll 2 copy "
+     "0.2 mul exch 0.7 mul add 3 1 roll 0.5 mul exch 0.3 mul add 0}",
+     2, 4},
+    {"split ramp",
+     "{dup 0.5 lt {2 mul 0 exch 1 exch sub 0} {0.5 sub 2 mul 1 0 3 -1 roll} "
+     "ifelse}",
+     1, 3},
+};
+
+}  // namespace
+
+TEST(cpdf_psengine, CompiledMatchesInterpreter) {
+  struct {
+    const char* program;
+    uint32_t nInputs;
+    uint32_t nOutputs;
+  } const kTests[] = {
+      // Tint transforms as they appear in Separation and DeviceN spaces.
+      {"{dup 0.1 mul exch dup 0.7 mul exch 0.25 mul 0}", 1, 4},
+      {"{2 copy mul 3 1 roll exch 1 exch sub}", 2, 3},
+      {"{1 index 2 index add 0.5 mul 3 -1 roll pop}", 2, 2},
+      // Branches on the inputs, nested and on constants.
+      {"{dup 0.5 gt {0.5 sub 2 mul} {2 mul 1 exch sub} ifelse 1}", 1, 2},
+      {"{dup 0.25 lt {pop 0} if dup 0.75 gt {1 sub neg} if}", 1, 1},
+      {"{2 copy gt {exch} if dup 0.5 ge {pop 1 0} {0.1 lt {0 1} {1 1} ifelse}"
+       " ifelse}",
+       2, 3},
+      {"{1 2 lt {3 mul} {4 mul} ifelse true {1 add} if false {pop 0} if}", 1,
+       1},
+      // Integer, comparison and transcendental operators.
+      {"{100 mul cvi 7 idiv 10 mod 3 bitshift -1 bitshift 255 and 255 div}", 1,
+       1},
+      {"{dup 360 mul sin exch dup 180 mul cos exch 1 exch atan 360 div}", 1, 3},
+      {"{dup 0 eq exch dup 2 exp sqrt exch 1 add ln exch 10 mul log}", 1, 4},
+      {"{round exch ceiling exch floor truncate abs not xor}", 2, 1},
+      // Popping an empty stack gives 0.
+      {"{pop pop pop 1 add}", 2, 1},
+      // Too few results.
+      {"{pop}", 2, 2},
+  };
+  const float kInputs[][2] = {{0, 0},       {1, 1},     {0.3f, 0.8f},
+                              {0.5f, 0.5f}, {0.9f, 0.1f}, {0.71f, 0.26f}};
+  for (const auto& test : kTests) {
+    CPDF_PSEngine engine;
+    ASSERT_TRUE(engine.Parse(test.program, strlen(test.program)))
+        << test.program;
+    CPDF_PSProgram program;
+    ASSERT_TRUE(program.Compile(engine.GetMainProc(), test.nInputs,
+                                test.nOutputs))
+        << test.program;
+    for (const auto& inputs : kInputs) {
+      float expected[4] = {-1, -1, -1, -1};
+      float actual[4] = {-1, -1, -1, -1};
+      bool result =
+          engine.Run(inputs, test.nInputs, expected, test.nOutputs);
+      EXPECT_EQ(result, program.Run(inputs, actual)) << test.program;
+      for (uint32_t i = 0; i < test.nOutputs; i++)
+        EXPECT_FLOAT_EQ(expected[i], actual[i]) << test.program;
+    }
+  }
+}
+
+TEST(cpdf_psengine, CompileInputDependentStack) {
+  // The stack depth depends on the input, so these have to be interpreted.
+  const char* const kPrograms[] = {
+      "{dup 3 mul cvi copy}", "{1 2 3 4 4 index 3 mul cvi index}",
+      "{1 2 3 4 4 index 3 mul cvi 3 exch roll}", "{dup 0.5 gt {1 2} if}",
+      "{dup 0.5 gt {1 2} {3} ifelse}"};
+  for (const char* program_text : kPrograms) {
+    CPDF_PSEngine engine;
+    ASSERT_TRUE(engine.Parse(program_text, strlen(program_text)));
+    CPDF_PSProgram program;
+    EXPECT_FALSE(program.Compile(engine.GetMainProc(), 1, 1)) << program_text;
+  }
+}
+
+TEST(cpdf_psengine, RunBatch) {
+  const char* const kPrograms[] = {
+      "{dup 0.1 mul exch dup 0.7 mul exch 0.25 mul 0}",
+      "{dup 0.5 gt {0.2 add 1 0} {0.3 mul 0 1} ifelse 0.5}"};
+  std::vector<float> inputs(150);
+  for (size_t i = 0; i < inputs.size(); i++)
+    inputs[i] = static_cast<float>(i) / inputs.size();
+  for (const char* program_text : kPrograms) {
+    CPDF_PSEngine engine;
+    ASSERT_TRUE(engine.Parse(program_text, strlen(program_text)));
+    CPDF_PSProgram program;
+    ASSERT_TRUE(program.Compile(engine.GetMainProc(), 1, 4));
+    std::vector<float> results(inputs.size() * 4);
+    ASSERT_TRUE(program.RunBatch(inputs.data(), results.data(),
+                                 static_cast<uint32_t>(inputs.size())));
+    for (size_t i = 0; i < inputs.size(); i++) {
+      float expected[4];
+      ASSERT_TRUE(program.Run(&inputs[i], expected));
+      for (size_t j = 0; j < 4; j++)
+        EXPECT_FLOAT_EQ(expected[j], results[i * 4 + j]) << program_text;
+    }
+  }
+}
+
+TEST(cpdf_psengine, FunctionMatchesInterpreter) {
+  // Type 4 functions run compiled when they can, through both Call() and
+  // CallBatch(), and interpreted otherwise. Either way the results have to
+  // be those of the interpreter.
+  const char* const kPrograms[] = {
+      "{dup 0.5 gt {0.5 sub 2 mul} {2 mul 1 exch sub} ifelse 1}",
+      "{dup 360 mul sin exch dup 180 mul cos exch 1 exch atan 360 div}",
+      "{dup 0.25 lt {pop 0} if dup 0.75 gt {1 sub neg} if 0.5}",
+      "{dup dup dup 3 mul cvi 1 add copy}",
+      "{dup 0.5 gt {1 2} if 1 1}",
+  };
+  const uint32_t kCount = 100;
+  std::vector<float> inputs(kCount);
+  for (uint32_t i = 0; i < kCount; i++)
+    inputs[i] = static_cast<float>(i) / (kCount - 1);
+
+  for (const char* program : kPrograms) {
+    CPDF_PSEngine engine;
+    ASSERT_TRUE(engine.Parse(program, strlen(program))) << program;
+    std::unique_ptr<CPDF_Stream> pStream = MakePSFunctionStream(program, 1, 2);
+    std::unique_ptr<CPDF_Function> pFunc = CPDF_Function::Load(pStream.get());
+    ASSERT_TRUE(pFunc) << program;
+
+    std::vector<float> batch_results(kCount * 2);
+    int nresults = 0;
+    ASSERT_TRUE(pFunc->CallBatch(inputs.data(), 1, kCount,
+                                 batch_results.data(), &nresults));
+    EXPECT_EQ(2, nresults);
+    for (uint32_t i = 0; i < kCount; i++) {
+      float expected[2];
+      ASSERT_TRUE(engine.Run(&inputs[i], 1, expected, 2)) << program;
+      float input = inputs[i];
+      float results[2];
+      ASSERT_TRUE(pFunc->Call(&input, 1, results, &nresults));
+      for (uint32_t j = 0; j < 2; j++) {
+        float clamped =
+            std::min(std::max(expected[j], -kRangeLimit), kRangeLimit);
+        EXPECT_FLOAT_EQ(clamped, results[j]) << program << " " << inputs[i];
+        EXPECT_FLOAT_EQ(clamped, batch_results[i * 2 + j])
+            << program << " " << inputs[i];
+      }
+    }
+  }
+}
+
+TEST(cpdf_psengine, RunAfterRun) {
+  // A compiled program keeps no state between runs, so interleaving inputs
+  // gives the same results as running each on its own.
+  const char* program = kTintTransforms[2].program;
+  CPDF_PSEngine engine;
+  ASSERT_TRUE(engine.Parse(program, strlen(program)));
+  CPDF_PSProgram compiled;
+  ASSERT_TRUE(compiled.Compile(engine.GetMainProc(), 2, 4));
+  const float kInputs[][2] = {{0.9f, 0.8f}, {0.1f, 0.2f}, {0.9f, 0.8f}};
+  float first[4];
+  ASSERT_TRUE(compiled.Run(kInputs[0], first));
+  float other[4];
+  ASSERT_TRUE(compiled.Run(kInputs[1], other));
+  float again[4];
+  ASSERT_TRUE(compiled.Run(kInputs[2], again));
+  for (size_t i = 0; i < 4; i++)
+    EXPECT_EQ(first[i], again[i]);
+}
+
+// Compares the interpreter with the compiled tint transforms, one input set
+// at a time and in batches, and prints nanoseconds per input set. Run with
+// --gtest_also_run_disabled_tests --gtest_filter=*TintTransformSpeed.
+TEST(cpdf_psengine, DISABLED_TintTransformSpeed) {
+  const uint32_t kCount = 1 << 20;
+  std::vector<float> inputs(kCount * 2);
+  for (uint32_t i = 0; i < inputs.size(); i++)
+    inputs[i] = static_cast<float>(i % 1000) / 1000;
+  std::vector<float> results(kCount * 4);
+  for (const auto& tint : kTintTransforms) {
+    CPDF_PSEngine engine;
+    ASSERT_TRUE(engine.Parse(tint.program, strlen(tint.program)));
+    CPDF_PSProgram program;
+    ASSERT_TRUE(program.Compile(engine.GetMainProc(), tint.nInputs,
+                                tint.nOutputs));
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < kCount; i++) {
+      engine.Run(&inputs[i * tint.nInputs], tint.nInputs,
+                 &results[i * tint.nOutputs], tint.nOutputs);
+    }
+    auto interpreted = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < kCount; i++)
+      program.Run(&inputs[i * tint.nInputs], &results[i * tint.nOutputs]);
+    auto compiled = std::chrono::steady_clock::now();
+    program.RunBatch(inputs.data(), results.data(), kCount);
+    auto batch = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double, std::nano> interpreted_ns =
+        interpreted - start;
+    std::chrono::duration<double, std::nano> compiled_ns =
+        compiled - interpreted;
+    std::chrono::duration<double, std::nano> batch_ns = batch - compiled;
+    printf("%-20s interpreted %6.1f ns  compiled %6.1f ns  batch %6.1f ns\n",
+           tint.name, interpreted_ns.count() / kCount,
+           compiled_ns.count() / kCount, batch_ns.count() / kCount);
+  }
+}
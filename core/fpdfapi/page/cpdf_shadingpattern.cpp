@@ -62,6 +62,7 @@ CPDF_ShadingPattern* CPDF_ShadingPattern::AsShadingPattern() {
 }
 
 bool CPDF_ShadingPattern::Load() {
+  std::lock_guard<std::mutex> lock(m_LoadMutex);
   if (m_ShadingType != kInvalidShading)
     return true;
 
@@ -8,6 +8,7 @@
 #define CORE_FPDFAPI_PAGE_CPDF_SHADINGPATTERN_H_
 
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include "core/fpdfapi/page/cpdf_countedobject.h"
@@ -49,6 +50,9 @@ class CPDF_ShadingPattern : public CPDF_Pattern {
            m_ShadingType == kCoonsPatchMeshShading ||
            m_ShadingType == kTensorProductPatchMeshShading;
   }
+
+  // Loads the shading the first time it is called. Pages that share the
+  // pattern may call it from several threads at once.
   bool Load();
 
   ShadingType GetShadingType() const { return m_ShadingType; }
@@ -60,6 +64,7 @@ class CPDF_ShadingPattern : public CPDF_Pattern {
   }
 
  private:
+  std::mutex m_LoadMutex;
   ShadingType m_ShadingType;
   bool m_bShadingObj;
   CPDF_Object* m_pShadingObj;
@@ -6,7 +6,9 @@
 
 #include "core/fpdfapi/page/cpdf_streamcontentparser.h"
 
+#include <cctype>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <vector>
 
@@ -34,6 +36,7 @@
 #include "core/fpdfapi/parser/cpdf_reference.h"
 #include "core/fpdfapi/parser/cpdf_stream.h"
 #include "core/fpdfapi/parser/fpdf_parser_decode.h"
+#include "core/fxcrt/fx_extension.h"
 #include "core/fxcrt/fx_safe_types.h"
 #include "core/fxge/cfx_graphstatedata.h"
 #include "third_party/base/ptr_util.h"
@@ -56,6 +59,56 @@ const char kPathOperatorCubicBezier3 = 'y';
 const char kPathOperatorClosePath = 'h';
 const char kPathOperatorRectangle[] = "re";
 
+// Converts a content stream number like FX_atonum() does, with the same
+// results, but in a single pass for the short plain numbers that make up
+// nearly all operands. Returns true for integers.
+bool ParseNumber(const CFX_ByteStringC& word, void* pData) {
+  // Up to 7 digits fit into a float exactly, so the integer part comes out
+  // the same as when FX_atof() accumulates it digit by digit.
+  const int kMaxFastDigits = 7;
+
+  int len = word.GetLength();
+  int cc = 0;
+  bool bNegative = false;
+  if (len > 0 && (word[0] == '-' || word[0] == '+')) {
+    bNegative = word[0] == '-';
+    cc++;
+  }
+  int value = 0;
+  int digits = 0;
+  while (cc < len && std::isdigit(word[cc])) {
+    if (++digits > kMaxFastDigits)
+      return FX_atonum(word, pData);
+
+    value = value * 10 + FXSYS_DecimalCharToInt(word.CharAt(cc));
+    cc++;
+  }
+  if (cc == len) {
+    if (digits == 0)
+      return FX_atonum(word, pData);
+
+    *static_cast<int*>(pData) = bNegative ? -value : value;
+    return true;
+  }
+  if (word[cc] != '.')
+    return FX_atonum(word, pData);
+
+  float fValue = static_cast<float>(value);
+  int scale = 0;
+  for (cc++; cc < len && scale < FXSYS_FractionalScaleCount(); cc++) {
+    if (!std::isdigit(word[cc]))
+      return FX_atonum(word, pData);
+
+    fValue +=
+        FXSYS_FractionalScale(scale++, FXSYS_DecimalCharToInt(word.CharAt(cc)));
+  }
+  if (cc < len)
+    return FX_atonum(word, pData);
+
+  *static_cast<float*>(pData) = bNegative ? -fValue : fValue;
+  return false;
+}
+
 class CPDF_StreamParserAutoClearer {
  public:
   CPDF_StreamParserAutoClearer(CPDF_StreamParser** scoped_variable,
@@ -244,6 +297,10 @@ CFX_ByteStringC PDF_FindValueAbbreviationForTesting(
   return FindFullName(InlineValueAbbr, FX_ArraySize(InlineValueAbbr), abbr);
 }
 
+bool PDF_ParseNumberForTesting(const CFX_ByteStringC& word, void* pData) {
+  return ParseNumber(word, pData);
+}
+
 CPDF_StreamContentParser::CPDF_StreamContentParser(
     CPDF_Document* pDocument,
     CPDF_Dictionary* pPageResources,
@@ -339,7 +396,7 @@ void CPDF_StreamContentParser::AddNameParam(const CFX_ByteStringC& bsName) {
 void CPDF_StreamContentParser::AddNumberParam(const CFX_ByteStringC& str) {
   ContentParam& param = m_ParamBuf[GetNextParamPos()];
   param.m_Type = ContentParam::NUMBER;
-  param.m_Number.m_bInteger = FX_atonum(str, &param.m_Number.m_Integer);
+  param.m_Number.m_bInteger = ParseNumber(str, &param.m_Number.m_Integer);
 }
 
 void CPDF_StreamContentParser::AddObjectParam(
@@ -448,133 +505,226 @@ void CPDF_StreamContentParser::SetGraphicStates(CPDF_PageObject* pObj,
   }
 }
 
-// static
-CPDF_StreamContentParser::OpCodes
-CPDF_StreamContentParser::InitializeOpCodes() {
-  return OpCodes({
-      {FXBSTR_ID('"', 0, 0, 0),
-       &CPDF_StreamContentParser::Handle_NextLineShowText_Space},
-      {FXBSTR_ID('\'', 0, 0, 0),
-       &CPDF_StreamContentParser::Handle_NextLineShowText},
-      {FXBSTR_ID('B', 0, 0, 0),
-       &CPDF_StreamContentParser::Handle_FillStrokePath},
-      {FXBSTR_ID('B', '*', 0, 0),
-       &CPDF_StreamContentParser::Handle_EOFillStrokePath},
-      {FXBSTR_ID('B', 'D', 'C', 0),
-       &CPDF_StreamContentParser::Handle_BeginMarkedContent_Dictionary},
-      {FXBSTR_ID('B', 'I', 0, 0), &CPDF_StreamContentParser::Handle_BeginImage},
-      {FXBSTR_ID('B', 'M', 'C', 0),
-       &CPDF_StreamContentParser::Handle_BeginMarkedContent},
-      {FXBSTR_ID('B', 'T', 0, 0), &CPDF_StreamContentParser::Handle_BeginText},
-      {FXBSTR_ID('C', 'S', 0, 0),
-       &CPDF_StreamContentParser::Handle_SetColorSpace_Stroke},
-      {FXBSTR_ID('D', 'P', 0, 0),
-       &CPDF_StreamContentParser::Handle_MarkPlace_Dictionary},
-      {FXBSTR_ID('D', 'o', 0, 0),
-       &CPDF_StreamContentParser::Handle_ExecuteXObject},
-      {FXBSTR_ID('E', 'I', 0, 0), &CPDF_StreamContentParser::Handle_EndImage},
-      {FXBSTR_ID('E', 'M', 'C', 0),
-       &CPDF_StreamContentParser::Handle_EndMarkedContent},
-      {FXBSTR_ID('E', 'T', 0, 0), &CPDF_StreamContentParser::Handle_EndText},
-      {FXBSTR_ID('F', 0, 0, 0), &CPDF_StreamContentParser::Handle_FillPathOld},
-      {FXBSTR_ID('G', 0, 0, 0),
-       &CPDF_StreamContentParser::Handle_SetGray_Stroke},
-      {FXBSTR_ID('I', 'D', 0, 0),
-       &CPDF_StreamContentParser::Handle_BeginImageData},
-      {FXBSTR_ID('J', 0, 0, 0), &CPDF_StreamContentParser::Handle_SetLineCap},
-      {FXBSTR_ID('K', 0, 0, 0),
-       &CPDF_StreamContentParser::Handle_SetCMYKColor_Stroke},
-      {FXBSTR_ID('M', 0, 0, 0),
-       &CPDF_StreamContentParser::Handle_SetMiterLimit},
-      {FXBSTR_ID('M', 'P', 0, 0), &CPDF_StreamContentParser::Handle_MarkPlace},
-      {FXBSTR_ID('Q', 0, 0, 0),
-       &CPDF_StreamContentParser::Handle_RestoreGraphState},
-      {FXBSTR_ID('R', 'G', 0, 0),
-       &CPDF_StreamContentParser::Handle_SetRGBColor_Stroke},
-      {FXBSTR_ID('S', 0, 0, 0), &CPDF_StreamContentParser::Handle_StrokePath},
-      {FXBSTR_ID('S', 'C', 0, 0),
-       &CPDF_StreamContentParser::Handle_SetColor_Stroke},
-      {FXBSTR_ID('S', 'C', 'N', 0),
-       &CPDF_StreamContentParser::Handle_SetColorPS_Stroke},
-      {FXBSTR_ID('T', '*', 0, 0),
-       &CPDF_StreamContentParser::Handle_MoveToNextLine},
-      {FXBSTR_ID('T', 'D', 0, 0),
-       &CPDF_StreamContentParser::Handle_MoveTextPoint_SetLeading},
-      {FXBSTR_ID('T', 'J', 0, 0),
-       &CPDF_StreamContentParser::Handle_ShowText_Positioning},
-      {FXBSTR_ID('T', 'L', 0, 0),
-       &CPDF_StreamContentParser::Handle_SetTextLeading},
-      {FXBSTR_ID('T', 'c', 0, 0),
-       &CPDF_StreamContentParser::Handle_SetCharSpace},
-      {FXBSTR_ID('T', 'd', 0, 0),
-       &CPDF_StreamContentParser::Handle_MoveTextPoint},
-      {FXBSTR_ID('T', 'f', 0, 0), &CPDF_StreamContentParser::Handle_SetFont},
-      {FXBSTR_ID('T', 'j', 0, 0), &CPDF_StreamContentParser::Handle_ShowText},
-      {FXBSTR_ID('T', 'm', 0, 0),
-       &CPDF_StreamContentParser::Handle_SetTextMatrix},
-      {FXBSTR_ID('T', 'r', 0, 0),
-       &CPDF_StreamContentParser::Handle_SetTextRenderMode},
-      {FXBSTR_ID('T', 's', 0, 0),
-       &CPDF_StreamContentParser::Handle_SetTextRise},
-      {FXBSTR_ID('T', 'w', 0, 0),
-       &CPDF_StreamContentParser::Handle_SetWordSpace},
-      {FXBSTR_ID('T', 'z', 0, 0),
-       &CPDF_StreamContentParser::Handle_SetHorzScale},
-      {FXBSTR_ID('W', 0, 0, 0), &CPDF_StreamContentParser::Handle_Clip},
-      {FXBSTR_ID('W', '*', 0, 0), &CPDF_StreamContentParser::Handle_EOClip},
-      {FXBSTR_ID('b', 0, 0, 0),
-       &CPDF_StreamContentParser::Handle_CloseFillStrokePath},
-      {FXBSTR_ID('b', '*', 0, 0),
-       &CPDF_StreamContentParser::Handle_CloseEOFillStrokePath},
-      {FXBSTR_ID('c', 0, 0, 0), &CPDF_StreamContentParser::Handle_CurveTo_123},
-      {FXBSTR_ID('c', 'm', 0, 0),
-       &CPDF_StreamContentParser::Handle_ConcatMatrix},
-      {FXBSTR_ID('c', 's', 0, 0),
-       &CPDF_StreamContentParser::Handle_SetColorSpace_Fill},
-      {FXBSTR_ID('d', 0, 0, 0), &CPDF_StreamContentParser::Handle_SetDash},
-      {FXBSTR_ID('d', '0', 0, 0),
-       &CPDF_StreamContentParser::Handle_SetCharWidth},
-      {FXBSTR_ID('d', '1', 0, 0),
-       &CPDF_StreamContentParser::Handle_SetCachedDevice},
-      {FXBSTR_ID('f', 0, 0, 0), &CPDF_StreamContentParser::Handle_FillPath},
-      {FXBSTR_ID('f', '*', 0, 0), &CPDF_StreamContentParser::Handle_EOFillPath},
-      {FXBSTR_ID('g', 0, 0, 0), &CPDF_StreamContentParser::Handle_SetGray_Fill},
-      {FXBSTR_ID('g', 's', 0, 0),
-       &CPDF_StreamContentParser::Handle_SetExtendGraphState},
-      {FXBSTR_ID('h', 0, 0, 0), &CPDF_StreamContentParser::Handle_ClosePath},
-      {FXBSTR_ID('i', 0, 0, 0), &CPDF_StreamContentParser::Handle_SetFlat},
-      {FXBSTR_ID('j', 0, 0, 0), &CPDF_StreamContentParser::Handle_SetLineJoin},
-      {FXBSTR_ID('k', 0, 0, 0),
-       &CPDF_StreamContentParser::Handle_SetCMYKColor_Fill},
-      {FXBSTR_ID('l', 0, 0, 0), &CPDF_StreamContentParser::Handle_LineTo},
-      {FXBSTR_ID('m', 0, 0, 0), &CPDF_StreamContentParser::Handle_MoveTo},
-      {FXBSTR_ID('n', 0, 0, 0), &CPDF_StreamContentParser::Handle_EndPath},
-      {FXBSTR_ID('q', 0, 0, 0),
-       &CPDF_StreamContentParser::Handle_SaveGraphState},
-      {FXBSTR_ID('r', 'e', 0, 0), &CPDF_StreamContentParser::Handle_Rectangle},
-      {FXBSTR_ID('r', 'g', 0, 0),
-       &CPDF_StreamContentParser::Handle_SetRGBColor_Fill},
-      {FXBSTR_ID('r', 'i', 0, 0),
-       &CPDF_StreamContentParser::Handle_SetRenderIntent},
-      {FXBSTR_ID('s', 0, 0, 0),
-       &CPDF_StreamContentParser::Handle_CloseStrokePath},
-      {FXBSTR_ID('s', 'c', 0, 0),
-       &CPDF_StreamContentParser::Handle_SetColor_Fill},
-      {FXBSTR_ID('s', 'c', 'n', 0),
-       &CPDF_StreamContentParser::Handle_SetColorPS_Fill},
-      {FXBSTR_ID('s', 'h', 0, 0), &CPDF_StreamContentParser::Handle_ShadeFill},
-      {FXBSTR_ID('v', 0, 0, 0), &CPDF_StreamContentParser::Handle_CurveTo_23},
-      {FXBSTR_ID('w', 0, 0, 0), &CPDF_StreamContentParser::Handle_SetLineWidth},
-      {FXBSTR_ID('y', 0, 0, 0), &CPDF_StreamContentParser::Handle_CurveTo_13},
-  });
-}
-
 void CPDF_StreamContentParser::OnOperator(const CFX_ByteStringC& op) {
-  static const OpCodes s_OpCodes = InitializeOpCodes();
-
-  auto it = s_OpCodes.find(op.GetID());
-  if (it != s_OpCodes.end())
-    (this->*it->second)();
+  // A switch over the packed operator bytes compiles to a jump table or a
+  // short binary search, with no per-operator allocation or tree walk.
+  switch (op.GetID()) {
+    case FXBSTR_ID('"', 0, 0, 0):
+      Handle_NextLineShowText_Space();
+      break;
+    case FXBSTR_ID('\'', 0, 0, 0):
+      Handle_NextLineShowText();
+      break;
+    case FXBSTR_ID('B', 0, 0, 0):
+      Handle_FillStrokePath();
+      break;
+    case FXBSTR_ID('B', '*', 0, 0):
+      Handle_EOFillStrokePath();
+      break;
+    case FXBSTR_ID('B', 'D', 'C', 0):
+      Handle_BeginMarkedContent_Dictionary();
+      break;
+    case FXBSTR_ID('B', 'I', 0, 0):
+      Handle_BeginImage();
+      break;
+    case FXBSTR_ID('B', 'M', 'C', 0):
+      Handle_BeginMarkedContent();
+      break;
+    case FXBSTR_ID('B', 'T', 0, 0):
+      Handle_BeginText();
+      break;
+    case FXBSTR_ID('C', 'S', 0, 0):
+      Handle_SetColorSpace_Stroke();
+      break;
+    case FXBSTR_ID('D', 'P', 0, 0):
+      Handle_MarkPlace_Dictionary();
+      break;
+    case FXBSTR_ID('D', 'o', 0, 0):
+      Handle_ExecuteXObject();
+      break;
+    case FXBSTR_ID('E', 'I', 0, 0):
+      Handle_EndImage();
+      break;
+    case FXBSTR_ID('E', 'M', 'C', 0):
+      Handle_EndMarkedContent();
+      break;
+    case FXBSTR_ID('E', 'T', 0, 0):
+      Handle_EndText();
+      break;
+    case FXBSTR_ID('F', 0, 0, 0):
+      Handle_FillPathOld();
+      break;
+    case FXBSTR_ID('G', 0, 0, 0):
+      Handle_SetGray_Stroke();
+      break;
+    case FXBSTR_ID('I', 'D', 0, 0):
+      Handle_BeginImageData();
+      break;
+    case FXBSTR_ID('J', 0, 0, 0):
+      Handle_SetLineCap();
+      break;
+    case FXBSTR_ID('K', 0, 0, 0):
+      Handle_SetCMYKColor_Stroke();
+      break;
+    case FXBSTR_ID('M', 0, 0, 0):
+      Handle_SetMiterLimit();
+      break;
+    case FXBSTR_ID('M', 'P', 0, 0):
+      Handle_MarkPlace();
+      break;
+    case FXBSTR_ID('Q', 0, 0, 0):
+      Handle_RestoreGraphState();
+      break;
+    case FXBSTR_ID('R', 'G', 0, 0):
+      Handle_SetRGBColor_Stroke();
+      break;
+    case FXBSTR_ID('S', 0, 0, 0):
+      Handle_StrokePath();
+      break;
+    case FXBSTR_ID('S', 'C', 0, 0):
+      Handle_SetColor_Stroke();
+      break;
+    case FXBSTR_ID('S', 'C', 'N', 0):
+      Handle_SetColorPS_Stroke();
+      break;
+    case FXBSTR_ID('T', '*', 0, 0):
+      Handle_MoveToNextLine();
+      break;
+    case FXBSTR_ID('T', 'D', 0, 0):
+      Handle_MoveTextPoint_SetLeading();
+      break;
+    case FXBSTR_ID('T', 'J', 0, 0):
+      Handle_ShowText_Positioning();
+      break;
+    case FXBSTR_ID('T', 'L', 0, 0):
+      Handle_SetTextLeading();
+      break;
+    case FXBSTR_ID('T', 'c', 0, 0):
+      Handle_SetCharSpace();
+      break;
+    case FXBSTR_ID('T', 'd', 0, 0):
+      Handle_MoveTextPoint();
+      break;
+    case FXBSTR_ID('T', 'f', 0, 0):
+      Handle_SetFont();
+      break;
+    case FXBSTR_ID('T', 'j', 0, 0):
+      Handle_ShowText();
+      break;
+    case FXBSTR_ID('T', 'm', 0, 0):
+      Handle_SetTextMatrix();
+      break;
+    case FXBSTR_ID('T', 'r', 0, 0):
+      Handle_SetTextRenderMode();
+      break;
+    case FXBSTR_ID('T', 's', 0, 0):
+      Handle_SetTextRise();
+      break;
+    case FXBSTR_ID('T', 'w', 0, 0):
+      Handle_SetWordSpace();
+      break;
+    case FXBSTR_ID('T', 'z', 0, 0):
+      Handle_SetHorzScale();
+      break;
+    case FXBSTR_ID('W', 0, 0, 0):
+      Handle_Clip();
+      break;
+    case FXBSTR_ID('W', '*', 0, 0):
+      Handle_EOClip();
+      break;
+    case FXBSTR_ID('b', 0, 0, 0):
+      Handle_CloseFillStrokePath();
+      break;
+    case FXBSTR_ID('b', '*', 0, 0):
+      Handle_CloseEOFillStrokePath();
+      break;
+    case FXBSTR_ID('c', 0, 0, 0):
+      Handle_CurveTo_123();
+      break;
+    case FXBSTR_ID('c', 'm', 0, 0):
+      Handle_ConcatMatrix();
+      break;
+    case FXBSTR_ID('c', 's', 0, 0):
+      Handle_SetColorSpace_Fill();
+      break;
+    case FXBSTR_ID('d', 0, 0, 0):
+      Handle_SetDash();
+      break;
+    case FXBSTR_ID('d', '0', 0, 0):
+      Handle_SetCharWidth();
+      break;
+    case FXBSTR_ID('d', '1', 0, 0):
+      Handle_SetCachedDevice();
+      break;
+    case FXBSTR_ID('f', 0, 0, 0):
+      Handle_FillPath();
+      break;
+    case FXBSTR_ID('f', '*', 0, 0):
+      Handle_EOFillPath();
+      break;
+    case FXBSTR_ID('g', 0, 0, 0):
+      Handle_SetGray_Fill();
+      break;
+    case FXBSTR_ID('g', 's', 0, 0):
+      Handle_SetExtendGraphState();
+      break;
+    case FXBSTR_ID('h', 0, 0, 0):
+      Handle_ClosePath();
+      break;
+    case FXBSTR_ID('i', 0, 0, 0):
+      Handle_SetFlat();
+      break;
+    case FXBSTR_ID('j', 0, 0, 0):
+      Handle_SetLineJoin();
+      break;
+    case FXBSTR_ID('k', 0, 0, 0):
+      Handle_SetCMYKColor_Fill();
+      break;
+    case FXBSTR_ID('l', 0, 0, 0):
+      Handle_LineTo();
+      break;
+    case FXBSTR_ID('m', 0, 0, 0):
+      Handle_MoveTo();
+      break;
+    case FXBSTR_ID('n', 0, 0, 0):
+      Handle_EndPath();
+      break;
+    case FXBSTR_ID('q', 0, 0, 0):
+      Handle_SaveGraphState();
+      break;
+    case FXBSTR_ID('r', 'e', 0, 0):
+      Handle_Rectangle();
+      break;
+    case FXBSTR_ID('r', 'g', 0, 0):
+      Handle_SetRGBColor_Fill();
+      break;
+    case FXBSTR_ID('r', 'i', 0, 0):
+      Handle_SetRenderIntent();
+      break;
+    case FXBSTR_ID('s', 0, 0, 0):
+      Handle_CloseStrokePath();
+      break;
+    case FXBSTR_ID('s', 'c', 0, 0):
+      Handle_SetColor_Fill();
+      break;
+    case FXBSTR_ID('s', 'c', 'n', 0):
+      Handle_SetColorPS_Fill();
+      break;
+    case FXBSTR_ID('s', 'h', 0, 0):
+      Handle_ShadeFill();
+      break;
+    case FXBSTR_ID('v', 0, 0, 0):
+      Handle_CurveTo_23();
+      break;
+    case FXBSTR_ID('w', 0, 0, 0):
+      Handle_SetLineWidth();
+      break;
+    case FXBSTR_ID('y', 0, 0, 0):
+      Handle_CurveTo_13();
+      break;
+    default:
+      break;
+  }
 }
 
 void CPDF_StreamContentParser::Handle_CloseFillStrokePath() {
@@ -786,7 +936,7 @@ void CPDF_StreamContentParser::AddForm(CPDF_Stream* pStream) {
   }
   pFormObj->CalcBoundingBox();
   SetGraphicStates(pFormObj.get(), true, true, true);
-  m_pObjectHolder->GetPageObjectList()->push_back(std::move(pFormObj));
+  m_pObjectHolder->AppendPageObject(std::move(pFormObj));
 }
 
 CPDF_ImageObject* CPDF_StreamContentParser::AddImage(
@@ -829,7 +979,7 @@ CPDF_ImageObject* CPDF_StreamContentParser::AddImageObject(
   pImageObj->CalcBoundingBox();
 
   CPDF_ImageObject* pRet = pImageObj.get();
-  m_pObjectHolder->GetPageObjectList()->push_back(std::move(pImageObj));
+  m_pObjectHolder->AppendPageObject(std::move(pImageObj));
   return pRet;
 }
 
@@ -1128,7 +1278,7 @@ void CPDF_StreamContentParser::Handle_ShadeFill() {
   pObj->m_Right = bbox.right;
   pObj->m_Top = bbox.top;
   pObj->m_Bottom = bbox.bottom;
-  m_pObjectHolder->GetPageObjectList()->push_back(std::move(pObj));
+  m_pObjectHolder->AppendPageObject(std::move(pObj));
 }
 
 void CPDF_StreamContentParser::Handle_SetCharSpace() {
@@ -1181,6 +1331,7 @@ CPDF_Font* CPDF_StreamContentParser::FindFont(const CFX_ByteString& name) {
 
   CPDF_Font* pFont = m_pDocument->LoadFont(pFontDict);
   if (pFont && pFont->IsType3Font()) {
+    std::lock_guard<std::recursive_mutex> lock(*pFont->GetMutex());
     pFont->AsType3Font()->SetPageResources(m_pResources);
     pFont->AsType3Font()->CheckType3FontMetrics();
   }
@@ -1275,7 +1426,7 @@ void CPDF_StreamContentParser::AddTextObject(CFX_ByteString* pStrs,
       m_ClipTextList.push_back(
           std::unique_ptr<CPDF_TextObject>(pText->Clone()));
     }
-    m_pObjectHolder->GetPageObjectList()->push_back(std::move(pText));
+    m_pObjectHolder->AppendPageObject(std::move(pText));
   }
   if (pKerning && pKerning[nsegs - 1] != 0) {
     if (!pFont->IsVertWriting()) {
@@ -1496,7 +1647,7 @@ void CPDF_StreamContentParser::AddPathObject(int FillType, bool bStroke) {
     pPathObj->m_Matrix = matrix;
     SetGraphicStates(pPathObj.get(), true, false, true);
     pPathObj->CalcBoundingBox();
-    m_pObjectHolder->GetPageObjectList()->push_back(std::move(pPathObj));
+    m_pObjectHolder->AppendPageObject(std::move(pPathObj));
   }
   if (PathClipType) {
     if (!matrix.IsIdentity()) {
@@ -1612,7 +1763,7 @@ void CPDF_StreamContentParser::ParsePathObject() {
           break;
 
         int value;
-        bool bInteger = FX_atonum(m_pSyntax->GetWord(), &value);
+        bool bInteger = ParseNumber(m_pSyntax->GetWord(), &value);
         params[nParams++] = bInteger ? (float)value : *(float*)&value;
         break;
       }
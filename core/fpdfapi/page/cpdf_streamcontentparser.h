@@ -7,7 +7,6 @@
 #ifndef CORE_FPDFAPI_PAGE_CPDF_STREAMCONTENTPARSER_H_
 #define CORE_FPDFAPI_PAGE_CPDF_STREAMCONTENTPARSER_H_
 
-#include <map>
 #include <memory>
 #include <vector>
 
@@ -73,9 +72,6 @@ class CPDF_StreamContentParser {
 
   static const int kParamBufSize = 16;
 
-  using OpCodes = std::map<uint32_t, void (CPDF_StreamContentParser::*)()>;
-  static OpCodes InitializeOpCodes();
-
   void AddNameParam(const CFX_ByteStringC& str);
   void AddNumberParam(const CFX_ByteStringC& str);
   void AddObjectParam(std::unique_ptr<CPDF_Object> pObj);
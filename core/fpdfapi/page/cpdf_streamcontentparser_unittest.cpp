@@ -2,8 +2,23 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "core/fpdfapi/cpdf_modulemgr.h"
+#include "core/fpdfapi/page/cpdf_page.h"
 #include "core/fpdfapi/page/pageint.h"
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fpdfapi/parser/cpdf_document.h"
+#include "core/fpdfapi/parser/cpdf_parser.h"
+#include "core/fpdfapi/parser/cpdf_reference.h"
+#include "core/fpdfapi/parser/cpdf_stream.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/base/ptr_util.h"
 
 TEST(cpdf_streamcontentparser, PDF_FindKeyAbbreviation) {
   EXPECT_EQ(CFX_ByteStringC("BitsPerComponent"),
@@ -32,3 +47,91 @@ TEST(cpdf_streamcontentparser, PDF_FindValueAbbreviation) {
   EXPECT_EQ(CFX_ByteStringC(""),
             PDF_FindValueAbbreviationForTesting(CFX_ByteStringC("II")));
 }
+
+TEST(cpdf_streamcontentparser, PDF_ParseNumber) {
+  const char* const kNumbers[] = {"0",
+                                  "7",
+                                  "-12",
+                                  "+34",
+                                  "1234567",
+                                  "12345678",
+                                  "-2147483648",
+                                  "4294967295",
+                                  "99999999999",
+                                  ".5",
+                                  "-.25",
+                                  "3.",
+                                  "12.125",
+                                  "-0.001",
+                                  "1234567.5",
+                                  "12345678.5",
+                                  "0.123456789012345",
+                                  "+-3.5",
+                                  "1.2.3",
+                                  "4-5",
+                                  "-",
+                                  ".",
+                                  "--1",
+                                  "1e5"};
+  for (const char* number : kNumbers) {
+    CFX_ByteStringC word(number);
+    union {
+      int i;
+      float f;
+    } expected, actual;
+    bool bExpectedInteger = FX_atonum(word, &expected);
+    bool bInteger = PDF_ParseNumberForTesting(word, &actual);
+    ASSERT_EQ(bExpectedInteger, bInteger) << number;
+    if (bInteger)
+      EXPECT_EQ(expected.i, actual.i) << number;
+    else
+      EXPECT_EQ(expected.f, actual.f) << number;
+  }
+}
+
+// Times parsing a page of generated content, once with graphics state
+// operators and once with paths. Run with --gtest_also_run_disabled_tests.
+TEST(cpdf_streamcontentparser, DISABLED_ParseSpeed) {
+  const struct {
+    const char* name;
+    const char* content;
+  } kContents[] = {
+      {"state",
+       "q 0.5 w 1 J 2 j 10 M 0.25 0.5 0.75 rg 0 0 0 1 K [ 3 1 ] 0 d 1 i Q "},
+      {"paths",
+       "10 20 m 30.5 40 l 1 2 3 4 5.5 6 c 7 8 9 10 v 0 0 100 50 re h f "}};
+  const size_t kTokens = 2000000;
+  const int kRuns = 5;
+  CPDF_ModuleMgr::Get()->InitPageModule();
+  for (const auto& test : kContents) {
+    std::string repeated = test.content;
+    size_t tokens = std::count(repeated.begin(), repeated.end(), ' ');
+    size_t repeats = kTokens / tokens;
+    std::string data;
+    for (size_t i = 0; i < repeats; ++i)
+      data += repeated;
+    tokens *= repeats;
+
+    auto pDoc = pdfium::MakeUnique<CPDF_Document>(nullptr);
+    pDoc->CreateNewDoc();
+    CPDF_Dictionary* pPageDict = pDoc->CreateNewPage(0);
+    CPDF_Stream* pStream = pDoc->NewIndirect<CPDF_Stream>();
+    pStream->SetData(reinterpret_cast<const uint8_t*>(data.c_str()),
+                     data.size());
+    pPageDict->SetNewFor<CPDF_Reference>("Contents", pDoc.get(),
+                                         pStream->GetObjNum());
+
+    std::chrono::duration<double, std::nano> best =
+        std::chrono::duration<double>::max();
+    for (int run = 0; run < kRuns; ++run) {
+      auto pPage = pdfium::MakeUnique<CPDF_Page>(pDoc.get(), pPageDict, false);
+      auto start = std::chrono::steady_clock::now();
+      pPage->ParseContent();
+      best = std::min<std::chrono::duration<double, std::nano>>(
+          best, std::chrono::steady_clock::now() - start);
+    }
+    printf("%s: %zu tokens, best of %d %.1f ns per token\n", test.name,
+           tokens, kRuns, best.count() / tokens);
+  }
+  CPDF_ModuleMgr::Destroy();
+}
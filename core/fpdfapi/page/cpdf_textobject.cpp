@@ -7,6 +7,7 @@
 #include "core/fpdfapi/page/cpdf_textobject.h"
 
 #include <algorithm>
+#include <mutex>
 
 #include "core/fpdfapi/font/cpdf_cidfont.h"
 #include "core/fpdfapi/font/cpdf_font.h"
@@ -169,6 +170,7 @@ void CPDF_TextObject::SetText(const CFX_ByteString& str) {
 float CPDF_TextObject::GetCharWidth(uint32_t charcode) const {
   float fontsize = m_TextState.GetFontSize() / 1000;
   CPDF_Font* pFont = m_TextState.GetFont();
+  std::lock_guard<std::recursive_mutex> lock(*pFont->GetMutex());
   bool bVertWriting = false;
   CPDF_CIDFont* pCIDFont = pFont->AsCIDFont();
   if (pCIDFont)
@@ -195,6 +197,7 @@ CFX_PointF CPDF_TextObject::CalcPositionData(float horz_scale) {
   float min_y = 10000 * 1.0f;
   float max_y = -10000 * 1.0f;
   CPDF_Font* pFont = m_TextState.GetFont();
+  std::lock_guard<std::recursive_mutex> lock(*pFont->GetMutex());
   bool bVertWriting = false;
   CPDF_CIDFont* pCIDFont = pFont->AsCIDFont();
   if (pCIDFont)
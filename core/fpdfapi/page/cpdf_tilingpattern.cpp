@@ -32,6 +32,7 @@ CPDF_ShadingPattern* CPDF_TilingPattern::AsShadingPattern() {
 }
 
 bool CPDF_TilingPattern::Load() {
+  std::lock_guard<std::mutex> lock(m_LoadMutex);
   if (m_pForm)
     return true;
 
@@ -39,7 +40,6 @@ bool CPDF_TilingPattern::Load() {
   if (!pDict)
     return false;
 
-  m_bColored = pDict->GetIntegerFor("PaintType") == 1;
   m_XStep = static_cast<float>(fabs(pDict->GetNumberFor("XStep")));
   m_YStep = static_cast<float>(fabs(pDict->GetNumberFor("YStep")));
 
@@ -8,6 +8,7 @@
 #define CORE_FPDFAPI_PAGE_CPDF_TILINGPATTERN_H_
 
 #include <memory>
+#include <mutex>
 
 #include "core/fpdfapi/page/cpdf_pattern.h"
 #include "core/fxcrt/fx_coordinates.h"
@@ -27,6 +28,8 @@ class CPDF_TilingPattern : public CPDF_Pattern {
   CPDF_TilingPattern* AsTilingPattern() override;
   CPDF_ShadingPattern* AsShadingPattern() override;
 
+  // Parses the pattern cell the first time it is called. Pages that share
+  // the pattern may call it from several threads at once.
   bool Load();
 
   bool colored() const { return m_bColored; }
@@ -36,6 +39,7 @@ class CPDF_TilingPattern : public CPDF_Pattern {
   CPDF_Form* form() const { return m_pForm.get(); }
 
  private:
+  std::mutex m_LoadMutex;
   bool m_bColored;
   CFX_FloatRect m_BBox;
   float m_XStep;
@@ -93,7 +93,7 @@ bool CPDF_DeviceCS::GetRGB(float* pBuf, float* R, float* G, float* B) const {
       *B = NormalizeChannel(pBuf[2]);
       return true;
     case PDFCS_DEVICECMYK:
-      if (m_dwStdConversion) {
+      if (IsStdConversionEnabled()) {
         float k = pBuf[3];
         *R = 1.0f - std::min(1.0f, pBuf[0] + k);
         *G = 1.0f - std::min(1.0f, pBuf[1] + k);
@@ -197,8 +197,9 @@ void CPDF_DeviceCS::TranslateImageLine(uint8_t* pDestBuf,
           pSrcBuf += 4;
         }
       } else {
+        bool bStdConversion = IsStdConversionEnabled();
         for (int i = 0; i < pixels; i++) {
-          if (m_dwStdConversion) {
+          if (bStdConversion) {
             uint8_t k = pSrcBuf[3];
             pDestBuf[2] = 255 - std::min(255, pSrcBuf[0] + k);
             pDestBuf[1] = 255 - std::min(255, pSrcBuf[1] + k);
@@ -220,7 +221,8 @@ void CPDF_DeviceCS::TranslateImageLine(uint8_t* pDestBuf,
 
 CPDF_IccProfile::CPDF_IccProfile(CPDF_Stream* pStream,
                                  const uint8_t* pData,
-                                 uint32_t dwSize)
+                                 uint32_t dwSize,
+                                 const CFX_ByteString& bsDigest)
     : m_bsRGB(DetectSRGB(pData, dwSize)), m_pStream(pStream) {
   if (m_bsRGB) {
     m_nSrcComponents = 3;
@@ -229,7 +231,8 @@ CPDF_IccProfile::CPDF_IccProfile(CPDF_Stream* pStream,
   auto* pIccModule = CPDF_ModuleMgr::Get()->GetIccModule();
   if (pIccModule) {
     uint32_t nSrcComps = 0;
-    m_pTransform = pIccModule->CreateTransform_sRGB(pData, dwSize, nSrcComps);
+    m_pTransform = pIccModule->CreateSharedTransform_sRGB(
+        bsDigest.AsStringC(), pData, dwSize, nSrcComps);
     if (m_pTransform)
       m_nSrcComponents = nSrcComps;
   }
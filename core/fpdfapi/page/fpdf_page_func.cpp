@@ -53,6 +53,159 @@ const PDF_PSOpName kPsOpNames[] = {
     {"dup", PSOP_DUP},         {"copy", PSOP_COPY},
     {"index", PSOP_INDEX},     {"roll", PSOP_ROLL}};
 
+bool IsUnaryOp(PDF_PSOP op) {
+  switch (op) {
+    case PSOP_NEG:
+    case PSOP_ABS:
+    case PSOP_CEILING:
+    case PSOP_FLOOR:
+    case PSOP_ROUND:
+    case PSOP_TRUNCATE:
+    case PSOP_SQRT:
+    case PSOP_SIN:
+    case PSOP_COS:
+    case PSOP_LN:
+    case PSOP_LOG:
+    case PSOP_CVI:
+    case PSOP_NOT:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsBinaryOp(PDF_PSOP op) {
+  switch (op) {
+    case PSOP_ADD:
+    case PSOP_SUB:
+    case PSOP_MUL:
+    case PSOP_DIV:
+    case PSOP_IDIV:
+    case PSOP_MOD:
+    case PSOP_ATAN:
+    case PSOP_EXP:
+    case PSOP_EQ:
+    case PSOP_NE:
+    case PSOP_GT:
+    case PSOP_GE:
+    case PSOP_LT:
+    case PSOP_LE:
+    case PSOP_AND:
+    case PSOP_OR:
+    case PSOP_XOR:
+    case PSOP_BITSHIFT:
+      return true;
+    default:
+      return false;
+  }
+}
+
+float ApplyUnaryOp(PDF_PSOP op, float d1) {
+  switch (op) {
+    case PSOP_NEG:
+      return -d1;
+    case PSOP_ABS:
+      return (float)fabs(d1);
+    case PSOP_CEILING:
+      return (float)ceil(d1);
+    case PSOP_FLOOR:
+      return (float)floor(d1);
+    case PSOP_ROUND:
+      return FXSYS_round(d1);
+    case PSOP_TRUNCATE:
+    case PSOP_CVI:
+      return (int)d1;
+    case PSOP_SQRT:
+      return (float)sqrt(d1);
+    case PSOP_SIN:
+      return (float)sin(d1 * FX_PI / 180.0f);
+    case PSOP_COS:
+      return (float)cos(d1 * FX_PI / 180.0f);
+    case PSOP_LN:
+      return (float)log(d1);
+    case PSOP_LOG:
+      return (float)log10(d1);
+    case PSOP_NOT:
+      return (int)!(int)d1;
+    default:
+      ASSERT(false);
+      return d1;
+  }
+}
+
+// |d2| is the operand on top of the stack.
+float ApplyBinaryOp(PDF_PSOP op, float d1, float d2) {
+  int i1;
+  int i2;
+  FX_SAFE_INT32 result;
+  switch (op) {
+    case PSOP_ADD:
+      return d1 + d2;
+    case PSOP_SUB:
+      return d1 - d2;
+    case PSOP_MUL:
+      return d1 * d2;
+    case PSOP_DIV:
+      return d1 / d2;
+    case PSOP_IDIV:
+      i2 = static_cast<int>(d2);
+      i1 = static_cast<int>(d1);
+      if (!i2)
+        return 0;
+      result = i1;
+      result /= i2;
+      return result.ValueOrDefault(0);
+    case PSOP_MOD:
+      i2 = static_cast<int>(d2);
+      i1 = static_cast<int>(d1);
+      if (!i2)
+        return 0;
+      result = i1;
+      result %= i2;
+      return result.ValueOrDefault(0);
+    case PSOP_ATAN:
+      d1 = (float)(atan2(d1, d2) * 180.0 / FX_PI);
+      if (d1 < 0)
+        d1 += 360;
+      return d1;
+    case PSOP_EXP:
+      return (float)FXSYS_pow(d1, d2);
+    case PSOP_EQ:
+      return (int)(d1 == d2);
+    case PSOP_NE:
+      return (int)(d1 != d2);
+    case PSOP_GT:
+      return (int)(d1 > d2);
+    case PSOP_GE:
+      return (int)(d1 >= d2);
+    case PSOP_LT:
+      return (int)(d1 < d2);
+    case PSOP_LE:
+      return (int)(d1 <= d2);
+    case PSOP_AND:
+      return (int)d1 & (int)d2;
+    case PSOP_OR:
+      return (int)d1 | (int)d2;
+    case PSOP_XOR:
+      return (int)d1 ^ (int)d2;
+    case PSOP_BITSHIFT: {
+      int shift = (int)d2;
+      result = (int)d1;
+      if (shift > 0) {
+        result <<= shift;
+      } else {
+        // Avoids unsafe negation of INT_MIN.
+        FX_SAFE_INT32 safe_shift = shift;
+        result >>= (-safe_shift).ValueOrDefault(0);
+      }
+      return result.ValueOrDefault(0);
+    }
+    default:
+      ASSERT(false);
+      return d2;
+  }
+}
+
 // See PDF Reference 1.7, page 170, table 3.36.
 bool IsValidBitsPerSample(uint32_t x) {
   switch (x) {
@@ -78,37 +231,47 @@ float PDF_Interpolate(float x, float xmin, float xmax, float ymin, float ymax) {
 
 class CPDF_PSFunc : public CPDF_Function {
  public:
-  CPDF_PSFunc() : CPDF_Function(Type::kType4PostScript) {}
+  CPDF_PSFunc()
+      : CPDF_Function(Type::kType4PostScript), m_bCompiled(false) {}
   ~CPDF_PSFunc() override {}
 
   // CPDF_Function
   bool v_Init(CPDF_Object* pObj) override;
   bool v_Call(float* inputs, float* results) const override;
+  bool v_CallBatch(float* inputs,
+                   float* results,
+                   uint32_t count) const override;
 
  private:
   CPDF_PSEngine m_PS;
+  CPDF_PSProgram m_Program;
+  bool m_bCompiled;
 };
 
 bool CPDF_PSFunc::v_Init(CPDF_Object* pObj) {
   auto pAcc = pdfium::MakeRetain<CPDF_StreamAcc>(pObj->AsStream());
   pAcc->LoadAllData(false);
-  return m_PS.Parse(reinterpret_cast<const char*>(pAcc->GetData()),
-                    pAcc->GetSize());
-}
-
-bool CPDF_PSFunc::v_Call(float* inputs, float* results) const {
-  CPDF_PSEngine& PS = const_cast<CPDF_PSEngine&>(m_PS);
-  PS.Reset();
-  for (uint32_t i = 0; i < m_nInputs; i++)
-    PS.Push(inputs[i]);
-  PS.Execute();
-  if (PS.GetStackSize() < m_nOutputs)
+  if (!m_PS.Parse(reinterpret_cast<const char*>(pAcc->GetData()),
+                  pAcc->GetSize())) {
     return false;
-  for (uint32_t i = 0; i < m_nOutputs; i++)
-    results[m_nOutputs - i - 1] = PS.Pop();
+  }
+  m_bCompiled = m_Program.Compile(m_PS.GetMainProc(), m_nInputs, m_nOutputs);
   return true;
 }
 
+bool CPDF_PSFunc::v_CallBatch(float* inputs,
+                              float* results,
+                              uint32_t count) const {
+  if (!m_bCompiled)
+    return CPDF_Function::v_CallBatch(inputs, results, count);
+  return m_Program.RunBatch(inputs, results, count);
+}
+
+bool CPDF_PSFunc::v_Call(float* inputs, float* results) const {
+  if (m_bCompiled)
+    return m_Program.Run(inputs, results);
+  return m_PS.Run(inputs, m_nInputs, results, m_nOutputs);
+}
 }  // namespace
 
 class CPDF_PSOP {
@@ -149,10 +312,25 @@ bool CPDF_PSEngine::Execute() {
   return m_MainProc.Execute(this);
 }
 
+bool CPDF_PSEngine::Run(const float* inputs,
+                        uint32_t nInputs,
+                        float* results,
+                        uint32_t nOutputs) const {
+  CPDF_PSEngine engine;
+  for (uint32_t i = 0; i < nInputs; i++)
+    engine.Push(inputs[i]);
+  m_MainProc.Execute(&engine);
+  if (engine.GetStackSize() < nOutputs)
+    return false;
+  for (uint32_t i = 0; i < nOutputs; i++)
+    results[nOutputs - i - 1] = engine.Pop();
+  return true;
+}
+
 CPDF_PSProc::CPDF_PSProc() {}
 CPDF_PSProc::~CPDF_PSProc() {}
 
-bool CPDF_PSProc::Execute(CPDF_PSEngine* pEngine) {
+bool CPDF_PSProc::Execute(CPDF_PSEngine* pEngine) const {
   for (size_t i = 0; i < m_Operators.size(); ++i) {
     const PDF_PSOP op = m_Operators[i]->GetOp();
     if (op == PSOP_PROC)
@@ -235,180 +413,19 @@ bool CPDF_PSProc::Parse(CPDF_SimpleParser* parser, int depth) {
 }
 
 bool CPDF_PSEngine::DoOperator(PDF_PSOP op) {
-  int i1;
-  int i2;
+  if (IsUnaryOp(op)) {
+    Push(ApplyUnaryOp(op, Pop()));
+    return true;
+  }
+  if (IsBinaryOp(op)) {
+    float d2 = Pop();
+    float d1 = Pop();
+    Push(ApplyBinaryOp(op, d1, d2));
+    return true;
+  }
   float d1;
   float d2;
-  FX_SAFE_INT32 result;
   switch (op) {
-    case PSOP_ADD:
-      d1 = Pop();
-      d2 = Pop();
-      Push(d1 + d2);
-      break;
-    case PSOP_SUB:
-      d2 = Pop();
-      d1 = Pop();
-      Push(d1 - d2);
-      break;
-    case PSOP_MUL:
-      d1 = Pop();
-      d2 = Pop();
-      Push(d1 * d2);
-      break;
-    case PSOP_DIV:
-      d2 = Pop();
-      d1 = Pop();
-      Push(d1 / d2);
-      break;
-    case PSOP_IDIV:
-      i2 = static_cast<int>(Pop());
-      i1 = static_cast<int>(Pop());
-      if (i2) {
-        result = i1;
-        result /= i2;
-        Push(result.ValueOrDefault(0));
-      } else {
-        Push(0);
-      }
-      break;
-    case PSOP_MOD:
-      i2 = static_cast<int>(Pop());
-      i1 = static_cast<int>(Pop());
-      if (i2) {
-        result = i1;
-        result %= i2;
-        Push(result.ValueOrDefault(0));
-      } else {
-        Push(0);
-      }
-      break;
-    case PSOP_NEG:
-      d1 = Pop();
-      Push(-d1);
-      break;
-    case PSOP_ABS:
-      d1 = Pop();
-      Push((float)fabs(d1));
-      break;
-    case PSOP_CEILING:
-      d1 = Pop();
-      Push((float)ceil(d1));
-      break;
-    case PSOP_FLOOR:
-      d1 = Pop();
-      Push((float)floor(d1));
-      break;
-    case PSOP_ROUND:
-      d1 = Pop();
-      Push(FXSYS_round(d1));
-      break;
-    case PSOP_TRUNCATE:
-      i1 = (int)Pop();
-      Push(i1);
-      break;
-    case PSOP_SQRT:
-      d1 = Pop();
-      Push((float)sqrt(d1));
-      break;
-    case PSOP_SIN:
-      d1 = Pop();
-      Push((float)sin(d1 * FX_PI / 180.0f));
-      break;
-    case PSOP_COS:
-      d1 = Pop();
-      Push((float)cos(d1 * FX_PI / 180.0f));
-      break;
-    case PSOP_ATAN:
-      d2 = Pop();
-      d1 = Pop();
-      d1 = (float)(atan2(d1, d2) * 180.0 / FX_PI);
-      if (d1 < 0) {
-        d1 += 360;
-      }
-      Push(d1);
-      break;
-    case PSOP_EXP:
-      d2 = Pop();
-      d1 = Pop();
-      Push((float)FXSYS_pow(d1, d2));
-      break;
-    case PSOP_LN:
-      d1 = Pop();
-      Push((float)log(d1));
-      break;
-    case PSOP_LOG:
-      d1 = Pop();
-      Push((float)log10(d1));
-      break;
-    case PSOP_CVI:
-      i1 = (int)Pop();
-      Push(i1);
-      break;
-    case PSOP_CVR:
-      break;
-    case PSOP_EQ:
-      d2 = Pop();
-      d1 = Pop();
-      Push((int)(d1 == d2));
-      break;
-    case PSOP_NE:
-      d2 = Pop();
-      d1 = Pop();
-      Push((int)(d1 != d2));
-      break;
-    case PSOP_GT:
-      d2 = Pop();
-      d1 = Pop();
-      Push((int)(d1 > d2));
-      break;
-    case PSOP_GE:
-      d2 = Pop();
-      d1 = Pop();
-      Push((int)(d1 >= d2));
-      break;
-    case PSOP_LT:
-      d2 = Pop();
-      d1 = Pop();
-      Push((int)(d1 < d2));
-      break;
-    case PSOP_LE:
-      d2 = Pop();
-      d1 = Pop();
-      Push((int)(d1 <= d2));
-      break;
-    case PSOP_AND:
-      i1 = (int)Pop();
-      i2 = (int)Pop();
-      Push(i1 & i2);
-      break;
-    case PSOP_OR:
-      i1 = (int)Pop();
-      i2 = (int)Pop();
-      Push(i1 | i2);
-      break;
-    case PSOP_XOR:
-      i1 = (int)Pop();
-      i2 = (int)Pop();
-      Push(i1 ^ i2);
-      break;
-    case PSOP_NOT:
-      i1 = (int)Pop();
-      Push((int)!i1);
-      break;
-    case PSOP_BITSHIFT: {
-      int shift = (int)Pop();
-      result = (int)Pop();
-      if (shift > 0) {
-        result <<= shift;
-      } else {
-        // Avoids unsafe negation of INT_MIN.
-        FX_SAFE_INT32 safe_shift = shift;
-        result >>= (-safe_shift).ValueOrDefault(0);
-      }
-      Push(result.ValueOrDefault(0));
-      break;
-    }
     case PSOP_TRUE:
       Push(1);
       break;
@@ -469,6 +486,446 @@ bool CPDF_PSEngine::DoOperator(PDF_PSOP op) {
   return true;
 }
 
+// Runs a program symbolically to translate it into CPDF_PSProgram's
+// instructions. Each stack slot holds a constant or names the register
+// holding its value. Before a branch on a computed value, and at the end of
+// each side, every slot is moved into the register numbered after its
+// position, so that both sides leave the stack in the same registers.
+class CPDF_PSCompiler {
+ public:
+  explicit CPDF_PSCompiler(CPDF_PSProgram* pProgram)
+      : m_pProgram(pProgram), m_nRegisters(PSENGINE_STACKSIZE) {}
+
+  bool Compile(const CPDF_PSProc& proc, uint32_t nInputs, uint32_t nOutputs);
+
+ private:
+  using Instruction = CPDF_PSProgram::Instruction;
+  using OpType = CPDF_PSProgram::OpType;
+
+  struct Slot {
+    bool bConst;
+    float value;
+    uint32_t reg;
+  };
+
+  // Keeps the code size in check for deeply nested branches.
+  static const size_t kMaxInstructions = 1 << 16;
+
+  static Slot ConstSlot(float value) { return {true, value, 0}; }
+  static Slot RegisterSlot(uint32_t reg) { return {false, 0, reg}; }
+
+  bool CompileProc(const CPDF_PSProc& proc);
+  bool CompileBranch(uint32_t cond_reg,
+                     const CPDF_PSProc& then_proc,
+                     const CPDF_PSProc* else_proc);
+  bool CompileOperator(PDF_PSOP op);
+
+  // These follow CPDF_PSEngine::Push() and Pop() on a full or empty stack.
+  void Push(const Slot& slot) {
+    if (m_Stack.size() < PSENGINE_STACKSIZE)
+      m_Stack.push_back(slot);
+  }
+  Slot Pop() {
+    if (m_Stack.empty())
+      return ConstSlot(0);
+    Slot slot = m_Stack.back();
+    m_Stack.pop_back();
+    return slot;
+  }
+
+  size_t Emit(OpType type, PDF_PSOP op, uint32_t dest, uint32_t src1,
+              uint32_t src2, float value);
+  uint32_t ToRegister(const Slot& slot);
+  void Materialize();
+
+  CPDF_PSProgram* const m_pProgram;
+  uint32_t m_nRegisters;
+  std::vector<Slot> m_Stack;
+};
+
+bool CPDF_PSCompiler::Compile(const CPDF_PSProc& proc,
+                              uint32_t nInputs,
+                              uint32_t nOutputs) {
+  for (uint32_t i = 0; i < nInputs; i++)
+    Push(RegisterSlot(i));
+  if (!CompileProc(proc))
+    return false;
+
+  m_pProgram->m_nInputs = nInputs;
+  m_pProgram->m_nRegisters = m_nRegisters;
+  m_pProgram->m_bEnoughOutputs = m_Stack.size() >= nOutputs;
+  if (m_pProgram->m_bEnoughOutputs) {
+    for (size_t i = m_Stack.size() - nOutputs; i < m_Stack.size(); i++) {
+      m_pProgram->m_Outputs.push_back(
+          {m_Stack[i].bConst, m_Stack[i].value, m_Stack[i].reg});
+    }
+  }
+  return true;
+}
+
+// Mirrors CPDF_PSProc::Execute().
+bool CPDF_PSCompiler::CompileProc(const CPDF_PSProc& proc) {
+  const auto& operators = proc.GetOperators();
+  for (size_t i = 0; i < operators.size(); ++i) {
+    if (m_pProgram->m_Instructions.size() > kMaxInstructions)
+      return false;
+
+    const PDF_PSOP op = operators[i]->GetOp();
+    if (op == PSOP_PROC)
+      continue;
+
+    if (op == PSOP_CONST) {
+      Push(ConstSlot(operators[i]->GetFloatValue()));
+      continue;
+    }
+
+    if (op == PSOP_IF) {
+      if (i == 0 || operators[i - 1]->GetOp() != PSOP_PROC)
+        return true;
+
+      Slot cond = Pop();
+      const CPDF_PSProc* then_proc = operators[i - 1]->GetProc();
+      if (!cond.bConst) {
+        if (!CompileBranch(cond.reg, *then_proc, nullptr))
+          return false;
+      } else if (static_cast<int>(cond.value) && !CompileProc(*then_proc)) {
+        return false;
+      }
+    } else if (op == PSOP_IFELSE) {
+      if (i < 2 || operators[i - 1]->GetOp() != PSOP_PROC ||
+          operators[i - 2]->GetOp() != PSOP_PROC) {
+        return true;
+      }
+      Slot cond = Pop();
+      const CPDF_PSProc* then_proc = operators[i - 2]->GetProc();
+      const CPDF_PSProc* else_proc = operators[i - 1]->GetProc();
+      if (!cond.bConst) {
+        if (!CompileBranch(cond.reg, *then_proc, else_proc))
+          return false;
+      } else if (!CompileProc(static_cast<int>(cond.value) ? *then_proc
+                                                           : *else_proc)) {
+        return false;
+      }
+    } else if (!CompileOperator(op)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CPDF_PSCompiler::CompileBranch(uint32_t cond_reg,
+                                    const CPDF_PSProc& then_proc,
+                                    const CPDF_PSProc* else_proc) {
+  // Materialize() may overwrite the condition.
+  if (cond_reg < PSENGINE_STACKSIZE)
+    cond_reg = ToRegister(RegisterSlot(cond_reg));
+  Materialize();
+  const std::vector<Slot> entry_stack = m_Stack;
+  size_t skip_then =
+      Emit(OpType::kJumpIfZero, PSOP_CONST, 0, cond_reg, 0, 0);
+  if (!CompileProc(then_proc))
+    return false;
+
+  Materialize();
+  const size_t then_depth = m_Stack.size();
+  if (else_proc) {
+    size_t skip_else = Emit(OpType::kJump, PSOP_CONST, 0, 0, 0, 0);
+    m_pProgram->m_Instructions[skip_then].dest =
+        m_pProgram->m_Instructions.size();
+    m_Stack = entry_stack;
+    if (!CompileProc(*else_proc))
+      return false;
+
+    Materialize();
+    skip_then = skip_else;
+  }
+  // The stack has to look the same whichever way the program goes.
+  if (m_Stack.size() != then_depth ||
+      (!else_proc && then_depth != entry_stack.size())) {
+    return false;
+  }
+  m_pProgram->m_Instructions[skip_then].dest =
+      m_pProgram->m_Instructions.size();
+  m_pProgram->m_bHasJumps = true;
+  return true;
+}
+
+// Mirrors CPDF_PSEngine::DoOperator(), folding operators on constants.
+bool CPDF_PSCompiler::CompileOperator(PDF_PSOP op) {
+  if (IsUnaryOp(op)) {
+    Slot slot = Pop();
+    if (slot.bConst) {
+      Push(ConstSlot(ApplyUnaryOp(op, slot.value)));
+    } else {
+      Push(RegisterSlot(m_nRegisters));
+      Emit(OpType::kUnary, op, m_nRegisters++, slot.reg, 0, 0);
+    }
+    return true;
+  }
+  if (IsBinaryOp(op)) {
+    Slot slot2 = Pop();
+    Slot slot1 = Pop();
+    if (slot1.bConst && slot2.bConst) {
+      Push(ConstSlot(ApplyBinaryOp(op, slot1.value, slot2.value)));
+    } else {
+      uint32_t reg1 = ToRegister(slot1);
+      uint32_t reg2 = ToRegister(slot2);
+      Push(RegisterSlot(m_nRegisters));
+      Emit(OpType::kBinary, op, m_nRegisters++, reg1, reg2, 0);
+    }
+    return true;
+  }
+  switch (op) {
+    case PSOP_TRUE:
+      Push(ConstSlot(1));
+      break;
+    case PSOP_FALSE:
+      Push(ConstSlot(0));
+      break;
+    case PSOP_POP:
+      Pop();
+      break;
+    case PSOP_EXCH: {
+      Slot slot2 = Pop();
+      Slot slot1 = Pop();
+      Push(slot2);
+      Push(slot1);
+      break;
+    }
+    case PSOP_DUP: {
+      Slot slot = Pop();
+      Push(slot);
+      Push(slot);
+      break;
+    }
+    case PSOP_COPY: {
+      Slot count = Pop();
+      if (!count.bConst)
+        return false;
+      int n = static_cast<int>(count.value);
+      int size = static_cast<int>(m_Stack.size());
+      if (n < 0 || size + n > static_cast<int>(PSENGINE_STACKSIZE) ||
+          n > size) {
+        break;
+      }
+      for (int i = 0; i < n; i++) {
+        Slot slot = m_Stack[size + i - n];
+        m_Stack.push_back(slot);
+      }
+      break;
+    }
+    case PSOP_INDEX: {
+      Slot index = Pop();
+      if (!index.bConst)
+        return false;
+      int n = static_cast<int>(index.value);
+      if (n < 0 || n >= static_cast<int>(m_Stack.size()))
+        break;
+      Slot slot = m_Stack[m_Stack.size() - n - 1];
+      Push(slot);
+      break;
+    }
+    case PSOP_ROLL: {
+      Slot shift = Pop();
+      Slot count = Pop();
+      if (!shift.bConst || !count.bConst)
+        return false;
+      int j = static_cast<int>(shift.value);
+      int n = static_cast<int>(count.value);
+      if (j == 0 || n == 0 || m_Stack.empty())
+        break;
+      if (n < 0 || n > static_cast<int>(m_Stack.size()))
+        break;
+
+      j %= n;
+      if (j > 0)
+        j -= n;
+      auto begin_it = m_Stack.end() - n;
+      std::rotate(begin_it, begin_it - j, m_Stack.end());
+      break;
+    }
+    default:
+      break;
+  }
+  return true;
+}
+
+size_t CPDF_PSCompiler::Emit(OpType type,
+                             PDF_PSOP op,
+                             uint32_t dest,
+                             uint32_t src1,
+                             uint32_t src2,
+                             float value) {
+  m_pProgram->m_Instructions.push_back({type, op, dest, src1, src2, value});
+  return m_pProgram->m_Instructions.size() - 1;
+}
+
+uint32_t CPDF_PSCompiler::ToRegister(const Slot& slot) {
+  if (slot.bConst) {
+    Emit(OpType::kConst, PSOP_CONST, m_nRegisters, 0, 0, slot.value);
+    return m_nRegisters++;
+  }
+  if (slot.reg >= PSENGINE_STACKSIZE)
+    return slot.reg;
+  Emit(OpType::kMove, PSOP_CONST, m_nRegisters, slot.reg, 0, 0);
+  return m_nRegisters++;
+}
+
+void CPDF_PSCompiler::Materialize() {
+  // First move values out of the registers of other slots, so that the
+  // moves below cannot overwrite anything still needed.
+  for (size_t i = 0; i < m_Stack.size(); ++i) {
+    if (!m_Stack[i].bConst && m_Stack[i].reg != i &&
+        m_Stack[i].reg < PSENGINE_STACKSIZE) {
+      m_Stack[i].reg = ToRegister(m_Stack[i]);
+    }
+  }
+  for (size_t i = 0; i < m_Stack.size(); ++i) {
+    uint32_t reg = static_cast<uint32_t>(i);
+    if (m_Stack[i].bConst)
+      Emit(OpType::kConst, PSOP_CONST, reg, 0, 0, m_Stack[i].value);
+    else if (m_Stack[i].reg != reg)
+      Emit(OpType::kMove, PSOP_CONST, reg, m_Stack[i].reg, 0, 0);
+    m_Stack[i] = RegisterSlot(reg);
+  }
+}
+
+CPDF_PSProgram::CPDF_PSProgram()
+    : m_nInputs(0),
+      m_nRegisters(0),
+      m_bEnoughOutputs(false),
+      m_bHasJumps(false) {}
+
+CPDF_PSProgram::~CPDF_PSProgram() {}
+
+bool CPDF_PSProgram::Compile(const CPDF_PSProc& proc,
+                             uint32_t nInputs,
+                             uint32_t nOutputs) {
+  m_Instructions.clear();
+  m_Outputs.clear();
+  m_bHasJumps = false;
+  return CPDF_PSCompiler(this).Compile(proc, nInputs, nOutputs);
+}
+
+bool CPDF_PSProgram::Run(const float* inputs, float* results) const {
+  if (!m_bEnoughOutputs)
+    return false;
+
+  // Most programs need a few registers past the stack slots, which fit on the
+  // stack of the caller.
+  const uint32_t kMaxLocalRegisters = 512;
+  float local_regs[kMaxLocalRegisters];
+  std::vector<float> heap_regs;
+  float* regs = local_regs;
+  if (m_nRegisters > kMaxLocalRegisters) {
+    heap_regs.resize(m_nRegisters);
+    regs = heap_regs.data();
+  }
+  uint32_t nInputs = std::min(m_nInputs, PSENGINE_STACKSIZE);
+  for (uint32_t i = 0; i < nInputs; i++)
+    regs[i] = inputs[i];
+  size_t pc = 0;
+  while (pc < m_Instructions.size()) {
+    const Instruction& inst = m_Instructions[pc++];
+    switch (inst.type) {
+      case OpType::kConst:
+        regs[inst.dest] = inst.value;
+        break;
+      case OpType::kMove:
+        regs[inst.dest] = regs[inst.src1];
+        break;
+      case OpType::kUnary:
+        regs[inst.dest] = ApplyUnaryOp(inst.op, regs[inst.src1]);
+        break;
+      case OpType::kBinary:
+        regs[inst.dest] =
+            ApplyBinaryOp(inst.op, regs[inst.src1], regs[inst.src2]);
+        break;
+      case OpType::kJumpIfZero:
+        if (!static_cast<int>(regs[inst.src1]))
+          pc = inst.dest;
+        break;
+      case OpType::kJump:
+        pc = inst.dest;
+        break;
+    }
+  }
+  for (size_t i = 0; i < m_Outputs.size(); i++)
+    results[i] = m_Outputs[i].bConst ? m_Outputs[i].value
+                                     : regs[m_Outputs[i].reg];
+  return true;
+}
+
+bool CPDF_PSProgram::RunBatch(const float* inputs,
+                              float* results,
+                              uint32_t count) const {
+  if (!m_bEnoughOutputs)
+    return false;
+
+  const size_t nOutputs = m_Outputs.size();
+  if (m_bHasJumps) {
+    for (uint32_t i = 0; i < count; i++)
+      Run(inputs + i * m_nInputs, results + i * nOutputs);
+    return true;
+  }
+
+  // Without branches every instruction applies to a whole batch at once,
+  // with the registers holding |kBatchSize| values each.
+  const uint32_t kBatchSize = 64;
+  std::vector<float> batch_regs(m_nRegisters * kBatchSize);
+  uint32_t nInputs = std::min(m_nInputs, PSENGINE_STACKSIZE);
+  for (uint32_t start = 0; start < count; start += kBatchSize) {
+    const uint32_t size = std::min(count - start, kBatchSize);
+    float* regs = batch_regs.data();
+    for (uint32_t i = 0; i < nInputs; i++) {
+      for (uint32_t j = 0; j < size; j++)
+        regs[i * kBatchSize + j] = inputs[(start + j) * m_nInputs + i];
+    }
+    for (const Instruction& inst : m_Instructions) {
+      float* dest = regs + inst.dest * kBatchSize;
+      const float* src1 = regs + inst.src1 * kBatchSize;
+      const float* src2 = regs + inst.src2 * kBatchSize;
+      switch (inst.type) {
+        case OpType::kConst:
+          std::fill(dest, dest + size, inst.value);
+          break;
+        case OpType::kMove:
+          std::copy(src1, src1 + size, dest);
+          break;
+        case OpType::kUnary:
+          for (uint32_t j = 0; j < size; j++)
+            dest[j] = ApplyUnaryOp(inst.op, src1[j]);
+          break;
+        case OpType::kBinary:
+          if (inst.op == PSOP_ADD) {
+            for (uint32_t j = 0; j < size; j++)
+              dest[j] = src1[j] + src2[j];
+          } else if (inst.op == PSOP_MUL) {
+            for (uint32_t j = 0; j < size; j++)
+              dest[j] = src1[j] * src2[j];
+          } else {
+            for (uint32_t j = 0; j < size; j++)
+              dest[j] = ApplyBinaryOp(inst.op, src1[j], src2[j]);
+          }
+          break;
+        case OpType::kJumpIfZero:
+        case OpType::kJump:
+          ASSERT(false);
+          break;
+      }
+    }
+    for (size_t i = 0; i < nOutputs; i++) {
+      const Output& output = m_Outputs[i];
+      for (uint32_t j = 0; j < size; j++) {
+        results[(start + j) * nOutputs + i] =
+            output.bConst ? output.value
+                          : regs[output.reg * kBatchSize + j];
+      }
+    }
+  }
+  return true;
+}
+
 CPDF_SampledFunc::CPDF_SampledFunc() : CPDF_Function(Type::kType0Sampled) {}
 
 CPDF_SampledFunc::~CPDF_SampledFunc() {}
@@ -831,6 +1288,46 @@ bool CPDF_Function::Call(float* inputs,
   return true;
 }
 
+bool CPDF_Function::CallBatch(const float* inputs,
+                              uint32_t ninputs,
+                              uint32_t count,
+                              float* results,
+                              int* nresults) const {
+  if (m_nInputs != ninputs)
+    return false;
+
+  *nresults = m_nOutputs;
+  std::vector<float> clamped(inputs, inputs + count * m_nInputs);
+  for (uint32_t i = 0; i < count; i++) {
+    for (uint32_t j = 0; j < m_nInputs; j++) {
+      float& input = clamped[i * m_nInputs + j];
+      input = pdfium::clamp(input, m_pDomains[j * 2], m_pDomains[j * 2 + 1]);
+    }
+  }
+  v_CallBatch(clamped.data(), results, count);
+  if (!m_pRanges)
+    return true;
+
+  for (uint32_t i = 0; i < count; i++) {
+    for (uint32_t j = 0; j < m_nOutputs; j++) {
+      float& result = results[i * m_nOutputs + j];
+      result = pdfium::clamp(result, m_pRanges[j * 2], m_pRanges[j * 2 + 1]);
+    }
+  }
+  return true;
+}
+
+bool CPDF_Function::v_CallBatch(float* inputs,
+                                float* results,
+                                uint32_t count) const {
+  bool ret = true;
+  for (uint32_t i = 0; i < count; i++) {
+    if (!v_Call(inputs + i * m_nInputs, results + i * m_nOutputs))
+      ret = false;
+  }
+  return ret;
+}
+
 const CPDF_SampledFunc* CPDF_Function::ToSampledFunc() const {
   return m_Type == Type::kType0Sampled
              ? static_cast<const CPDF_SampledFunc*>(this)
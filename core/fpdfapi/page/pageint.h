@@ -39,6 +39,14 @@ class CPDF_Function {
             uint32_t ninputs,
             float* results,
             int* nresults) const;
+  // Like Call(), for |count| sets of inputs and results stored one after
+  // another. Functions that can evaluate many inputs faster override
+  // v_CallBatch().
+  bool CallBatch(const float* inputs,
+                 uint32_t ninputs,
+                 uint32_t count,
+                 float* results,
+                 int* nresults) const;
   uint32_t CountInputs() const { return m_nInputs; }
   uint32_t CountOutputs() const { return m_nOutputs; }
   float GetDomain(int i) const { return m_pDomains[i]; }
@@ -54,6 +62,9 @@ class CPDF_Function {
   bool Init(CPDF_Object* pObj);
   virtual bool v_Init(CPDF_Object* pObj) = 0;
   virtual bool v_Call(float* inputs, float* results) const = 0;
+  virtual bool v_CallBatch(float* inputs,
+                           float* results,
+                           uint32_t count) const;
 
   uint32_t m_nInputs;
   uint32_t m_nOutputs;
@@ -148,7 +159,10 @@ class CPDF_IccProfile : public CFX_Retainable {
   uint32_t GetComponents() const { return m_nSrcComponents; }
 
  private:
-  CPDF_IccProfile(CPDF_Stream* pStream, const uint8_t* pData, uint32_t dwSize);
+  CPDF_IccProfile(CPDF_Stream* pStream,
+                  const uint8_t* pData,
+                  uint32_t dwSize,
+                  const CFX_ByteString& bsDigest);
   ~CPDF_IccProfile() override;
 
   const bool m_bsRGB;
@@ -209,5 +223,6 @@ struct PatternValue {
 CFX_ByteStringC PDF_FindKeyAbbreviationForTesting(const CFX_ByteStringC& abbr);
 CFX_ByteStringC PDF_FindValueAbbreviationForTesting(
     const CFX_ByteStringC& abbr);
+bool PDF_ParseNumberForTesting(const CFX_ByteStringC& word, void* pData);
 
 #endif  // CORE_FPDFAPI_PAGE_PAGEINT_H_
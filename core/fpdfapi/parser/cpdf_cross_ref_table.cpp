@@ -0,0 +1,82 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#include "core/fpdfapi/parser/cpdf_cross_ref_table.h"
+
+#include <algorithm>
+
+CPDF_CrossRefTable::CPDF_CrossRefTable()
+    : m_DenseLimit(kMaxDenseObjectNumber), m_LastObjNum(0), m_bEmpty(true) {}
+
+CPDF_CrossRefTable::~CPDF_CrossRefTable() {}
+
+void CPDF_CrossRefTable::clear() {
+  m_Dense.clear();
+  m_Sparse.clear();
+  m_LastObjNum = 0;
+  m_bEmpty = true;
+}
+
+void CPDF_CrossRefTable::SetFileSize(FX_FILESIZE size) {
+  ASSERT(empty());
+  FX_FILESIZE limit = std::max<FX_FILESIZE>(size / kBytesPerDenseObject,
+                                            kMinDenseObjectNumber);
+  m_DenseLimit = static_cast<uint32_t>(
+      std::min<FX_FILESIZE>(limit, kMaxDenseObjectNumber));
+}
+
+CPDF_CrossRefTable::ObjectInfo& CPDF_CrossRefTable::operator[](
+    uint32_t objnum) {
+  if (m_bEmpty || objnum > m_LastObjNum) {
+    m_LastObjNum = objnum;
+    m_bEmpty = false;
+  }
+  if (objnum >= m_DenseLimit)
+    return m_Sparse[objnum];
+
+  if (objnum >= m_Dense.size())
+    m_Dense.resize(objnum + 1);
+  return m_Dense[objnum];
+}
+
+const CPDF_CrossRefTable::ObjectInfo* CPDF_CrossRefTable::Find(
+    uint32_t objnum) const {
+  if (m_bEmpty || objnum > m_LastObjNum)
+    return nullptr;
+
+  if (objnum < m_Dense.size())
+    return &m_Dense[objnum];
+
+  if (objnum < m_DenseLimit)
+    return nullptr;
+
+  auto it = m_Sparse.find(objnum);
+  return it != m_Sparse.end() ? &it->second : nullptr;
+}
+
+void CPDF_CrossRefTable::Reserve(uint32_t size) {
+  m_Dense.reserve(std::min(size, m_DenseLimit));
+}
+
+void CPDF_CrossRefTable::ShrinkTo(uint32_t size) {
+  if (size == 0) {
+    clear();
+    return;
+  }
+
+  if (size < m_Dense.size())
+    m_Dense.resize(size);
+  m_Sparse.erase(m_Sparse.lower_bound(size), m_Sparse.end());
+
+  // Unset slots in the dense range need no placeholder. Find() reports them
+  // as missing, which callers treat like default entries.
+  const uint32_t last = size - 1;
+  if (last >= m_DenseLimit)
+    m_Sparse[last];
+
+  m_LastObjNum = last;
+  m_bEmpty = false;
+}
@@ -0,0 +1,99 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#ifndef CORE_FPDFAPI_PARSER_CPDF_CROSS_REF_TABLE_H_
+#define CORE_FPDFAPI_PARSER_CPDF_CROSS_REF_TABLE_H_
+
+#include <map>
+#include <vector>
+
+#include "core/fxcrt/fx_system.h"
+
+// Cross reference entries indexed by object number. Object numbers below the
+// dense limit live in a flat vector so lookups are O(1) and loading a table
+// does not allocate per entry. Larger object numbers, which only show up in
+// damaged or hostile files, fall back to a sparse map.
+//
+// Entries that were never written read back as default ObjectInfo values,
+// which callers treat the same way as free entries.
+class CPDF_CrossRefTable {
+ public:
+  struct ObjectInfo {
+    ObjectInfo() : pos(0), type(0), gennum(0) {}
+
+    FX_FILESIZE pos;
+    uint8_t type;
+    uint16_t gennum;
+  };
+
+  static const uint32_t kMaxDenseObjectNumber = 1048576;
+  static const uint32_t kMinDenseObjectNumber = 4096;
+  // Even the smallest objects and cross reference entries take more bytes
+  // than this, so a file cannot hold more objects than its size divided by it.
+  static const uint32_t kBytesPerDenseObject = 8;
+
+  CPDF_CrossRefTable();
+  ~CPDF_CrossRefTable();
+
+  bool empty() const { return m_bEmpty; }
+  void clear();
+
+  // Limits the dense storage to what a file of |size| bytes can fill, so an
+  // out-of-range object number in a small file does not allocate megabytes.
+  // Must be called while the table is empty.
+  void SetFileSize(FX_FILESIZE size);
+
+  // Only valid when !empty().
+  uint32_t GetLastObjNum() const { return m_LastObjNum; }
+
+  // Returns the entry for |objnum|, creating it if needed.
+  ObjectInfo& operator[](uint32_t objnum);
+
+  // Returns nullptr if |objnum| has no entry.
+  const ObjectInfo* Find(uint32_t objnum) const;
+
+  // Pre-sizes the dense storage for a table of |size| objects.
+  void Reserve(uint32_t size);
+
+  // Calls |visitor(objnum, info)| in ascending object number order until it
+  // returns false. Dense slots that were never written are visited too, with
+  // default values.
+  template <typename Visitor>
+  void Visit(Visitor visitor) {
+    for (uint32_t i = 0; i < m_Dense.size(); ++i) {
+      if (!visitor(i, m_Dense[i]))
+        return;
+    }
+    for (auto& it : m_Sparse) {
+      if (!visitor(it.first, it.second))
+        return;
+    }
+  }
+  template <typename Visitor>
+  void Visit(Visitor visitor) const {
+    for (uint32_t i = 0; i < m_Dense.size(); ++i) {
+      if (!visitor(i, m_Dense[i]))
+        return;
+    }
+    for (const auto& it : m_Sparse) {
+      if (!visitor(it.first, it.second))
+        return;
+    }
+  }
+
+  // Drops all entries at or above |size| and makes |size| - 1 the last
+  // object number. A |size| of 0 clears the table.
+  void ShrinkTo(uint32_t size);
+
+ private:
+  std::vector<ObjectInfo> m_Dense;
+  std::map<uint32_t, ObjectInfo> m_Sparse;
+  uint32_t m_DenseLimit;
+  uint32_t m_LastObjNum;
+  bool m_bEmpty;
+};
+
+#endif  // CORE_FPDFAPI_PARSER_CPDF_CROSS_REF_TABLE_H_
@@ -0,0 +1,142 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/parser/cpdf_cross_ref_table.h"
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+TEST(cpdf_cross_ref_table, Empty) {
+  CPDF_CrossRefTable table;
+  EXPECT_TRUE(table.empty());
+  EXPECT_FALSE(table.Find(0));
+  EXPECT_FALSE(table.Find(1));
+}
+
+TEST(cpdf_cross_ref_table, DenseAndSparse) {
+  const uint32_t kSparse = CPDF_CrossRefTable::kMaxDenseObjectNumber + 5;
+
+  CPDF_CrossRefTable table;
+  table[3].pos = 100;
+  table[3].type = 1;
+  EXPECT_FALSE(table.empty());
+  EXPECT_EQ(3u, table.GetLastObjNum());
+
+  // Unwritten dense slots read back as default entries.
+  ASSERT_TRUE(table.Find(1));
+  EXPECT_EQ(0, table.Find(1)->pos);
+  EXPECT_EQ(0, table.Find(1)->type);
+  ASSERT_TRUE(table.Find(3));
+  EXPECT_EQ(100, table.Find(3)->pos);
+  EXPECT_FALSE(table.Find(4));
+
+  table[kSparse].pos = 200;
+  EXPECT_EQ(kSparse, table.GetLastObjNum());
+  ASSERT_TRUE(table.Find(kSparse));
+  EXPECT_EQ(200, table.Find(kSparse)->pos);
+  EXPECT_FALSE(table.Find(kSparse - 1));
+
+  // Writing a lower object number keeps the last object number.
+  table[2].pos = 50;
+  EXPECT_EQ(kSparse, table.GetLastObjNum());
+
+  table.clear();
+  EXPECT_TRUE(table.empty());
+  EXPECT_FALSE(table.Find(3));
+}
+
+TEST(cpdf_cross_ref_table, ShrinkTo) {
+  const uint32_t kSparse = CPDF_CrossRefTable::kMaxDenseObjectNumber + 5;
+
+  CPDF_CrossRefTable table;
+  table[1].pos = 10;
+  table[7].pos = 70;
+  table[kSparse].pos = 80;
+
+  table.ShrinkTo(5);
+  EXPECT_EQ(4u, table.GetLastObjNum());
+  EXPECT_EQ(10, table.Find(1)->pos);
+  EXPECT_FALSE(table.Find(7));
+  EXPECT_FALSE(table.Find(kSparse));
+
+  // Growing the last object number does not require stored entries.
+  table.ShrinkTo(20);
+  EXPECT_EQ(19u, table.GetLastObjNum());
+  EXPECT_EQ(10, table.Find(1)->pos);
+  EXPECT_FALSE(table.Find(7));
+
+  table[kSparse].pos = 80;
+  table.ShrinkTo(kSparse);
+  EXPECT_EQ(kSparse - 1, table.GetLastObjNum());
+  ASSERT_TRUE(table.Find(kSparse - 1));
+  EXPECT_EQ(0, table.Find(kSparse - 1)->pos);
+  EXPECT_FALSE(table.Find(kSparse));
+
+  table.ShrinkTo(0);
+  EXPECT_TRUE(table.empty());
+}
+
+TEST(cpdf_cross_ref_table, Visit) {
+  const uint32_t kSparse = CPDF_CrossRefTable::kMaxDenseObjectNumber + 5;
+
+  CPDF_CrossRefTable table;
+  table[kSparse].pos = 30;
+  table[2].pos = 20;
+
+  std::vector<uint32_t> visited;
+  table.Visit([&visited](uint32_t objnum,
+                         const CPDF_CrossRefTable::ObjectInfo& info) {
+    if (info.pos)
+      visited.push_back(objnum);
+    return true;
+  });
+  ASSERT_EQ(2u, visited.size());
+  EXPECT_EQ(2u, visited[0]);
+  EXPECT_EQ(kSparse, visited[1]);
+
+  // Stops as soon as the visitor returns false.
+  visited.clear();
+  table.Visit([&visited](uint32_t objnum,
+                         const CPDF_CrossRefTable::ObjectInfo& info) {
+    visited.push_back(objnum);
+    return info.pos == 0;
+  });
+  ASSERT_EQ(3u, visited.size());
+  EXPECT_EQ(2u, visited.back());
+}
+
+TEST(cpdf_cross_ref_table, SetFileSize) {
+  const uint32_t kObjNum = 500000;
+  size_t visited = 0;
+  auto count = [&visited](uint32_t objnum,
+                          const CPDF_CrossRefTable::ObjectInfo& info) {
+    ++visited;
+    return true;
+  };
+
+  // A small file cannot hold that many objects, so the entry goes to the
+  // sparse map instead of growing the dense storage to reach it.
+  CPDF_CrossRefTable small_table;
+  small_table.SetFileSize(1000);
+  small_table[2].pos = 20;
+  small_table[kObjNum].pos = 30;
+  small_table.Visit(count);
+  EXPECT_EQ(4u, visited);
+  EXPECT_EQ(kObjNum, small_table.GetLastObjNum());
+  ASSERT_TRUE(small_table.Find(kObjNum));
+  EXPECT_EQ(30, small_table.Find(kObjNum)->pos);
+  EXPECT_FALSE(small_table.Find(kObjNum - 1));
+
+  // A large enough file keeps it dense.
+  visited = 0;
+  CPDF_CrossRefTable large_table;
+  large_table.SetFileSize(100000000);
+  large_table[2].pos = 20;
+  large_table[kObjNum].pos = 30;
+  large_table.Visit(count);
+  EXPECT_EQ(kObjNum + 1, visited);
+  ASSERT_TRUE(large_table.Find(kObjNum));
+  EXPECT_EQ(30, large_table.Find(kObjNum)->pos);
+}
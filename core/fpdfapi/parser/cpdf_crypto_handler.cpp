@@ -160,6 +160,20 @@ bool CPDF_CryptoHandler::CryptStream(void* context,
   uint32_t src_off = 0;
   uint32_t src_left = src_size;
   while (1) {
+    if (pContext->m_BlockOffset == 0 && !pContext->m_bIV && src_left > 16) {
+      // Run all the whole blocks but the last through in one call. The last
+      // one is kept back, as below, in case it holds the padding.
+      uint32_t bulk_size = (src_left - 1) / 16 * 16;
+      FX_STRSIZE old_size = dest_buf.GetSize();
+      dest_buf.AppendBlock(src_buf + src_off, bulk_size);
+      uint8_t* bulk = dest_buf.GetBuffer() + old_size;
+      if (bEncrypt)
+        CRYPT_AESEncrypt(&pContext->m_Context, bulk, bulk, bulk_size);
+      else
+        CRYPT_AESDecrypt(&pContext->m_Context, bulk, bulk, bulk_size);
+      src_off += bulk_size;
+      src_left -= bulk_size;
+    }
     uint32_t copy_size = 16 - pContext->m_BlockOffset;
     if (copy_size > src_left) {
       copy_size = src_left;
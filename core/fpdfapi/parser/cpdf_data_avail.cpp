@@ -106,12 +106,11 @@ uint32_t CPDF_DataAvail::GetObjectSize(uint32_t objnum, FX_FILESIZE& offset) {
   if (offset == 0)
     return 0;
 
-  auto it = pParser->m_SortedOffset.find(offset);
-  if (it == pParser->m_SortedOffset.end() ||
-      ++it == pParser->m_SortedOffset.end()) {
+  FX_FILESIZE nextoff = 0;
+  if (!pParser->GetNextSortedOffset(offset, &nextoff))
     return 0;
-  }
-  return *it - offset;
+
+  return nextoff - offset;
 }
 
 bool CPDF_DataAvail::AreObjectsAvailable(std::vector<CPDF_Object*>& obj_array,
@@ -325,8 +324,11 @@ bool CPDF_DataAvail::LoadAllFile(DownloadHints* pHints) {
 
 bool CPDF_DataAvail::LoadAllXref(DownloadHints* pHints) {
   m_parser.m_pSyntax->InitParser(m_pFileRead, (uint32_t)m_dwHeaderOffset);
-  if (!m_parser.LoadAllCrossRefV4(m_dwLastXRefOffset) &&
-      !m_parser.LoadAllCrossRefV5(m_dwLastXRefOffset)) {
+  m_parser.m_ObjectInfo.SetFileSize(m_parser.m_pSyntax->m_FileLen);
+  bool bLoaded = m_parser.LoadAllCrossRefV4(m_dwLastXRefOffset) ||
+                 m_parser.LoadAllCrossRefV5(m_dwLastXRefOffset);
+  m_parser.SortOffsets();
+  if (!bLoaded) {
     m_docStatus = PDF_DATAAVAIL_LOADALLFILE;
     return false;
   }
@@ -7,6 +7,7 @@
 #include "core/fpdfapi/parser/cpdf_document.h"
 
 #include <memory>
+#include <mutex>
 #include <set>
 #include <utility>
 #include <vector>
@@ -349,7 +350,8 @@ CPDF_Document::CPDF_Document(std::unique_ptr<CPDF_Parser> pParser)
       m_iFirstPageNo(0),
       m_dwFirstPageObjNum(0),
       m_pDocPage(pdfium::MakeUnique<CPDF_DocPageData>(this)),
-      m_pDocRender(pdfium::MakeUnique<CPDF_DocRenderData>(this)) {
+      m_pDocRender(pdfium::MakeUnique<CPDF_DocRenderData>(this)),
+      m_pCodecContext(pdfium::MakeUnique<JBig2_DocumentContext>()) {
   if (pParser)
     SetLastObjNum(m_pParser->GetLastObjNum());
 }
@@ -481,6 +483,8 @@ CPDF_Dictionary* CPDF_Document::GetPage(int iPage) {
   if (!pdfium::IndexInBounds(m_PageList, iPage))
     return nullptr;
 
+  // Walking the page tree updates the traversal state and the page list.
+  std::lock_guard<std::recursive_mutex> lock(*GetObjectMutex());
   if (m_bLinearized && iPage == m_iFirstPageNo) {
     if (CPDF_Dictionary* pDict =
             ToDictionary(GetOrParseIndirectObject(m_dwFirstPageObjNum))) {
@@ -569,6 +573,7 @@ int CPDF_Document::FindPageIndex(CPDF_Dictionary* pNode,
 }
 
 int CPDF_Document::GetPageIndex(uint32_t objnum) {
+  std::lock_guard<std::recursive_mutex> lock(*GetObjectMutex());
   uint32_t nPages = m_PageList.size();
   uint32_t skip_count = 0;
   bool bSkipped = false;
@@ -23,6 +23,7 @@ CPDF_IndirectObjectHolder::~CPDF_IndirectObjectHolder() {
 
 CPDF_Object* CPDF_IndirectObjectHolder::GetIndirectObject(
     uint32_t objnum) const {
+  std::lock_guard<std::recursive_mutex> lock(m_ObjectMutex);
   auto it = m_IndirectObjs.find(objnum);
   return it != m_IndirectObjs.end() ? it->second.get() : nullptr;
 }
@@ -32,6 +33,7 @@ CPDF_Object* CPDF_IndirectObjectHolder::GetOrParseIndirectObject(
   if (objnum == 0)
     return nullptr;
 
+  std::lock_guard<std::recursive_mutex> lock(m_ObjectMutex);
   CPDF_Object* pObj = GetIndirectObject(objnum);
   if (pObj)
     return pObj->GetObjNum() != CPDF_Object::kInvalidObjNum ? pObj : nullptr;
@@ -54,6 +56,7 @@ std::unique_ptr<CPDF_Object> CPDF_IndirectObjectHolder::ParseIndirectObject(
 CPDF_Object* CPDF_IndirectObjectHolder::AddIndirectObject(
     std::unique_ptr<CPDF_Object> pObj) {
   CHECK(!pObj->m_ObjNum);
+  std::lock_guard<std::recursive_mutex> lock(m_ObjectMutex);
   CPDF_Object* pUnowned = pObj.get();
   pObj->m_ObjNum = ++m_LastObjNum;
   if (m_IndirectObjs[m_LastObjNum])
@@ -70,6 +73,7 @@ bool CPDF_IndirectObjectHolder::ReplaceIndirectObjectIfHigherGeneration(
   if (!pObj)
     return false;
 
+  std::lock_guard<std::recursive_mutex> lock(m_ObjectMutex);
   CPDF_Object* pOldObj = GetIndirectObject(objnum);
   if (pOldObj && pObj->GetGenNum() <= pOldObj->GetGenNum())
     return false;
@@ -81,6 +85,7 @@ bool CPDF_IndirectObjectHolder::ReplaceIndirectObjectIfHigherGeneration(
 }
 
 void CPDF_IndirectObjectHolder::DeleteIndirectObject(uint32_t objnum) {
+  std::lock_guard<std::recursive_mutex> lock(m_ObjectMutex);
   CPDF_Object* pObj = GetIndirectObject(objnum);
   if (!pObj || pObj->GetObjNum() == CPDF_Object::kInvalidObjNum)
     return;
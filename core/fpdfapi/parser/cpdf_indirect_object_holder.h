@@ -9,6 +9,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -62,6 +63,11 @@ class CPDF_IndirectObjectHolder {
     return m_pByteStringPool;
   }
 
+  // Guards the object table, and the parser that fills it, against threads
+  // that load objects at the same time. It is recursive, since parsing one
+  // object can load others, such as the /Length of a stream.
+  std::recursive_mutex* GetObjectMutex() const { return &m_ObjectMutex; }
+
   const_iterator begin() const { return m_IndirectObjs.begin(); }
   const_iterator end() const { return m_IndirectObjs.end(); }
 
@@ -69,6 +75,7 @@ class CPDF_IndirectObjectHolder {
   virtual std::unique_ptr<CPDF_Object> ParseIndirectObject(uint32_t objnum);
 
  private:
+  mutable std::recursive_mutex m_ObjectMutex;
   uint32_t m_LastObjNum;
   std::map<uint32_t, std::unique_ptr<CPDF_Object>> m_IndirectObjs;
   std::vector<std::unique_ptr<CPDF_Object>> m_OrphanObjs;
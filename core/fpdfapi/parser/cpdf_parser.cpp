@@ -21,13 +21,21 @@
 #include "core/fpdfapi/parser/cpdf_stream.h"
 #include "core/fpdfapi/parser/cpdf_stream_acc.h"
 #include "core/fpdfapi/parser/cpdf_syntax_parser.h"
+#include "core/fpdfapi/parser/cpdf_xref_cache.h"
 #include "core/fpdfapi/parser/fpdf_parser_utility.h"
 #include "core/fxcrt/cfx_memorystream.h"
 #include "core/fxcrt/fx_extension.h"
 #include "core/fxcrt/fx_safe_types.h"
+#include "third_party/base/bits.h"
 #include "third_party/base/ptr_util.h"
 #include "third_party/base/stl_util.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define REBUILD_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace {
 
 // A limit on the size of the xref table. Theoretical limits are higher, but
@@ -49,6 +57,86 @@ int32_t GetStreamFirst(const CFX_RetainPtr<CPDF_StreamAcc>& pObjStream) {
   return pObjStream->GetDict()->GetIntegerFor("First");
 }
 
+// Whether |byte| moves RebuildCrossRef() out of its default state.
+bool IsDefaultStateTrigger(uint8_t byte) {
+  return PDFCharIsWhitespace(byte) || std::isdigit(byte) || byte == '%' ||
+         byte == '(' || byte == '<' || byte == '\\' || byte == 't';
+}
+
+#if defined(REBUILD_USE_SSE2)
+int FirstSetBit(int mask) {
+  return 31 - pdfium::base::bits::CountLeadingZeroBits32(mask & -mask);
+}
+
+// Returns a bit for each of the 16 bytes at |pData| that
+// IsDefaultStateTrigger() accepts.
+int DefaultStateTriggerMask(const uint8_t* pData) {
+  __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData));
+  auto equals = [bytes](char c) {
+    return _mm_cmpeq_epi8(bytes, _mm_set1_epi8(c));
+  };
+  // Matches the |count| byte values from |first| on, compared unsigned.
+  auto in_range = [bytes](char first, char count) {
+    __m128i offset = _mm_sub_epi8(bytes, _mm_set1_epi8(first));
+    return _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(count - 1)),
+                          offset);
+  };
+  // PDF whitespace is 0, 9, 10, 12, 13, 32, 128 and 255.
+  __m128i mask = _mm_andnot_si128(equals(11), in_range(9, 5));
+  mask = _mm_or_si128(mask, in_range('0', 10));
+  for (char c : {'\0', ' ', '\x80', '\xff', '%', '(', '<', '\\', 't'})
+    mask = _mm_or_si128(mask, equals(c));
+  return _mm_movemask_epi8(mask);
+}
+#endif  // defined(REBUILD_USE_SSE2)
+
+// Returns the index of the first byte from |i| on that
+// IsDefaultStateTrigger() accepts, or |size| if there is none.
+uint32_t FindDefaultStateTrigger(const uint8_t* pData,
+                                 uint32_t i,
+                                 uint32_t size) {
+#if defined(REBUILD_USE_SSE2)
+  // Triggers are usually close together in PDF syntax, so only long runs of
+  // other bytes, as in binary data, are worth checking 16 at a time.
+  for (uint32_t end = std::min(i + 16, size); i < end; ++i) {
+    if (IsDefaultStateTrigger(pData[i]))
+      return i;
+  }
+  for (; i + 16 <= size; i += 16) {
+    int mask = DefaultStateTriggerMask(pData + i);
+    if (mask)
+      return i + FirstSetBit(mask);
+  }
+#endif
+  while (i < size && !IsDefaultStateTrigger(pData[i]))
+    ++i;
+  return i;
+}
+
+// Returns the index of the first |c1| or |c2| from |i| on, or |size| if
+// there is none.
+uint32_t FindEither(const uint8_t* pData,
+                    uint32_t i,
+                    uint32_t size,
+                    uint8_t c1,
+                    uint8_t c2) {
+#if defined(REBUILD_USE_SSE2)
+  const __m128i v1 = _mm_set1_epi8(c1);
+  const __m128i v2 = _mm_set1_epi8(c2);
+  for (; i + 16 <= size; i += 16) {
+    __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + i));
+    int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(bytes, v1),
+                                              _mm_cmpeq_epi8(bytes, v2)));
+    if (mask)
+      return i + FirstSetBit(mask);
+  }
+#endif
+  while (i < size && pData[i] != c1 && pData[i] != c2)
+    ++i;
+  return i;
+}
+
 }  // namespace
 
 CPDF_Parser::CPDF_Parser()
@@ -67,29 +155,33 @@ CPDF_Parser::~CPDF_Parser() {
   SetEncryptDictionary(nullptr);
 }
 
+void CPDF_Parser::SetXRefCache(std::unique_ptr<CPDF_XRefCache> pCache) {
+  m_pXRefCache = std::move(pCache);
+}
+
 uint32_t CPDF_Parser::GetLastObjNum() const {
-  return m_ObjectInfo.empty() ? 0 : m_ObjectInfo.rbegin()->first;
+  return m_ObjectInfo.empty() ? 0 : m_ObjectInfo.GetLastObjNum();
 }
 
 bool CPDF_Parser::IsValidObjectNumber(uint32_t objnum) const {
-  return !m_ObjectInfo.empty() && objnum <= m_ObjectInfo.rbegin()->first;
+  return !m_ObjectInfo.empty() && objnum <= m_ObjectInfo.GetLastObjNum();
 }
 
 FX_FILESIZE CPDF_Parser::GetObjectPositionOrZero(uint32_t objnum) const {
-  auto it = m_ObjectInfo.find(objnum);
-  return it != m_ObjectInfo.end() ? it->second.pos : 0;
+  const CPDF_CrossRefTable::ObjectInfo* info = m_ObjectInfo.Find(objnum);
+  return info ? info->pos : 0;
 }
 
 uint8_t CPDF_Parser::GetObjectType(uint32_t objnum) const {
   ASSERT(IsValidObjectNumber(objnum));
-  auto it = m_ObjectInfo.find(objnum);
-  return it != m_ObjectInfo.end() ? it->second.type : 0;
+  const CPDF_CrossRefTable::ObjectInfo* info = m_ObjectInfo.Find(objnum);
+  return info ? info->type : 0;
 }
 
 uint16_t CPDF_Parser::GetObjectGenNum(uint32_t objnum) const {
   ASSERT(IsValidObjectNumber(objnum));
-  auto it = m_ObjectInfo.find(objnum);
-  return it != m_ObjectInfo.end() ? it->second.gennum : 0;
+  const CPDF_CrossRefTable::ObjectInfo* info = m_ObjectInfo.Find(objnum);
+  return info ? info->gennum : 0;
 }
 
 bool CPDF_Parser::IsObjectFreeOrNull(uint32_t objnum) const {
@@ -110,24 +202,61 @@ CFX_RetainPtr<IFX_SeekableReadStream> CPDF_Parser::GetFileAccess() const {
 }
 
 void CPDF_Parser::ShrinkObjectMap(uint32_t objnum) {
-  if (objnum == 0) {
-    m_ObjectInfo.clear();
+  m_ObjectInfo.ShrinkTo(objnum);
+}
+
+void CPDF_Parser::AddSortedOffset(FX_FILESIZE offset) {
+  m_PendingOffset.push_back(offset);
+}
+
+void CPDF_Parser::SortOffsets() {
+  if (m_PendingOffset.empty())
     return;
-  }
 
-  auto it = m_ObjectInfo.lower_bound(objnum);
-  while (it != m_ObjectInfo.end()) {
-    auto saved_it = it++;
-    m_ObjectInfo.erase(saved_it);
+  std::sort(m_PendingOffset.begin(), m_PendingOffset.end());
+  size_t old_size = m_SortedOffset.size();
+  m_SortedOffset.insert(m_SortedOffset.end(), m_PendingOffset.begin(),
+                        m_PendingOffset.end());
+  m_PendingOffset.clear();
+  std::inplace_merge(m_SortedOffset.begin(), m_SortedOffset.begin() + old_size,
+                     m_SortedOffset.end());
+  m_SortedOffset.erase(
+      std::unique(m_SortedOffset.begin(), m_SortedOffset.end()),
+      m_SortedOffset.end());
+}
+
+bool CPDF_Parser::GetNextSortedOffset(FX_FILESIZE offset,
+                                      FX_FILESIZE* pNextOffset) const {
+  auto it =
+      std::lower_bound(m_SortedOffset.begin(), m_SortedOffset.end(), offset);
+  if (it == m_SortedOffset.end() || *it != offset ||
+      ++it == m_SortedOffset.end()) {
+    return false;
   }
 
-  if (!pdfium::ContainsKey(m_ObjectInfo, objnum - 1))
-    m_ObjectInfo[objnum - 1].pos = 0;
+  *pNextOffset = *it;
+  return true;
 }
 
 CPDF_Parser::Error CPDF_Parser::StartParse(
     const CFX_RetainPtr<IFX_SeekableReadStream>& pFileAccess,
     CPDF_Document* pDocument) {
+  return StartParseImpl(pFileAccess, pDocument, nullptr);
+}
+
+CPDF_Parser::Error CPDF_Parser::StartParseFrom(
+    const CPDF_Parser& source,
+    const CFX_RetainPtr<IFX_SeekableReadStream>& pFileAccess,
+    CPDF_Document* pDocument) {
+  SetPassword(source.m_Password.c_str());
+  return StartParseImpl(pFileAccess, pDocument,
+                        source.m_pLinearized ? nullptr : &source);
+}
+
+CPDF_Parser::Error CPDF_Parser::StartParseImpl(
+    const CFX_RetainPtr<IFX_SeekableReadStream>& pFileAccess,
+    CPDF_Document* pDocument,
+    const CPDF_Parser* pSource) {
   ASSERT(!m_bHasParsed);
   m_bHasParsed = true;
   m_bXRefStream = false;
@@ -138,6 +267,7 @@ CPDF_Parser::Error CPDF_Parser::StartParse(
     return FORMAT_ERROR;
 
   m_pSyntax->InitParser(pFileAccess, offset);
+  m_ObjectInfo.SetFileSize(m_pSyntax->m_FileLen);
 
   uint8_t ch;
   if (!m_pSyntax->GetCharAt(5, ch))
@@ -159,8 +289,16 @@ CPDF_Parser::Error CPDF_Parser::StartParse(
   m_pDocument = pDocument;
 
   bool bXRefRebuilt = false;
-  if (m_pSyntax->BackwardsSearchToWord("startxref", 4096)) {
-    m_SortedOffset.insert(m_pSyntax->GetPos());
+  bool bLoadedFromSource = false;
+  bool bLoadedFromCache = false;
+  if (pSource)
+    bLoadedFromSource = LoadFromParser(*pSource);
+  else if (m_pXRefCache)
+    bLoadedFromCache = LoadFromXRefCache(&bXRefRebuilt);
+  if (bLoadedFromSource || bLoadedFromCache) {
+    // The cross reference table and trailer are already in place.
+  } else if (m_pSyntax->BackwardsSearchToWord("startxref", 4096)) {
+    AddSortedOffset(m_pSyntax->GetPos());
     m_pSyntax->GetKeyword();
 
     bool bNumber;
@@ -183,19 +321,24 @@ CPDF_Parser::Error CPDF_Parser::StartParse(
 
     bXRefRebuilt = true;
   }
+  SortOffsets();
+
   Error eRet = SetEncryptHandler();
   if (eRet != SUCCESS)
     return eRet;
 
   m_pDocument->LoadDoc();
   if (!m_pDocument->GetRoot() || m_pDocument->GetPageCount() == 0) {
-    if (bXRefRebuilt)
+    // The source already checked its table against the document, so
+    // rebuilding it would not find anything new.
+    if (bXRefRebuilt || bLoadedFromSource)
       return FORMAT_ERROR;
 
     ReleaseEncryptHandler();
     if (!RebuildCrossRef())
       return FORMAT_ERROR;
 
+    bXRefRebuilt = true;
     eRet = SetEncryptHandler();
     if (eRet != SUCCESS)
       return eRet;
@@ -209,6 +352,7 @@ CPDF_Parser::Error CPDF_Parser::StartParse(
     if (!RebuildCrossRef() || GetRootObjNum() == 0)
       return FORMAT_ERROR;
 
+    bXRefRebuilt = true;
     eRet = SetEncryptHandler();
     if (eRet != SUCCESS)
       return eRet;
@@ -219,8 +363,115 @@ CPDF_Parser::Error CPDF_Parser::StartParse(
     if (pMetadata)
       m_pSyntax->m_MetadataObjnum = pMetadata->GetRefObjNum();
   }
+  if (m_pXRefCache && !bLoadedFromSource && !bLoadedFromCache)
+    StoreToXRefCache(bXRefRebuilt);
   return SUCCESS;
 }
+
+std::unique_ptr<CPDF_Dictionary> CPDF_Parser::ParseTrailer(uint8_t* pData,
+                                                           size_t size) {
+  auto pTrailerFile =
+      pdfium::MakeRetain<CFX_MemoryStream>(pData, size, false);
+  CPDF_SyntaxParser syntax;
+  syntax.InitParser(pTrailerFile, 0);
+  return ToDictionary(syntax.GetObject(m_pDocument, 0, 0, true));
+}
+
+bool CPDF_Parser::LoadFromParser(const CPDF_Parser& source) {
+  if (!source.m_pTrailer)
+    return false;
+
+  // Round trip the trailer through its text form rather than cloning it, so
+  // that no string buffers are shared with |source|, which may be used on
+  // another thread.
+  CFX_ByteTextBuf trailer;
+  trailer << source.m_pTrailer.get();
+  std::unique_ptr<CPDF_Dictionary> pTrailer =
+      ParseTrailer(trailer.GetBuffer(), trailer.GetSize());
+  if (!pTrailer)
+    return false;
+
+  m_pTrailer = std::move(pTrailer);
+  m_ObjectInfo = source.m_ObjectInfo;
+  m_LastXRefOffset = source.m_LastXRefOffset;
+  m_bXRefStream = source.m_bXRefStream;
+  m_bVersionUpdated = source.m_bVersionUpdated;
+  m_SortedOffset = source.m_SortedOffset;
+  return true;
+}
+
+CFX_ByteString CPDF_Parser::ReadTrailerID() {
+  FX_FILESIZE SavedPos = m_pSyntax->GetPos();
+  if (!m_pSyntax->BackwardsSearchToWord("startxref", 4096))
+    return CFX_ByteString();
+
+  m_pSyntax->GetKeyword();
+  bool bNumber;
+  CFX_ByteString xrefpos_str = m_pSyntax->GetNextWord(&bNumber);
+  FX_FILESIZE xrefpos = FXSYS_atoi64(xrefpos_str.c_str());
+  std::unique_ptr<CPDF_Object> pTrailer;
+  if (bNumber && xrefpos > 0) {
+    m_pSyntax->SetPos(xrefpos);
+    if (m_pSyntax->GetKeyword() != "xref") {
+      // A cross reference stream, whose dictionary is the trailer.
+      pTrailer = ParseIndirectObjectAt(nullptr, xrefpos, 0);
+    } else if (m_pSyntax->FindTag("trailer", 0) >= 0) {
+      m_pSyntax->SetPos(m_pSyntax->GetPos() - 7);
+      pTrailer = LoadTrailerV4();
+    }
+  }
+  m_pSyntax->SetPos(SavedPos);
+
+  CPDF_Dictionary* pDict = pTrailer ? pTrailer->GetDict() : nullptr;
+  CPDF_Array* pID = pDict ? pDict->GetArrayFor("ID") : nullptr;
+  if (!pID)
+    return CFX_ByteString();
+  return pID->GetStringAt(0) + pID->GetStringAt(1);
+}
+
+bool CPDF_Parser::LoadFromXRefCache(bool* pXRefRebuilt) {
+  CPDF_XRefCache::Contents contents;
+  if (!m_pXRefCache->Load(GetFileAccess(), ReadTrailerID(), &m_ObjectInfo,
+                          &contents)) {
+    m_ObjectInfo.clear();
+    return false;
+  }
+
+  std::unique_ptr<CPDF_Dictionary> pTrailer =
+      ParseTrailer(contents.trailer.data(), contents.trailer.size());
+  if (!pTrailer) {
+    m_ObjectInfo.clear();
+    return false;
+  }
+
+  m_pTrailer = std::move(pTrailer);
+  m_LastXRefOffset = contents.last_xref_offset;
+  m_bXRefStream = contents.xref_stream;
+  m_bVersionUpdated = contents.version_updated;
+  // A damaged cache may list the offsets out of order.
+  m_PendingOffset = std::move(contents.sorted_offsets);
+  *pXRefRebuilt = contents.xref_rebuilt;
+  return true;
+}
+
+void CPDF_Parser::StoreToXRefCache(bool bXRefRebuilt) {
+  if (!m_pTrailer)
+    return;
+
+  CFX_ByteTextBuf trailer;
+  trailer << m_pTrailer.get();
+
+  CPDF_XRefCache::Contents contents;
+  contents.last_xref_offset = m_LastXRefOffset;
+  contents.xref_stream = m_bXRefStream;
+  contents.xref_rebuilt = bXRefRebuilt;
+  contents.version_updated = m_bVersionUpdated;
+  contents.sorted_offsets = m_SortedOffset;
+  contents.trailer.assign(trailer.GetBuffer(),
+                          trailer.GetBuffer() + trailer.GetSize());
+  m_pXRefCache->Store(m_ObjectInfo, contents);
+}
+
 CPDF_Parser::Error CPDF_Parser::SetEncryptHandler() {
   ReleaseEncryptHandler();
   SetEncryptDictionary(nullptr);
@@ -282,25 +533,25 @@ FX_FILESIZE CPDF_Parser::GetObjectOffset(uint32_t objnum) const {
 // with the objects. crbug/602650 showed a case where object numbers
 // in the cross reference table are all off by one.
 bool CPDF_Parser::VerifyCrossRefV4() {
-  for (const auto& it : m_ObjectInfo) {
-    if (it.second.pos == 0)
-      continue;
+  bool bValid = true;
+  m_ObjectInfo.Visit([this, &bValid](
+                         uint32_t objnum,
+                         const CPDF_CrossRefTable::ObjectInfo& info) {
+    if (info.pos == 0)
+      return true;
     // Find the first non-zero position.
     FX_FILESIZE SavedPos = m_pSyntax->GetPos();
-    m_pSyntax->SetPos(it.second.pos);
+    m_pSyntax->SetPos(info.pos);
     bool is_num = false;
     CFX_ByteString num_str = m_pSyntax->GetNextWord(&is_num);
     m_pSyntax->SetPos(SavedPos);
-    if (!is_num || num_str.IsEmpty() ||
-        FXSYS_atoui(num_str.c_str()) != it.first) {
-      // If the object number read doesn't match the one stored,
-      // something is wrong with the cross reference table.
-      return false;
-    } else {
-      return true;
-    }
-  }
-  return true;
+    // If the object number read doesn't match the one stored,
+    // something is wrong with the cross reference table.
+    bValid = is_num && !num_str.IsEmpty() &&
+             FXSYS_atoui(num_str.c_str()) == objnum;
+    return false;
+  });
+  return bValid;
 }
 
 bool CPDF_Parser::LoadAllCrossRefV4(FX_FILESIZE xrefpos) {
@@ -415,7 +666,7 @@ bool CPDF_Parser::LoadLinearizedCrossRefV4(FX_FILESIZE pos,
   FX_FILESIZE dwStartPos = pos - m_pSyntax->m_HeaderOffset;
 
   m_pSyntax->SetPos(dwStartPos);
-  m_SortedOffset.insert(pos);
+  AddSortedOffset(pos);
 
   uint32_t start_objnum = 0;
   uint32_t count = dwObjCount;
@@ -440,9 +691,10 @@ bool CPDF_Parser::LoadLinearizedCrossRefV4(FX_FILESIZE pos,
     for (int32_t i = 0; i < block_size; i++) {
       uint32_t objnum = start_objnum + block * 1024 + i;
       char* pEntry = &buf[i * recordsize];
+      CPDF_CrossRefTable::ObjectInfo& info = m_ObjectInfo[objnum];
       if (pEntry[17] == 'f') {
-        m_ObjectInfo[objnum].pos = 0;
-        m_ObjectInfo[objnum].type = 0;
+        info.pos = 0;
+        info.type = 0;
       } else {
         int32_t offset = FXSYS_atoi(pEntry);
         if (offset == 0) {
@@ -452,16 +704,16 @@ bool CPDF_Parser::LoadLinearizedCrossRefV4(FX_FILESIZE pos,
           }
         }
 
-        m_ObjectInfo[objnum].pos = offset;
+        info.pos = offset;
         int32_t version = FXSYS_atoi(pEntry + 11);
         if (version >= 1)
           m_bVersionUpdated = true;
 
-        m_ObjectInfo[objnum].gennum = version;
-        if (m_ObjectInfo[objnum].pos < m_pSyntax->m_FileLen)
-          m_SortedOffset.insert(m_ObjectInfo[objnum].pos);
+        info.gennum = version;
+        if (info.pos < m_pSyntax->m_FileLen)
+          AddSortedOffset(info.pos);
 
-        m_ObjectInfo[objnum].type = 1;
+        info.type = 1;
       }
     }
   }
@@ -476,9 +728,9 @@ bool CPDF_Parser::LoadCrossRefV4(FX_FILESIZE pos,
   if (m_pSyntax->GetKeyword() != "xref")
     return false;
 
-  m_SortedOffset.insert(pos);
+  AddSortedOffset(pos);
   if (streampos)
-    m_SortedOffset.insert(streampos);
+    AddSortedOffset(streampos);
 
   while (1) {
     FX_FILESIZE SavedPos = m_pSyntax->GetPos();
@@ -503,6 +755,11 @@ bool CPDF_Parser::LoadCrossRefV4(FX_FILESIZE pos,
 
     m_dwXrefStartObjNum = start_objnum;
     if (!bSkip) {
+      // Only trust |count| for pre-sizing when the file can hold that many
+      // entries.
+      if (count <= (m_pSyntax->m_FileLen - SavedPos) / recordsize)
+        m_ObjectInfo.Reserve(start_objnum + count);
+
       std::vector<char> buf(1024 * recordsize + 1);
       buf[1024 * recordsize] = '\0';
 
@@ -515,9 +772,10 @@ bool CPDF_Parser::LoadCrossRefV4(FX_FILESIZE pos,
         for (int32_t i = 0; i < block_size; i++) {
           uint32_t objnum = start_objnum + block * 1024 + i;
           char* pEntry = &buf[i * recordsize];
+          CPDF_CrossRefTable::ObjectInfo& info = m_ObjectInfo[objnum];
           if (pEntry[17] == 'f') {
-            m_ObjectInfo[objnum].pos = 0;
-            m_ObjectInfo[objnum].type = 0;
+            info.pos = 0;
+            info.type = 0;
           } else {
             FX_FILESIZE offset = (FX_FILESIZE)FXSYS_atoi64(pEntry);
             if (offset == 0) {
@@ -527,16 +785,16 @@ bool CPDF_Parser::LoadCrossRefV4(FX_FILESIZE pos,
               }
             }
 
-            m_ObjectInfo[objnum].pos = offset;
+            info.pos = offset;
             int32_t version = FXSYS_atoi(pEntry + 11);
             if (version >= 1)
               m_bVersionUpdated = true;
 
-            m_ObjectInfo[objnum].gennum = version;
-            if (m_ObjectInfo[objnum].pos < m_pSyntax->m_FileLen)
-              m_SortedOffset.insert(m_ObjectInfo[objnum].pos);
+            info.gennum = version;
+            if (info.pos < m_pSyntax->m_FileLen)
+              AddSortedOffset(info.pos);
 
-            m_ObjectInfo[objnum].type = 1;
+            info.type = 1;
           }
         }
       }
@@ -568,6 +826,7 @@ bool CPDF_Parser::LoadAllCrossRefV5(FX_FILESIZE xrefpos) {
 bool CPDF_Parser::RebuildCrossRef() {
   m_ObjectInfo.clear();
   m_SortedOffset.clear();
+  m_PendingOffset.clear();
   m_pTrailer.reset();
 
   ParserState state = ParserState::kDefault;
@@ -577,6 +836,7 @@ bool CPDF_Parser::RebuildCrossRef() {
   int32_t depth = 0;
   const uint32_t kBufferSize = 4096;
   std::vector<uint8_t> buffer(kBufferSize);
+  const uint8_t* pDirectBuf = m_pSyntax->m_pFileAccess->GetDirectBuffer();
 
   FX_FILESIZE pos = m_pSyntax->m_HeaderOffset;
   FX_FILESIZE start_pos = 0;
@@ -590,11 +850,40 @@ bool CPDF_Parser::RebuildCrossRef() {
     bool bOverFlow = false;
     uint32_t size =
         std::min((uint32_t)(m_pSyntax->m_FileLen - pos), kBufferSize);
-    if (!m_pSyntax->m_pFileAccess->ReadBlock(buffer.data(), pos, size))
+    const uint8_t* pData = pDirectBuf ? pDirectBuf + pos : buffer.data();
+    if (!pDirectBuf &&
+        !m_pSyntax->m_pFileAccess->ReadBlock(buffer.data(), pos, size)) {
       break;
+    }
 
     for (uint32_t i = 0; i < size; i++) {
-      uint8_t byte = buffer[i];
+      // Skip runs of bytes that leave |state| unchanged, 16 at a time where
+      // SSE2 is available. Stream data that fails to parse gets scanned here,
+      // which dominates the time spent on large damaged files.
+      switch (state) {
+        case ParserState::kDefault:
+          i = FindDefaultStateTrigger(pData, i, size);
+          break;
+        case ParserState::kComment:
+          i = FindEither(pData, i, size, '\r', '\n');
+          break;
+        case ParserState::kString:
+          i = FindEither(pData, i, size, '(', ')');
+          break;
+        case ParserState::kHexString:
+          if (inside_index == 0) {
+            const uint8_t* pEnd = static_cast<const uint8_t*>(
+                memchr(pData + i, '>', size - i));
+            i = pEnd ? static_cast<uint32_t>(pEnd - pData) : size;
+          }
+          break;
+        default:
+          break;
+      }
+      if (i == size)
+        break;
+
+      uint8_t byte = pData[i];
       switch (state) {
         case ParserState::kDefault:
           if (PDFCharIsWhitespace(byte)) {
@@ -715,7 +1004,7 @@ bool CPDF_Parser::RebuildCrossRef() {
             case 3:
               if (PDFCharIsWhitespace(byte) || PDFCharIsDelimiter(byte)) {
                 FX_FILESIZE obj_pos = start_pos - m_pSyntax->m_HeaderOffset;
-                m_SortedOffset.insert(obj_pos);
+                AddSortedOffset(obj_pos);
                 last_obj = start_pos;
                 FX_FILESIZE obj_end = 0;
                 std::unique_ptr<CPDF_Object> pObject =
@@ -751,19 +1040,20 @@ bool CPDF_Parser::RebuildCrossRef() {
                   i += (uint32_t)nLen;
                 }
 
-                if (!m_ObjectInfo.empty() && IsValidObjectNumber(objnum) &&
-                    m_ObjectInfo[objnum].pos) {
+                if (GetObjectPositionOrZero(objnum)) {
                   if (pObject) {
-                    uint32_t oldgen = GetObjectGenNum(objnum);
-                    m_ObjectInfo[objnum].pos = obj_pos;
-                    m_ObjectInfo[objnum].gennum = gennum;
-                    if (oldgen != gennum)
+                    CPDF_CrossRefTable::ObjectInfo& info =
+                        m_ObjectInfo[objnum];
+                    if (info.gennum != gennum)
                       m_bVersionUpdated = true;
+                    info.pos = obj_pos;
+                    info.gennum = gennum;
                   }
                 } else {
-                  m_ObjectInfo[objnum].pos = obj_pos;
-                  m_ObjectInfo[objnum].type = 1;
-                  m_ObjectInfo[objnum].gennum = gennum;
+                  CPDF_CrossRefTable::ObjectInfo& info = m_ObjectInfo[objnum];
+                  info.pos = obj_pos;
+                  info.type = 1;
+                  info.gennum = gennum;
                 }
               }
               --i;
@@ -790,7 +1080,8 @@ bool CPDF_Parser::RebuildCrossRef() {
                       CPDF_Reference* pRef = ToReference(pRoot);
                       if (!pRoot ||
                           (pRef && IsValidObjectNumber(pRef->GetRefObjNum()) &&
-                           m_ObjectInfo[pRef->GetRefObjNum()].pos != 0)) {
+                           GetObjectPositionOrZero(pRef->GetRefObjNum()) !=
+                               0)) {
                         auto it = pTrailer->begin();
                         while (it != pTrailer->end()) {
                           const CFX_ByteString& key = it->first;
@@ -914,7 +1205,8 @@ bool CPDF_Parser::RebuildCrossRef() {
   else if (last_trailer == -1 || last_xref < last_obj)
     last_trailer = m_pSyntax->m_FileLen;
 
-  m_SortedOffset.insert(last_trailer - m_pSyntax->m_HeaderOffset);
+  AddSortedOffset(last_trailer - m_pSyntax->m_HeaderOffset);
+  SortOffsets();
   return m_pTrailer && !m_ObjectInfo.empty();
 }
 
@@ -953,8 +1245,11 @@ bool CPDF_Parser::LoadCrossRefV5(FX_FILESIZE* pos, bool bMainXRef) {
   if (bMainXRef) {
     m_pTrailer = std::move(pNewTrailer);
     ShrinkObjectMap(size);
-    for (auto& it : m_ObjectInfo)
-      it.second.type = 0;
+    m_ObjectInfo.Visit(
+        [](uint32_t objnum, CPDF_CrossRefTable::ObjectInfo& info) {
+          info.type = 0;
+          return true;
+        });
   } else {
     m_Trailers.push_back(std::move(pNewTrailer));
   }
@@ -998,6 +1293,9 @@ bool CPDF_Parser::LoadCrossRefV5(FX_FILESIZE* pos, bool bMainXRef) {
 
   const uint8_t* pData = pAcc->GetData();
   uint32_t dwTotalSize = pAcc->GetSize();
+  if (bMainXRef && totalWidth)
+    m_ObjectInfo.Reserve(std::min<uint32_t>(size, dwTotalSize / totalWidth));
+
   uint32_t segindex = 0;
   for (uint32_t i = 0; i < arrIndex.size(); i++) {
     int32_t startnum = arrIndex[i].first;
@@ -1027,26 +1325,27 @@ bool CPDF_Parser::LoadCrossRefV5(FX_FILESIZE* pos, bool bMainXRef) {
       if (WidthArray[0])
         type = GetVarInt(entrystart, WidthArray[0]);
 
-      if (GetObjectType(startnum + j) == 255) {
+      CPDF_CrossRefTable::ObjectInfo& info = m_ObjectInfo[startnum + j];
+      if (info.type == 255) {
         FX_FILESIZE offset =
             GetVarInt(entrystart + WidthArray[0], WidthArray[1]);
-        m_ObjectInfo[startnum + j].pos = offset;
-        m_SortedOffset.insert(offset);
+        info.pos = offset;
+        AddSortedOffset(offset);
         continue;
       }
 
-      if (GetObjectType(startnum + j))
+      if (info.type)
         continue;
 
-      m_ObjectInfo[startnum + j].type = type;
+      info.type = type;
       if (type == 0) {
-        m_ObjectInfo[startnum + j].pos = 0;
+        info.pos = 0;
       } else {
         FX_FILESIZE offset =
             GetVarInt(entrystart + WidthArray[0], WidthArray[1]);
-        m_ObjectInfo[startnum + j].pos = offset;
+        info.pos = offset;
         if (type == 1) {
-          m_SortedOffset.insert(offset);
+          AddSortedOffset(offset);
         } else {
           if (offset < 0 || !IsValidObjectNumber(offset))
             return false;
@@ -1102,7 +1401,7 @@ std::unique_ptr<CPDF_Object> CPDF_Parser::ParseIndirectObject(
 
   pdfium::ScopedSetInsertion<uint32_t> local_insert(&m_ParsingObjNums, objnum);
   if (GetObjectType(objnum) == 1 || GetObjectType(objnum) == 255) {
-    FX_FILESIZE pos = m_ObjectInfo[objnum].pos;
+    FX_FILESIZE pos = GetObjectPositionOrZero(objnum);
     if (pos <= 0)
       return nullptr;
     return ParseIndirectObjectAt(pObjList, pos, objnum);
@@ -1111,7 +1410,7 @@ std::unique_ptr<CPDF_Object> CPDF_Parser::ParseIndirectObject(
     return nullptr;
 
   CFX_RetainPtr<CPDF_StreamAcc> pObjStream =
-      GetObjectStream(m_ObjectInfo[objnum].pos);
+      GetObjectStream(GetObjectPositionOrZero(objnum));
   if (!pObjStream)
     return nullptr;
 
@@ -1172,11 +1471,11 @@ FX_FILESIZE CPDF_Parser::GetObjectSize(uint32_t objnum) const {
   if (offset == 0)
     return 0;
 
-  auto it = m_SortedOffset.find(offset);
-  if (it == m_SortedOffset.end() || ++it == m_SortedOffset.end())
+  FX_FILESIZE nextoff = 0;
+  if (!GetNextSortedOffset(offset, &nextoff))
     return 0;
 
-  return *it - offset;
+  return nextoff - offset;
 }
 
 void CPDF_Parser::GetIndirectBinary(uint32_t objnum,
@@ -1189,7 +1488,7 @@ void CPDF_Parser::GetIndirectBinary(uint32_t objnum,
 
   if (GetObjectType(objnum) == 2) {
     CFX_RetainPtr<CPDF_StreamAcc> pObjStream =
-        GetObjectStream(m_ObjectInfo[objnum].pos);
+        GetObjectStream(GetObjectPositionOrZero(objnum));
     if (!pObjStream)
       return;
 
@@ -1225,7 +1524,7 @@ void CPDF_Parser::GetIndirectBinary(uint32_t objnum,
   if (GetObjectType(objnum) != 1)
     return;
 
-  FX_FILESIZE pos = m_ObjectInfo[objnum].pos;
+  FX_FILESIZE pos = GetObjectPositionOrZero(objnum);
   if (pos == 0)
     return;
 
@@ -1256,13 +1555,12 @@ void CPDF_Parser::GetIndirectBinary(uint32_t objnum,
     return;
   }
 
-  auto it = m_SortedOffset.find(pos);
-  if (it == m_SortedOffset.end() || ++it == m_SortedOffset.end()) {
+  FX_FILESIZE nextoff = 0;
+  if (!GetNextSortedOffset(pos, &nextoff)) {
     m_pSyntax->SetPos(SavedPos);
     return;
   }
 
-  FX_FILESIZE nextoff = *it;
   bool bNextOffValid = false;
   if (nextoff != pos) {
     m_pSyntax->SetPos(nextoff);
@@ -1464,6 +1762,7 @@ CPDF_Parser::Error CPDF_Parser::StartLinearizedParse(
   }
   m_bHasParsed = true;
   m_pDocument = pDocument;
+  m_ObjectInfo.SetFileSize(m_pSyntax->m_FileLen);
 
   FX_FILESIZE dwFirstXRefOffset = m_pSyntax->GetPos();
   bool bXRefRebuilt = false;
@@ -1475,6 +1774,7 @@ CPDF_Parser::Error CPDF_Parser::StartLinearizedParse(
     bXRefRebuilt = true;
     m_LastXRefOffset = 0;
   }
+  SortOffsets();
 
   if (bLoadV4) {
     m_pTrailer = LoadTrailerV4();
@@ -1566,8 +1866,11 @@ CPDF_Parser::Error CPDF_Parser::LoadLinearizedMainXRefTable() {
   m_ObjectStreamMap.clear();
   m_ObjCache.clear();
 
-  if (!LoadLinearizedAllCrossRefV4(m_LastXRefOffset, m_dwXrefStartObjNum) &&
-      !LoadLinearizedAllCrossRefV5(m_LastXRefOffset)) {
+  bool bLoaded =
+      LoadLinearizedAllCrossRefV4(m_LastXRefOffset, m_dwXrefStartObjNum) ||
+      LoadLinearizedAllCrossRefV5(m_LastXRefOffset);
+  SortOffsets();
+  if (!bLoaded) {
     m_LastXRefOffset = 0;
     m_pSyntax->m_MetadataObjnum = dwSaveMetadataObjnum;
     return FORMAT_ERROR;
@@ -12,6 +12,7 @@
 #include <set>
 #include <vector>
 
+#include "core/fpdfapi/parser/cpdf_cross_ref_table.h"
 #include "core/fxcrt/fx_basic.h"
 
 class CPDF_Array;
@@ -24,6 +25,7 @@ class CPDF_Object;
 class CPDF_SecurityHandler;
 class CPDF_StreamAcc;
 class CPDF_SyntaxParser;
+class CPDF_XRefCache;
 class IFX_SeekableReadStream;
 
 class CPDF_Parser {
@@ -45,9 +47,20 @@ class CPDF_Parser {
 
   Error StartParse(const CFX_RetainPtr<IFX_SeekableReadStream>& pFile,
                    CPDF_Document* pDocument);
+  // Like StartParse(), but takes the cross reference table and trailer from
+  // |source|, which has already parsed the same file, instead of parsing
+  // them again. This lets several documents over one file open cheaply.
+  // Falls back to a full parse for linearized sources.
+  Error StartParseFrom(const CPDF_Parser& source,
+                       const CFX_RetainPtr<IFX_SeekableReadStream>& pFile,
+                       CPDF_Document* pDocument);
   Error StartLinearizedParse(const CFX_RetainPtr<IFX_SeekableReadStream>& pFile,
                              CPDF_Document* pDocument);
 
+  // Lets StartParse() take the cross reference table and trailer from
+  // |pCache| instead of parsing them, and store them there once parsed.
+  void SetXRefCache(std::unique_ptr<CPDF_XRefCache> pCache);
+
   void SetPassword(const char* password) { m_Password = password; }
   CFX_ByteString GetPassword() { return m_Password; }
   CPDF_Dictionary* GetTrailer() const { return m_pTrailer.get(); }
@@ -95,19 +108,19 @@ class CPDF_Parser {
   uint32_t GetFirstPageNo() const;
 
  protected:
-  struct ObjectInfo {
-    ObjectInfo() : pos(0), type(0), gennum(0) {}
-
-    FX_FILESIZE pos;
-    uint8_t type;
-    uint16_t gennum;
-  };
-
   std::unique_ptr<CPDF_SyntaxParser> m_pSyntax;
-  std::map<uint32_t, ObjectInfo> m_ObjectInfo;
+  CPDF_CrossRefTable m_ObjectInfo;
 
   bool LoadCrossRefV4(FX_FILESIZE pos, FX_FILESIZE streampos, bool bSkip);
   bool RebuildCrossRef();
+  void AddSortedOffset(FX_FILESIZE offset);
+  // Merges the offsets added since the last call into |m_SortedOffset|. Called
+  // whenever loading cross references finishes, whether or not it succeeded.
+  void SortOffsets();
+  // Looks up |offset| among the known object and xref offsets and returns the
+  // one that follows it in |pNextOffset|. Returns false if |offset| is not
+  // known or is the last one.
+  bool GetNextSortedOffset(FX_FILESIZE offset, FX_FILESIZE* pNextOffset) const;
 
  private:
   friend class CPDF_DataAvail;
@@ -149,6 +162,16 @@ class CPDF_Parser {
   // A simple check whether the cross reference table matches with
   // the objects.
   bool VerifyCrossRefV4();
+  Error StartParseImpl(const CFX_RetainPtr<IFX_SeekableReadStream>& pFile,
+                       CPDF_Document* pDocument,
+                       const CPDF_Parser* pSource);
+  std::unique_ptr<CPDF_Dictionary> ParseTrailer(uint8_t* pData, size_t size);
+  bool LoadFromParser(const CPDF_Parser& source);
+  // Returns the /ID strings, concatenated, of the trailer that "startxref"
+  // points to, without loading any cross reference table.
+  CFX_ByteString ReadTrailerID();
+  bool LoadFromXRefCache(bool* pXRefRebuilt);
+  void StoreToXRefCache(bool bXRefRebuilt);
 
   CPDF_Document* m_pDocument;  // not owned
   bool m_bHasParsed;
@@ -159,11 +182,15 @@ class CPDF_Parser {
   FX_FILESIZE m_LastXRefOffset;
   std::unique_ptr<CPDF_SecurityHandler> m_pSecurityHandler;
   CFX_ByteString m_Password;
-  std::set<FX_FILESIZE> m_SortedOffset;
+  // Sorted and deduplicated. Offsets found while cross references load go to
+  // |m_PendingOffset| first, so each load sorts them only once.
+  std::vector<FX_FILESIZE> m_SortedOffset;
+  std::vector<FX_FILESIZE> m_PendingOffset;
   std::unique_ptr<CPDF_Dictionary> m_pTrailer;
   std::vector<std::unique_ptr<CPDF_Dictionary>> m_Trailers;
   std::unique_ptr<CPDF_LinearizedHeader> m_pLinearized;
   uint32_t m_dwXrefStartObjNum;
+  std::unique_ptr<CPDF_XRefCache> m_pXRefCache;
 
   // A map of object numbers to indirect streams.
   std::map<uint32_t, CFX_RetainPtr<CPDF_StreamAcc>> m_ObjectStreamMap;
@@ -2,11 +2,92 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/fxcrt/fx_stream.h"
 #include "public/fpdf_text.h"
 #include "testing/embedder_test.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "testing/test_support.h"
+#include "testing/utils/path_service.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#define mkdir(path, mode) _mkdir(path)
+#define rmdir _rmdir
+#endif
+
+namespace {
+
+// Returns the names of the files in |dir|.
+std::vector<std::string> ListFiles(const std::string& dir) {
+  std::vector<std::string> files;
+  FX_FileHandle* handle = FX_OpenFolder(dir.c_str());
+  if (!handle)
+    return files;
+
+  CFX_ByteString filename;
+  bool bFolder;
+  while (FX_GetNextFile(handle, &filename, &bFolder)) {
+    if (!bFolder)
+      files.push_back(filename.c_str());
+  }
+  FX_CloseFolder(handle);
+  return files;
+}
+
+std::string ReadFile(const std::string& path) {
+  size_t length = 0;
+  std::unique_ptr<char, pdfium::FreeDeleter> contents =
+      GetFileContents(path.c_str(), &length);
+  return contents ? std::string(contents.get(), length) : std::string();
+}
+
+}  // namespace
 
-class CPDFParserEmbeddertest : public EmbedderTest {};
+class CPDFParserEmbeddertest : public EmbedderTest {
+ protected:
+  // Restarts the library with cross reference tables cached in |dir|.
+  void EnableXRefCache(const std::string& dir) {
+    FPDF_DestroyLibrary();
+    FPDF_LIBRARY_CONFIG config;
+    config.version = 3;
+    config.m_pUserFontPaths = nullptr;
+    config.m_v8EmbedderSlot = 0;
+    config.m_pIsolate = external_isolate_;
+    config.m_pXRefCacheDir = dir.c_str();
+    FPDF_InitLibraryWithConfig(&config);
+  }
+
+  // Opens |file_path| with FPDF_LoadDocument() and returns a summary of
+  // its pages and their text, or an empty string if it fails to load.
+  std::string LoadDocumentSummary(const std::string& file_path) {
+    FPDF_DOCUMENT document = FPDF_LoadDocument(file_path.c_str(), nullptr);
+    if (!document)
+      return std::string();
+
+    std::string summary;
+    int page_count = FPDF_GetPageCount(document);
+    for (int i = 0; i < page_count; ++i) {
+      FPDF_PAGE page = FPDF_LoadPage(document, i);
+      if (!page) {
+        summary += "missing page;";
+        continue;
+      }
+      FPDF_TEXTPAGE text_page = FPDFText_LoadPage(page);
+      summary += std::to_string(FPDFText_CountChars(text_page)) + ";";
+      FPDFText_ClosePage(text_page);
+      FPDF_ClosePage(page);
+    }
+    FPDF_CloseDocument(document);
+    return summary;
+  }
+};
 
 TEST_F(CPDFParserEmbeddertest, LoadError_454695) {
   // Test a dictionary with hex string instead of correct content.
@@ -57,3 +138,60 @@ TEST_F(CPDFParserEmbeddertest, Bug_602650) {
   FPDFText_ClosePage(text_page);
   UnloadPage(page);
 }
+
+TEST_F(CPDFParserEmbeddertest, XRefCache) {
+  std::string cache_dir;
+  ASSERT_TRUE(PathService::GetTempDir(&cache_dir));
+  cache_dir += PATH_SEPARATOR;
+  cache_dir += "pdfium_xref_cache_embeddertest";
+  mkdir(cache_dir.c_str(), 0700);
+  std::string cache_prefix = cache_dir + PATH_SEPARATOR;
+  for (const std::string& name : ListFiles(cache_dir))
+    remove((cache_prefix + name).c_str());
+  EnableXRefCache(cache_dir);
+
+  // A well formed file with an /ID, and one whose table gets rebuilt.
+  for (const char* filename : {"tagged_alt_text.pdf", "bug_602650.pdf"}) {
+    std::string file_path;
+    ASSERT_TRUE(PathService::GetTestFilePath(filename, &file_path));
+
+    // Cold: the document loads and leaves one cache file and nothing else.
+    std::string summary = LoadDocumentSummary(file_path);
+    ASSERT_FALSE(summary.empty()) << filename;
+    std::vector<std::string> files = ListFiles(cache_dir);
+    ASSERT_EQ(1u, files.size()) << filename;
+    std::string cache_path = cache_prefix + files[0];
+    std::string cache_contents = ReadFile(cache_path);
+    ASSERT_FALSE(cache_contents.empty()) << filename;
+    struct stat cold_stat;
+    ASSERT_EQ(0, stat(cache_path.c_str(), &cold_stat)) << filename;
+
+    // Warm: the document loads the same from the cache, which is not
+    // written again.
+    EXPECT_EQ(summary, LoadDocumentSummary(file_path)) << filename;
+    EXPECT_EQ(std::vector<std::string>{files[0]}, ListFiles(cache_dir))
+        << filename;
+    EXPECT_EQ(cache_contents, ReadFile(cache_path)) << filename;
+    struct stat warm_stat;
+    ASSERT_EQ(0, stat(cache_path.c_str(), &warm_stat)) << filename;
+    EXPECT_EQ(cold_stat.st_ino, warm_stat.st_ino) << filename;
+
+    // Corrupted: a cache file with one byte changed, and a truncated one,
+    // are ignored and replaced.
+    for (size_t size : {cache_contents.size(), cache_contents.size() / 2}) {
+      std::string corrupted = cache_contents.substr(0, size);
+      corrupted[size / 2] ^= 1;
+      FILE* file = fopen(cache_path.c_str(), "wb");
+      ASSERT_TRUE(file) << filename;
+      fwrite(corrupted.data(), 1, corrupted.size(), file);
+      fclose(file);
+
+      EXPECT_EQ(summary, LoadDocumentSummary(file_path)) << filename;
+      EXPECT_EQ(std::vector<std::string>{files[0]}, ListFiles(cache_dir))
+          << filename;
+      EXPECT_EQ(cache_contents, ReadFile(cache_path)) << filename;
+    }
+    remove(cache_path.c_str());
+  }
+  rmdir(cache_dir.c_str());
+}
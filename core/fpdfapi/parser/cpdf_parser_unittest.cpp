@@ -4,9 +4,11 @@
 
 #include <limits>
 #include <string>
+#include <vector>
 
 #include "core/fpdfapi/parser/cpdf_parser.h"
 #include "core/fpdfapi/parser/cpdf_syntax_parser.h"
+#include "core/fpdfapi/parser/fpdf_parser_utility.h"
 #include "core/fxcrt/cfx_retain_ptr.h"
 #include "core/fxcrt/fx_extension.h"
 #include "core/fxcrt/fx_stream.h"
@@ -70,8 +72,13 @@ class CPDF_TestParser : public CPDF_Parser {
   // Need to access RebuildCrossRef.
   FRIEND_TEST(cpdf_parser, RebuildCrossRefCorrectly);
   FRIEND_TEST(cpdf_parser, RebuildCrossRefFailed);
+  FRIEND_TEST(cpdf_parser, RebuildCrossRefSkipsCommentsAndStrings);
+  FRIEND_TEST(cpdf_parser, RebuildCrossRefSkipsBinaryData);
   // Need to access LoadCrossRefV4.
   FRIEND_TEST(cpdf_parser, LoadCrossRefV4);
+  // Need to access AddSortedOffset, SortOffsets and GetNextSortedOffset.
+  FRIEND_TEST(cpdf_parser, SortedOffsets);
+  FRIEND_TEST(cpdf_parser, GetObjectSizeAfterRebuild);
 };
 
 TEST(cpdf_parser, RebuildCrossRefCorrectly) {
@@ -100,6 +107,70 @@ TEST(cpdf_parser, RebuildCrossRefFailed) {
   ASSERT_FALSE(parser.RebuildCrossRef());
 }
 
+TEST(cpdf_parser, RebuildCrossRefSkipsCommentsAndStrings) {
+  const unsigned char data[] =
+      "%PDF-1.7\n"
+      "% 9 0 obj in a comment\n"
+      "1 0 obj\n<</Type /Catalog /Pages 2 0 R>>\nendobj\n"
+      "(7 0 obj (nested) 8 0 obj)\n"
+      "<8 0 obj>\n"
+      "2 0 obj\n<</Type /Pages /Count 0 /Kids []>>\nendobj\n"
+      "trailer\n<</Root 1 0 R>>\n";
+  CPDF_TestParser parser;
+  ASSERT_TRUE(parser.InitTestFromBuffer(data, sizeof(data) - 1));
+
+  ASSERT_TRUE(parser.RebuildCrossRef());
+  EXPECT_EQ(2u, parser.GetLastObjNum());
+  EXPECT_EQ(32, parser.GetObjectPositionOrZero(1));
+  EXPECT_EQ(116, parser.GetObjectPositionOrZero(2));
+  EXPECT_EQ(1u, parser.GetRootObjNum());
+}
+
+TEST(cpdf_parser, RebuildCrossRefSkipsBinaryData) {
+  // Bytes that RebuildCrossRef() passes over in its default state and that do
+  // not end a comment, a string or a hex string either.
+  std::string junk_bytes;
+  for (int c = 1; c < 255; ++c) {
+    if (c != 128 && !PDFCharIsWhitespace(c) && !std::isdigit(c) &&
+        !strchr("%()<>\\t", c)) {
+      junk_bytes += static_cast<char>(c);
+    }
+  }
+
+  // Runs of junk of every length up to twice the 16 byte scan width, and
+  // some that cross the 4096 byte read blocks, must not hide the objects or
+  // the comment and string starts that follow them.
+  std::vector<size_t> lengths;
+  for (size_t length = 0; length <= 33; ++length)
+    lengths.push_back(length);
+  lengths.push_back(4090);
+  lengths.push_back(5000);
+  for (size_t length : lengths) {
+    std::string junk;
+    for (size_t i = 0; i < length; ++i)
+      junk += junk_bytes[(i * 7 + length) % junk_bytes.size()];
+
+    std::string data = "%PDF-1.7\n" + junk + "\n";
+    FX_FILESIZE pos1 = data.size();
+    data += "1 0 obj\n<</Type /Catalog /Pages 2 0 R>>\nendobj\n" + junk;
+    data += "%" + junk + " 7 0 obj\n" + junk;
+    data += "(" + junk + " 8 0 obj)" + junk;
+    data += "<" + junk + ">\n";
+    FX_FILESIZE pos2 = data.size();
+    data += "2 0 obj\n<</Type /Pages /Count 0 /Kids []>>\nendobj\n" + junk;
+    data += "\ntrailer\n<</Root 1 0 R>>\n";
+
+    CPDF_TestParser parser;
+    ASSERT_TRUE(parser.InitTestFromBuffer(
+        reinterpret_cast<const unsigned char*>(data.c_str()), data.size()));
+    ASSERT_TRUE(parser.RebuildCrossRef()) << length;
+    EXPECT_EQ(2u, parser.GetLastObjNum()) << length;
+    EXPECT_EQ(pos1, parser.GetObjectPositionOrZero(1)) << length;
+    EXPECT_EQ(pos2, parser.GetObjectPositionOrZero(2)) << length;
+    EXPECT_EQ(1u, parser.GetRootObjNum()) << length;
+  }
+}
+
 TEST(cpdf_parser, LoadCrossRefV4) {
   {
     const unsigned char xref_table[] =
@@ -201,3 +272,48 @@ TEST(cpdf_parser, LoadCrossRefV4) {
     }
   }
 }
+
+TEST(cpdf_parser, SortedOffsets) {
+  CPDF_TestParser parser;
+  FX_FILESIZE next = 0;
+  parser.AddSortedOffset(300);
+  parser.AddSortedOffset(100);
+  parser.AddSortedOffset(300);
+  // Nothing is looked up before the offsets are sorted.
+  EXPECT_FALSE(parser.GetNextSortedOffset(100, &next));
+
+  parser.SortOffsets();
+  ASSERT_TRUE(parser.GetNextSortedOffset(100, &next));
+  EXPECT_EQ(300, next);
+  EXPECT_FALSE(parser.GetNextSortedOffset(300, &next));
+  EXPECT_FALSE(parser.GetNextSortedOffset(200, &next));
+
+  // Later loads merge into the offsets already sorted.
+  parser.AddSortedOffset(200);
+  parser.AddSortedOffset(400);
+  parser.AddSortedOffset(100);
+  parser.SortOffsets();
+  const FX_FILESIZE expected[] = {100, 200, 300, 400};
+  for (size_t i = 0; i + 1 < FX_ArraySize(expected); ++i) {
+    ASSERT_TRUE(parser.GetNextSortedOffset(expected[i], &next));
+    EXPECT_EQ(expected[i + 1], next);
+  }
+  EXPECT_FALSE(parser.GetNextSortedOffset(400, &next));
+}
+
+TEST(cpdf_parser, GetObjectSizeAfterRebuild) {
+  const unsigned char data[] =
+      "%PDF-1.7\n"
+      "1 0 obj\n<</Type /Catalog /Pages 2 0 R>>\nendobj\n"
+      "2 0 obj\n<</Type /Pages /Count 0 /Kids []>>\nendobj\n"
+      "trailer\n<</Root 1 0 R>>\n";
+  CPDF_TestParser parser;
+  ASSERT_TRUE(parser.InitTestFromBuffer(data, sizeof(data) - 1));
+
+  ASSERT_TRUE(parser.RebuildCrossRef());
+  EXPECT_EQ(9, parser.GetObjectPositionOrZero(1));
+  EXPECT_EQ(56, parser.GetObjectPositionOrZero(2));
+  EXPECT_EQ(47, parser.GetObjectSize(1));
+  // Without an xref table, the last object runs to the end of the file.
+  EXPECT_EQ(74, parser.GetObjectSize(2));
+}
@@ -34,7 +34,7 @@ enum class ReadStatus { Normal, Backslash, Octal, FinishOctal, CarriageReturn };
 }  // namespace
 
 // static
-int CPDF_SyntaxParser::s_CurrentRecursionDepth = 0;
+thread_local int CPDF_SyntaxParser::s_CurrentRecursionDepth = 0;
 
 CPDF_SyntaxParser::CPDF_SyntaxParser()
     : CPDF_SyntaxParser(CFX_WeakPtr<CFX_ByteStringPool>()) {}
@@ -43,6 +43,7 @@ CPDF_SyntaxParser::CPDF_SyntaxParser(
     const CFX_WeakPtr<CFX_ByteStringPool>& pPool)
     : m_MetadataObjnum(0),
       m_pFileAccess(nullptr),
+      m_pDirectBuf(nullptr),
       m_pFileBuf(nullptr),
       m_BufSize(CPDF_ModuleMgr::kFileBufSize),
       m_pPool(pPool) {}
@@ -78,6 +79,14 @@ bool CPDF_SyntaxParser::GetNextChar(uint8_t& ch) {
   if (pos >= m_FileLen)
     return false;
 
+  if (m_pDirectBuf) {
+    if (pos < 0)
+      return false;
+    ch = m_pDirectBuf[pos];
+    m_Pos++;
+    return true;
+  }
+
   if (CheckPosition(pos)) {
     FX_FILESIZE read_pos = pos;
     uint32_t read_size = m_BufSize;
@@ -90,11 +99,47 @@ bool CPDF_SyntaxParser::GetNextChar(uint8_t& ch) {
   return true;
 }
 
+bool CPDF_SyntaxParser::SkipToChar(uint8_t ch, FX_FILESIZE end) {
+  end = std::min(end, m_FileLen - m_HeaderOffset);
+  while (m_Pos < end) {
+    FX_FILESIZE pos = m_Pos + m_HeaderOffset;
+    const uint8_t* pData;
+    FX_FILESIZE available = end - m_Pos;
+    if (m_pDirectBuf) {
+      if (pos < 0)
+        return false;
+      pData = m_pDirectBuf + pos;
+    } else {
+      uint32_t read_size =
+          std::min(m_BufSize, static_cast<uint32_t>(m_FileLen));
+      if (CheckPosition(pos) && !ReadChar(pos, read_size))
+        return false;
+      pData = m_pFileBuf + (pos - m_BufOffset);
+      available = std::min(available, m_BufOffset + m_BufSize - pos);
+    }
+    const uint8_t* pFound =
+        static_cast<const uint8_t*>(memchr(pData, ch, available));
+    if (pFound) {
+      m_Pos += pFound - pData;
+      return true;
+    }
+    m_Pos += available;
+  }
+  return false;
+}
+
 bool CPDF_SyntaxParser::GetCharAtBackward(FX_FILESIZE pos, uint8_t* ch) {
   pos += m_HeaderOffset;
   if (pos >= m_FileLen)
     return false;
 
+  if (m_pDirectBuf) {
+    if (pos < 0)
+      return false;
+    *ch = m_pDirectBuf[pos];
+    return true;
+  }
+
   if (CheckPosition(pos)) {
     FX_FILESIZE read_pos;
     if (pos < static_cast<FX_FILESIZE>(m_BufSize))
@@ -765,13 +810,18 @@ void CPDF_SyntaxParser::InitParser(
     const CFX_RetainPtr<IFX_SeekableReadStream>& pFileAccess,
     uint32_t HeaderOffset) {
   FX_Free(m_pFileBuf);
+  m_pFileBuf = nullptr;
 
-  m_pFileBuf = FX_Alloc(uint8_t, m_BufSize);
   m_HeaderOffset = HeaderOffset;
   m_FileLen = pFileAccess->GetSize();
   m_Pos = 0;
   m_pFileAccess = pFileAccess;
   m_BufOffset = 0;
+  m_pDirectBuf = pFileAccess->GetDirectBuffer();
+  if (m_pDirectBuf)
+    return;
+
+  m_pFileBuf = FX_Alloc(uint8_t, m_BufSize);
   pFileAccess->ReadBlock(m_pFileBuf, 0,
                          std::min(m_BufSize, static_cast<uint32_t>(m_FileLen)));
 }
@@ -856,6 +906,13 @@ FX_FILESIZE CPDF_SyntaxParser::FindTag(const CFX_ByteStringC& tag,
   FX_FILESIZE startpos = m_Pos;
 
   while (1) {
+    // Nothing can match before the next first byte of |tag|, so find that
+    // with memchr() instead of going through the bytes one at a time.
+    if (match == 0 &&
+        !SkipToChar(tag[0], limit > startpos ? limit : m_FileLen)) {
+      return -1;
+    }
+
     uint8_t ch;
     if (!GetNextChar(ch))
       return -1;
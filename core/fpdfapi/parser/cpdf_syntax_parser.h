@@ -59,11 +59,15 @@ class CPDF_SyntaxParser {
   friend class cpdf_syntax_parser_ReadHexString_Test;
 
   static const int kParserMaxRecursionDepth = 64;
-  static int s_CurrentRecursionDepth;
+  // Per thread, since documents may be parsed on several at once.
+  static thread_local int s_CurrentRecursionDepth;
 
   uint32_t GetDirectNum();
   bool ReadChar(FX_FILESIZE read_pos, uint32_t read_size);
   bool GetNextChar(uint8_t& ch);
+  // Moves to the next |ch| before |end|, or to |end|. Returns whether |ch|
+  // was found.
+  bool SkipToChar(uint8_t ch, FX_FILESIZE end);
   bool GetCharAtBackward(FX_FILESIZE pos, uint8_t* ch);
   void GetNextWordInternal(bool* bIsNumber);
   bool IsWholeWord(FX_FILESIZE startpos,
@@ -89,6 +93,9 @@ class CPDF_SyntaxParser {
   CFX_RetainPtr<IFX_SeekableReadStream> m_pFileAccess;
   FX_FILESIZE m_HeaderOffset;
   FX_FILESIZE m_FileLen;
+  // Set when |m_pFileAccess| keeps the whole file in memory. Bytes are then
+  // read from it directly and |m_pFileBuf| is not used.
+  const uint8_t* m_pDirectBuf;
   uint8_t* m_pFileBuf;
   uint32_t m_BufSize;
   FX_FILESIZE m_BufOffset;
@@ -14,6 +14,54 @@
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/utils/path_service.h"
 
+namespace {
+
+// Wraps a stream but hides its direct buffer, so the parser goes through
+// ReadBlock() and its own read window.
+class CFX_IndirectReadStream : public IFX_SeekableReadStream {
+ public:
+  template <typename T, typename... Args>
+  friend CFX_RetainPtr<T> pdfium::MakeRetain(Args&&... args);
+
+  // IFX_SeekableReadStream:
+  bool ReadBlock(void* buffer, FX_FILESIZE offset, size_t size) override {
+    return m_pStream->ReadBlock(buffer, offset, size);
+  }
+  FX_FILESIZE GetSize() override { return m_pStream->GetSize(); }
+
+ private:
+  explicit CFX_IndirectReadStream(
+      const CFX_RetainPtr<IFX_SeekableReadStream>& pStream)
+      : m_pStream(pStream) {}
+
+  CFX_RetainPtr<IFX_SeekableReadStream> m_pStream;
+};
+
+// Finds |tag| the way CPDF_SyntaxParser::FindTag() does, one byte at a
+// time, and leaves |*pos| where it stops.
+FX_FILESIZE ReferenceFindTag(const std::string& data,
+                             const std::string& tag,
+                             FX_FILESIZE limit,
+                             FX_FILESIZE* pos) {
+  size_t match = 0;
+  FX_FILESIZE startpos = *pos;
+  limit += *pos;
+  while (*pos < static_cast<FX_FILESIZE>(data.size())) {
+    char ch = data[(*pos)++];
+    if (ch == tag[match]) {
+      if (++match == tag.size())
+        return *pos - startpos - tag.size();
+    } else {
+      match = ch == tag[0] ? 1 : 0;
+    }
+    if (limit && *pos == limit)
+      return -1;
+  }
+  return -1;
+}
+
+}  // namespace
+
 TEST(cpdf_syntax_parser, ReadHexString) {
   {
     // Empty string.
@@ -155,3 +203,67 @@ TEST(cpdf_syntax_parser, GetInvalidReference) {
       parser.GetObject(nullptr, CPDF_Object::kInvalidObjNum, 0, false);
   EXPECT_FALSE(ref);
 }
+
+TEST(cpdf_syntax_parser, DirectBufferMatchesBufferedReads) {
+  uint8_t data[] =
+      "%PDF-1.7\n1 0 obj\n<</Type /Catalog>>\nendobj\n"
+      "xref\n0 2\ntrailer\n<</Root 1 0 R>>\nstartxref\n42\n%%EOF\n";
+  const size_t size = sizeof(data) - 1;
+  auto pMemory = pdfium::MakeRetain<CFX_MemoryStream>(data, size, false);
+  ASSERT_TRUE(pMemory->GetDirectBuffer());
+
+  CPDF_SyntaxParser direct;
+  direct.InitParser(pMemory, 0);
+  CPDF_SyntaxParser buffered;
+  buffered.InitParser(pdfium::MakeRetain<CFX_IndirectReadStream>(pMemory), 0);
+
+  for (CPDF_SyntaxParser* parser : {&direct, &buffered}) {
+    parser->SetPos(size - 1);
+    ASSERT_TRUE(parser->BackwardsSearchToWord("startxref", 4096));
+    EXPECT_EQ(76, parser->GetPos());
+    EXPECT_EQ("startxref", parser->GetKeyword());
+
+    parser->SetPos(0);
+    EXPECT_EQ(13, parser->FindTag("obj", 0));
+    EXPECT_EQ("<<", parser->GetKeyword());
+
+    uint8_t ch;
+    EXPECT_TRUE(parser->GetCharAt(0, ch));
+    EXPECT_EQ('%', ch);
+    EXPECT_FALSE(parser->GetCharAt(size, ch));
+  }
+}
+
+TEST(cpdf_syntax_parser, FindTag) {
+  // Spread over several read windows, with partial matches and the overlap
+  // that byte at a time matching misses.
+  std::string data;
+  for (int i = 0; i < 40; ++i) {
+    data += std::string(i * 37 % 101, 'x') + "endstre" + std::string(i, 'e');
+    data += i % 3 ? "endstrendstream " : "endobj\n";
+  }
+  auto pMemory = pdfium::MakeRetain<CFX_MemoryStream>(
+      reinterpret_cast<uint8_t*>(&data[0]), data.size(), false);
+  CPDF_SyntaxParser direct;
+  direct.InitParser(pMemory, 0);
+  CPDF_SyntaxParser buffered;
+  buffered.InitParser(pdfium::MakeRetain<CFX_IndirectReadStream>(pMemory), 0);
+
+  for (const char* tag : {"endstream", "endobj", "x"}) {
+    for (FX_FILESIZE start = 0; start < static_cast<FX_FILESIZE>(data.size());
+         start += 97) {
+      for (FX_FILESIZE limit : {0, 1, 9, 500, 1000000}) {
+        FX_FILESIZE expected_pos = start;
+        FX_FILESIZE expected =
+            ReferenceFindTag(data, tag, limit, &expected_pos);
+        for (CPDF_SyntaxParser* parser : {&direct, &buffered}) {
+          parser->SetPos(start);
+          EXPECT_EQ(expected, parser->FindTag(tag, limit))
+              << tag << " " << start << " " << limit;
+          EXPECT_EQ(expected_pos, parser->GetPos())
+              << tag << " " << start << " " << limit;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,351 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#include "core/fpdfapi/parser/cpdf_xref_cache.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+
+#include "core/fdrm/crypto/fx_crypt.h"
+#include "core/fxcrt/fx_basic.h"
+#include "core/fxcrt/fx_stream.h"
+#include "third_party/base/stl_util.h"
+
+namespace {
+
+const char kCacheMagic[] = "PDFXREF2";
+const size_t kCacheMagicSize = sizeof(kCacheMagic) - 1;
+
+// How much of the document is hashed at a time.
+const size_t kHashBlockSize = 64 * 1024;
+
+// The MD5 digest at the end of a cache file.
+const size_t kChecksumSize = 16;
+
+// Cache files larger than this are not read back.
+const size_t kMaxCacheFileSize = 256 * 1024 * 1024;
+
+// objnum, pos, type, gennum.
+const size_t kEntrySize = 4 + 8 + 1 + 2;
+
+enum CacheFlags : uint8_t {
+  kXRefStream = 1 << 0,
+  kXRefRebuilt = 1 << 1,
+  kVersionUpdated = 1 << 2,
+};
+
+void AppendUint16(CFX_BinaryBuf* buf, uint16_t value) {
+  buf->AppendByte(value & 0xff);
+  buf->AppendByte(value >> 8);
+}
+
+void AppendUint32(CFX_BinaryBuf* buf, uint32_t value) {
+  for (int i = 0; i < 4; ++i)
+    buf->AppendByte((value >> (8 * i)) & 0xff);
+}
+
+void AppendUint64(CFX_BinaryBuf* buf, uint64_t value) {
+  for (int i = 0; i < 8; ++i)
+    buf->AppendByte((value >> (8 * i)) & 0xff);
+}
+
+// Bounds-checked little-endian reads from a cache file.
+class CacheReader {
+ public:
+  CacheReader(const uint8_t* data, size_t size)
+      : m_pData(data), m_Size(size), m_Pos(0) {}
+
+  size_t remaining() const { return m_Size - m_Pos; }
+
+  bool ReadBytes(void* buffer, size_t size) {
+    if (size > remaining())
+      return false;
+    memcpy(buffer, m_pData + m_Pos, size);
+    m_Pos += size;
+    return true;
+  }
+
+  bool ReadUint8(uint8_t* value) { return ReadBytes(value, 1); }
+
+  bool ReadUint16(uint16_t* value) {
+    uint64_t result;
+    if (!ReadLE(2, &result))
+      return false;
+    *value = static_cast<uint16_t>(result);
+    return true;
+  }
+
+  bool ReadUint32(uint32_t* value) {
+    uint64_t result;
+    if (!ReadLE(4, &result))
+      return false;
+    *value = static_cast<uint32_t>(result);
+    return true;
+  }
+
+  bool ReadUint64(uint64_t* value) { return ReadLE(8, value); }
+
+  bool ReadFileSize(FX_FILESIZE* value) {
+    uint64_t result;
+    if (!ReadLE(8, &result))
+      return false;
+    *value = static_cast<FX_FILESIZE>(result);
+    return true;
+  }
+
+ private:
+  bool ReadLE(size_t size, uint64_t* value) {
+    if (size > remaining())
+      return false;
+    uint64_t result = 0;
+    for (size_t i = 0; i < size; ++i)
+      result |= static_cast<uint64_t>(m_pData[m_Pos + i]) << (8 * i);
+    m_Pos += size;
+    *value = result;
+    return true;
+  }
+
+  const uint8_t* const m_pData;
+  const size_t m_Size;
+  size_t m_Pos;
+};
+
+}  // namespace
+
+CPDF_XRefCache::Contents::Contents()
+    : last_xref_offset(0),
+      xref_stream(false),
+      xref_rebuilt(false),
+      version_updated(false) {}
+
+CPDF_XRefCache::Contents::~Contents() {}
+
+CPDF_XRefCache::CPDF_XRefCache(const CFX_ByteString& dir)
+    : m_Dir(dir), m_FileSize(0) {
+  memset(m_Digest, 0, sizeof(m_Digest));
+  if (m_Dir.IsEmpty())
+    return;
+
+  char last = m_Dir[m_Dir.GetLength() - 1];
+  if (last != '/' && last != '\\')
+    m_Dir += '/';
+}
+
+CPDF_XRefCache::~CPDF_XRefCache() {}
+
+bool CPDF_XRefCache::ComputeKey(
+    const CFX_RetainPtr<IFX_SeekableReadStream>& pFile) {
+  CRYPT_md5_context context;
+  CRYPT_MD5Start(&context);
+  CFX_BinaryBuf header;
+  AppendUint64(&header, m_FileSize);
+  AppendUint32(&header, m_ID.GetLength());
+  header.AppendBlock(m_ID.raw_str(), m_ID.GetLength());
+  CRYPT_MD5Update(&context, header.GetBuffer(), header.GetSize());
+
+  std::vector<uint8_t> block(kHashBlockSize);
+  for (FX_FILESIZE pos = 0; pos < m_FileSize; pos += kHashBlockSize) {
+    size_t size = static_cast<size_t>(
+        std::min(m_FileSize - pos, static_cast<FX_FILESIZE>(kHashBlockSize)));
+    if (!pFile->ReadBlock(block.data(), pos, size))
+      return false;
+    CRYPT_MD5Update(&context, block.data(), size);
+  }
+  CRYPT_MD5Finish(&context, m_Digest);
+  return true;
+}
+
+bool CPDF_XRefCache::Load(const CFX_RetainPtr<IFX_SeekableReadStream>& pFile,
+                          const CFX_ByteString& id,
+                          CPDF_CrossRefTable* pObjects,
+                          Contents* pContents) {
+  m_FileSize = pFile->GetSize();
+  m_ID = id;
+  if (m_Dir.IsEmpty() || m_FileSize <= 0 || !ComputeKey(pFile))
+    return false;
+
+  static const char kHexChars[] = "0123456789abcdef";
+  m_Path = m_Dir;
+  for (uint8_t byte : m_Digest) {
+    m_Path += kHexChars[byte >> 4];
+    m_Path += kHexChars[byte & 0xf];
+  }
+  m_Path += ".xref";
+
+  CFX_RetainPtr<IFX_SeekableReadStream> pCacheFile =
+      IFX_SeekableReadStream::CreateFromFilename(m_Path.c_str());
+  if (!pCacheFile)
+    return false;
+
+  FX_FILESIZE cache_size = pCacheFile->GetSize();
+  if (cache_size <= static_cast<FX_FILESIZE>(kChecksumSize) ||
+      cache_size > static_cast<FX_FILESIZE>(kMaxCacheFileSize)) {
+    return false;
+  }
+  std::vector<uint8_t> data(static_cast<size_t>(cache_size));
+  if (!pCacheFile->ReadBlock(data.data(), 0, data.size()))
+    return false;
+
+  size_t data_size = data.size() - kChecksumSize;
+  uint8_t checksum[kChecksumSize];
+  CRYPT_MD5Generate(data.data(), data_size, checksum);
+  if (memcmp(checksum, data.data() + data_size, kChecksumSize) != 0)
+    return false;
+
+  CacheReader reader(data.data(), data_size);
+  char magic[kCacheMagicSize];
+  uint8_t digest[sizeof(m_Digest)];
+  uint64_t file_size;
+  uint32_t id_size;
+  uint8_t flags;
+  if (!reader.ReadBytes(magic, kCacheMagicSize) ||
+      memcmp(magic, kCacheMagic, kCacheMagicSize) != 0 ||
+      !reader.ReadBytes(digest, sizeof(digest)) ||
+      memcmp(digest, m_Digest, sizeof(digest)) != 0 ||
+      !reader.ReadUint64(&file_size) ||
+      file_size != static_cast<uint64_t>(m_FileSize) ||
+      !reader.ReadUint32(&id_size) ||
+      id_size != static_cast<uint32_t>(m_ID.GetLength()) ||
+      id_size > reader.remaining()) {
+    return false;
+  }
+  std::vector<uint8_t> cached_id(id_size);
+  if (!reader.ReadBytes(cached_id.data(), id_size) ||
+      CFX_ByteString(cached_id.data(), id_size) != m_ID ||
+      !reader.ReadUint8(&flags) ||
+      !reader.ReadFileSize(&pContents->last_xref_offset)) {
+    return false;
+  }
+  pContents->xref_stream = !!(flags & kXRefStream);
+  pContents->xref_rebuilt = !!(flags & kXRefRebuilt);
+  pContents->version_updated = !!(flags & kVersionUpdated);
+
+  uint32_t last_objnum;
+  uint32_t entry_count;
+  if (!reader.ReadUint32(&last_objnum) || !reader.ReadUint32(&entry_count) ||
+      entry_count > reader.remaining() / kEntrySize) {
+    return false;
+  }
+  pObjects->clear();
+  bool bFirst = true;
+  uint32_t prev_objnum = 0;
+  for (uint32_t i = 0; i < entry_count; ++i) {
+    uint32_t objnum;
+    FX_FILESIZE pos;
+    uint8_t type;
+    uint16_t gennum;
+    if (!reader.ReadUint32(&objnum) || !reader.ReadFileSize(&pos) ||
+        !reader.ReadUint8(&type) || !reader.ReadUint16(&gennum)) {
+      return false;
+    }
+    if ((!bFirst && objnum <= prev_objnum) || objnum > last_objnum)
+      return false;
+    if (type != 0 && type != 1 && type != 2 && type != 255)
+      return false;
+
+    CPDF_CrossRefTable::ObjectInfo& info = (*pObjects)[objnum];
+    info.pos = pos;
+    info.type = type;
+    info.gennum = gennum;
+    prev_objnum = objnum;
+    bFirst = false;
+  }
+  (*pObjects)[last_objnum];
+
+  uint32_t offset_count;
+  if (!reader.ReadUint32(&offset_count) ||
+      offset_count > reader.remaining() / 8) {
+    return false;
+  }
+  pContents->sorted_offsets.resize(offset_count);
+  for (FX_FILESIZE& offset : pContents->sorted_offsets) {
+    if (!reader.ReadFileSize(&offset))
+      return false;
+  }
+
+  uint32_t trailer_size;
+  if (!reader.ReadUint32(&trailer_size) || trailer_size != reader.remaining())
+    return false;
+  pContents->trailer.resize(trailer_size);
+  return reader.ReadBytes(pContents->trailer.data(), trailer_size);
+}
+
+void CPDF_XRefCache::Store(const CPDF_CrossRefTable& objects,
+                           const Contents& contents) {
+  if (m_Path.IsEmpty() || objects.empty())
+    return;
+
+  CFX_BinaryBuf buf;
+  buf.AppendBlock(kCacheMagic, kCacheMagicSize);
+  buf.AppendBlock(m_Digest, sizeof(m_Digest));
+  AppendUint64(&buf, m_FileSize);
+  AppendUint32(&buf, m_ID.GetLength());
+  buf.AppendBlock(m_ID.raw_str(), m_ID.GetLength());
+  uint8_t flags = 0;
+  if (contents.xref_stream)
+    flags |= kXRefStream;
+  if (contents.xref_rebuilt)
+    flags |= kXRefRebuilt;
+  if (contents.version_updated)
+    flags |= kVersionUpdated;
+  buf.AppendByte(flags);
+  AppendUint64(&buf, contents.last_xref_offset);
+
+  // Only entries that were actually written are stored. Unwritten entries
+  // read back as default ObjectInfo values either way.
+  CFX_BinaryBuf entries;
+  uint32_t entry_count = 0;
+  objects.Visit([&entries, &entry_count](
+                    uint32_t objnum,
+                    const CPDF_CrossRefTable::ObjectInfo& info) {
+    if (info.pos == 0 && info.type == 0 && info.gennum == 0)
+      return true;
+    AppendUint32(&entries, objnum);
+    AppendUint64(&entries, info.pos);
+    entries.AppendByte(info.type);
+    AppendUint16(&entries, info.gennum);
+    ++entry_count;
+    return true;
+  });
+  AppendUint32(&buf, objects.GetLastObjNum());
+  AppendUint32(&buf, entry_count);
+  buf.AppendBlock(entries.GetBuffer(), entries.GetSize());
+
+  AppendUint32(&buf, pdfium::CollectionSize<uint32_t>(contents.sorted_offsets));
+  for (FX_FILESIZE offset : contents.sorted_offsets)
+    AppendUint64(&buf, offset);
+
+  AppendUint32(&buf, pdfium::CollectionSize<uint32_t>(contents.trailer));
+  buf.AppendBlock(contents.trailer.data(), contents.trailer.size());
+
+  uint8_t checksum[kChecksumSize];
+  CRYPT_MD5Generate(buf.GetBuffer(), buf.GetSize(), checksum);
+  buf.AppendBlock(checksum, kChecksumSize);
+  if (static_cast<size_t>(buf.GetSize()) > kMaxCacheFileSize)
+    return;
+
+  // Write to a file of its own first and then rename it into place, so
+  // concurrent readers never see a partially written cache file and
+  // concurrent writers never write to the same file.
+  CFX_ByteString temp_path;
+  if (!FX_CreateUniqueFile(m_Dir, &temp_path))
+    return;
+
+  CFX_RetainPtr<IFX_SeekableStream> pCacheFile =
+      IFX_SeekableStream::CreateFromFilename(temp_path.c_str(),
+                                             FX_FILEMODE_Truncate);
+  if (!pCacheFile) {
+    remove(temp_path.c_str());
+    return;
+  }
+
+  bool bWritten = pCacheFile->WriteBlock(buf.GetBuffer(), 0, buf.GetSize()) &&
+                  pCacheFile->Flush();
+  pCacheFile.Reset();
+  if (!bWritten || !FX_ReplaceFile(temp_path.c_str(), m_Path.c_str()))
+    remove(temp_path.c_str());
+}
@@ -0,0 +1,74 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#ifndef CORE_FPDFAPI_PARSER_CPDF_XREF_CACHE_H_
+#define CORE_FPDFAPI_PARSER_CPDF_XREF_CACHE_H_
+
+#include <vector>
+
+#include "core/fpdfapi/parser/cpdf_cross_ref_table.h"
+#include "core/fxcrt/cfx_retain_ptr.h"
+#include "core/fxcrt/fx_string.h"
+#include "core/fxcrt/fx_system.h"
+
+class IFX_SeekableReadStream;
+
+// Sidecar files holding the resolved cross reference table and trailer of a
+// document, so reopening an unchanged file skips CPDF_Parser's xref loading
+// and any RebuildCrossRef() pass.
+//
+// A cache file is keyed by the document's trailer /ID, its size and a digest
+// of its whole content, so computing the key reads the document once. Cache
+// files also carry a digest of their own content. Anything that fails to
+// match or to validate is ignored.
+class CPDF_XRefCache {
+ public:
+  struct Contents {
+    Contents();
+    ~Contents();
+
+    FX_FILESIZE last_xref_offset;
+    bool xref_stream;
+    bool xref_rebuilt;
+    bool version_updated;
+    std::vector<FX_FILESIZE> sorted_offsets;
+    // The trailer dictionary, in PDF syntax.
+    std::vector<uint8_t> trailer;
+  };
+
+  // |dir| is an existing directory that cache files are written to.
+  explicit CPDF_XRefCache(const CFX_ByteString& dir);
+  ~CPDF_XRefCache();
+
+  // Looks up the cache file for |pFile|, whose trailer has the /ID strings
+  // |id| concatenated, or an empty string if it has none. On success, fills
+  // |pObjects| and |pContents| and returns true. Must be called before
+  // Store().
+  bool Load(const CFX_RetainPtr<IFX_SeekableReadStream>& pFile,
+            const CFX_ByteString& id,
+            CPDF_CrossRefTable* pObjects,
+            Contents* pContents);
+
+  // Writes the cache file for the document passed to Load().
+  void Store(const CPDF_CrossRefTable& objects, const Contents& contents);
+
+  // The cache file for the document passed to Load().
+  const CFX_ByteString& GetPath() const { return m_Path; }
+
+ private:
+  // Computes |m_Digest| from |m_FileSize|, |m_ID| and the content of
+  // |pFile|.
+  bool ComputeKey(const CFX_RetainPtr<IFX_SeekableReadStream>& pFile);
+
+  // |m_Dir| ends with a separator.
+  CFX_ByteString m_Dir;
+  FX_FILESIZE m_FileSize;
+  CFX_ByteString m_ID;
+  uint8_t m_Digest[16];
+  CFX_ByteString m_Path;
+};
+
+#endif  // CORE_FPDFAPI_PARSER_CPDF_XREF_CACHE_H_
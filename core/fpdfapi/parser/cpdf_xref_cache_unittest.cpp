@@ -0,0 +1,159 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/parser/cpdf_xref_cache.h"
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "core/fxcrt/cfx_memorystream.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/utils/path_service.h"
+
+namespace {
+
+const char kDocument[] =
+    "%PDF-1.7\n"
+    "1 0 obj <</Type /Catalog>> endobj\n"
+    "trailer <</Root 1 0 R /ID [<0123> <4567>]>>\n";
+
+const char kID[] = "\x01\x23\x45\x67";
+
+class cpdf_xref_cache_test : public testing::Test {
+ public:
+  void SetUp() override {
+    ASSERT_TRUE(PathService::GetTempDir(&m_Dir));
+    m_Document.assign(kDocument, kDocument + sizeof(kDocument) - 1);
+  }
+
+  CFX_RetainPtr<IFX_SeekableReadStream> CreateDocumentStream() {
+    return pdfium::MakeRetain<CFX_MemoryStream>(m_Document.data(),
+                                                m_Document.size(), false);
+  }
+
+  CFX_ByteString dir() const { return CFX_ByteString(m_Dir.c_str()); }
+
+ protected:
+  std::string m_Dir;
+  std::vector<uint8_t> m_Document;
+};
+
+}  // namespace
+
+TEST_F(cpdf_xref_cache_test, RoundTrip) {
+  CPDF_CrossRefTable objects;
+  CPDF_XRefCache::Contents contents;
+  CPDF_XRefCache writer(dir());
+  ASSERT_FALSE(writer.Load(CreateDocumentStream(), kID, &objects, &contents));
+
+  objects[1].pos = 9;
+  objects[1].type = 1;
+  objects[3].pos = 1;
+  objects[3].type = 2;
+  objects[3].gennum = 7;
+  objects[5];
+  contents.last_xref_offset = 0;
+  contents.xref_rebuilt = true;
+  contents.sorted_offsets = {9, 43};
+  const char kTrailer[] = "<</Root 1 0 R>>";
+  contents.trailer.assign(kTrailer, kTrailer + sizeof(kTrailer) - 1);
+  writer.Store(objects, contents);
+
+  CPDF_CrossRefTable loaded_objects;
+  CPDF_XRefCache::Contents loaded_contents;
+  CPDF_XRefCache reader(dir());
+  ASSERT_TRUE(
+      reader.Load(CreateDocumentStream(), kID, &loaded_objects,
+                  &loaded_contents));
+  EXPECT_EQ(writer.GetPath(), reader.GetPath());
+
+  EXPECT_EQ(5u, loaded_objects.GetLastObjNum());
+  for (uint32_t i = 0; i <= 5; ++i) {
+    ASSERT_TRUE(loaded_objects.Find(i)) << i;
+    EXPECT_EQ(objects[i].pos, loaded_objects.Find(i)->pos) << i;
+    EXPECT_EQ(objects[i].type, loaded_objects.Find(i)->type) << i;
+    EXPECT_EQ(objects[i].gennum, loaded_objects.Find(i)->gennum) << i;
+  }
+  EXPECT_FALSE(loaded_contents.xref_stream);
+  EXPECT_TRUE(loaded_contents.xref_rebuilt);
+  EXPECT_FALSE(loaded_contents.version_updated);
+  EXPECT_EQ(contents.sorted_offsets, loaded_contents.sorted_offsets);
+  EXPECT_EQ(contents.trailer, loaded_contents.trailer);
+
+  remove(reader.GetPath().c_str());
+}
+
+TEST_F(cpdf_xref_cache_test, ModifiedFileMisses) {
+  CPDF_CrossRefTable objects;
+  CPDF_XRefCache::Contents contents;
+  CPDF_XRefCache writer(dir());
+  ASSERT_FALSE(writer.Load(CreateDocumentStream(), kID, &objects, &contents));
+  objects[1].pos = 9;
+  objects[1].type = 1;
+  const char kTrailer[] = "<</Root 1 0 R>>";
+  contents.trailer.assign(kTrailer, kTrailer + sizeof(kTrailer) - 1);
+  writer.Store(objects, contents);
+
+  CPDF_XRefCache same(dir());
+  EXPECT_TRUE(same.Load(CreateDocumentStream(), kID, &objects, &contents));
+
+  // A different /ID makes for a different key.
+  CPDF_XRefCache other_id(dir());
+  EXPECT_FALSE(other_id.Load(CreateDocumentStream(), "\x01\x23", &objects,
+                             &contents));
+
+  // So does a change anywhere in the file, even one that keeps its size.
+  m_Document[11] = '2';
+  CPDF_XRefCache edited(dir());
+  EXPECT_FALSE(edited.Load(CreateDocumentStream(), kID, &objects, &contents));
+
+  remove(writer.GetPath().c_str());
+}
+
+TEST_F(cpdf_xref_cache_test, CorruptCacheFileIgnored) {
+  CPDF_CrossRefTable objects;
+  CPDF_XRefCache::Contents contents;
+  CPDF_XRefCache writer(dir());
+  ASSERT_FALSE(writer.Load(CreateDocumentStream(), kID, &objects, &contents));
+
+  FILE* file = fopen(writer.GetPath().c_str(), "wb");
+  ASSERT_TRUE(file);
+  fputs("PDFXREF1 truncated", file);
+  fclose(file);
+
+  CPDF_XRefCache reader(dir());
+  EXPECT_FALSE(reader.Load(CreateDocumentStream(), kID, &objects, &contents));
+
+  remove(writer.GetPath().c_str());
+}
+
+TEST_F(cpdf_xref_cache_test, DamagedCacheFileIgnored) {
+  CPDF_CrossRefTable objects;
+  CPDF_XRefCache::Contents contents;
+  CPDF_XRefCache writer(dir());
+  ASSERT_FALSE(writer.Load(CreateDocumentStream(), kID, &objects, &contents));
+  objects[1].pos = 9;
+  objects[1].type = 1;
+  const char kTrailer[] = "<</Root 1 0 R>>";
+  contents.trailer.assign(kTrailer, kTrailer + sizeof(kTrailer) - 1);
+  writer.Store(objects, contents);
+
+  // Change the position of object 1, which still parses as a valid entry.
+  // From the end, the file holds the checksum, the trailer and its size, an
+  // empty offset list and the gennum and type of the entry.
+  FILE* file = fopen(writer.GetPath().c_str(), "r+b");
+  ASSERT_TRUE(file);
+  ASSERT_EQ(0, fseek(file, -(16 + 15 + 4 + 4 + 2 + 1 + 8), SEEK_END));
+  ASSERT_EQ(9, fgetc(file));
+  ASSERT_EQ(0, fseek(file, -1, SEEK_CUR));
+  fputc(10, file);
+  fclose(file);
+
+  CPDF_XRefCache reader(dir());
+  EXPECT_FALSE(reader.Load(CreateDocumentStream(), kID, &objects, &contents));
+
+  remove(writer.GetPath().c_str());
+}
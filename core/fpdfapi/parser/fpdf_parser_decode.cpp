@@ -354,9 +354,17 @@ bool PDF_DataDecode(const uint8_t* src_buf,
   uint32_t last_size = src_size;
   int nSize = pdfium::CollectionSize<int>(DecoderArray);
   for (int i = 0; i < nSize; i++) {
-    int estimated_size = i == nSize - 1 ? last_estimated_size : 0;
     CFX_ByteString decoder = DecoderArray[i].first;
     CPDF_Dictionary* pParam = ToDictionary(DecoderArray[i].second);
+    uint32_t estimated_size = 0;
+    if (i == nSize - 1) {
+      estimated_size = last_estimated_size;
+      // The optional /DL entry is the length of the fully decoded data. Only
+      // the last filter puts that out, and only if no predictor follows.
+      bool bPredictor = pParam && pParam->GetIntegerFor("Predictor") > 1;
+      if (!estimated_size && !bPredictor)
+        estimated_size = std::max(pDict->GetIntegerFor("DL"), 0);
+    }
     uint8_t* new_buf = nullptr;
     uint32_t new_size = 0xFFFFFFFF;
     int offset = -1;
@@ -4,8 +4,20 @@
 
 #include "core/fpdfapi/parser/fpdf_parser_decode.h"
 
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/fpdfapi/cpdf_modulemgr.h"
+#include "core/fpdfapi/parser/cpdf_array.h"
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fpdfapi/parser/cpdf_name.h"
+#include "core/fpdfapi/parser/cpdf_number.h"
+#include "core/fxcodec/codec/ccodec_flatemodule.h"
+#include "core/fxcodec/fx_codec.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/test_support.h"
+#include "third_party/base/ptr_util.h"
 
 TEST(fpdf_parser_decode, A85Decode) {
   pdfium::DecodeTestData test_data[] = {
@@ -109,3 +121,68 @@ TEST(fpdf_parser_decode, EncodeText) {
     }
   }
 }
+
+TEST(fpdf_parser_decode, DataDecodeDecodedLength) {
+  CCodec_ModuleMgr codec_module;
+  CPDF_ModuleMgr::Get()->SetCodecModule(&codec_module);
+
+  std::string plain;
+  for (int i = 0; i < 5000; ++i)
+    plain += std::to_string(i * 7) + " 0 0 1 " + std::to_string(i) + " cm\n";
+  // Compresses |data| and returns it as a string.
+  auto compress = [&codec_module](const std::string& data) {
+    uint8_t* encoded = nullptr;
+    uint32_t encoded_size = 0;
+    codec_module.GetFlateModule()->Encode(
+        reinterpret_cast<const uint8_t*>(data.c_str()), data.size(), &encoded,
+        &encoded_size);
+    std::string result(reinterpret_cast<char*>(encoded), encoded_size);
+    FX_Free(encoded);
+    return result;
+  };
+  auto hex_encode = [](const std::string& data) {
+    std::string result;
+    for (unsigned char c : data) {
+      result += "0123456789abcdef"[c >> 4];
+      result += "0123456789abcdef"[c & 15];
+    }
+    return result + ">";
+  };
+
+  // /DL is the size of the final output. It only sizes the output of the last
+  // filter, which makes no difference to the result.
+  struct {
+    std::vector<const char*> filters;
+    std::string encoded;
+  } chains[] = {
+      {{"FlateDecode"}, compress(plain)},
+      {{"ASCIIHexDecode", "FlateDecode"}, hex_encode(compress(plain))},
+      {{"FlateDecode", "ASCIIHexDecode"}, compress(hex_encode(plain))},
+  };
+  for (const auto& chain : chains) {
+    for (int decoded_length : {-1, 0, 1, static_cast<int>(plain.size()) - 1,
+                               static_cast<int>(plain.size()), 0x7FFFFFFF}) {
+      auto pDict = pdfium::MakeUnique<CPDF_Dictionary>();
+      CPDF_Array* pFilters = pDict->SetNewFor<CPDF_Array>("Filter");
+      for (const char* filter : chain.filters)
+        pFilters->AddNew<CPDF_Name>(filter);
+      if (decoded_length >= 0)
+        pDict->SetNewFor<CPDF_Number>("DL", decoded_length);
+
+      uint8_t* dest_buf = nullptr;
+      uint32_t dest_size = 0;
+      CFX_ByteString image_encoding;
+      CPDF_Dictionary* pImageParams = nullptr;
+      ASSERT_TRUE(PDF_DataDecode(
+          reinterpret_cast<const uint8_t*>(chain.encoded.c_str()),
+          chain.encoded.size(), pDict.get(), dest_buf, dest_size,
+          &image_encoding, pImageParams, 0, false));
+      EXPECT_EQ(plain, std::string(reinterpret_cast<char*>(dest_buf),
+                                   dest_size))
+          << chain.filters.size() << " " << chain.filters[0] << " "
+          << decoded_length;
+      FX_Free(dest_buf);
+    }
+  }
+  CPDF_ModuleMgr::Destroy();
+}
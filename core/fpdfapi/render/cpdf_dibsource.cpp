@@ -99,8 +99,51 @@ class JpxBitMapContext {
 
 const int kMaxImageDimension = 0x01FFFF;
 
+// JPEG decoders scale down by up to 8. JPEG 2000 ones drop resolution levels,
+// and rarely have more than 5 to drop.
+const int kMaxJpegDownScale = 8;
+const int kMaxJpxDownScale = 32;
+
+// Switches |pCS| to the standard conversions for the current scope, when
+// |bEnable| is set.
+class StdConversionScope {
+ public:
+  StdConversionScope(CPDF_ColorSpace* pCS, bool bEnable)
+      : m_pColorSpace(bEnable ? pCS : nullptr) {
+    if (m_pColorSpace)
+      m_pColorSpace->EnableStdConversion(true);
+  }
+  ~StdConversionScope() {
+    if (m_pColorSpace)
+      m_pColorSpace->EnableStdConversion(false);
+  }
+
+ private:
+  CPDF_ColorSpace* const m_pColorSpace;
+};
+
 }  // namespace
 
+// static
+int CPDF_DIBSource::GetDownScale(int width,
+                                 int height,
+                                 int32_t dest_width,
+                                 int32_t dest_height,
+                                 int max_scale) {
+  dest_width = abs(dest_width);
+  dest_height = abs(dest_height);
+  if (dest_width == 0 || dest_height == 0)
+    return 1;
+
+  int scale = 1;
+  while (scale < max_scale &&
+         (width + scale * 2 - 1) / (scale * 2) >= dest_width &&
+         (height + scale * 2 - 1) / (scale * 2) >= dest_height) {
+    scale *= 2;
+  }
+  return scale;
+}
+
 CPDF_DIBSource::CPDF_DIBSource()
     : m_pDocument(nullptr),
       m_pStream(nullptr),
@@ -112,6 +155,7 @@ CPDF_DIBSource::CPDF_DIBSource()
       m_nComponents(0),
       m_GroupFamily(0),
       m_MatteColor(0),
+      m_nDownScale(1),
       m_bLoadMask(false),
       m_bDefaultDecode(true),
       m_bImageMask(false),
@@ -172,7 +216,7 @@ bool CPDF_DIBSource::Load(CPDF_Document* pDoc, const CPDF_Stream* pStream) {
   if (m_pStreamAcc->GetSize() == 0 || !m_pStreamAcc->GetData())
     return false;
 
-  if (!CreateDecoder())
+  if (!CreateDecoder(1, 1))
     return false;
 
   if (m_bImageMask) {
@@ -227,10 +271,10 @@ int CPDF_DIBSource::ContinueToLoadMask() {
     return 0;
   }
   m_pLineBuf = FX_Alloc(uint8_t, pitch.ValueOrDie());
-  if (m_pColorSpace && m_bStdCS) {
-    m_pColorSpace->EnableStdConversion(true);
+  {
+    StdConversionScope std_conversion(m_pColorSpace, m_bStdCS);
+    LoadPalette();
   }
-  LoadPalette();
   if (m_bColorKey) {
     m_bpp = 32;
     m_AlphaFlag = 2;
@@ -251,7 +295,9 @@ int CPDF_DIBSource::StartLoadDIBSource(CPDF_Document* pDoc,
                                        CPDF_Dictionary* pPageResources,
                                        bool bStdCS,
                                        uint32_t GroupFamily,
-                                       bool bLoadMask) {
+                                       bool bLoadMask,
+                                       int32_t downsampleWidth,
+                                       int32_t downsampleHeight) {
   if (!pStream) {
     return 0;
   }
@@ -285,7 +331,11 @@ int CPDF_DIBSource::StartLoadDIBSource(CPDF_Document* pDoc,
   if (m_pStreamAcc->GetSize() == 0 || !m_pStreamAcc->GetData()) {
     return 0;
   }
-  int ret = CreateDecoder();
+  int ret = CreateDecoder(
+      GetDownScale(m_Width, m_Height, downsampleWidth, downsampleHeight,
+                   kMaxJpegDownScale),
+      GetDownScale(m_Width, m_Height, downsampleWidth, downsampleHeight,
+                   kMaxJpxDownScale));
   if (!ret)
     return ret;
 
@@ -304,12 +354,6 @@ int CPDF_DIBSource::StartLoadDIBSource(CPDF_Document* pDoc,
   if (m_bHasMask) {
     ret = StratLoadMask();
   }
-  if (ret == 2) {
-    return ret;
-  }
-  if (m_pColorSpace && m_bStdCS) {
-    m_pColorSpace->EnableStdConversion(false);
-  }
   return ret;
 }
 
@@ -349,12 +393,6 @@ int CPDF_DIBSource::ContinueLoadDIBSource(IFX_Pause* pPause) {
         ret1 = ContinueLoadMaskDIB(pPause);
         m_Status = 2;
       }
-      if (ret1 == 2) {
-        return ret1;
-      }
-      if (m_pColorSpace && m_bStdCS) {
-        m_pColorSpace->EnableStdConversion(false);
-      }
       return ret1;
     }
     ret = pJbig2Module->ContinueDecode(m_pJbig2Context.get(), pPause);
@@ -372,12 +410,6 @@ int CPDF_DIBSource::ContinueLoadDIBSource(IFX_Pause* pPause) {
       ret1 = ContinueLoadMaskDIB(pPause);
       m_Status = 2;
     }
-    if (ret1 == 2) {
-      return ret1;
-    }
-    if (m_pColorSpace && m_bStdCS) {
-      m_pColorSpace->EnableStdConversion(false);
-    }
     return ret1;
   }
   if (m_Status == 2) {
@@ -498,7 +530,7 @@ DIB_COMP_DATA* CPDF_DIBSource::GetDecodeAndMaskArray(bool* bDefaultDecode,
   return pCompData;
 }
 
-int CPDF_DIBSource::CreateDecoder() {
+int CPDF_DIBSource::CreateDecoder(int jpeg_down_scale, int jpx_down_scale) {
   const CFX_ByteString& decoder = m_pStreamAcc->GetImageDecoder();
   if (decoder.IsEmpty())
     return 1;
@@ -507,7 +539,7 @@ int CPDF_DIBSource::CreateDecoder() {
     return 0;
 
   if (decoder == "JPXDecode") {
-    LoadJpxBitmap();
+    LoadJpxBitmap(jpx_down_scale);
     return m_pCachedBitmap ? 1 : 0;
   }
   if (decoder == "JBIG2Decode") {
@@ -537,9 +569,12 @@ int CPDF_DIBSource::CreateDecoder() {
                      ->CreateRunLengthDecoder(src_data, src_size, m_Width,
                                               m_Height, m_nComponents, m_bpc);
   } else if (decoder == "DCTDecode") {
+    // Image masks are drawn from their 1 bpp data, which scaling would blur.
+    if (!m_bImageMask)
+      m_nDownScale = jpeg_down_scale;
     m_pDecoder = CPDF_ModuleMgr::Get()->GetJpegModule()->CreateDecoder(
         src_data, src_size, m_Width, m_Height, m_nComponents,
-        !pParams || pParams->GetIntegerFor("ColorTransform", 1));
+        !pParams || pParams->GetIntegerFor("ColorTransform", 1), m_nDownScale);
     if (!m_pDecoder) {
       bool bTransform = false;
       int comps;
@@ -592,13 +627,18 @@ int CPDF_DIBSource::CreateDecoder() {
         }
         m_bpc = bpc;
         m_pDecoder = CPDF_ModuleMgr::Get()->GetJpegModule()->CreateDecoder(
-            src_data, src_size, m_Width, m_Height, m_nComponents, bTransform);
+            src_data, src_size, m_Width, m_Height, m_nComponents, bTransform,
+            m_nDownScale);
       }
     }
   }
   if (!m_pDecoder)
     return 0;
 
+  // The rest of the image is read as if it had been this size all along.
+  m_Width = (m_Width + m_nDownScale - 1) / m_nDownScale;
+  m_Height = (m_Height + m_nDownScale - 1) / m_nDownScale;
+
   FX_SAFE_UINT32 requested_pitch =
       CalculatePitch8(m_bpc, m_nComponents, m_Width);
   if (!requested_pitch.IsValid())
@@ -612,17 +652,32 @@ int CPDF_DIBSource::CreateDecoder() {
   return 1;
 }
 
-void CPDF_DIBSource::LoadJpxBitmap() {
+void CPDF_DIBSource::LoadJpxBitmap(int down_scale) {
   CCodec_JpxModule* pJpxModule = CPDF_ModuleMgr::Get()->GetJpxModule();
   if (!pJpxModule)
     return;
 
+  uint32_t discard_levels = 0;
+  while ((2 << discard_levels) <= down_scale)
+    ++discard_levels;
+
   auto context = pdfium::MakeUnique<JpxBitMapContext>(pJpxModule);
   context->set_decoder(pJpxModule->CreateDecoder(
-      m_pStreamAcc->GetData(), m_pStreamAcc->GetSize(), m_pColorSpace));
+      m_pStreamAcc->GetData(), m_pStreamAcc->GetSize(), m_pColorSpace,
+      discard_levels));
+  if (!context->decoder() && discard_levels) {
+    // A tile can have fewer resolution levels than the main header promises.
+    context->set_decoder(pJpxModule->CreateDecoder(
+        m_pStreamAcc->GetData(), m_pStreamAcc->GetSize(), m_pColorSpace, 0));
+  }
   if (!context->decoder())
     return;
 
+  // As with JPEG, the rest of the image is read as if it had been this size.
+  m_nDownScale = 1 << pJpxModule->GetDiscardLevels(context->decoder());
+  m_Width = (m_Width + m_nDownScale - 1) / m_nDownScale;
+  m_Height = (m_Height + m_nDownScale - 1) / m_nDownScale;
+
   uint32_t width = 0;
   uint32_t height = 0;
   uint32_t components = 0;
@@ -705,7 +760,10 @@ int CPDF_DIBSource::StratLoadMask() {
       for (uint32_t i = 0; i < m_nComponents; i++)
         colors[i] = pMatte->GetFloatAt(i);
 
-      m_pColorSpace->GetRGB(colors.data(), &R, &G, &B);
+      {
+        StdConversionScope std_conversion(m_pColorSpace, m_bStdCS);
+        m_pColorSpace->GetRGB(colors.data(), &R, &G, &B);
+      }
       m_MatteColor = FXARGB_MAKE(0, FXSYS_round(R * 255), FXSYS_round(G * 255),
                                  FXSYS_round(B * 255));
     }
@@ -724,9 +782,6 @@ int CPDF_DIBSource::ContinueLoadMaskDIB(IFX_Pause* pPause) {
   if (ret == 2)
     return ret;
 
-  if (m_pColorSpace && m_bStdCS)
-    m_pColorSpace->EnableStdConversion(false);
-
   if (!ret) {
     m_pMask.Reset();
     return ret;
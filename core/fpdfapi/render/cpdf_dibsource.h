@@ -42,6 +42,16 @@ class CPDF_DIBSource : public CFX_DIBSource {
   template <typename T, typename... Args>
   friend CFX_RetainPtr<T> pdfium::MakeRetain(Args&&... args);
 
+  // Returns the power of two, at most |max_scale|, that an image of |width|
+  // by |height| can be scaled down by while keeping at least |dest_width| by
+  // |dest_height| pixels. Negative sizes count as their magnitude, and 0 as
+  // an unknown size.
+  static int GetDownScale(int width,
+                          int height,
+                          int32_t dest_width,
+                          int32_t dest_height,
+                          int max_scale);
+
   ~CPDF_DIBSource() override;
 
   bool Load(CPDF_Document* pDoc, const CPDF_Stream* pStream);
@@ -59,7 +69,12 @@ class CPDF_DIBSource : public CFX_DIBSource {
                           int clip_width) const override;
 
   uint32_t GetMatteColor() const { return m_MatteColor; }
+  // Whether the image was decoded at less than its full resolution.
+  bool IsDownScaled() const { return m_nDownScale > 1; }
 
+  // |downsampleWidth| and |downsampleHeight| are the size the image is drawn
+  // at, if known. JPEG and JPEG 2000 images are then decoded at a reduced
+  // resolution that still has at least that many pixels.
   int StartLoadDIBSource(CPDF_Document* pDoc,
                          const CPDF_Stream* pStream,
                          bool bHasMask,
@@ -67,7 +82,9 @@ class CPDF_DIBSource : public CFX_DIBSource {
                          CPDF_Dictionary* pPageResources,
                          bool bStdCS = false,
                          uint32_t GroupFamily = 0,
-                         bool bLoadMask = false);
+                         bool bLoadMask = false,
+                         int32_t downsampleWidth = 0,
+                         int32_t downsampleHeight = 0);
   int ContinueLoadDIBSource(IFX_Pause* pPause);
   int StratLoadMask();
   int StartLoadMaskDIB();
@@ -81,9 +98,9 @@ class CPDF_DIBSource : public CFX_DIBSource {
   bool LoadColorInfo(const CPDF_Dictionary* pFormResources,
                      const CPDF_Dictionary* pPageResources);
   DIB_COMP_DATA* GetDecodeAndMaskArray(bool* bDefaultDecode, bool* bColorKey);
-  void LoadJpxBitmap();
+  void LoadJpxBitmap(int down_scale);
   void LoadPalette();
-  int CreateDecoder();
+  int CreateDecoder(int jpeg_down_scale, int jpx_down_scale);
   void TranslateScanline24bpp(uint8_t* dest_scan,
                               const uint8_t* src_scan) const;
   void ValidateDictParam();
@@ -127,6 +144,7 @@ class CPDF_DIBSource : public CFX_DIBSource {
   uint32_t m_nComponents;
   uint32_t m_GroupFamily;
   uint32_t m_MatteColor;
+  int m_nDownScale;
   bool m_bLoadMask;
   bool m_bDefaultDecode;
   bool m_bImageMask;
@@ -0,0 +1,38 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/render/cpdf_dibsource.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+TEST(CPDF_DIBSource, GetDownScale) {
+  // The size is unknown.
+  EXPECT_EQ(1, CPDF_DIBSource::GetDownScale(4000, 3000, 0, 0, 8));
+  EXPECT_EQ(1, CPDF_DIBSource::GetDownScale(4000, 3000, 100, 0, 8));
+
+  // Drawn at full size or larger.
+  EXPECT_EQ(1, CPDF_DIBSource::GetDownScale(4000, 3000, 4000, 3000, 8));
+  EXPECT_EQ(1, CPDF_DIBSource::GetDownScale(4000, 3000, 8000, 6000, 8));
+
+  // Just large enough for each scale, and one pixel too many for it.
+  EXPECT_EQ(2, CPDF_DIBSource::GetDownScale(4000, 3000, 2000, 1500, 8));
+  EXPECT_EQ(1, CPDF_DIBSource::GetDownScale(4000, 3000, 2001, 1500, 8));
+  EXPECT_EQ(4, CPDF_DIBSource::GetDownScale(4000, 3000, 1000, 750, 8));
+  EXPECT_EQ(2, CPDF_DIBSource::GetDownScale(4000, 3000, 1000, 751, 8));
+  EXPECT_EQ(8, CPDF_DIBSource::GetDownScale(4000, 3000, 500, 375, 8));
+  EXPECT_EQ(4, CPDF_DIBSource::GetDownScale(4000, 3000, 501, 375, 8));
+
+  // The scaled size is rounded up.
+  EXPECT_EQ(8, CPDF_DIBSource::GetDownScale(4001, 3001, 501, 376, 8));
+  EXPECT_EQ(4, CPDF_DIBSource::GetDownScale(4001, 3001, 502, 376, 8));
+
+  // Flipped images have negative sizes.
+  EXPECT_EQ(4, CPDF_DIBSource::GetDownScale(4000, 3000, -1000, -750, 8));
+  EXPECT_EQ(4, CPDF_DIBSource::GetDownScale(4000, 3000, 1000, -750, 8));
+
+  // Never beyond the maximum.
+  EXPECT_EQ(8, CPDF_DIBSource::GetDownScale(4000, 3000, 1, 1, 8));
+  EXPECT_EQ(32, CPDF_DIBSource::GetDownScale(4000, 3000, 1, 1, 32));
+  EXPECT_EQ(16, CPDF_DIBSource::GetDownScale(4000, 3000, 200, 150, 32));
+}
@@ -7,14 +7,17 @@
 #include "core/fpdfapi/render/cpdf_docrenderdata.h"
 
 #include <memory>
+#include <mutex>
 
 #include "core/fpdfapi/font/cpdf_type3font.h"
 #include "core/fpdfapi/page/pageint.h"
 #include "core/fpdfapi/parser/cpdf_array.h"
 #include "core/fpdfapi/parser/cpdf_document.h"
 #include "core/fpdfapi/render/cpdf_dibsource.h"
+#include "core/fpdfapi/render/cpdf_imagecache.h"
 #include "core/fpdfapi/render/cpdf_transferfunc.h"
 #include "core/fpdfapi/render/cpdf_type3cache.h"
+#include "third_party/base/ptr_util.h"
 
 namespace {
 
@@ -23,13 +26,15 @@ const int kMaxOutputs = 16;
 }  // namespace
 
 CPDF_DocRenderData::CPDF_DocRenderData(CPDF_Document* pPDFDoc)
-    : m_pPDFDoc(pPDFDoc) {}
+    : m_pPDFDoc(pPDFDoc),
+      m_pImageCache(pdfium::MakeUnique<CPDF_ImageCache>()) {}
 
 CPDF_DocRenderData::~CPDF_DocRenderData() {
   Clear(true);
 }
 
 void CPDF_DocRenderData::Clear(bool bRelease) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
   for (auto it = m_Type3FaceMap.begin(); it != m_Type3FaceMap.end();) {
     auto curr_it = it++;
     if (bRelease || curr_it->second->HasOneRef()) {
@@ -46,6 +51,7 @@ void CPDF_DocRenderData::Clear(bool bRelease) {
 
 CFX_RetainPtr<CPDF_Type3Cache> CPDF_DocRenderData::GetCachedType3(
     CPDF_Type3Font* pFont) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
   auto it = m_Type3FaceMap.find(pFont);
   if (it != m_Type3FaceMap.end())
     return it->second;
@@ -56,6 +62,7 @@ CFX_RetainPtr<CPDF_Type3Cache> CPDF_DocRenderData::GetCachedType3(
 }
 
 void CPDF_DocRenderData::MaybePurgeCachedType3(CPDF_Type3Font* pFont) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
   auto it = m_Type3FaceMap.find(pFont);
   if (it != m_Type3FaceMap.end() && it->second->HasOneRef())
     m_Type3FaceMap.erase(it);
@@ -66,6 +73,9 @@ CFX_RetainPtr<CPDF_TransferFunc> CPDF_DocRenderData::GetTransferFunc(
   if (!pObj)
     return nullptr;
 
+  // Held until the samples are filled in, so that no other thread sees them
+  // half done.
+  std::lock_guard<std::mutex> lock(m_Mutex);
   auto it = m_TransferFuncMap.find(pObj);
   if (it != m_TransferFuncMap.end())
     return it->second;
@@ -125,6 +135,7 @@ CFX_RetainPtr<CPDF_TransferFunc> CPDF_DocRenderData::GetTransferFunc(
 }
 
 void CPDF_DocRenderData::MaybePurgeTransferFunc(CPDF_Object* pObj) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
   auto it = m_TransferFuncMap.find(pObj);
   if (it != m_TransferFuncMap.end() && it->second->HasOneRef())
     m_TransferFuncMap.erase(it);
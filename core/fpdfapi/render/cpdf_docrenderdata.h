@@ -8,16 +8,21 @@
 #define CORE_FPDFAPI_RENDER_CPDF_DOCRENDERDATA_H_
 
 #include <map>
+#include <memory>
+#include <mutex>
 
 #include "core/fpdfapi/page/cpdf_countedobject.h"
 #include "core/fpdfapi/render/cpdf_transferfunc.h"
 
 class CPDF_Document;
 class CPDF_Font;
+class CPDF_ImageCache;
 class CPDF_Object;
 class CPDF_Type3Cache;
 class CPDF_Type3Font;
 
+// Caches the render data that the pages of a document share. It is safe to
+// use from several threads.
 class CPDF_DocRenderData {
  public:
   explicit CPDF_DocRenderData(CPDF_Document* pPDFDoc);
@@ -29,12 +34,16 @@ class CPDF_DocRenderData {
   CFX_RetainPtr<CPDF_TransferFunc> GetTransferFunc(CPDF_Object* pObj);
   void MaybePurgeTransferFunc(CPDF_Object* pOb);
 
+  CPDF_ImageCache* GetImageCache() const { return m_pImageCache.get(); }
+
   void Clear(bool bRelease);
 
  private:
   CPDF_Document* m_pPDFDoc;  // Not Owned
+  std::mutex m_Mutex;
   std::map<CPDF_Font*, CFX_RetainPtr<CPDF_Type3Cache>> m_Type3FaceMap;
   std::map<CPDF_Object*, CFX_RetainPtr<CPDF_TransferFunc>> m_TransferFuncMap;
+  std::unique_ptr<CPDF_ImageCache> m_pImageCache;
 };
 
 #endif  // CORE_FPDFAPI_RENDER_CPDF_DOCRENDERDATA_H_
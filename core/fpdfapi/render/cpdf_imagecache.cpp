@@ -0,0 +1,163 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#include "core/fpdfapi/render/cpdf_imagecache.h"
+
+#include <stdlib.h>
+
+#include <iterator>
+#include <tuple>
+
+#include "core/fpdfapi/parser/cpdf_stream.h"
+
+bool CPDF_ImageCache::Key::operator<(const Key& that) const {
+  return std::tie(objnum, bStdCS, GroupFamily, bLoadMask) <
+         std::tie(that.objnum, that.bStdCS, that.GroupFamily, that.bLoadMask);
+}
+
+CPDF_ImageCache::Image::Image() : MatteColor(0), bDownScaled(false) {}
+
+CPDF_ImageCache::Image::Image(const Image& that) = default;
+
+CPDF_ImageCache::Image::~Image() {}
+
+bool CPDF_ImageCache::Image::IsLargeEnoughFor(int32_t downsampleWidth,
+                                              int32_t downsampleHeight) const {
+  if (!pBitmap || !bDownScaled)
+    return true;
+
+  return downsampleWidth && downsampleHeight &&
+         pBitmap->GetWidth() >= abs(downsampleWidth) &&
+         pBitmap->GetHeight() >= abs(downsampleHeight);
+}
+
+CPDF_ImageCache::Node::Node(const Key& key,
+                            const CPDF_Stream* pStream,
+                            const Image& image,
+                            uint32_t size)
+    : key(key), pStream(pStream), image(image), size(size) {}
+
+CPDF_ImageCache::Node::~Node() {}
+
+CPDF_ImageCache::CPDF_ImageCache()
+    : m_Limit(kDefaultLimit),
+      m_Size(0),
+      m_nHits(0),
+      m_nMisses(0),
+      m_nEvictions(0) {}
+
+CPDF_ImageCache::~CPDF_ImageCache() {}
+
+bool CPDF_ImageCache::Find(const Key& key,
+                           const CPDF_Stream* pStream,
+                           Image* pImage,
+                           int32_t downsampleWidth,
+                           int32_t downsampleHeight) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  auto it = m_Entries.find(key);
+  if (it == m_Entries.end()) {
+    m_nMisses++;
+    return false;
+  }
+
+  // The object number may have been given to a different stream since.
+  NodeList::iterator node = it->second;
+  if (node->pStream != pStream) {
+    Erase(node);
+    m_nMisses++;
+    return false;
+  }
+
+  // A bigger image is decoded and added in its place.
+  if (!node->image.IsLargeEnoughFor(downsampleWidth, downsampleHeight)) {
+    m_nMisses++;
+    return false;
+  }
+
+  m_LRU.splice(m_LRU.begin(), m_LRU, node);
+  m_nHits++;
+  *pImage = node->image;
+  return true;
+}
+
+void CPDF_ImageCache::Add(const Key& key,
+                          const CPDF_Stream* pStream,
+                          const Image& image,
+                          uint32_t size) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  auto it = m_Entries.find(key);
+  if (it != m_Entries.end())
+    Erase(it->second);
+
+  m_LRU.emplace_front(key, pStream, image, size);
+  m_Entries[key] = m_LRU.begin();
+  m_Size += size;
+  EvictToLimit(1);
+}
+
+void CPDF_ImageCache::Remove(const CPDF_Stream* pStream) {
+  // Only images with an object number are cached.
+  if (!pStream || !pStream->GetObjNum())
+    return;
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  const uint32_t objnum = pStream->GetObjNum();
+  auto it = m_Entries.lower_bound({objnum, false, 0, false});
+  while (it != m_Entries.end() && it->first.objnum == objnum) {
+    NodeList::iterator node = (it++)->second;
+    if (node->pStream == pStream)
+      Erase(node);
+  }
+}
+
+void CPDF_ImageCache::SetLimit(size_t limit) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Limit = limit;
+  EvictToLimit(0);
+}
+
+size_t CPDF_ImageCache::GetLimit() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Limit;
+}
+
+size_t CPDF_ImageCache::GetSize() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Size;
+}
+
+size_t CPDF_ImageCache::GetCount() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Entries.size();
+}
+
+uint32_t CPDF_ImageCache::GetHitCount() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_nHits;
+}
+
+uint32_t CPDF_ImageCache::GetMissCount() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_nMisses;
+}
+
+uint32_t CPDF_ImageCache::GetEvictionCount() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_nEvictions;
+}
+
+void CPDF_ImageCache::Erase(NodeList::iterator it) {
+  m_Size -= it->size;
+  m_Entries.erase(it->key);
+  m_LRU.erase(it);
+}
+
+void CPDF_ImageCache::EvictToLimit(size_t nKeep) {
+  while (m_Size > m_Limit && m_LRU.size() > nKeep) {
+    Erase(std::prev(m_LRU.end()));
+    m_nEvictions++;
+  }
+}
@@ -0,0 +1,122 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#ifndef CORE_FPDFAPI_RENDER_CPDF_IMAGECACHE_H_
+#define CORE_FPDFAPI_RENDER_CPDF_IMAGECACHE_H_
+
+#include <list>
+#include <map>
+#include <mutex>
+
+#include "core/fxcrt/cfx_retain_ptr.h"
+#include "core/fxcrt/fx_system.h"
+#include "core/fxge/dib/cfx_dibitmap.h"
+
+class CPDF_Stream;
+
+// Decoded images of a document, shared by all of its pages and evicted in
+// least recently used order once their total size exceeds a byte limit.
+// Only images that are indirect objects are cached here; inline images
+// belong to a single page and stay in its CPDF_PageRenderCache. It is safe
+// to use from several threads.
+class CPDF_ImageCache {
+ public:
+  // Everything besides the image that affects the decoded result.
+  struct Key {
+    bool operator<(const Key& that) const;
+
+    uint32_t objnum;
+    bool bStdCS;
+    uint32_t GroupFamily;
+    bool bLoadMask;
+  };
+
+  // A fully decoded image. Cached images are never modified, so every page
+  // that finds one can draw its bitmaps directly.
+  struct Image {
+    Image();
+    Image(const Image& that);
+    ~Image();
+
+    // Whether the image has enough pixels to be drawn at |downsampleWidth|
+    // by |downsampleHeight|. A size of 0 is unknown, and only an image that
+    // was not scaled down will do then.
+    bool IsLargeEnoughFor(int32_t downsampleWidth,
+                          int32_t downsampleHeight) const;
+
+    CFX_RetainPtr<CFX_DIBitmap> pBitmap;
+    CFX_RetainPtr<CFX_DIBitmap> pMask;
+    uint32_t MatteColor;
+    bool bDownScaled;
+  };
+
+  static const size_t kDefaultLimit = 100 * 1024 * 1024;
+
+  CPDF_ImageCache();
+  ~CPDF_ImageCache();
+
+  // Copies the image for |key| to |pImage| and marks it as the most recently
+  // used. Returns false, and counts a miss, if there is none for |pStream| or
+  // it is too small to be drawn at |downsampleWidth| by |downsampleHeight|.
+  bool Find(const Key& key,
+            const CPDF_Stream* pStream,
+            Image* pImage,
+            int32_t downsampleWidth = 0,
+            int32_t downsampleHeight = 0);
+
+  // Takes in |image| of |pStream|, charged as |size| bytes, as the most
+  // recently used entry. Older entries are evicted to stay within the limit,
+  // but |image| itself is kept even if it alone exceeds it.
+  void Add(const Key& key,
+           const CPDF_Stream* pStream,
+           const Image& image,
+           uint32_t size);
+
+  // Drops all entries for |pStream|, which may be null.
+  void Remove(const CPDF_Stream* pStream);
+
+  void SetLimit(size_t limit);
+  size_t GetLimit() const;
+  size_t GetSize() const;
+  size_t GetCount() const;
+
+  uint32_t GetHitCount() const;
+  uint32_t GetMissCount() const;
+  uint32_t GetEvictionCount() const;
+
+ private:
+  struct Node {
+    Node(const Key& key,
+         const CPDF_Stream* pStream,
+         const Image& image,
+         uint32_t size);
+    ~Node();
+
+    Key key;
+    const CPDF_Stream* pStream;
+    Image image;
+    uint32_t size;
+  };
+  using NodeList = std::list<Node>;
+
+  void Erase(NodeList::iterator it);
+  // Evicts the least recently used entries, but never the |nKeep| most
+  // recently used ones.
+  void EvictToLimit(size_t nKeep);
+
+  mutable std::mutex m_Mutex;
+  // Most recently used first.
+  NodeList m_LRU;
+  // Ordered by object number first, so the entries of a stream are adjacent.
+  std::map<Key, NodeList::iterator> m_Entries;
+  size_t m_Limit;
+  size_t m_Size;
+  uint32_t m_nHits;
+  uint32_t m_nMisses;
+  uint32_t m_nEvictions;
+};
+
+#endif  // CORE_FPDFAPI_RENDER_CPDF_IMAGECACHE_H_
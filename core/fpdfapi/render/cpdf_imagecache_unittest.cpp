@@ -0,0 +1,108 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/render/cpdf_imagecache.h"
+
+#include "core/fpdfapi/parser/cpdf_indirect_object_holder.h"
+#include "core/fpdfapi/parser/cpdf_stream.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+CPDF_ImageCache::Image MakeImage(int width) {
+  CPDF_ImageCache::Image image;
+  image.pBitmap = pdfium::MakeRetain<CFX_DIBitmap>();
+  image.pBitmap->Create(width, 1, FXDIB_8bppRgb);
+  return image;
+}
+
+CPDF_ImageCache::Key MakeKey(const CPDF_Stream* pStream, bool bStdCS) {
+  return {pStream->GetObjNum(), bStdCS, 0, false};
+}
+
+}  // namespace
+
+TEST(CPDF_ImageCache, FindAndEvict) {
+  CPDF_IndirectObjectHolder holder;
+  CPDF_Stream* pStream1 = holder.NewIndirect<CPDF_Stream>();
+  CPDF_Stream* pStream2 = holder.NewIndirect<CPDF_Stream>();
+  CPDF_ImageCache cache;
+  cache.SetLimit(150);
+
+  CPDF_ImageCache::Image image = MakeImage(10);
+  cache.Add(MakeKey(pStream1, false), pStream1, image, 100);
+  CPDF_ImageCache::Image found;
+  ASSERT_TRUE(cache.Find(MakeKey(pStream1, false), pStream1, &found));
+  EXPECT_EQ(image.pBitmap, found.pBitmap);
+  EXPECT_FALSE(cache.Find(MakeKey(pStream1, true), pStream1, &found));
+  // The same object number now names another stream.
+  EXPECT_FALSE(cache.Find(MakeKey(pStream1, false), pStream2, &found));
+  EXPECT_EQ(0u, cache.GetCount());
+  EXPECT_EQ(1u, cache.GetHitCount());
+  EXPECT_EQ(2u, cache.GetMissCount());
+
+  // Adding past the limit evicts the least recently used image, but keeps
+  // the newest even when it alone exceeds the limit.
+  cache.Add(MakeKey(pStream1, false), pStream1, MakeImage(1), 100);
+  cache.Add(MakeKey(pStream2, false), pStream2, MakeImage(2), 100);
+  EXPECT_FALSE(cache.Find(MakeKey(pStream1, false), pStream1, &found));
+  EXPECT_TRUE(cache.Find(MakeKey(pStream2, false), pStream2, &found));
+  cache.Add(MakeKey(pStream1, false), pStream1, MakeImage(3), 200);
+  EXPECT_EQ(1u, cache.GetCount());
+  EXPECT_EQ(200u, cache.GetSize());
+  EXPECT_EQ(2u, cache.GetEvictionCount());
+}
+
+TEST(CPDF_ImageCache, Remove) {
+  CPDF_IndirectObjectHolder holder;
+  CPDF_Stream* pStream1 = holder.NewIndirect<CPDF_Stream>();
+  CPDF_Stream* pStream2 = holder.NewIndirect<CPDF_Stream>();
+  CPDF_Stream* pStream3 = holder.NewIndirect<CPDF_Stream>();
+  CPDF_ImageCache cache;
+  cache.Add(MakeKey(pStream1, false), pStream1, MakeImage(1), 10);
+  cache.Add(MakeKey(pStream2, false), pStream2, MakeImage(2), 10);
+  cache.Add(MakeKey(pStream2, true), pStream2, MakeImage(3), 10);
+  cache.Add(MakeKey(pStream3, false), pStream3, MakeImage(4), 10);
+
+  // Every entry of the stream goes, whatever else is in its key.
+  cache.Remove(pStream2);
+  EXPECT_EQ(2u, cache.GetCount());
+  EXPECT_EQ(20u, cache.GetSize());
+  CPDF_ImageCache::Image found;
+  EXPECT_FALSE(cache.Find(MakeKey(pStream2, false), pStream2, &found));
+  EXPECT_FALSE(cache.Find(MakeKey(pStream2, true), pStream2, &found));
+  EXPECT_TRUE(cache.Find(MakeKey(pStream1, false), pStream1, &found));
+  EXPECT_TRUE(cache.Find(MakeKey(pStream3, false), pStream3, &found));
+
+  // Streams that are not in the document are never cached.
+  CPDF_Stream inline_stream;
+  cache.Remove(&inline_stream);
+  cache.Remove(nullptr);
+  EXPECT_EQ(2u, cache.GetCount());
+}
+
+TEST(CPDF_ImageCache, FindDownScaled) {
+  CPDF_IndirectObjectHolder holder;
+  CPDF_Stream* pStream = holder.NewIndirect<CPDF_Stream>();
+  CPDF_ImageCache cache;
+  CPDF_ImageCache::Image image = MakeImage(10);
+  image.bDownScaled = true;
+  cache.Add(MakeKey(pStream, false), pStream, image, 10);
+
+  // Only drawings of known size that need no more pixels find it.
+  CPDF_ImageCache::Image found;
+  EXPECT_TRUE(cache.Find(MakeKey(pStream, false), pStream, &found, 10, 1));
+  EXPECT_TRUE(cache.Find(MakeKey(pStream, false), pStream, &found, -5, -1));
+  EXPECT_FALSE(cache.Find(MakeKey(pStream, false), pStream, &found, 11, 1));
+  EXPECT_FALSE(cache.Find(MakeKey(pStream, false), pStream, &found, 10, 2));
+  EXPECT_FALSE(cache.Find(MakeKey(pStream, false), pStream, &found));
+  EXPECT_EQ(2u, cache.GetHitCount());
+  EXPECT_EQ(3u, cache.GetMissCount());
+  EXPECT_EQ(1u, cache.GetCount());
+
+  // A full size image serves any size.
+  cache.Add(MakeKey(pStream, false), pStream, MakeImage(5), 5);
+  EXPECT_TRUE(cache.Find(MakeKey(pStream, false), pStream, &found, 100, 100));
+  EXPECT_TRUE(cache.Find(MakeKey(pStream, false), pStream, &found));
+}
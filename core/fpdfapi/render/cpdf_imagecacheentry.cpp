@@ -17,6 +17,7 @@
 #include "core/fpdfapi/render/cpdf_pagerendercache.h"
 #include "core/fpdfapi/render/cpdf_rendercontext.h"
 #include "core/fpdfapi/render/cpdf_renderstatus.h"
+#include "core/fxcrt/fx_safe_types.h"
 
 CPDF_ImageCacheEntry::CPDF_ImageCacheEntry(CPDF_Document* pDoc,
                                            CPDF_Stream* pStream)
@@ -27,6 +28,8 @@ CPDF_ImageCacheEntry::CPDF_ImageCacheEntry(CPDF_Document* pDoc,
       m_pStream(pStream),
       m_pCurBitmap(nullptr),
       m_pCurMask(nullptr),
+      m_bCachedDownScaled(false),
+      m_bCachedDecoded(false),
       m_dwCacheSize(0) {}
 
 CPDF_ImageCacheEntry::~CPDF_ImageCacheEntry() {}
@@ -35,15 +38,56 @@ void CPDF_ImageCacheEntry::Reset(const CFX_RetainPtr<CFX_DIBitmap>& pBitmap) {
   m_pCachedBitmap.Reset();
   if (pBitmap)
     m_pCachedBitmap = pBitmap->Clone(nullptr);
+  m_bCachedDownScaled = false;
+  m_bCachedDecoded = true;
   CalcSize();
 }
 
+void CPDF_ImageCacheEntry::SetDecodedImage(
+    const CPDF_ImageCache::Image& image) {
+  m_pCachedBitmap = image.pBitmap;
+  m_pCachedMask = image.pMask;
+  m_MatteColor = image.MatteColor;
+  m_bCachedDownScaled = image.bDownScaled;
+  m_bCachedDecoded = true;
+  CalcSize();
+}
+
+bool CPDF_ImageCacheEntry::GetDecodedImage(
+    CPDF_ImageCache::Image* pImage) const {
+  if (!m_pCachedBitmap || !m_bCachedDecoded)
+    return false;
+
+  pImage->pBitmap = m_pCachedBitmap.As<CFX_DIBitmap>();
+  pImage->pMask = m_pCachedMask.As<CFX_DIBitmap>();
+  pImage->MatteColor = m_MatteColor;
+  pImage->bDownScaled = m_bCachedDownScaled;
+  return true;
+}
+
+bool CPDF_ImageCacheEntry::IsLargeEnoughFor(int32_t downsampleWidth,
+                                            int32_t downsampleHeight) const {
+  if (!m_pCachedBitmap || !m_bCachedDownScaled)
+    return true;
+
+  // The size is unknown when it is 0, and then only the full image will do.
+  return downsampleWidth && downsampleHeight &&
+         m_pCachedBitmap->GetWidth() >= abs(downsampleWidth) &&
+         m_pCachedBitmap->GetHeight() >= abs(downsampleHeight);
+}
+
+// Huge images stay CPDF_DIBSources that decode rows on demand, with no
+// buffer of their own. They are charged as if decoded, since they keep the
+// stream data and a decoder alive and must not escape the cache limits.
 static uint32_t FPDF_ImageCache_EstimateImageSize(
     const CFX_RetainPtr<CFX_DIBSource>& pDIB) {
-  return pDIB && pDIB->GetBuffer()
-             ? (uint32_t)pDIB->GetHeight() * pDIB->GetPitch() +
-                   (uint32_t)pDIB->GetPaletteSize() * 4
-             : 0;
+  if (!pDIB)
+    return 0;
+
+  FX_SAFE_UINT32 size = pDIB->GetHeight();
+  size *= pDIB->GetPitch();
+  size += pDIB->GetPaletteSize() * 4;
+  return size.ValueOrDefault(UINT32_MAX);
 }
 
 CFX_RetainPtr<CFX_DIBSource> CPDF_ImageCacheEntry::DetachBitmap() {
@@ -74,7 +118,7 @@ int CPDF_ImageCacheEntry::StartGetCachedBitmap(CPDF_Dictionary* pFormResources,
   m_pCurBitmap = pdfium::MakeRetain<CPDF_DIBSource>();
   int ret = m_pCurBitmap.As<CPDF_DIBSource>()->StartLoadDIBSource(
       m_pDocument, m_pStream, true, pFormResources, pPageResources, bStdCS,
-      GroupFamily, bLoadMask);
+      GroupFamily, bLoadMask, downsampleWidth, downsampleHeight);
   if (ret == 2)
     return ret;
 
@@ -88,6 +132,7 @@ int CPDF_ImageCacheEntry::StartGetCachedBitmap(CPDF_Dictionary* pFormResources,
 
 void CPDF_ImageCacheEntry::ContinueGetCachedBitmap() {
   m_MatteColor = m_pCurBitmap.As<CPDF_DIBSource>()->GetMatteColor();
+  m_bCachedDownScaled = m_pCurBitmap.As<CPDF_DIBSource>()->IsDownScaled();
   m_pCurMask = m_pCurBitmap.As<CPDF_DIBSource>()->DetachMask();
   CPDF_RenderContext* pContext = m_pRenderStatus->GetContext();
   CPDF_PageRenderCache* pPageRenderCache = pContext->GetPageCache();
@@ -96,8 +141,10 @@ void CPDF_ImageCacheEntry::ContinueGetCachedBitmap() {
       FPDF_HUGE_IMAGE_SIZE) {
     m_pCachedBitmap = m_pCurBitmap->Clone(nullptr);
     m_pCurBitmap.Reset();
+    m_bCachedDecoded = true;
   } else {
     m_pCachedBitmap = m_pCurBitmap;
+    m_bCachedDecoded = false;
   }
   if (m_pCurMask) {
     m_pCachedMask = m_pCurMask->Clone(nullptr);
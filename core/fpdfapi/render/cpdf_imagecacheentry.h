@@ -9,6 +9,7 @@
 
 #include <memory>
 
+#include "core/fpdfapi/render/cpdf_imagecache.h"
 #include "core/fxcrt/cfx_retain_ptr.h"
 #include "core/fxcrt/fx_system.h"
 
@@ -26,7 +27,17 @@ class CPDF_ImageCacheEntry {
   ~CPDF_ImageCacheEntry();
 
   void Reset(const CFX_RetainPtr<CFX_DIBitmap>& pBitmap);
+  // Takes |image| from the shared cache as the cached bitmap. It is drawn as
+  // it is and never modified.
+  void SetDecodedImage(const CPDF_ImageCache::Image& image);
+  // Copies the cached bitmap to |pImage|. Returns false unless it is fully
+  // decoded: huge images decode rows on demand and so are not shareable.
+  bool GetDecodedImage(CPDF_ImageCache::Image* pImage) const;
   uint32_t EstimateSize() const { return m_dwCacheSize; }
+  // Whether the cached image has enough pixels to be drawn at
+  // |downsampleWidth| by |downsampleHeight|.
+  bool IsLargeEnoughFor(int32_t downsampleWidth,
+                        int32_t downsampleHeight) const;
   uint32_t GetTimeCount() const { return m_dwTimeCount; }
   CPDF_Stream* GetStream() const { return m_pStream; }
 
@@ -56,6 +67,9 @@ class CPDF_ImageCacheEntry {
   CFX_RetainPtr<CFX_DIBSource> m_pCurMask;
   CFX_RetainPtr<CFX_DIBSource> m_pCachedBitmap;
   CFX_RetainPtr<CFX_DIBSource> m_pCachedMask;
+  bool m_bCachedDownScaled;
+  // Whether |m_pCachedBitmap| is a CFX_DIBitmap rather than a CPDF_DIBSource.
+  bool m_bCachedDecoded;
   uint32_t m_dwCacheSize;
 };
 
@@ -63,6 +63,14 @@ bool CPDF_ImageRenderer::StartLoadDIBSource() {
       m_ImageMatrix.a >= 0 ? image_rect.Width() : -image_rect.Width();
   int dest_height =
       m_ImageMatrix.d <= 0 ? image_rect.Height() : -image_rect.Height();
+  if (m_ImageMatrix.b != 0 || m_ImageMatrix.c != 0) {
+    // The bounding box does not follow the image axes, so use the length each
+    // axis has on the device to decide how many pixels are needed.
+    dest_width = static_cast<int>(
+        ceil(FXSYS_sqrt2(m_ImageMatrix.a, m_ImageMatrix.b)));
+    dest_height = static_cast<int>(
+        ceil(FXSYS_sqrt2(m_ImageMatrix.c, m_ImageMatrix.d)));
+  }
   if (m_Loader.Start(
           m_pImageObject, m_pRenderStatus->m_pContext->GetPageCache(), m_bStdCS,
           m_pRenderStatus->m_GroupFamily, m_pRenderStatus->m_bLoadMask,
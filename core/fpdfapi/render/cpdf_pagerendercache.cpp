@@ -6,9 +6,15 @@
 
 #include "core/fpdfapi/render/cpdf_pagerendercache.h"
 
+#include <utility>
+
 #include "core/fpdfapi/page/cpdf_page.h"
+#include "core/fpdfapi/parser/cpdf_document.h"
+#include "core/fpdfapi/parser/cpdf_stream.h"
+#include "core/fpdfapi/render/cpdf_docrenderdata.h"
 #include "core/fpdfapi/render/cpdf_imagecacheentry.h"
 #include "core/fpdfapi/render/cpdf_renderstatus.h"
+#include "third_party/base/ptr_util.h"
 
 namespace {
 
@@ -30,7 +36,9 @@ CPDF_PageRenderCache::CPDF_PageRenderCache(CPDF_Page* pPage)
       m_pCurImageCacheEntry(nullptr),
       m_nTimeCount(0),
       m_nCacheSize(0),
-      m_bCurFindCache(false) {}
+      m_bCurFindCache(false),
+      m_CurKey(),
+      m_bCurShared(false) {}
 
 CPDF_PageRenderCache::~CPDF_PageRenderCache() {
   for (const auto& it : m_ImageCache)
@@ -87,10 +95,35 @@ bool CPDF_PageRenderCache::StartGetCachedBitmap(
     CPDF_RenderStatus* pRenderStatus,
     int32_t downsampleWidth,
     int32_t downsampleHeight) {
-  const auto it = m_ImageCache.find(pStream);
+  m_bCurShared = false;
+  auto it = m_ImageCache.find(pStream);
+  // An image decoded at a reduced resolution for a smaller size than this
+  // one is loaded again, and the new one replaces it.
+  if (it != m_ImageCache.end() &&
+      !it->second->IsLargeEnoughFor(downsampleWidth, downsampleHeight)) {
+    ClearImageCacheEntry(pStream);
+    it = m_ImageCache.end();
+  }
   m_bCurFindCache = it != m_ImageCache.end();
   if (m_bCurFindCache) {
     m_pCurImageCacheEntry = it->second;
+  } else if (CPDF_ImageCache* pImageCache = GetSharedImageCache(pStream)) {
+    m_bCurShared = true;
+    m_CurKey.objnum = pStream->GetObjNum();
+    m_CurKey.bStdCS = bStdCS;
+    m_CurKey.GroupFamily = GroupFamily;
+    m_CurKey.bLoadMask = bLoadMask;
+    // The shared image is drawn through an entry of this page's own, so
+    // nothing shared is touched while drawing it.
+    m_pPendingEntry =
+        pdfium::MakeUnique<CPDF_ImageCacheEntry>(m_pPage->m_pDocument, pStream);
+    m_pCurImageCacheEntry = m_pPendingEntry.get();
+    CPDF_ImageCache::Image image;
+    if (pImageCache->Find(m_CurKey, pStream, &image, downsampleWidth,
+                          downsampleHeight)) {
+      m_pCurImageCacheEntry->SetDecodedImage(image);
+      m_bCurFindCache = true;
+    }
   } else {
     m_pCurImageCacheEntry =
         new CPDF_ImageCacheEntry(m_pPage->m_pDocument, pStream);
@@ -101,13 +134,7 @@ bool CPDF_PageRenderCache::StartGetCachedBitmap(
   if (ret == 2)
     return true;
 
-  m_nTimeCount++;
-  if (!m_bCurFindCache)
-    m_ImageCache[pStream] = m_pCurImageCacheEntry;
-
-  if (!ret)
-    m_nCacheSize += m_pCurImageCacheEntry->EstimateSize();
-
+  FinishGetCachedBitmap(ret);
   return false;
 }
 
@@ -116,17 +143,52 @@ bool CPDF_PageRenderCache::Continue(IFX_Pause* pPause) {
   if (ret == 2)
     return true;
 
+  FinishGetCachedBitmap(ret);
+  return false;
+}
+
+CPDF_ImageCache* CPDF_PageRenderCache::GetSharedImageCache(
+    CPDF_Stream* pStream) const {
+  // Inline images and images that are not in the document yet have no
+  // object number to share them by.
+  if (!pStream->GetObjNum())
+    return nullptr;
+
+  CPDF_ImageCache* pImageCache =
+      m_pPage->m_pDocument->GetRenderData()->GetImageCache();
+  return pImageCache->GetLimit() ? pImageCache : nullptr;
+}
+
+void CPDF_PageRenderCache::FinishGetCachedBitmap(int ret) {
   m_nTimeCount++;
+  if (m_bCurShared) {
+    if (m_bCurFindCache)
+      return;
+
+    // Only fully decoded images are shared, so no other page ever finds one
+    // that is still loading or that decodes rows as it is drawn. Huge images
+    // stay with this page instead, like inline images.
+    CPDF_ImageCache::Image image;
+    if (m_pPendingEntry->GetDecodedImage(&image)) {
+      m_pPage->m_pDocument->GetRenderData()->GetImageCache()->Add(
+          m_CurKey, m_pPendingEntry->GetStream(), image,
+          m_pPendingEntry->EstimateSize());
+      return;
+    }
+    m_pCurImageCacheEntry = m_pPendingEntry.release();
+  }
+
   if (!m_bCurFindCache)
     m_ImageCache[m_pCurImageCacheEntry->GetStream()] = m_pCurImageCacheEntry;
   if (!ret)
     m_nCacheSize += m_pCurImageCacheEntry->EstimateSize();
-  return false;
 }
 
 void CPDF_PageRenderCache::ResetBitmap(
     CPDF_Stream* pStream,
     const CFX_RetainPtr<CFX_DIBitmap>& pBitmap) {
+  m_pPage->m_pDocument->GetRenderData()->GetImageCache()->Remove(pStream);
+
   CPDF_ImageCacheEntry* pEntry;
   const auto it = m_ImageCache.find(pStream);
   if (it == m_ImageCache.end()) {
@@ -8,12 +8,14 @@
 #define CORE_FPDFAPI_RENDER_CPDF_PAGERENDERCACHE_H_
 
 #include <map>
+#include <memory>
 
+#include "core/fpdfapi/render/cpdf_imagecache.h"
 #include "core/fxcrt/cfx_retain_ptr.h"
 #include "core/fxcrt/fx_system.h"
 
-class CPDF_Stream;
 class CPDF_ImageCacheEntry;
+class CPDF_Stream;
 class CPDF_Page;
 class CPDF_RenderStatus;
 class CFX_DIBitmap;
@@ -47,10 +49,20 @@ class CPDF_PageRenderCache {
 
  private:
   void ClearImageCacheEntry(CPDF_Stream* pStream);
+  // Returns the document-wide cache to use for |pStream|, or nullptr to keep
+  // it in |m_ImageCache|.
+  CPDF_ImageCache* GetSharedImageCache(CPDF_Stream* pStream) const;
+  void FinishGetCachedBitmap(int ret);
 
   CPDF_Page* const m_pPage;
   CPDF_ImageCacheEntry* m_pCurImageCacheEntry;
   std::map<CPDF_Stream*, CPDF_ImageCacheEntry*> m_ImageCache;
+  // The entry drawing the current image when it belongs in the shared cache.
+  // It is loaded here and then copied to the shared cache, or takes the image
+  // found there.
+  std::unique_ptr<CPDF_ImageCacheEntry> m_pPendingEntry;
+  CPDF_ImageCache::Key m_CurKey;
+  bool m_bCurShared;
   uint32_t m_nTimeCount;
   uint32_t m_nCacheSize;
   bool m_bCurFindCache;
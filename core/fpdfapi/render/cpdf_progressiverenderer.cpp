@@ -6,6 +6,8 @@
 
 #include "core/fpdfapi/render/cpdf_progressiverenderer.h"
 
+#include <iterator>
+
 #include "core/fpdfapi/page/cpdf_image.h"
 #include "core/fpdfapi/page/cpdf_imageobject.h"
 #include "core/fpdfapi/page/cpdf_pageobject.h"
@@ -13,6 +15,7 @@
 #include "core/fpdfapi/render/cpdf_pagerendercache.h"
 #include "core/fpdfapi/render/cpdf_renderoptions.h"
 #include "core/fpdfapi/render/cpdf_renderstatus.h"
+#include "core/fxcrt/cfx_rectindex.h"
 #include "core/fxge/cfx_renderdevice.h"
 #include "third_party/base/ptr_util.h"
 
@@ -25,7 +28,9 @@ CPDF_ProgressiveRenderer::CPDF_ProgressiveRenderer(
       m_pDevice(pDevice),
       m_pOptions(pOptions),
       m_LayerIndex(0),
-      m_pCurrentLayer(nullptr) {}
+      m_pCurrentLayer(nullptr),
+      m_bUseObjectIndex(false),
+      m_nIndexedObjectsRendered(0) {}
 
 CPDF_ProgressiveRenderer::~CPDF_ProgressiveRenderer() {
   if (m_pRenderStatus)
@@ -60,16 +65,15 @@ void CPDF_ProgressiveRenderer::Continue(IFX_Pause* pPause) {
       CFX_Matrix device2object;
       device2object.SetReverse(m_pCurrentLayer->m_Matrix);
       device2object.TransformRect(m_ClipRect);
+      const CFX_RectIndex* pIndex =
+          m_pCurrentLayer->m_pObjectHolder->GetObjectIndex();
+      m_bUseObjectIndex =
+          pIndex && pIndex->GetCandidates(m_ClipRect, &m_IndexedObjects);
+      m_nIndexedObjectsRendered = 0;
     }
-    CPDF_PageObjectList::iterator iter;
+    CPDF_PageObjectList::iterator iter = GetNextObject();
     CPDF_PageObjectList::iterator iterEnd =
         m_pCurrentLayer->m_pObjectHolder->GetPageObjectList()->end();
-    if (m_LastObjectRendered != iterEnd) {
-      iter = m_LastObjectRendered;
-      ++iter;
-    } else {
-      iter = m_pCurrentLayer->m_pObjectHolder->GetPageObjectList()->begin();
-    }
     int nObjsToGo = kStepLimit;
     while (iter != iterEnd) {
       CPDF_PageObject* pCurObj = iter->get();
@@ -92,6 +96,7 @@ void CPDF_ProgressiveRenderer::Continue(IFX_Pause* pPause) {
           --nObjsToGo;
       }
       m_LastObjectRendered = iter;
+      ++m_nIndexedObjectsRendered;
       if (nObjsToGo == 0) {
         if (pPause && pPause->NeedToPauseNow())
           return;
@@ -101,7 +106,7 @@ void CPDF_ProgressiveRenderer::Continue(IFX_Pause* pPause) {
           (m_pOptions->m_Flags & RENDER_BREAKFORMASKS)) {
         return;
       }
-      ++iter;
+      iter = GetNextObject();
     }
     if (m_pCurrentLayer->m_pObjectHolder->IsParsed()) {
       m_pRenderStatus.reset();
@@ -118,3 +123,16 @@ void CPDF_ProgressiveRenderer::Continue(IFX_Pause* pPause) {
     }
   }
 }
+
+CPDF_PageObjectList::iterator CPDF_ProgressiveRenderer::GetNextObject() {
+  CPDF_PageObjectList* pObjectList =
+      m_pCurrentLayer->m_pObjectHolder->GetPageObjectList();
+  if (m_bUseObjectIndex) {
+    if (m_nIndexedObjectsRendered >= m_IndexedObjects.size())
+      return pObjectList->end();
+    return pObjectList->begin() + m_IndexedObjects[m_nIndexedObjectsRendered];
+  }
+  if (m_LastObjectRendered == pObjectList->end())
+    return pObjectList->begin();
+  return std::next(m_LastObjectRendered);
+}
@@ -8,6 +8,7 @@
 #define CORE_FPDFAPI_RENDER_CPDF_PROGRESSIVERENDERER_H_
 
 #include <memory>
+#include <vector>
 
 #include "core/fpdfapi/page/cpdf_pageobjectlist.h"
 #include "core/fpdfapi/render/cpdf_rendercontext.h"
@@ -46,6 +47,8 @@ class CPDF_ProgressiveRenderer {
   // Maximum page objects to render before checking for pause.
   static const int kStepLimit = 100;
 
+  CPDF_PageObjectList::iterator GetNextObject();
+
   Status m_Status;
   CPDF_RenderContext* const m_pContext;
   CFX_RenderDevice* const m_pDevice;
@@ -55,6 +58,11 @@ class CPDF_ProgressiveRenderer {
   uint32_t m_LayerIndex;
   CPDF_RenderContext::Layer* m_pCurrentLayer;
   CPDF_PageObjectList::iterator m_LastObjectRendered;
+  // When the layer has an object index, the positions of the objects that
+  // may intersect |m_ClipRect|, and how many of them have been rendered.
+  bool m_bUseObjectIndex;
+  std::vector<uint32_t> m_IndexedObjects;
+  size_t m_nIndexedObjectsRendered;
 };
 
 #endif  // CORE_FPDFAPI_RENDER_CPDF_PROGRESSIVERENDERER_H_
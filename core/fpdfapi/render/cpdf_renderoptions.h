@@ -29,6 +29,7 @@
 #define RENDER_OVERPRINT 0x00000400
 #define RENDER_THINLINE 0x00000800
 #define RENDER_BREAKFORMASKS 0x00001000
+#define RENDER_NO_THREADS 0x00002000
 #define RENDER_NOTEXTSMOOTH 0x10000000
 #define RENDER_NOPATHSMOOTH 0x20000000
 #define RENDER_NOIMAGESMOOTH 0x40000000
@@ -7,7 +7,9 @@
 #include "core/fpdfapi/render/cpdf_renderstatus.h"
 
 #include <algorithm>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <vector>
 
@@ -47,6 +49,8 @@
 #include "core/fpdfdoc/cpdf_occontext.h"
 #include "core/fxcodec/fx_codec.h"
 #include "core/fxcrt/cfx_maybe_owned.h"
+#include "core/fxcrt/cfx_rectindex.h"
+#include "core/fxcrt/cfx_threadpool.h"
 #include "core/fxcrt/fx_safe_types.h"
 #include "core/fxge/cfx_fxgedevice.h"
 #include "core/fxge/cfx_graphstatedata.h"
@@ -61,6 +65,12 @@
 #include "core/fxge/skia/fx_skia_device.h"
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SHADING_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 #define SHADING_STEPS 256
 
 namespace {
@@ -98,12 +108,268 @@ uint32_t CountOutputs(
   return total;
 }
 
+// Fills |rgb_array| with the colours of a shading with one input at
+// SHADING_STEPS points evenly spaced from |t_min| towards |t_max|.
+void GetShadingSteps(float t_min,
+                     float t_max,
+                     const std::vector<std::unique_ptr<CPDF_Function>>& funcs,
+                     CPDF_ColorSpace* pCS,
+                     int alpha,
+                     uint32_t* rgb_array) {
+  float inputs[SHADING_STEPS];
+  for (int i = 0; i < SHADING_STEPS; i++)
+    inputs[i] = (t_max - t_min) * i / SHADING_STEPS + t_min;
+
+  // Evaluate each function for all the steps at once, then gather the
+  // results of the functions step by step.
+  std::vector<std::vector<float>> func_results;
+  for (const auto& func : funcs) {
+    if (!func)
+      continue;
+    std::vector<float> results(SHADING_STEPS * func->CountOutputs());
+    int nresults;
+    if (func->CallBatch(inputs, 1, SHADING_STEPS, results.data(), &nresults))
+      func_results.push_back(std::move(results));
+  }
+  uint32_t total_results =
+      std::max(CountOutputs(funcs), pCS->CountComponents());
+  CFX_FixedBufGrow<float, 16> result_array(total_results);
+  float* pResults = result_array;
+  memset(pResults, 0, total_results * sizeof(float));
+  for (int i = 0; i < SHADING_STEPS; i++) {
+    float* pDest = pResults;
+    for (const auto& results : func_results) {
+      size_t nresults = results.size() / SHADING_STEPS;
+      std::copy(results.begin() + i * nresults,
+                results.begin() + (i + 1) * nresults, pDest);
+      pDest += nresults;
+    }
+    float R = 0.0f;
+    float G = 0.0f;
+    float B = 0.0f;
+    pCS->GetRGB(pResults, &R, &G, &B);
+    rgb_array[i] =
+        FXARGB_TODIB(FXARGB_MAKE(alpha, FXSYS_round(R * 255),
+                                 FXSYS_round(G * 255), FXSYS_round(B * 255)));
+  }
+}
+
+// Shadings of at least this many pixels are drawn on several threads, which
+// take bands of about this many rows at a time.
+const int kMinThreadedShadingPixels = 256 * 256;
+const int kShadingBandRows = 32;
+
+// Calls |draw_rows(top, bottom, worker)| for bands of |band_rows| rows that
+// together cover [0, |height|), on up to |nThreads| threads. No two threads
+// use the same |worker| at once, and it is below |nThreads|.
+void DrawShadingRows(size_t nThreads,
+                     int width,
+                     int height,
+                     int band_rows,
+                     const std::function<void(int, int, size_t)>& draw_rows) {
+  int nBands = (height + band_rows - 1) / band_rows;
+  if (nThreads < 2 || nBands < 2 ||
+      static_cast<int64_t>(width) * height < kMinThreadedShadingPixels) {
+    draw_rows(0, height, 0);
+    return;
+  }
+
+  CFX_ThreadPool pool(std::min(nThreads, static_cast<size_t>(nBands)));
+  pool.Run(nBands,
+           [band_rows, height, &draw_rows](size_t index, size_t worker) {
+             int top = static_cast<int>(index) * band_rows;
+             draw_rows(top, std::min(top + band_rows, height), worker);
+           });
+}
+
+#if defined(SHADING_USE_SSE2)
+// Sets the four pixels at |dest| to the colours at the indices in |index|,
+// except in the lanes set in |skip|. Indices outside the table are clamped
+// to it where the shading extends that way, and skipped otherwise, like the
+// scalar loops do.
+void StoreShadingPixelsSSE2(__m128i index,
+                            __m128i skip,
+                            bool bStartExtend,
+                            bool bEndExtend,
+                            const uint32_t* rgb_array,
+                            uint32_t* dest) {
+  const __m128i last = _mm_set1_epi32(SHADING_STEPS - 1);
+  __m128i below = _mm_cmplt_epi32(index, _mm_setzero_si128());
+  __m128i above = _mm_cmpgt_epi32(index, last);
+  if (!bStartExtend)
+    skip = _mm_or_si128(skip, below);
+  if (!bEndExtend)
+    skip = _mm_or_si128(skip, above);
+  index = _mm_andnot_si128(below, index);
+  index = _mm_or_si128(_mm_and_si128(above, last),
+                       _mm_andnot_si128(above, index));
+
+  int32_t indices[4];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(indices), index);
+  int skipped = _mm_movemask_ps(_mm_castsi128_ps(skip));
+  for (int i = 0; i < 4; i++) {
+    if (!(skipped & (1 << i)))
+      dest[i] = rgb_array[indices[i]];
+  }
+}
+
+// Draws the pixels of an axial shading row four at a time, with the same
+// arithmetic as the scalar loop. Returns the first column left to draw.
+int DrawAxialRowSSE2(uint32_t* dib_buf,
+                     int width,
+                     float row_index,
+                     float index_dx,
+                     bool bStartExtend,
+                     bool bEndExtend,
+                     const uint32_t* rgb_array) {
+  const __m128 origin = _mm_set1_ps(row_index);
+  const __m128 step = _mm_set1_ps(index_dx);
+  const __m128i four = _mm_set1_epi32(4);
+  __m128i columns = _mm_setr_epi32(0, 1, 2, 3);
+  int column = 0;
+  for (; column + 4 <= width; column += 4) {
+    __m128 index =
+        _mm_add_ps(origin, _mm_mul_ps(_mm_cvtepi32_ps(columns), step));
+    StoreShadingPixelsSSE2(_mm_cvttps_epi32(index), _mm_setzero_si128(),
+                           bStartExtend, bEndExtend, rgb_array,
+                           dib_buf + column);
+    columns = _mm_add_epi32(columns, four);
+  }
+  return column;
+}
+
+// What a radial shading row needs beyond its start position, with positions
+// relative to the start circle.
+struct RadialShadingRow {
+  float matrix_a;
+  float matrix_b;
+  float a;
+  float dx;
+  float dy;
+  float dr;
+  float start_r;
+  bool bDecreasing;
+  bool bStartExtend;
+  bool bEndExtend;
+};
+
+__m128 SelectSSE2(__m128 mask, __m128 a, __m128 b) {
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Draws the pixels of a radial shading row four at a time, with the same
+// arithmetic as the scalar loop. Only for circles whose radius changes at a
+// different rate than their distance from the start, that is |row.a| != 0.
+// Returns the first column left to draw.
+int DrawRadialRowSSE2(uint32_t* dib_buf,
+                      int width,
+                      float row_x,
+                      float row_y,
+                      const RadialShadingRow& row,
+                      const uint32_t* rgb_array) {
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 sign = _mm_set1_ps(-0.0f);
+  const __m128 origin_x = _mm_set1_ps(row_x);
+  const __m128 origin_y = _mm_set1_ps(row_y);
+  const __m128 step_x = _mm_set1_ps(row.matrix_a);
+  const __m128 step_y = _mm_set1_ps(row.matrix_b);
+  const __m128 a = _mm_set1_ps(row.a);
+  const __m128 two_a = _mm_set1_ps(2 * row.a);
+  const __m128 dx = _mm_set1_ps(row.dx);
+  const __m128 dy = _mm_set1_ps(row.dy);
+  const __m128 dr = _mm_set1_ps(row.dr);
+  const __m128 start_r = _mm_set1_ps(row.start_r);
+  const __m128 start_r_dr = _mm_set1_ps(row.start_r * row.dr);
+  const __m128 start_r_square = _mm_set1_ps(row.start_r * row.start_r);
+  const __m128 minus_two = _mm_set1_ps(-2.0f);
+  const __m128 four = _mm_set1_ps(4.0f);
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 steps = _mm_set1_ps(SHADING_STEPS - 1);
+  const __m128i four_columns = _mm_set1_epi32(4);
+  __m128i columns = _mm_setr_epi32(0, 1, 2, 3);
+  int column = 0;
+  for (; column + 4 <= width; column += 4) {
+    __m128 column_f = _mm_cvtepi32_ps(columns);
+    columns = _mm_add_epi32(columns, four_columns);
+    __m128 pos_x = _mm_add_ps(origin_x, _mm_mul_ps(step_x, column_f));
+    __m128 pos_y = _mm_add_ps(origin_y, _mm_mul_ps(step_y, column_f));
+    __m128 b = _mm_mul_ps(
+        minus_two,
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(pos_x, dx), _mm_mul_ps(pos_y, dy)),
+                   start_r_dr));
+    __m128 c = _mm_sub_ps(
+        _mm_add_ps(_mm_mul_ps(pos_x, pos_x), _mm_mul_ps(pos_y, pos_y)),
+        start_r_square);
+    __m128 b2_4ac =
+        _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(four, _mm_mul_ps(a, c)));
+    __m128 skip = _mm_cmplt_ps(b2_4ac, zero);
+    __m128 root = _mm_sqrt_ps(b2_4ac);
+    __m128 minus_b = _mm_xor_ps(b, sign);
+    __m128 low = _mm_div_ps(_mm_sub_ps(minus_b, root), two_a);
+    __m128 high = _mm_div_ps(_mm_add_ps(minus_b, root), two_a);
+    __m128 s1 = row.a > 0 ? low : high;
+    __m128 s2 = row.a > 0 ? high : low;
+    __m128 s;
+    if (row.bDecreasing) {
+      s = row.bStartExtend ? s1 : SelectSSE2(_mm_cmpge_ps(s1, zero), s1, s2);
+    } else {
+      s = row.bEndExtend ? s2 : SelectSSE2(_mm_cmple_ps(s2, one), s2, s1);
+    }
+    skip = _mm_or_ps(
+        skip, _mm_cmplt_ps(_mm_add_ps(start_r, _mm_mul_ps(s, dr)), zero));
+    StoreShadingPixelsSSE2(_mm_cvttps_epi32(_mm_mul_ps(s, steps)),
+                           _mm_castps_si128(skip), row.bStartExtend,
+                           row.bEndExtend, rgb_array, dib_buf + column);
+  }
+  return column;
+}
+
+// Sets pixels [|left|, |right|) of |dib_buf| to colours interpolated from
+// |from| towards |to| across them, four at a time, with the same arithmetic
+// as the scalar loop. Returns the first column left to draw.
+int InterpolateRowSSE2(uint32_t* dib_buf,
+                       int left,
+                       int right,
+                       const float* from,
+                       const float* to,
+                       int alpha) {
+  const __m128 width = _mm_set1_ps(static_cast<float>(right - left));
+  const __m128 scale = _mm_set1_ps(255.0f);
+  const __m128i alpha_bits = _mm_set1_epi32(static_cast<uint32_t>(alpha)
+                                            << 24);
+  const __m128i four = _mm_set1_epi32(4);
+  __m128 start[3];
+  __m128 span[3];
+  for (int i = 0; i < 3; i++) {
+    start[i] = _mm_set1_ps(from[i]);
+    span[i] = _mm_set1_ps(to[i] - from[i]);
+  }
+  __m128i offsets = _mm_setr_epi32(0, 1, 2, 3);
+  int column = left;
+  for (; column + 4 <= right; column += 4) {
+    __m128 s = _mm_div_ps(_mm_cvtepi32_ps(offsets), width);
+    offsets = _mm_add_epi32(offsets, four);
+    __m128i channels[3];
+    for (int i = 0; i < 3; i++) {
+      channels[i] = _mm_cvttps_epi32(_mm_mul_ps(
+          _mm_add_ps(start[i], _mm_mul_ps(span[i], s)), scale));
+    }
+    __m128i argb = _mm_or_si128(
+        _mm_or_si128(alpha_bits, _mm_slli_epi32(channels[0], 16)),
+        _mm_or_si128(_mm_slli_epi32(channels[1], 8), channels[2]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dib_buf + column), argb);
+  }
+  return column;
+}
+#endif  // defined(SHADING_USE_SSE2)
+
 void DrawAxialShading(const CFX_RetainPtr<CFX_DIBitmap>& pBitmap,
                       CFX_Matrix* pObject2Bitmap,
                       CPDF_Dictionary* pDict,
                       const std::vector<std::unique_ptr<CPDF_Function>>& funcs,
                       CPDF_ColorSpace* pCS,
-                      int alpha) {
+                      int alpha,
+                      size_t nThreads) {
   ASSERT(pBitmap->GetFormat() == FXDIB_Argb);
   CPDF_Array* pCoords = pDict->GetArrayFor("Coords");
   if (!pCoords)
@@ -134,54 +400,44 @@ void DrawAxialShading(const CFX_RetainPtr<CFX_DIBitmap>& pBitmap,
   float axis_len_square = (x_span * x_span) + (y_span * y_span);
   CFX_Matrix matrix;
   matrix.SetReverse(*pObject2Bitmap);
-  uint32_t total_results =
-      std::max(CountOutputs(funcs), pCS->CountComponents());
-  CFX_FixedBufGrow<float, 16> result_array(total_results);
-  float* pResults = result_array;
-  memset(pResults, 0, total_results * sizeof(float));
   uint32_t rgb_array[SHADING_STEPS];
-  for (int i = 0; i < SHADING_STEPS; i++) {
-    float input = (t_max - t_min) * i / SHADING_STEPS + t_min;
-    int offset = 0;
-    for (const auto& func : funcs) {
-      if (func) {
-        int nresults = 0;
-        if (func->Call(&input, 1, pResults + offset, &nresults))
-          offset += nresults;
-      }
-    }
-    float R = 0.0f;
-    float G = 0.0f;
-    float B = 0.0f;
-    pCS->GetRGB(pResults, &R, &G, &B);
-    rgb_array[i] =
-        FXARGB_TODIB(FXARGB_MAKE(alpha, FXSYS_round(R * 255),
-                                 FXSYS_round(G * 255), FXSYS_round(B * 255)));
-  }
+  GetShadingSteps(t_min, t_max, funcs, pCS, alpha, rgb_array);
+  // The table index is an affine function of the pixel position, so step it
+  // along each row instead of transforming every pixel.
+  float index_scale = (SHADING_STEPS - 1) / axis_len_square;
+  float index_dx = (matrix.a * x_span + matrix.b * y_span) * index_scale;
+  float index_dy = (matrix.c * x_span + matrix.d * y_span) * index_scale;
+  float index_origin =
+      ((matrix.e - start_x) * x_span + (matrix.f - start_y) * y_span) *
+      index_scale;
   int pitch = pBitmap->GetPitch();
-  for (int row = 0; row < height; row++) {
-    uint32_t* dib_buf = (uint32_t*)(pBitmap->GetBuffer() + row * pitch);
-    for (int column = 0; column < width; column++) {
-      CFX_PointF pos = matrix.Transform(
-          CFX_PointF(static_cast<float>(column), static_cast<float>(row)));
-      float scale =
-          (((pos.x - start_x) * x_span) + ((pos.y - start_y) * y_span)) /
-          axis_len_square;
-      int index = (int32_t)(scale * (SHADING_STEPS - 1));
-      if (index < 0) {
-        if (!bStartExtend)
-          continue;
+  auto draw_rows = [&](int top, int bottom, size_t worker) {
+    for (int row = top; row < bottom; row++) {
+      uint32_t* dib_buf = (uint32_t*)(pBitmap->GetBuffer() + row * pitch);
+      float row_index = index_origin + row * index_dy;
+      int column = 0;
+#if defined(SHADING_USE_SSE2)
+      column = DrawAxialRowSSE2(dib_buf, width, row_index, index_dx,
+                                bStartExtend, bEndExtend, rgb_array);
+#endif
+      for (; column < width; column++) {
+        int index = (int32_t)(row_index + column * index_dx);
+        if (index < 0) {
+          if (!bStartExtend)
+            continue;
 
-        index = 0;
-      } else if (index >= SHADING_STEPS) {
-        if (!bEndExtend)
-          continue;
+          index = 0;
+        } else if (index >= SHADING_STEPS) {
+          if (!bEndExtend)
+            continue;
 
-        index = SHADING_STEPS - 1;
+          index = SHADING_STEPS - 1;
+        }
+        dib_buf[column] = rgb_array[index];
       }
-      dib_buf[column] = rgb_array[index];
     }
-  }
+  };
+  DrawShadingRows(nThreads, width, height, kShadingBandRows, draw_rows);
 }
 
 void DrawRadialShading(const CFX_RetainPtr<CFX_DIBitmap>& pBitmap,
@@ -189,7 +445,8 @@ void DrawRadialShading(const CFX_RetainPtr<CFX_DIBitmap>& pBitmap,
                        CPDF_Dictionary* pDict,
                        const std::vector<std::unique_ptr<CPDF_Function>>& funcs,
                        CPDF_ColorSpace* pCS,
-                       int alpha) {
+                       int alpha,
+                       size_t nThreads) {
   ASSERT(pBitmap->GetFormat() == FXDIB_Argb);
   CPDF_Array* pCoords = pDict->GetArrayFor("Coords");
   if (!pCoords)
@@ -217,30 +474,8 @@ void DrawRadialShading(const CFX_RetainPtr<CFX_DIBitmap>& pBitmap,
     bStartExtend = !!pArray->GetIntegerAt(0);
     bEndExtend = !!pArray->GetIntegerAt(1);
   }
-  uint32_t total_results =
-      std::max(CountOutputs(funcs), pCS->CountComponents());
-  CFX_FixedBufGrow<float, 16> result_array(total_results);
-  float* pResults = result_array;
-  memset(pResults, 0, total_results * sizeof(float));
   uint32_t rgb_array[SHADING_STEPS];
-  for (int i = 0; i < SHADING_STEPS; i++) {
-    float input = (t_max - t_min) * i / SHADING_STEPS + t_min;
-    int offset = 0;
-    for (const auto& func : funcs) {
-      if (func) {
-        int nresults;
-        if (func->Call(&input, 1, pResults + offset, &nresults))
-          offset += nresults;
-      }
-    }
-    float R = 0.0f;
-    float G = 0.0f;
-    float B = 0.0f;
-    pCS->GetRGB(pResults, &R, &G, &B);
-    rgb_array[i] =
-        FXARGB_TODIB(FXARGB_MAKE(alpha, FXSYS_round(R * 255),
-                                 FXSYS_round(G * 255), FXSYS_round(B * 255)));
-  }
+  GetShadingSteps(t_min, t_max, funcs, pCS, alpha, rgb_array);
   float a = ((start_x - end_x) * (start_x - end_x)) +
             ((start_y - end_y) * (start_y - end_y)) -
             ((start_r - end_r) * (start_r - end_r));
@@ -255,64 +490,426 @@ void DrawRadialShading(const CFX_RetainPtr<CFX_DIBitmap>& pBitmap,
       bDecreasing = true;
     }
   }
-  for (int row = 0; row < height; row++) {
-    uint32_t* dib_buf = (uint32_t*)(pBitmap->GetBuffer() + row * pitch);
-    for (int column = 0; column < width; column++) {
-      CFX_PointF pos = matrix.Transform(
-          CFX_PointF(static_cast<float>(column), static_cast<float>(row)));
-      float b = -2 * (((pos.x - start_x) * (end_x - start_x)) +
-                      ((pos.y - start_y) * (end_y - start_y)) +
-                      (start_r * (end_r - start_r)));
-      float c = ((pos.x - start_x) * (pos.x - start_x)) +
-                ((pos.y - start_y) * (pos.y - start_y)) - (start_r * start_r);
-      float s;
-      if (a == 0) {
-        s = -c / b;
-      } else {
-        float b2_4ac = (b * b) - 4 * (a * c);
-        if (b2_4ac < 0) {
-          continue;
-        }
-        float root = sqrt(b2_4ac);
-        float s1, s2;
-        if (a > 0) {
-          s1 = (-b - root) / (2 * a);
-          s2 = (-b + root) / (2 * a);
+  float dx = end_x - start_x;
+  float dy = end_y - start_y;
+  float dr = end_r - start_r;
+#if defined(SHADING_USE_SSE2)
+  const RadialShadingRow row_params = {
+      matrix.a, matrix.b,    a,            dx,        dy, dr,
+      start_r,  bDecreasing, bStartExtend, bEndExtend};
+#endif
+  auto draw_rows = [&](int top, int bottom, size_t worker) {
+    for (int row = top; row < bottom; row++) {
+      uint32_t* dib_buf = (uint32_t*)(pBitmap->GetBuffer() + row * pitch);
+      // Positions relative to the start circle, stepped along the row.
+      float row_x = matrix.c * row + matrix.e - start_x;
+      float row_y = matrix.d * row + matrix.f - start_y;
+      int column = 0;
+#if defined(SHADING_USE_SSE2)
+      if (a != 0) {
+        column = DrawRadialRowSSE2(dib_buf, width, row_x, row_y, row_params,
+                                   rgb_array);
+      }
+#endif
+      for (; column < width; column++) {
+        float pos_x = row_x + matrix.a * column;
+        float pos_y = row_y + matrix.b * column;
+        float b = -2 * ((pos_x * dx) + (pos_y * dy) + (start_r * dr));
+        float c = (pos_x * pos_x) + (pos_y * pos_y) - (start_r * start_r);
+        float s;
+        if (a == 0) {
+          s = -c / b;
         } else {
-          s2 = (-b - root) / (2 * a);
-          s1 = (-b + root) / (2 * a);
-        }
-        if (bDecreasing) {
-          if (s1 >= 0 || bStartExtend) {
-            s = s1;
+          float b2_4ac = (b * b) - 4 * (a * c);
+          if (b2_4ac < 0) {
+            continue;
+          }
+          float root = sqrt(b2_4ac);
+          float s1, s2;
+          if (a > 0) {
+            s1 = (-b - root) / (2 * a);
+            s2 = (-b + root) / (2 * a);
           } else {
-            s = s2;
+            s2 = (-b - root) / (2 * a);
+            s1 = (-b + root) / (2 * a);
           }
-        } else {
-          if (s2 <= 1.0f || bEndExtend) {
-            s = s2;
+          if (bDecreasing) {
+            if (s1 >= 0 || bStartExtend) {
+              s = s1;
+            } else {
+              s = s2;
+            }
           } else {
-            s = s1;
+            if (s2 <= 1.0f || bEndExtend) {
+              s = s2;
+            } else {
+              s = s1;
+            }
+          }
+          if ((start_r + s * dr) < 0) {
+            continue;
           }
         }
-        if ((start_r + s * (end_r - start_r)) < 0) {
-          continue;
+        int index = (int32_t)(s * (SHADING_STEPS - 1));
+        if (index < 0) {
+          if (!bStartExtend) {
+            continue;
+          }
+          index = 0;
         }
-      }
-      int index = (int32_t)(s * (SHADING_STEPS - 1));
-      if (index < 0) {
-        if (!bStartExtend) {
-          continue;
+        if (index >= SHADING_STEPS) {
+          if (!bEndExtend) {
+            continue;
+          }
+          index = SHADING_STEPS - 1;
         }
-        index = 0;
+        dib_buf[column] = rgb_array[index];
       }
-      if (index >= SHADING_STEPS) {
-        if (!bEndExtend) {
+    }
+  };
+  DrawShadingRows(nThreads, width, height, kShadingBandRows, draw_rows);
+}
+
+// Function shadings evaluate their function on a grid of pixels at most this
+// far apart and interpolate between the samples where that is accurate
+// enough. Grids finer than the minimum are not worth it.
+const int kFuncShadingGridStep = 16;
+const int kMinFuncShadingGridStep = 4;
+const float kFuncShadingTolerance = 1.0f / 255;
+
+struct FuncShadingSample {
+  bool bInDomain;
+  float R;
+  float G;
+  float B;
+};
+
+class CPDF_FuncShadingSampler {
+ public:
+  CPDF_FuncShadingSampler(
+      const CFX_RetainPtr<CFX_DIBitmap>& pBitmap,
+      const CFX_Matrix& matrix,
+      const CFX_FloatRect& domain,
+      const std::vector<std::unique_ptr<CPDF_Function>>& funcs,
+      CPDF_ColorSpace* pCS,
+      int alpha)
+      : m_pBitmap(pBitmap),
+        m_Matrix(matrix),
+        m_Domain(domain),
+        m_Funcs(funcs),
+        m_pCS(pCS),
+        m_Alpha(alpha),
+        m_Results(std::max(CountOutputs(funcs), pCS->CountComponents())),
+        m_FuncResults(funcs.size()),
+        m_GridStep(GetGridStep()) {}
+
+  // Returns how many rows Draw() should be given at a time: a whole number
+  // of grid cells.
+  int GetBandRows() const;
+  // Draws rows [|top|, |bottom|), where |top| is a multiple of
+  // GetBandRows().
+  void Draw(int top, int bottom);
+
+ private:
+  int GetGridStep() const;
+  FuncShadingSample Sample(int column, int row);
+  bool IsClose(const FuncShadingSample& sample,
+               const FuncShadingSample& a,
+               const FuncShadingSample& b,
+               float t) const;
+  void SetPixel(int column, int row, float R, float G, float B);
+  void DrawPixels(int left, int top, int right, int bottom);
+  void DrawCell(int left,
+                int top,
+                int right,
+                int bottom,
+                const FuncShadingSample& top_left,
+                const FuncShadingSample& top_right,
+                const FuncShadingSample& bottom_left,
+                const FuncShadingSample& bottom_right);
+
+  CFX_RetainPtr<CFX_DIBitmap> const m_pBitmap;
+  const CFX_Matrix m_Matrix;
+  const CFX_FloatRect m_Domain;
+  const std::vector<std::unique_ptr<CPDF_Function>>& m_Funcs;
+  CPDF_ColorSpace* const m_pCS;
+  const int m_Alpha;
+  std::vector<float> m_Results;
+  // Inputs and results of a row of pixels evaluated at once.
+  std::vector<float> m_Inputs;
+  std::vector<int> m_Columns;
+  std::vector<std::vector<float>> m_FuncResults;
+  const int m_GridStep;
+};
+
+// Interpolating is only safe where the colour cannot change much between
+// samples. Sampled functions are linear between their own samples, so a grid
+// no coarser than those samples can only miss changes that the checks in
+// DrawCell() bound. Other functions, such as PostScript calculators, may
+// vary arbitrarily fast and get evaluated at every pixel. Returns 0 then.
+int CPDF_FuncShadingSampler::GetGridStep() const {
+  switch (m_pCS->GetFamily()) {
+    case PDFCS_DEVICEGRAY:
+    case PDFCS_DEVICERGB:
+    case PDFCS_DEVICECMYK:
+    case PDFCS_CALGRAY:
+    case PDFCS_CALRGB:
+    case PDFCS_LAB:
+    case PDFCS_ICCBASED:
+      break;
+    default:
+      // Tint transforms and palettes need not be smooth.
+      return 0;
+  }
+
+  // How far the sample position of each input moves for one pixel.
+  const float input_speed[] = {fabs(m_Matrix.a) + fabs(m_Matrix.c),
+                               fabs(m_Matrix.b) + fabs(m_Matrix.d)};
+  float step = kFuncShadingGridStep;
+  for (const auto& func : m_Funcs) {
+    if (!func)
+      continue;
+
+    const CPDF_SampledFunc* pSampledFunc = func->ToSampledFunc();
+    if (!pSampledFunc || pSampledFunc->CountInputs() != 2)
+      return 0;
+
+    const auto& encode_info = pSampledFunc->GetEncodeInfo();
+    for (int i = 0; i < 2; i++) {
+      float domain = func->GetDomain(i * 2 + 1) - func->GetDomain(i * 2);
+      if (domain <= 0)
+        return 0;
+
+      float samples_per_pixel =
+          fabs(encode_info[i].encode_max - encode_info[i].encode_min) /
+          domain * input_speed[i];
+      if (!(samples_per_pixel * kMinFuncShadingGridStep <= 1))
+        return 0;
+      step = std::min(step, 1 / samples_per_pixel);
+    }
+  }
+  return static_cast<int>(step);
+}
+
+int CPDF_FuncShadingSampler::GetBandRows() const {
+  if (!m_GridStep)
+    return kShadingBandRows;
+  return m_GridStep * std::max(1, kShadingBandRows / m_GridStep);
+}
+
+void CPDF_FuncShadingSampler::Draw(int top, int bottom) {
+  int width = m_pBitmap->GetWidth();
+  if (!m_GridStep) {
+    DrawPixels(0, top, width, bottom);
+    return;
+  }
+
+  int grid_width = (width + m_GridStep - 1) / m_GridStep;
+  int grid_height = (bottom - top + m_GridStep - 1) / m_GridStep;
+  // Cells share their corners, so sample every grid point once. The last
+  // grid points lie just past the rows to draw.
+  std::vector<FuncShadingSample> grid((grid_width + 1) * (grid_height + 1));
+  for (int j = 0; j <= grid_height; j++) {
+    int row = std::min(top + j * m_GridStep, bottom);
+    for (int i = 0; i <= grid_width; i++) {
+      int column = std::min(i * m_GridStep, width);
+      grid[j * (grid_width + 1) + i] = Sample(column, row);
+    }
+  }
+  for (int j = 0; j < grid_height; j++) {
+    const FuncShadingSample* top_samples = &grid[j * (grid_width + 1)];
+    const FuncShadingSample* bottom_samples = top_samples + grid_width + 1;
+    int row = top + j * m_GridStep;
+    int next_row = std::min(row + m_GridStep, bottom);
+    for (int i = 0; i < grid_width; i++) {
+      int column = i * m_GridStep;
+      int next_column = std::min(column + m_GridStep, width);
+      DrawCell(column, row, next_column, next_row, top_samples[i],
+               top_samples[i + 1], bottom_samples[i], bottom_samples[i + 1]);
+    }
+  }
+}
+
+FuncShadingSample CPDF_FuncShadingSampler::Sample(int column, int row) {
+  FuncShadingSample sample = {false, 0.0f, 0.0f, 0.0f};
+  CFX_PointF pos = m_Matrix.Transform(
+      CFX_PointF(static_cast<float>(column), static_cast<float>(row)));
+  if (pos.x < m_Domain.left || pos.x > m_Domain.right ||
+      pos.y < m_Domain.bottom || pos.y > m_Domain.top) {
+    return sample;
+  }
+
+  float input[] = {pos.x, pos.y};
+  int offset = 0;
+  for (const auto& func : m_Funcs) {
+    if (func) {
+      int nresults;
+      if (func->Call(input, 2, m_Results.data() + offset, &nresults))
+        offset += nresults;
+    }
+  }
+  sample.bInDomain = true;
+  m_pCS->GetRGB(m_Results.data(), &sample.R, &sample.G, &sample.B);
+  return sample;
+}
+
+bool CPDF_FuncShadingSampler::IsClose(const FuncShadingSample& sample,
+                                      const FuncShadingSample& a,
+                                      const FuncShadingSample& b,
+                                      float t) const {
+  return sample.bInDomain &&
+         fabs(a.R + (b.R - a.R) * t - sample.R) <= kFuncShadingTolerance &&
+         fabs(a.G + (b.G - a.G) * t - sample.G) <= kFuncShadingTolerance &&
+         fabs(a.B + (b.B - a.B) * t - sample.B) <= kFuncShadingTolerance;
+}
+
+void CPDF_FuncShadingSampler::SetPixel(int column,
+                                       int row,
+                                       float R,
+                                       float G,
+                                       float B) {
+  uint32_t* dib_buf = reinterpret_cast<uint32_t*>(m_pBitmap->GetBuffer() +
+                                                  row * m_pBitmap->GetPitch());
+  dib_buf[column] = FXARGB_TODIB(FXARGB_MAKE(
+      m_Alpha, (int32_t)(R * 255), (int32_t)(G * 255), (int32_t)(B * 255)));
+}
+
+// Evaluates the functions at every pixel in the domain, a row at a time.
+void CPDF_FuncShadingSampler::DrawPixels(int left,
+                                         int top,
+                                         int right,
+                                         int bottom) {
+  for (int row = top; row < bottom; row++) {
+    m_Inputs.clear();
+    m_Columns.clear();
+    for (int column = left; column < right; column++) {
+      CFX_PointF pos = m_Matrix.Transform(
+          CFX_PointF(static_cast<float>(column), static_cast<float>(row)));
+      if (pos.x < m_Domain.left || pos.x > m_Domain.right ||
+          pos.y < m_Domain.bottom || pos.y > m_Domain.top) {
+        continue;
+      }
+      m_Inputs.push_back(pos.x);
+      m_Inputs.push_back(pos.y);
+      m_Columns.push_back(column);
+    }
+    uint32_t count = pdfium::CollectionSize<uint32_t>(m_Columns);
+    if (!count)
+      continue;
+
+    for (size_t i = 0; i < m_Funcs.size(); i++) {
+      std::vector<float>& results = m_FuncResults[i];
+      results.clear();
+      const auto& func = m_Funcs[i];
+      if (!func)
+        continue;
+
+      results.resize(count * func->CountOutputs());
+      int nresults;
+      if (!func->CallBatch(m_Inputs.data(), 2, count, results.data(),
+                           &nresults)) {
+        results.clear();
+      }
+    }
+    for (uint32_t j = 0; j < count; j++) {
+      int offset = 0;
+      for (size_t i = 0; i < m_Funcs.size(); i++) {
+        const std::vector<float>& results = m_FuncResults[i];
+        if (results.empty())
           continue;
-        }
-        index = SHADING_STEPS - 1;
+
+        uint32_t nresults = m_Funcs[i]->CountOutputs();
+        std::copy(results.begin() + j * nresults,
+                  results.begin() + (j + 1) * nresults,
+                  m_Results.begin() + offset);
+        offset += nresults;
       }
-      dib_buf[column] = rgb_array[index];
+      float R;
+      float G;
+      float B;
+      m_pCS->GetRGB(m_Results.data(), &R, &G, &B);
+      SetPixel(m_Columns[j], row, R, G, B);
+    }
+  }
+}
+
+// Draws the pixels from |left|, |top| up to but not including |right|,
+// |bottom|, given the samples at those four corners. If the samples halfway
+// along the edges and in the middle match the interpolated colours, the cell
+// is interpolated; otherwise it is split in four around those samples.
+void CPDF_FuncShadingSampler::DrawCell(
+    int left,
+    int top,
+    int right,
+    int bottom,
+    const FuncShadingSample& top_left,
+    const FuncShadingSample& top_right,
+    const FuncShadingSample& bottom_left,
+    const FuncShadingSample& bottom_right) {
+  int width = right - left;
+  int height = bottom - top;
+  if (width * height <= 4 || !top_left.bInDomain || !top_right.bInDomain ||
+      !bottom_left.bInDomain || !bottom_right.bInDomain) {
+    DrawPixels(left, top, right, bottom);
+    return;
+  }
+
+  int mid_x = left + width / 2;
+  int mid_y = top + height / 2;
+  float tx = static_cast<float>(width / 2) / width;
+  float ty = static_cast<float>(height / 2) / height;
+  FuncShadingSample top_mid = Sample(mid_x, top);
+  FuncShadingSample bottom_mid = Sample(mid_x, bottom);
+  FuncShadingSample left_mid = Sample(left, mid_y);
+  FuncShadingSample right_mid = Sample(right, mid_y);
+  FuncShadingSample center = Sample(mid_x, mid_y);
+  FuncShadingSample expected_center = {
+      true, left_mid.R + (right_mid.R - left_mid.R) * tx,
+      left_mid.G + (right_mid.G - left_mid.G) * tx,
+      left_mid.B + (right_mid.B - left_mid.B) * tx};
+  if (!IsClose(top_mid, top_left, top_right, tx) ||
+      !IsClose(bottom_mid, bottom_left, bottom_right, tx) ||
+      !IsClose(left_mid, top_left, bottom_left, ty) ||
+      !IsClose(right_mid, top_right, bottom_right, ty) ||
+      !IsClose(center, expected_center, expected_center, 0)) {
+    if (mid_x > left && mid_y > top) {
+      DrawCell(left, top, mid_x, mid_y, top_left, top_mid, left_mid, center);
+    }
+    if (mid_y > top) {
+      DrawCell(mid_x, top, right, mid_y, top_mid, top_right, center,
+               right_mid);
+    }
+    if (mid_x > left) {
+      DrawCell(left, mid_y, mid_x, bottom, left_mid, center, bottom_left,
+               bottom_mid);
+    }
+    DrawCell(mid_x, mid_y, right, bottom, center, right_mid, bottom_mid,
+             bottom_right);
+    return;
+  }
+
+  for (int row = top; row < bottom; row++) {
+    float t = static_cast<float>(row - top) / height;
+    float left_R = top_left.R + (bottom_left.R - top_left.R) * t;
+    float left_G = top_left.G + (bottom_left.G - top_left.G) * t;
+    float left_B = top_left.B + (bottom_left.B - top_left.B) * t;
+    float right_R = top_right.R + (bottom_right.R - top_right.R) * t;
+    float right_G = top_right.G + (bottom_right.G - top_right.G) * t;
+    float right_B = top_right.B + (bottom_right.B - top_right.B) * t;
+    int column = left;
+#if defined(SHADING_USE_SSE2)
+    const float from[] = {left_R, left_G, left_B};
+    const float to[] = {right_R, right_G, right_B};
+    column = InterpolateRowSSE2(
+        reinterpret_cast<uint32_t*>(m_pBitmap->GetBuffer() +
+                                    row * m_pBitmap->GetPitch()),
+        left, right, from, to, m_Alpha);
+#endif
+    for (; column < right; column++) {
+      float s = static_cast<float>(column - left) / width;
+      SetPixel(column, row, left_R + (right_R - left_R) * s,
+               left_G + (right_G - left_G) * s,
+               left_B + (right_B - left_B) * s);
     }
   }
 }
@@ -322,7 +919,8 @@ void DrawFuncShading(const CFX_RetainPtr<CFX_DIBitmap>& pBitmap,
                      CPDF_Dictionary* pDict,
                      const std::vector<std::unique_ptr<CPDF_Function>>& funcs,
                      CPDF_ColorSpace* pCS,
-                     int alpha) {
+                     int alpha,
+                     size_t nThreads) {
   ASSERT(pBitmap->GetFormat() == FXDIB_Argb);
   CPDF_Array* pDomain = pDict->GetArrayFor("Domain");
   float xmin = 0, ymin = 0, xmax = 1.0f, ymax = 1.0f;
@@ -339,40 +937,20 @@ void DrawFuncShading(const CFX_RetainPtr<CFX_DIBitmap>& pBitmap,
   CFX_Matrix reverse_matrix;
   reverse_matrix.SetReverse(mtDomain2Target);
   matrix.Concat(reverse_matrix);
-  int width = pBitmap->GetWidth();
-  int height = pBitmap->GetHeight();
-  int pitch = pBitmap->GetPitch();
-  uint32_t total_results =
-      std::max(CountOutputs(funcs), pCS->CountComponents());
-  CFX_FixedBufGrow<float, 16> result_array(total_results);
-  float* pResults = result_array;
-  memset(pResults, 0, total_results * sizeof(float));
-  for (int row = 0; row < height; row++) {
-    uint32_t* dib_buf = (uint32_t*)(pBitmap->GetBuffer() + row * pitch);
-    for (int column = 0; column < width; column++) {
-      CFX_PointF pos = matrix.Transform(
-          CFX_PointF(static_cast<float>(column), static_cast<float>(row)));
-      if (pos.x < xmin || pos.x > xmax || pos.y < ymin || pos.y > ymax)
-        continue;
-
-      float input[] = {pos.x, pos.y};
-      int offset = 0;
-      for (const auto& func : funcs) {
-        if (func) {
-          int nresults;
-          if (func->Call(input, 2, pResults + offset, &nresults))
-            offset += nresults;
-        }
-      }
-
-      float R = 0.0f;
-      float G = 0.0f;
-      float B = 0.0f;
-      pCS->GetRGB(pResults, &R, &G, &B);
-      dib_buf[column] = FXARGB_TODIB(FXARGB_MAKE(
-          alpha, (int32_t)(R * 255), (int32_t)(G * 255), (int32_t)(B * 255)));
+  CFX_FloatRect domain(xmin, ymin, xmax, ymax);
+  // Every thread samples with its own scratch buffers.
+  std::vector<std::unique_ptr<CPDF_FuncShadingSampler>> samplers(nThreads);
+  samplers[0] = pdfium::MakeUnique<CPDF_FuncShadingSampler>(
+      pBitmap, matrix, domain, funcs, pCS, alpha);
+  auto draw_rows = [&](int top, int bottom, size_t worker) {
+    if (!samplers[worker]) {
+      samplers[worker] = pdfium::MakeUnique<CPDF_FuncShadingSampler>(
+          pBitmap, matrix, domain, funcs, pCS, alpha);
     }
-  }
+    samplers[worker]->Draw(top, bottom);
+  };
+  DrawShadingRows(nThreads, pBitmap->GetWidth(), pBitmap->GetHeight(),
+                  samplers[0]->GetBandRows(), draw_rows);
 }
 
 bool GetScanlineIntersect(int y,
@@ -945,7 +1523,7 @@ bool IsAvailableMatrix(const CFX_Matrix& matrix) {
 }  // namespace
 
 // static
-int CPDF_RenderStatus::s_CurrentRecursionDepth = 0;
+thread_local int CPDF_RenderStatus::s_CurrentRecursionDepth = 0;
 
 CPDF_RenderStatus::CPDF_RenderStatus()
     : m_pFormResource(nullptr),
@@ -1035,23 +1613,43 @@ void CPDF_RenderStatus::RenderObjectList(
   device2object.SetReverse(*pObj2Device);
   device2object.TransformRect(clip_rect);
 
-  for (const auto& pCurObj : *pObjectHolder->GetPageObjectList()) {
-    if (pCurObj.get() == m_pStopObj) {
-      m_bStopped = true;
-      return;
+  // Objects up to |m_pStopObj| must be visited in order, visible or not.
+  const CFX_RectIndex* pIndex =
+      m_pStopObj ? nullptr : pObjectHolder->GetObjectIndex();
+  std::vector<uint32_t> candidates;
+  if (pIndex && pIndex->GetCandidates(clip_rect, &candidates)) {
+    const CPDF_PageObjectList* pObjectList = pObjectHolder->GetPageObjectList();
+    for (uint32_t index : candidates) {
+      CPDF_PageObject* pCurObj = (*pObjectList)[index].get();
+      if (!pCurObj || pCurObj->m_Left > clip_rect.right ||
+          pCurObj->m_Right < clip_rect.left ||
+          pCurObj->m_Bottom > clip_rect.top ||
+          pCurObj->m_Top < clip_rect.bottom) {
+        continue;
+      }
+      RenderSingleObject(pCurObj, pObj2Device);
+      if (m_bStopped)
+        return;
     }
-    if (!pCurObj)
-      continue;
+  } else {
+    for (const auto& pCurObj : *pObjectHolder->GetPageObjectList()) {
+      if (pCurObj.get() == m_pStopObj) {
+        m_bStopped = true;
+        return;
+      }
+      if (!pCurObj)
+        continue;
 
-    if (pCurObj->m_Left > clip_rect.right ||
-        pCurObj->m_Right < clip_rect.left ||
-        pCurObj->m_Bottom > clip_rect.top ||
-        pCurObj->m_Top < clip_rect.bottom) {
-      continue;
+      if (pCurObj->m_Left > clip_rect.right ||
+          pCurObj->m_Right < clip_rect.left ||
+          pCurObj->m_Bottom > clip_rect.top ||
+          pCurObj->m_Top < clip_rect.bottom) {
+        continue;
+      }
+      RenderSingleObject(pCurObj.get(), pObj2Device);
+      if (m_bStopped)
+        return;
     }
-    RenderSingleObject(pCurObj.get(), pObj2Device);
-    if (m_bStopped)
-      return;
   }
 #if defined _SKIA_SUPPORT_
   DebugVerifyDeviceIsPreMultiplied();
@@ -1837,15 +2435,24 @@ bool CPDF_RenderStatus::ProcessType3Text(CPDF_TextObject* textobj,
     if (charcode == static_cast<uint32_t>(-1))
       continue;
 
-    CPDF_Type3Char* pType3Char = pType3Font->LoadChar(charcode);
-    if (!pType3Char)
-      continue;
+    // Loading may turn the glyph into a bitmap and drop its form, so other
+    // threads must not see it half done. After that the glyph stays as it is.
+    CPDF_Type3Char* pType3Char;
+    bool bBitmap;
+    {
+      std::lock_guard<std::recursive_mutex> lock(*pType3Font->GetMutex());
+      pType3Char = pType3Font->LoadChar(charcode);
+      if (!pType3Char)
+        continue;
+
+      bBitmap = pType3Char->LoadBitmap(m_pContext);
+    }
 
     CFX_Matrix matrix = char_matrix;
     matrix.e += iChar ? textobj->m_CharPos[iChar - 1] : 0;
     matrix.Concat(text_matrix);
     matrix.Concat(*pObj2Device);
-    if (!pType3Char->LoadBitmap(m_pContext)) {
+    if (!bBitmap) {
       if (!glyphs.empty()) {
         for (int i = 0; i < iChar; i++) {
           const FXTEXT_GLYPHPOS& glyph = glyphs[i];
@@ -1917,7 +2524,7 @@ bool CPDF_RenderStatus::ProcessType3Text(CPDF_TextObject* textobj,
           m_pDevice->SetBitMask(pBitmap->m_pBitmap, origin.x + pBitmap->m_Left,
                                 origin.y - pBitmap->m_Top, fill_argb);
         } else {
-          glyphs[iChar].m_pGlyph = pBitmap;
+          glyphs[iChar].m_pGlyph = CFX_RetainPtr<CFX_GlyphBitmap>(pBitmap);
           glyphs[iChar].m_Origin = origin;
         }
       } else {
@@ -1996,6 +2603,7 @@ void CPDF_RenderStatus::DrawTextPathWithPattern(const CPDF_TextObject* textobj,
     RenderSingleObject(&path, pObj2Device);
     return;
   }
+  std::lock_guard<std::recursive_mutex> lock(*pFont->GetMutex());
   CPDF_CharPosList CharPosList;
   CharPosList.Load(textobj->m_CharCodes, textobj->m_CharPos, pFont, font_size);
   for (uint32_t i = 0; i < CharPosList.m_nChars; i++) {
@@ -2076,19 +2684,24 @@ void CPDF_RenderStatus::DrawShading(CPDF_ShadingPattern* pPattern,
 
   pBitmap->Clear(background);
   int fill_mode = m_Options.m_Flags;
+  size_t nThreads = (m_Options.m_Flags & RENDER_NO_THREADS)
+                        ? 1
+                        : CFX_ThreadPool::GetDefaultThreadCount();
   switch (pPattern->GetShadingType()) {
     case kInvalidShading:
     case kMaxShading:
       return;
     case kFunctionBasedShading:
-      DrawFuncShading(pBitmap, &FinalMatrix, pDict, funcs, pColorSpace, alpha);
+      DrawFuncShading(pBitmap, &FinalMatrix, pDict, funcs, pColorSpace, alpha,
+                      nThreads);
       break;
     case kAxialShading:
-      DrawAxialShading(pBitmap, &FinalMatrix, pDict, funcs, pColorSpace, alpha);
+      DrawAxialShading(pBitmap, &FinalMatrix, pDict, funcs, pColorSpace, alpha,
+                       nThreads);
       break;
     case kRadialShading:
       DrawRadialShading(pBitmap, &FinalMatrix, pDict, funcs, pColorSpace,
-                        alpha);
+                        alpha, nThreads);
       break;
     case kFreeFormGouraudTriangleMeshShading: {
       // The shading object can be a stream or a dictionary. We do not handle
@@ -155,7 +155,8 @@ class CPDF_RenderStatus {
   void GetScaledMatrix(CFX_Matrix& matrix) const;
 
   static const int kRenderMaxRecursionDepth = 64;
-  static int s_CurrentRecursionDepth;
+  // Per thread, since pages may be rendered on several at once.
+  static thread_local int s_CurrentRecursionDepth;
 
   CPDF_RenderContext* m_pContext;
   bool m_bStopped;
@@ -7,6 +7,7 @@
 #include "core/fpdfapi/render/cpdf_textrenderer.h"
 
 #include <algorithm>
+#include <mutex>
 
 #include "core/fpdfapi/font/cpdf_font.h"
 #include "core/fpdfapi/render/cpdf_charposlist.h"
@@ -36,6 +37,7 @@ bool CPDF_TextRenderer::DrawTextPath(CFX_RenderDevice* pDevice,
                                      FX_ARGB stroke_argb,
                                      CFX_PathData* pClippingPath,
                                      int nFlag) {
+  std::lock_guard<std::recursive_mutex> lock(*pFont->GetMutex());
   CPDF_CharPosList CharPosList;
   CharPosList.Load(charCodes, charPos, pFont, font_size);
   if (CharPosList.m_nChars == 0)
@@ -83,6 +85,7 @@ void CPDF_TextRenderer::DrawTextString(CFX_RenderDevice* pDevice,
   if (pFont->IsType3Font())
     return;
 
+  std::lock_guard<std::recursive_mutex> lock(*pFont->GetMutex());
   int nChars = pFont->CountChar(str.c_str(), str.GetLength());
   if (nChars <= 0)
     return;
@@ -119,6 +122,7 @@ bool CPDF_TextRenderer::DrawNormalText(CFX_RenderDevice* pDevice,
                                        const CFX_Matrix* pText2Device,
                                        FX_ARGB fill_argb,
                                        const CPDF_RenderOptions* pOptions) {
+  std::lock_guard<std::recursive_mutex> lock(*pFont->GetMutex());
   CPDF_CharPosList CharPosList;
   CharPosList.Load(charCodes, charPos, pFont, font_size);
   if (CharPosList.m_nChars == 0)
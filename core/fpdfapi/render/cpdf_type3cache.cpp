@@ -8,6 +8,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <utility>
 
 #include "core/fpdfapi/font/cpdf_type3char.h"
@@ -88,6 +89,7 @@ CFX_GlyphBitmap* CPDF_Type3Cache::LoadGlyph(uint32_t charcode,
                                             const CFX_Matrix* pMatrix,
                                             float retinaScaleX,
                                             float retinaScaleY) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
   CPDF_UniqueKeyGen keygen;
   keygen.Generate(
       4, FXSYS_round(pMatrix->a * 10000), FXSYS_round(pMatrix->b * 10000),
@@ -104,16 +106,16 @@ CFX_GlyphBitmap* CPDF_Type3Cache::LoadGlyph(uint32_t charcode,
   }
   auto it2 = pSizeCache->m_GlyphMap.find(charcode);
   if (it2 != pSizeCache->m_GlyphMap.end())
-    return it2->second.get();
+    return it2->second.Get();
 
-  std::unique_ptr<CFX_GlyphBitmap> pNewBitmap =
+  CFX_RetainPtr<CFX_GlyphBitmap> pNewBitmap =
       RenderGlyph(pSizeCache, charcode, pMatrix, retinaScaleX, retinaScaleY);
-  CFX_GlyphBitmap* pGlyphBitmap = pNewBitmap.get();
+  CFX_GlyphBitmap* pGlyphBitmap = pNewBitmap.Get();
   pSizeCache->m_GlyphMap[charcode] = std::move(pNewBitmap);
   return pGlyphBitmap;
 }
 
-std::unique_ptr<CFX_GlyphBitmap> CPDF_Type3Cache::RenderGlyph(
+CFX_RetainPtr<CFX_GlyphBitmap> CPDF_Type3Cache::RenderGlyph(
     CPDF_Type3Glyphs* pSize,
     uint32_t charcode,
     const CFX_Matrix* pMatrix,
@@ -167,7 +169,7 @@ std::unique_ptr<CFX_GlyphBitmap> CPDF_Type3Cache::RenderGlyph(
   if (!pResBitmap)
     return nullptr;
 
-  auto pGlyph = pdfium::MakeUnique<CFX_GlyphBitmap>();
+  auto pGlyph = pdfium::MakeRetain<CFX_GlyphBitmap>();
   pGlyph->m_Left = left;
   pGlyph->m_Top = -top;
   pGlyph->m_pBitmap->TakeOver(std::move(pResBitmap));
@@ -9,6 +9,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 
 #include "core/fpdfapi/font/cpdf_type3font.h"
 #include "core/fxcrt/cfx_retain_ptr.h"
@@ -32,13 +33,14 @@ class CPDF_Type3Cache : public CFX_Retainable {
   explicit CPDF_Type3Cache(CPDF_Type3Font* pFont);
   ~CPDF_Type3Cache() override;
 
-  std::unique_ptr<CFX_GlyphBitmap> RenderGlyph(CPDF_Type3Glyphs* pSize,
-                                               uint32_t charcode,
-                                               const CFX_Matrix* pMatrix,
-                                               float retinaScaleX,
-                                               float retinaScaleY);
+  CFX_RetainPtr<CFX_GlyphBitmap> RenderGlyph(CPDF_Type3Glyphs* pSize,
+                                             uint32_t charcode,
+                                             const CFX_Matrix* pMatrix,
+                                             float retinaScaleX,
+                                             float retinaScaleY);
 
   CPDF_Type3Font* const m_pFont;
+  std::mutex m_Mutex;
   std::map<CFX_ByteString, std::unique_ptr<CPDF_Type3Glyphs>> m_SizeMap;
 };
 
@@ -10,6 +10,7 @@
 #include <map>
 #include <memory>
 
+#include "core/fxcrt/cfx_retain_ptr.h"
 #include "core/fxcrt/fx_system.h"
 
 class CFX_GlyphBitmap;
@@ -23,7 +24,7 @@ class CPDF_Type3Glyphs {
 
   void AdjustBlue(float top, float bottom, int& top_line, int& bottom_line);
 
-  std::map<uint32_t, std::unique_ptr<CFX_GlyphBitmap>> m_GlyphMap;
+  std::map<uint32_t, CFX_RetainPtr<CFX_GlyphBitmap>> m_GlyphMap;
   int m_TopBlue[TYPE3_MAX_BLUES];
   int m_BottomBlue[TYPE3_MAX_BLUES];
   int m_TopBlueCount;
@@ -7,8 +7,10 @@
 #include "core/fpdfdoc/cpdf_annotlist.h"
 
 #include <memory>
+#include <mutex>
 #include <utility>
 
+#include "core/fpdfapi/page/cpdf_docpagedata.h"
 #include "core/fpdfapi/page/cpdf_page.h"
 #include "core/fpdfapi/parser/cpdf_document.h"
 #include "core/fpdfapi/parser/cpdf_name.h"
@@ -70,6 +72,12 @@ CPDF_AnnotList::CPDF_AnnotList(CPDF_Page* pPage)
   if (!pAnnots)
     return;
 
+  // Building the list edits the document: annotations are made indirect and
+  // missing appearance streams are generated, with fonts added to shared
+  // resources. The page data lock, which loading those fonts takes anyway,
+  // keeps pages on other threads from doing so at the same time.
+  std::lock_guard<std::recursive_mutex> lock(
+      *m_pDocument->GetPageData()->GetMutex());
   CPDF_Dictionary* pRoot = m_pDocument->GetRoot();
   CPDF_Dictionary* pAcroForm = pRoot->GetDictFor("AcroForm");
   bool bRegenerateAP = pAcroForm && pAcroForm->GetBooleanFor("NeedAppearances");
@@ -19,9 +19,11 @@
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfapi/parser/cpdf_string.h"
 #include "core/fpdftext/unicodenormalizationdata.h"
+#include "core/fxcrt/cfx_rectindex.h"
 #include "core/fxcrt/fx_bidi.h"
 #include "core/fxcrt/fx_extension.h"
 #include "core/fxcrt/fx_ucd.h"
+#include "third_party/base/ptr_util.h"
 #include "third_party/base/stl_util.h"
 
 namespace {
@@ -158,6 +160,7 @@ void CPDF_TextPage::ParseTextPage() {
   m_bIsParsed = false;
   m_TextBuf.Clear();
   m_CharList.clear();
+  m_pCharBoxIndex.reset();
   m_pPreTextObj = nullptr;
   ProcessObject();
 
@@ -305,15 +308,40 @@ int CPDF_TextPage::GetIndexAtPos(const CFX_PointF& point,
   if (!m_bIsParsed)
     return -3;
 
-  int pos = 0;
+  int nChars = pdfium::CollectionSize<int>(m_CharList);
+  if (!m_pCharBoxIndex && m_CharList.size() >= CFX_RectIndex::kMinRects) {
+    std::vector<CFX_FloatRect> boxes;
+    boxes.reserve(nChars);
+    for (const PAGECHAR_INFO& charinfo : m_CharList)
+      boxes.push_back(charinfo.m_CharBox);
+    m_pCharBoxIndex = pdfium::MakeUnique<CFX_RectIndex>(boxes);
+  }
+
+  // A character can only match if its box, grown by the tolerance, contains
+  // |point|. Check those in the same order as a full scan would. The extra
+  // unit of slack keeps rounding from dropping boxes that just touch.
+  std::vector<uint32_t> candidates;
+  bool bUseIndex = false;
+  if (m_pCharBoxIndex) {
+    CFX_FloatRect area(point.x - tolerance.width / 2,
+                       point.y - tolerance.height / 2,
+                       point.x + tolerance.width / 2,
+                       point.y + tolerance.height / 2);
+    area.Normalize();
+    area.Inflate(1, 1);
+    bUseIndex = m_pCharBoxIndex->GetCandidates(area, &candidates);
+  }
+  int nToCheck = bUseIndex ? pdfium::CollectionSize<int>(candidates) : nChars;
+
   int NearPos = -1;
   double xdif = 5000;
   double ydif = 5000;
-  while (pos < pdfium::CollectionSize<int>(m_CharList)) {
-    PAGECHAR_INFO charinfo = m_CharList[pos];
+  for (int i = 0; i < nToCheck; ++i) {
+    int pos = bUseIndex ? static_cast<int>(candidates[i]) : i;
+    const PAGECHAR_INFO& charinfo = m_CharList[pos];
     CFX_FloatRect charrect = charinfo.m_CharBox;
     if (charrect.Contains(point))
-      break;
+      return pos;
     if (tolerance.width > 0 || tolerance.height > 0) {
       CFX_FloatRect charRectExt;
       charrect.Normalize();
@@ -336,9 +364,8 @@ int CPDF_TextPage::GetIndexAtPos(const CFX_PointF& point,
         }
       }
     }
-    ++pos;
   }
-  return pos < pdfium::CollectionSize<int>(m_CharList) ? pos : NearPos;
+  return NearPos;
 }
 
 CFX_WideString CPDF_TextPage::GetTextByRect(const CFX_FloatRect& rect) const {
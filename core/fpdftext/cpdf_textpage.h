@@ -8,6 +8,7 @@
 #define CORE_FPDFTEXT_CPDF_TEXTPAGE_H_
 
 #include <deque>
+#include <memory>
 #include <vector>
 
 #include "core/fpdfapi/page/cpdf_pageobjectlist.h"
@@ -15,6 +16,7 @@
 #include "core/fxcrt/fx_coordinates.h"
 #include "core/fxcrt/fx_string.h"
 
+class CFX_RectIndex;
 class CPDF_Font;
 class CPDF_FormObject;
 class CPDF_Page;
@@ -165,6 +167,8 @@ class CPDF_TextPage {
   const CPDF_Page* const m_pPage;
   std::vector<uint16_t> m_CharIndex;
   std::deque<PAGECHAR_INFO> m_CharList;
+  // Index of the |m_CharList| boxes for GetIndexAtPos(), built on first use.
+  mutable std::unique_ptr<CFX_RectIndex> m_pCharBoxIndex;
   std::deque<PAGECHAR_INFO> m_TempCharList;
   CFX_WideTextBuf m_TextBuf;
   CFX_WideTextBuf m_TempTextBuf;
@@ -7,15 +7,7 @@
 #ifndef CORE_FXCODEC_JBIG2_DOCUMENTCONTEXT_H_
 #define CORE_FXCODEC_JBIG2_DOCUMENTCONTEXT_H_
 
-#include <list>
-#include <memory>
-#include <utility>
-
-class CJBig2_SymbolDict;
-
-using CJBig2_CacheKey = std::pair<uint32_t, uint32_t>;
-using CJBig2_CachePair =
-    std::pair<CJBig2_CacheKey, std::unique_ptr<CJBig2_SymbolDict>>;
+#include "core/fxcodec/jbig2/JBig2_SymbolDictCache.h"
 
 // Holds per-document JBig2 related data.
 class JBig2_DocumentContext {
@@ -23,12 +15,10 @@ class JBig2_DocumentContext {
   JBig2_DocumentContext();
   ~JBig2_DocumentContext();
 
-  std::list<CJBig2_CachePair>* GetSymbolDictCache() {
-    return &m_SymbolDictCache;
-  }
+  CJBig2_SymbolDictCache* GetSymbolDictCache() { return &m_SymbolDictCache; }
 
  private:
-  std::list<CJBig2_CachePair> m_SymbolDictCache;
+  CJBig2_SymbolDictCache m_SymbolDictCache;
 };
 
 #endif  // CORE_FXCODEC_JBIG2_DOCUMENTCONTEXT_H_
@@ -7,10 +7,17 @@
 #ifndef CORE_FXCODEC_CODEC_CCODEC_ICCMODULE_H_
 #define CORE_FXCODEC_CODEC_CCODEC_ICCMODULE_H_
 
+#include <list>
+#include <map>
+#include <mutex>
+#include <tuple>
+
 #include "core/fxcodec/fx_codec_def.h"
 #include "core/fxcrt/fx_string.h"
 #include "core/fxcrt/fx_system.h"
 
+struct CLcmsCmm;
+
 class CCodec_IccModule {
  public:
   CCodec_IccModule();
@@ -21,16 +28,36 @@ class CCodec_IccModule {
                              uint32_t& nComponents,
                              int32_t intent = 0,
                              uint32_t dwSrcFormat = Icc_FORMAT_DEFAULT);
+  // Like CreateTransform_sRGB(), but returns the transform already built for
+  // a profile with the same |bsDigest|, intent and format, if there is one.
+  // Shared transforms may be used from several threads at once.
+  void* CreateSharedTransform_sRGB(const CFX_ByteStringC& bsDigest,
+                                   const uint8_t* pProfileData,
+                                   uint32_t dwProfileSize,
+                                   uint32_t& nComponents,
+                                   int32_t intent = 0,
+                                   uint32_t dwSrcFormat = Icc_FORMAT_DEFAULT);
   void DestroyTransform(void* pTransform);
   void Translate(void* pTransform, const float* pSrcValues, float* pDestValues);
   void TranslateScanline(void* pTransform,
                          uint8_t* pDest,
                          const uint8_t* pSrc,
                          int pixels);
-  void SetComponents(uint32_t nComponents) { m_nComponents = nComponents; }
 
- protected:
-  uint32_t m_nComponents;
+ private:
+  using TransformKey = std::tuple<CFX_ByteString, int32_t, uint32_t>;
+
+  // Shared transforms that are no longer used are kept around, up to this
+  // many, for the next document that embeds the same profile.
+  static const size_t kMaxIdleTransforms = 16;
+
+  void ReleaseSharedTransform(CLcmsCmm* pCmm);
+
+  // Shared by every document, which may be loaded on different threads.
+  std::mutex m_Mutex;
+  std::map<TransformKey, CLcmsCmm*> m_SharedTransforms;
+  // Shared transforms with no users, least recently released first.
+  std::list<CLcmsCmm*> m_IdleTransforms;
 };
 
 #endif  // CORE_FXCODEC_CODEC_CCODEC_ICCMODULE_H_
@@ -23,12 +23,15 @@ class CCodec_JpegModule {
  public:
   CCodec_JpegModule() {}
 
+  // The decoder outputs the image scaled down by |down_scale|, which must be
+  // 1, 2, 4 or 8. Each dimension is rounded up.
   std::unique_ptr<CCodec_ScanlineDecoder> CreateDecoder(const uint8_t* src_buf,
                                                         uint32_t src_size,
                                                         int width,
                                                         int height,
                                                         int nComps,
-                                                        bool ColorTransform);
+                                                        bool ColorTransform,
+                                                        int down_scale);
   bool LoadInfo(const uint8_t* src_buf,
                 uint32_t src_size,
                 int* width,
@@ -20,13 +20,17 @@ class CCodec_JpxModule {
   CCodec_JpxModule();
   ~CCodec_JpxModule();
 
+  // The image is decoded with up to |discard_levels| fewer resolution levels,
+  // as many as the codestream has. GetDiscardLevels() tells how many.
   std::unique_ptr<CJPX_Decoder> CreateDecoder(const uint8_t* src_buf,
                                               uint32_t src_size,
-                                              CPDF_ColorSpace* cs);
+                                              CPDF_ColorSpace* cs,
+                                              uint32_t discard_levels);
   void GetImageInfo(CJPX_Decoder* pDecoder,
                     uint32_t* width,
                     uint32_t* height,
                     uint32_t* components);
+  uint32_t GetDiscardLevels(CJPX_Decoder* pDecoder);
   bool Decode(CJPX_Decoder* pDecoder,
               uint8_t* dest_data,
               int pitch,
@@ -18,8 +18,13 @@ class CJPX_Decoder {
   explicit CJPX_Decoder(CPDF_ColorSpace* cs);
   ~CJPX_Decoder();
 
-  bool Init(const unsigned char* src_data, uint32_t src_size);
+  // Leaves out up to |discard_levels| of the highest resolution levels, each
+  // of which halves the size of the image.
+  bool Init(const unsigned char* src_data,
+            uint32_t src_size,
+            uint32_t discard_levels);
   void GetInfo(uint32_t* width, uint32_t* height, uint32_t* components);
+  uint32_t GetDiscardLevels() const { return m_nDiscardLevels; }
   bool Decode(uint8_t* dest_buf,
               int pitch,
               const std::vector<uint8_t>& offsets);
@@ -27,6 +32,7 @@ class CJPX_Decoder {
  private:
   const uint8_t* m_SrcData;
   uint32_t m_SrcSize;
+  uint32_t m_nDiscardLevels;
   opj_image_t* image;
   opj_codec_t* l_codec;
   opj_stream_t* l_stream;
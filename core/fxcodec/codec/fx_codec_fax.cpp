@@ -11,72 +11,52 @@
 #include "core/fxcodec/codec/codec_int.h"
 #include "core/fxcodec/fx_codec.h"
 #include "core/fxcrt/fx_memory.h"
+#include "third_party/base/bits.h"
 #include "third_party/base/ptr_util.h"
 #include "third_party/base/stl_util.h"
 
 namespace {
 
-const uint8_t OneLeadPos[256] = {
-    8, 7, 6, 6, 5, 5, 5, 5, 4, 4, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3, 3, 3, 3,
-    3, 3, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
-    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-};
-const uint8_t ZeroLeadPos[256] = {
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
-    2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
-    4, 4, 4, 4, 4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 7, 8,
-};
-
 // Limit of image dimension, an arbitrary large number.
 const int kMaxImageDimension = 0x01FFFF;
 
+// Returns the number of leading zero bits in |data|, or 8 if it is 0.
+int LeadingZeroBits8(uint8_t data) {
+  return pdfium::base::bits::CountLeadingZeroBits32(data) - 24;
+}
+
 int FindBit(const uint8_t* data_buf, int max_pos, int start_pos, int bit) {
   ASSERT(start_pos >= 0);
   if (start_pos >= max_pos)
     return max_pos;
 
-  const uint8_t* leading_pos = bit ? OneLeadPos : ZeroLeadPos;
-  if (start_pos % 8) {
-    uint8_t data = data_buf[start_pos / 8];
-    if (bit)
-      data &= 0xff >> (start_pos % 8);
-    else
-      data |= 0xff << (8 - start_pos % 8);
-
-    if (leading_pos[data] < 8)
-      return start_pos / 8 * 8 + leading_pos[data];
-
-    start_pos += 7;
-  }
-  uint8_t skip = bit ? 0x00 : 0xff;
+  // Flipping the data when looking for 0 bits makes the wanted bit a 1.
+  const uint32_t flip = bit ? 0x00000000 : 0xffffffff;
   int byte_pos = start_pos / 8;
   int max_byte = (max_pos + 7) / 8;
-  while (byte_pos < max_byte) {
-    if (data_buf[byte_pos] != skip)
-      break;
+  if (byte_pos + 4 <= max_byte) {
+    uint32_t data = (FXDWORD_GET_MSBFIRST((data_buf + byte_pos)) ^ flip) &
+                    (0xffffffff >> (start_pos % 8));
+    for (byte_pos += 4; !data && byte_pos + 4 <= max_byte; byte_pos += 4)
+      data = FXDWORD_GET_MSBFIRST((data_buf + byte_pos)) ^ flip;
+    if (data) {
+      int pos = (byte_pos - 4) * 8 +
+                pdfium::base::bits::CountLeadingZeroBits32(data);
+      return std::min(pos, max_pos);
+    }
+  } else if (start_pos % 8) {
+    uint8_t data = (data_buf[byte_pos] ^ flip) & (0xff >> (start_pos % 8));
+    if (data)
+      return byte_pos * 8 + LeadingZeroBits8(data);
 
     ++byte_pos;
   }
-  if (byte_pos == max_byte)
-    return max_pos;
-
-  return std::min(leading_pos[data_buf[byte_pos]] + byte_pos * 8, max_pos);
+  for (; byte_pos < max_byte; ++byte_pos) {
+    uint8_t data = data_buf[byte_pos] ^ flip;
+    if (data)
+      return std::min(byte_pos * 8 + LeadingZeroBits8(data), max_pos);
+  }
+  return max_pos;
 }
 
 void FaxG4FindB1B2(const std::vector<uint8_t>& ref_buf,
@@ -111,17 +91,15 @@ void FaxFillBits(uint8_t* dest_buf, int columns, int startpos, int endpos) {
 
   int first_byte = startpos / 8;
   int last_byte = (endpos - 1) / 8;
+  uint8_t first_mask = 0xff >> (startpos % 8);
+  uint8_t last_mask = 0xff << (7 - (endpos - 1) % 8);
   if (first_byte == last_byte) {
-    for (int i = startpos % 8; i <= (endpos - 1) % 8; ++i)
-      dest_buf[first_byte] -= 1 << (7 - i);
+    dest_buf[first_byte] &= ~(first_mask & last_mask);
     return;
   }
 
-  for (int i = startpos % 8; i < 8; ++i)
-    dest_buf[first_byte] -= 1 << (7 - i);
-  for (int i = 0; i <= (endpos - 1) % 8; ++i)
-    dest_buf[last_byte] -= 1 << (7 - i);
-
+  dest_buf[first_byte] &= ~first_mask;
+  dest_buf[last_byte] &= ~last_mask;
   if (last_byte > first_byte + 1)
     memset(dest_buf + first_byte + 1, 0, last_byte - first_byte - 1);
 }
@@ -273,41 +251,131 @@ int FaxGetRun(const uint8_t* ins_array,
   }
 }
 
+// Returns the |count| bits at |bitpos|, with 0 bits past the end of the data.
+uint32_t PeekBits(const uint8_t* src_buf, int bitsize, int bitpos, int count) {
+  ASSERT(count <= 17);
+  int byte_pos = bitpos / 8;
+  int src_size = bitsize / 8;
+  uint32_t data;
+  if (byte_pos + 3 <= src_size) {
+    data = (src_buf[byte_pos] << 16) | (src_buf[byte_pos + 1] << 8) |
+           src_buf[byte_pos + 2];
+  } else {
+    data = 0;
+    for (int i = byte_pos; i < byte_pos + 3; ++i)
+      data = (data << 8) | (i < src_size ? src_buf[i] : 0);
+  }
+  return (data >> (24 - bitpos % 8 - count)) & ((1 << count) - 1);
+}
+
+// Run codes up to this long are looked up in one step. That covers every
+// white code up to 1728 and the black codes for runs below 18. Longer codes
+// go through FaxGetRun().
+const int kRunLookupBits = 10;
+
+struct FaxRunTable {
+  const uint8_t* ins_array;
+  // The run length in the top 12 bits and the code length in the low 4 bits,
+  // or 0 if no code fits in kRunLookupBits.
+  uint16_t entries[1 << kRunLookupBits];
+};
+
+struct FaxRunTables {
+  FaxRunTable white;
+  FaxRunTable black;
+};
+
+// Builds the lookup table from FaxGetRun() itself, so both agree on every
+// code, including the ones that are not in the spec.
+void BuildRunTable(const uint8_t* ins_array, FaxRunTable* table) {
+  table->ins_array = ins_array;
+  for (uint32_t code = 0; code < (1u << kRunLookupBits); ++code) {
+    uint32_t aligned = code << (16 - kRunLookupBits);
+    const uint8_t bits[2] = {static_cast<uint8_t>(aligned >> 8),
+                             static_cast<uint8_t>(aligned)};
+    int bitpos = 0;
+    int run = FaxGetRun(ins_array, bits, &bitpos, kRunLookupBits);
+    table->entries[code] = run < 0 ? 0 : (run << 4) | bitpos;
+  }
+}
+
+FaxRunTables BuildRunTables() {
+  FaxRunTables tables;
+  BuildRunTable(FaxWhiteRunIns, &tables.white);
+  BuildRunTable(FaxBlackRunIns, &tables.black);
+  return tables;
+}
+
+const FaxRunTables& GetFaxRunTables() {
+  static const FaxRunTables tables = BuildRunTables();
+  return tables;
+}
+
+// Same as FaxGetRun(), but most codes take a single table lookup.
+int FaxDecodeRun(const FaxRunTable& table,
+                 const uint8_t* src_buf,
+                 int* bitpos,
+                 int bitsize) {
+  uint16_t entry =
+      table.entries[PeekBits(src_buf, bitsize, *bitpos, kRunLookupBits)];
+  if (!entry)
+    return FaxGetRun(table.ins_array, src_buf, bitpos, bitsize);
+
+  int code_len = entry & 0xf;
+  if (code_len > bitsize - *bitpos) {
+    // The code is cut off by the end of the data.
+    *bitpos = std::max(*bitpos, bitsize);
+    return -1;
+  }
+  *bitpos += code_len;
+  return entry >> 4;
+}
+
+// 2D mode codes are told apart by their leading zero bits. Indexed by that
+// count, these are their lengths, including the bit after the leading 1 for
+// the vertical modes. 7 zeros is not a valid code, but is read as one.
+const int kModeCodeBits = 7;
+const int kModeCodeLength[kModeCodeBits + 1] = {1, 3, 3, 4, 6, 7, 7, 7};
+
 void FaxG4GetRow(const uint8_t* src_buf,
                  int bitsize,
                  int* bitpos,
                  uint8_t* dest_buf,
                  const std::vector<uint8_t>& ref_buf,
                  int columns) {
+  const FaxRunTables& tables = GetFaxRunTables();
   int a0 = -1;
   bool a0color = true;
   while (1) {
     if (*bitpos >= bitsize)
       return;
 
+    uint32_t mode = PeekBits(src_buf, bitsize, *bitpos, kModeCodeBits);
+    int zeros = pdfium::base::bits::CountLeadingZeroBits32(mode) -
+                (32 - kModeCodeBits);
+    if (kModeCodeLength[zeros] > bitsize - *bitpos) {
+      *bitpos = bitsize;
+      return;
+    }
+    *bitpos += kModeCodeLength[zeros];
+    // For vertical modes, whether a1 is to the right of b1.
+    bool right = zeros < 6 && ((mode >> (5 - zeros)) & 1);
+
     int a1;
     int a2;
-    int b1;
-    int b2;
-    FaxG4FindB1B2(ref_buf, columns, a0, a0color, &b1, &b2);
-
     int v_delta = 0;
-    if (!NextBit(src_buf, bitpos)) {
-      if (*bitpos >= bitsize)
-        return;
-
-      bool bit1 = NextBit(src_buf, bitpos);
-      if (*bitpos >= bitsize)
-        return;
-
-      bool bit2 = NextBit(src_buf, bitpos);
-      if (bit1) {
-        v_delta = bit2 ? 1 : -1;
-      } else if (bit2) {
+    switch (zeros) {
+      case 0:
+        break;
+      case 1:
+        v_delta = right ? 1 : -1;
+        break;
+      case 2: {
+        const FaxRunTable& run_table1 = a0color ? tables.white : tables.black;
+        const FaxRunTable& run_table2 = a0color ? tables.black : tables.white;
         int run_len1 = 0;
         while (1) {
-          int run = FaxGetRun(a0color ? FaxWhiteRunIns : FaxBlackRunIns,
-                              src_buf, bitpos, bitsize);
+          int run = FaxDecodeRun(run_table1, src_buf, bitpos, bitsize);
           run_len1 += run;
           if (run < 64)
             break;
@@ -323,8 +391,7 @@ void FaxG4GetRow(const uint8_t* src_buf,
 
         int run_len2 = 0;
         while (1) {
-          int run = FaxGetRun(a0color ? FaxBlackRunIns : FaxWhiteRunIns,
-                              src_buf, bitpos, bitsize);
+          int run = FaxDecodeRun(run_table2, src_buf, bitpos, bitsize);
           run_len2 += run;
           if (run < 64)
             break;
@@ -340,49 +407,36 @@ void FaxG4GetRow(const uint8_t* src_buf,
           continue;
 
         return;
-      } else {
-        if (*bitpos >= bitsize)
-          return;
-
-        if (NextBit(src_buf, bitpos)) {
-          if (!a0color)
-            FaxFillBits(dest_buf, columns, a0, b2);
-
-          if (b2 >= columns)
-            return;
-
-          a0 = b2;
-          continue;
-        }
-
-        if (*bitpos >= bitsize)
-          return;
+      }
+      case 3: {
+        int b1;
+        int b2;
+        FaxG4FindB1B2(ref_buf, columns, a0, a0color, &b1, &b2);
+        if (!a0color)
+          FaxFillBits(dest_buf, columns, a0, b2);
 
-        bool next_bit1 = NextBit(src_buf, bitpos);
-        if (*bitpos >= bitsize)
+        if (b2 >= columns)
           return;
 
-        bool next_bit2 = NextBit(src_buf, bitpos);
-        if (next_bit1) {
-          v_delta = next_bit2 ? 2 : -2;
-        } else if (next_bit2) {
-          if (*bitpos >= bitsize)
-            return;
-
-          v_delta = NextBit(src_buf, bitpos) ? 3 : -3;
-        } else {
-          if (*bitpos >= bitsize)
-            return;
-
-          if (NextBit(src_buf, bitpos)) {
-            *bitpos += 3;
-            continue;
-          }
-          *bitpos += 5;
-          return;
-        }
+        a0 = b2;
+        continue;
       }
+      case 4:
+        v_delta = right ? 2 : -2;
+        break;
+      case 5:
+        v_delta = right ? 3 : -3;
+        break;
+      case 6:
+        *bitpos += 3;
+        continue;
+      default:
+        *bitpos += 5;
+        return;
     }
+    int b1;
+    int b2;
+    FaxG4FindB1B2(ref_buf, columns, a0, a0color, &b1, &b2);
     a1 = b1 + v_delta;
     if (!a0color)
       FaxFillBits(dest_buf, columns, a0, a1);
@@ -415,6 +469,7 @@ void FaxGet1DLine(const uint8_t* src_buf,
                   int* bitpos,
                   std::vector<uint8_t>* dest_buf,
                   int columns) {
+  const FaxRunTables& tables = GetFaxRunTables();
   bool color = true;
   int startpos = 0;
   while (1) {
@@ -423,8 +478,8 @@ void FaxGet1DLine(const uint8_t* src_buf,
 
     int run_len = 0;
     while (1) {
-      int run = FaxGetRun(color ? FaxWhiteRunIns : FaxBlackRunIns, src_buf,
-                          bitpos, bitsize);
+      int run = FaxDecodeRun(color ? tables.white : tables.black, src_buf,
+                             bitpos, bitsize);
       if (run < 0) {
         while (*bitpos < bitsize) {
           if (NextBit(src_buf, bitpos))
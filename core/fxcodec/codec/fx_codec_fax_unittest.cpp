@@ -0,0 +1,404 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "core/fxcodec/codec/ccodec_faxmodule.h"
+#include "core/fxcodec/codec/ccodec_scanlinedecoder.h"
+#include "core/fxcodec/fx_codec.h"
+#include "core/fxcodec/jbig2/JBig2_Image.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/jbig2_testhelpers.h"
+#include "third_party/base/ptr_util.h"
+
+namespace {
+
+const int kWidth = 200;
+const int kHeight = 6;
+const int kPitch = (kWidth + 7) / 8;
+
+// A 200x6 image in CCITT G4. It has runs long enough for makeup codes, and
+// uses the pass, horizontal and every vertical mode.
+const uint8_t kG4Data[] = {0x93, 0x84, 0x32, 0x70, 0x52, 0x26, 0xa1,
+                           0x91, 0x9d, 0x8e, 0x60, 0xcd, 0x06, 0x83,
+                           0x41, 0xa4, 0x16, 0xda, 0x86, 0xe4, 0x0f,
+                           0x3d, 0x82, 0xb6, 0x23};
+
+struct BlackRun {
+  int row;
+  int start;
+  int end;
+};
+
+const BlackRun kBlackRuns[] = {
+    {1, 10, 20}, {1, 150, 200}, {2, 0, 130},  {2, 195, 200}, {3, 3, 6},
+    {3, 9, 12},  {3, 15, 18},   {3, 21, 24},  {4, 4, 7},     {4, 8, 12},
+    {4, 17, 19}, {4, 21, 90},   {5, 5, 8}};
+
+// Returns the image with 0 bits for black, as the decoder writes it.
+std::vector<uint8_t> ExpectedImage() {
+  std::vector<uint8_t> image(kPitch * kHeight, 0xff);
+  for (const BlackRun& run : kBlackRuns) {
+    for (int x = run.start; x < run.end; ++x)
+      image[run.row * kPitch + x / 8] &= ~(0x80 >> (x % 8));
+  }
+  return image;
+}
+
+
+struct FaxCode {
+  uint16_t code;
+  uint8_t length;
+};
+
+// The run length codes of ITU-T T.4, for runs of 0 to 63 and for multiples of
+// 64 up to 2560.
+const FaxCode kWhiteTerminatingCodes[64] = {
+    {0x035, 8}, {0x007, 6}, {0x007, 4}, {0x008, 4}, {0x00b, 4}, {0x00c, 4},
+    {0x00e, 4}, {0x00f, 4}, {0x013, 5}, {0x014, 5}, {0x007, 5}, {0x008, 5},
+    {0x008, 6}, {0x003, 6}, {0x034, 6}, {0x035, 6}, {0x02a, 6}, {0x02b, 6},
+    {0x027, 7}, {0x00c, 7}, {0x008, 7}, {0x017, 7}, {0x003, 7}, {0x004, 7},
+    {0x028, 7}, {0x02b, 7}, {0x013, 7}, {0x024, 7}, {0x018, 7}, {0x002, 8},
+    {0x003, 8}, {0x01a, 8}, {0x01b, 8}, {0x012, 8}, {0x013, 8}, {0x014, 8},
+    {0x015, 8}, {0x016, 8}, {0x017, 8}, {0x028, 8}, {0x029, 8}, {0x02a, 8},
+    {0x02b, 8}, {0x02c, 8}, {0x02d, 8}, {0x004, 8}, {0x005, 8}, {0x00a, 8},
+    {0x00b, 8}, {0x052, 8}, {0x053, 8}, {0x054, 8}, {0x055, 8}, {0x024, 8},
+    {0x025, 8}, {0x058, 8}, {0x059, 8}, {0x05a, 8}, {0x05b, 8}, {0x04a, 8},
+    {0x04b, 8}, {0x032, 8}, {0x033, 8}, {0x034, 8}};
+
+const FaxCode kWhiteMakeupCodes[40] = {
+    {0x01b, 5}, {0x012, 5}, {0x017, 6}, {0x037, 7}, {0x036, 8}, {0x037, 8},
+    {0x064, 8}, {0x065, 8}, {0x068, 8}, {0x067, 8}, {0x0cc, 9}, {0x0cd, 9},
+    {0x0d2, 9}, {0x0d3, 9}, {0x0d4, 9}, {0x0d5, 9}, {0x0d6, 9}, {0x0d7, 9},
+    {0x0d8, 9}, {0x0d9, 9}, {0x0da, 9}, {0x0db, 9}, {0x098, 9}, {0x099, 9},
+    {0x09a, 9}, {0x018, 6}, {0x09b, 9}, {0x008, 11}, {0x00c, 11}, {0x00d, 11},
+    {0x012, 12}, {0x013, 12}, {0x014, 12}, {0x015, 12}, {0x016, 12},
+    {0x017, 12}, {0x01c, 12}, {0x01d, 12}, {0x01e, 12}, {0x01f, 12}};
+
+const FaxCode kBlackTerminatingCodes[64] = {
+    {0x037, 10}, {0x002, 3}, {0x003, 2}, {0x002, 2}, {0x003, 3}, {0x003, 4},
+    {0x002, 4}, {0x003, 5}, {0x005, 6}, {0x004, 6}, {0x004, 7}, {0x005, 7},
+    {0x007, 7}, {0x004, 8}, {0x007, 8}, {0x018, 9}, {0x017, 10}, {0x018, 10},
+    {0x008, 10}, {0x067, 11}, {0x068, 11}, {0x06c, 11}, {0x037, 11},
+    {0x028, 11}, {0x017, 11}, {0x018, 11}, {0x0ca, 12}, {0x0cb, 12},
+    {0x0cc, 12}, {0x0cd, 12}, {0x068, 12}, {0x069, 12}, {0x06a, 12},
+    {0x06b, 12}, {0x0d2, 12}, {0x0d3, 12}, {0x0d4, 12}, {0x0d5, 12},
+    {0x0d6, 12}, {0x0d7, 12}, {0x06c, 12}, {0x06d, 12}, {0x0da, 12},
+    {0x0db, 12}, {0x054, 12}, {0x055, 12}, {0x056, 12}, {0x057, 12},
+    {0x064, 12}, {0x065, 12}, {0x052, 12}, {0x053, 12}, {0x024, 12},
+    {0x037, 12}, {0x038, 12}, {0x027, 12}, {0x028, 12}, {0x058, 12},
+    {0x059, 12}, {0x02b, 12}, {0x02c, 12}, {0x05a, 12}, {0x066, 12},
+    {0x067, 12}};
+
+const FaxCode kBlackMakeupCodes[40] = {
+    {0x00f, 10}, {0x0c8, 12}, {0x0c9, 12}, {0x05b, 12}, {0x033, 12},
+    {0x034, 12}, {0x035, 12}, {0x06c, 13}, {0x06d, 13}, {0x04a, 13},
+    {0x04b, 13}, {0x04c, 13}, {0x04d, 13}, {0x072, 13}, {0x073, 13},
+    {0x074, 13}, {0x075, 13}, {0x076, 13}, {0x077, 13}, {0x052, 13},
+    {0x053, 13}, {0x054, 13}, {0x055, 13}, {0x05a, 13}, {0x05b, 13},
+    {0x064, 13}, {0x065, 13}, {0x008, 11}, {0x00c, 11}, {0x00d, 11},
+    {0x012, 12}, {0x013, 12}, {0x014, 12}, {0x015, 12}, {0x016, 12},
+    {0x017, 12}, {0x01c, 12}, {0x01d, 12}, {0x01e, 12}, {0x01f, 12}};
+
+// Vertical mode codes, indexed by a1 - b1 + 3.
+const FaxCode kVerticalCodes[7] = {{0x02, 7}, {0x02, 6}, {0x02, 3}, {0x01, 1},
+                                   {0x03, 3}, {0x03, 6}, {0x03, 7}};
+
+class FaxBitWriter {
+ public:
+  void Write(uint32_t value, int length) {
+    for (int i = length - 1; i >= 0; --i) {
+      if (m_BitPos % 8 == 0)
+        m_Data.push_back(0);
+      if ((value >> i) & 1)
+        m_Data.back() |= 0x80 >> (m_BitPos % 8);
+      ++m_BitPos;
+    }
+  }
+
+  int bit_pos() const { return m_BitPos; }
+  const std::vector<uint8_t>& data() const { return m_Data; }
+
+ private:
+  std::vector<uint8_t> m_Data;
+  int m_BitPos = 0;
+};
+
+void EncodeRun(FaxBitWriter* writer, int32_t run, bool white) {
+  const FaxCode* makeup = white ? kWhiteMakeupCodes : kBlackMakeupCodes;
+  const FaxCode* terminating =
+      white ? kWhiteTerminatingCodes : kBlackTerminatingCodes;
+  while (run >= 64) {
+    int32_t units = std::min(run, 2560) / 64;
+    writer->Write(makeup[units - 1].code, makeup[units - 1].length);
+    run -= units * 64;
+  }
+  writer->Write(terminating[run].code, terminating[run].length);
+}
+
+// Returns the first pixel at or after |start| on row |y| whose colour differs
+// from the one before it, or the width if there is none. Rows and pixels
+// outside the image are white.
+int32_t NextChange(CJBig2_Image* image, int32_t y, int32_t start) {
+  for (int32_t x = start; x < image->width(); ++x) {
+    if (image->getPixel(x, y) != image->getPixel(x - 1, y))
+      return x;
+  }
+  return image->width();
+}
+
+void Encode1DLine(FaxBitWriter* writer, CJBig2_Image* image, int32_t y) {
+  int32_t x = 0;
+  int color = 0;
+  while (x < image->width()) {
+    int32_t end = x;
+    while (end < image->width() && image->getPixel(end, y) == color)
+      ++end;
+    EncodeRun(writer, end - x, color == 0);
+    x = end;
+    color = !color;
+  }
+}
+
+void Encode2DLine(FaxBitWriter* writer, CJBig2_Image* image, int32_t y) {
+  int32_t a0 = -1;
+  int color = 0;
+  while (a0 < image->width()) {
+    int32_t a1 = NextChange(image, y, a0 + 1);
+    int32_t b1 = NextChange(image, y - 1, a0 + 1);
+    while (b1 < image->width() && image->getPixel(b1, y - 1) == color)
+      b1 = NextChange(image, y - 1, b1 + 1);
+    int32_t b2 = NextChange(image, y - 1, b1 + 1);
+    if (b2 < a1) {
+      // Pass mode.
+      writer->Write(0x1, 4);
+      a0 = b2;
+    } else if (a1 - b1 >= -3 && a1 - b1 <= 3) {
+      const FaxCode& code = kVerticalCodes[a1 - b1 + 3];
+      writer->Write(code.code, code.length);
+      a0 = a1;
+      color = !color;
+    } else {
+      // Horizontal mode.
+      int32_t a2 = NextChange(image, y, a1 + 1);
+      writer->Write(0x1, 3);
+      EncodeRun(writer, a1 - std::max(a0, 0), color == 0);
+      EncodeRun(writer, a2 - a1, color != 0);
+      a0 = a2;
+    }
+  }
+}
+
+// Encodes |image|, where 1 is black, the way a CCITTFaxDecode filter with
+// these parameters expects.
+std::vector<uint8_t> FaxEncode(CJBig2_Image* image,
+                               int K,
+                               bool end_of_line,
+                               bool byte_align) {
+  FaxBitWriter writer;
+  for (int32_t y = 0; y < image->height(); ++y) {
+    if (end_of_line) {
+      // With byte alignment, fill bits make each EOL end on a byte boundary.
+      while (byte_align && (writer.bit_pos() + 12) % 8)
+        writer.Write(0, 1);
+      writer.Write(0x001, 12);
+    } else if (byte_align) {
+      while (writer.bit_pos() % 8)
+        writer.Write(0, 1);
+    }
+    bool two_d = K < 0 || (K > 0 && y % K != 0);
+    if (K > 0)
+      writer.Write(!two_d, 1);
+    if (two_d)
+      Encode2DLine(&writer, image, y);
+    else
+      Encode1DLine(&writer, image, y);
+  }
+  return writer.data();
+}
+
+// Makes an image with runs of every length the codes cover, including
+// makeup codes beyond 2560, and rows close to the one above so that the 2D
+// modes get used too.
+std::unique_ptr<CJBig2_Image> MakeFaxTestImage() {
+  auto image = pdfium::MakeUnique<CJBig2_Image>(2700, 40);
+  image->fill(false);
+  uint32_t seed = 1;
+  auto next = [&seed]() {
+    seed = seed * 1103515245 + 12345;
+    return static_cast<int32_t>(seed >> 16);
+  };
+  const int32_t kMaxRuns[] = {4, 70, 400, 2700};
+  for (int32_t y = 0; y < image->height(); ++y) {
+    if (y > 0 && next() % 2) {
+      // Copy the row above with a few edges moved.
+      image->copyLine(y, y - 1);
+      for (int i = next() % 8; i > 0; --i) {
+        int32_t x = NextChange(image.get(), y, next() % image->width());
+        for (int32_t dx = next() % 7 - 3; dx != 0; dx += dx < 0 ? 1 : -1)
+          image->setPixel(x + dx, y, !image->getPixel(x + dx, y));
+      }
+      continue;
+    }
+    int32_t max_run = kMaxRuns[next() % 4];
+    int color = next() % 2;
+    for (int32_t x = 0; x < image->width();) {
+      int32_t end = std::min(x + 1 + next() % max_run, image->width());
+      for (; x < end; ++x)
+        image->setPixel(x, y, color);
+      color = !color;
+    }
+  }
+  return image;
+}
+
+// Checks that every scanline decodes to |image|, whose rows are laid out the
+// same way as the decoder output but with 1 for black.
+void CheckFaxDecoder(CJBig2_Image* image,
+                     const std::vector<uint8_t>& data,
+                     int K,
+                     bool end_of_line,
+                     bool byte_align,
+                     bool black_is_1) {
+  std::unique_ptr<CCodec_ScanlineDecoder> decoder =
+      CCodec_ModuleMgr().GetFaxModule()->CreateDecoder(
+          data.data(), data.size(), image->width(), image->height(), K,
+          end_of_line, byte_align, black_is_1, 0, 0);
+  ASSERT_TRUE(decoder);
+  for (int32_t y = 0; y < image->height(); ++y) {
+    const uint8_t* line = decoder->GetScanline(y);
+    ASSERT_TRUE(line) << "row " << y;
+    const uint8_t* expected = image->m_pData + y * image->stride();
+    for (int32_t i = 0; i < image->stride(); ++i) {
+      ASSERT_EQ(black_is_1 ? expected[i] : ~expected[i] & 0xff, line[i])
+          << "row " << y << " byte " << i;
+    }
+  }
+  EXPECT_EQ(data.size(), decoder->GetSrcOffset());
+}
+
+}  // namespace
+
+TEST(fxcodec, FaxG4Decoder) {
+  const std::vector<uint8_t> expected = ExpectedImage();
+  for (bool black_is_1 : {false, true}) {
+    std::unique_ptr<CCodec_ScanlineDecoder> decoder =
+        CCodec_ModuleMgr().GetFaxModule()->CreateDecoder(
+            kG4Data, sizeof(kG4Data), kWidth, kHeight, -1, false, false,
+            black_is_1, 0, 0);
+    ASSERT_TRUE(decoder);
+    for (int row = 0; row < kHeight; ++row) {
+      const uint8_t* line = decoder->GetScanline(row);
+      ASSERT_TRUE(line);
+      for (int i = 0; i < kPitch; ++i) {
+        uint8_t expected_byte = expected[row * kPitch + i];
+        EXPECT_EQ(black_is_1 ? ~expected_byte & 0xff : expected_byte,
+                  line[i])
+            << "row " << row << " byte " << i;
+      }
+    }
+    EXPECT_EQ(sizeof(kG4Data), decoder->GetSrcOffset());
+  }
+}
+
+TEST(fxcodec, FaxG4Decode) {
+  std::vector<uint8_t> image(kPitch * kHeight);
+  int bitpos = 0;
+  FaxG4Decode(kG4Data, sizeof(kG4Data), &bitpos, image.data(), kWidth,
+              kHeight, kPitch);
+  EXPECT_EQ(ExpectedImage(), image);
+  EXPECT_EQ(200, bitpos);
+
+  // Running out of data leaves the rest of the image white.
+  std::vector<uint8_t> truncated(kPitch * kHeight);
+  bitpos = 0;
+  FaxG4Decode(kG4Data, 4, &bitpos, truncated.data(), kWidth, kHeight, kPitch);
+  EXPECT_EQ(32, bitpos);
+  for (int i = 2 * kPitch; i < kPitch * kHeight; ++i)
+    EXPECT_EQ(0xff, truncated[i]) << "byte " << i;
+}
+
+TEST(fxcodec, FaxDecoderEncodings) {
+  std::unique_ptr<CJBig2_Image> image = MakeFaxTestImage();
+  for (int K : {0, 2, 5, -1}) {
+    for (int options = 0; options < 4; ++options) {
+      bool end_of_line = options & 1;
+      bool byte_align = options & 2;
+      std::vector<uint8_t> data =
+          FaxEncode(image.get(), K, end_of_line, byte_align);
+      for (bool black_is_1 : {false, true}) {
+        SCOPED_TRACE(testing::Message()
+                     << "K " << K << " EndOfLine " << end_of_line
+                     << " EncodedByteAlign " << byte_align << " BlackIs1 "
+                     << black_is_1);
+        CheckFaxDecoder(image.get(), data, K, end_of_line, byte_align,
+                        black_is_1);
+      }
+    }
+  }
+
+  // FaxG4Decode() packs the rows without padding.
+  std::vector<uint8_t> data = FaxEncode(image.get(), -1, false, false);
+  int pitch = (image->width() + 7) / 8;
+  std::vector<uint8_t> decoded(pitch * image->height());
+  int bitpos = 0;
+  FaxG4Decode(data.data(), data.size(), &bitpos, decoded.data(),
+              image->width(), image->height(), pitch);
+  EXPECT_EQ(data.size(), static_cast<size_t>((bitpos + 7) / 8));
+  for (int32_t y = 0; y < image->height(); ++y) {
+    for (int i = 0; i < pitch; ++i) {
+      uint8_t expected = image->m_pData[y * image->stride() + i];
+      ASSERT_EQ(~expected & 0xff, decoded[y * pitch + i])
+          << "row " << y << " byte " << i;
+    }
+  }
+}
+
+// Times decoding a text page of A4 at 300 dpi in each encoding. Run with
+// --gtest_also_run_disabled_tests.
+TEST(fxcodec, DISABLED_FaxDecodeSpeed) {
+  const int kRuns = 10;
+  auto page = pdfium::MakeUnique<CJBig2_Image>(2480, 3508);
+  DrawJBig2TextPage(page.get(), 7);
+  for (int K : {0, 4, -1}) {
+    std::vector<uint8_t> data = FaxEncode(page.get(), K, false, false);
+    std::chrono::duration<double, std::milli> best =
+        std::chrono::duration<double>::max();
+    for (int run = 0; run < kRuns; ++run) {
+      auto start = std::chrono::steady_clock::now();
+      std::unique_ptr<CCodec_ScanlineDecoder> decoder =
+          CCodec_ModuleMgr().GetFaxModule()->CreateDecoder(
+              data.data(), data.size(), page->width(), page->height(), K,
+              false, false, false, 0, 0);
+      ASSERT_TRUE(decoder);
+      for (int32_t y = 0; y < page->height(); ++y)
+        ASSERT_TRUE(decoder->GetScanline(y));
+      best = std::min<std::chrono::duration<double, std::milli>>(
+          best, std::chrono::steady_clock::now() - start);
+    }
+    printf("K=%d: %zu bytes, best of %d %.1f ms\n", K, data.size(), kRuns,
+           best.count());
+  }
+
+  std::vector<uint8_t> data = FaxEncode(page.get(), -1, false, false);
+  int pitch = (page->width() + 7) / 8;
+  std::vector<uint8_t> decoded(pitch * page->height());
+  std::chrono::duration<double, std::milli> best =
+      std::chrono::duration<double>::max();
+  for (int run = 0; run < kRuns; ++run) {
+    int bitpos = 0;
+    auto start = std::chrono::steady_clock::now();
+    FaxG4Decode(data.data(), data.size(), &bitpos, decoded.data(),
+                page->width(), page->height(), pitch);
+    best = std::min<std::chrono::duration<double, std::milli>>(
+        best, std::chrono::steady_clock::now() - start);
+  }
+  printf("FaxG4Decode: best of %d %.1f ms\n", kRuns, best.count());
+}
@@ -13,6 +13,7 @@
 
 #include "core/fxcodec/fx_codec.h"
 #include "core/fxcrt/fx_extension.h"
+#include "core/fxcrt/fx_safe_types.h"
 #include "third_party/base/numerics/safe_conversions.h"
 #include "third_party/base/ptr_util.h"
 
@@ -22,6 +23,12 @@
 #include "third_party/zlib/zlib.h"
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PREDICTOR_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 extern "C" {
 
 static void* my_alloc_func(void* opaque,
@@ -285,6 +292,286 @@ void PNG_PredictorEncode(uint8_t** data_buf, uint32_t* data_size) {
                (last_row_size > 0 ? (row_size - last_row_size) : 0);
 }
 
+// The PNG and TIFF predictors below undo the filter one pixel at a time so
+// the left neighbour is carried in a register instead of being reloaded from
+// the row just written. The SSE2 kernels cover the pixel sizes of 8 and 16 bit
+// RGB(A) data and return how many bytes they handled; the scalar loops finish
+// the remainder and handle every other pixel size.
+#if defined(PREDICTOR_USE_SSE2)
+
+// Pixels are loaded as a whole 4 or 8 bytes, so callers only use these while
+// that many bytes remain in the row. Only the pixel itself is stored.
+template <int kBpp>
+constexpr int LoadSize() {
+  return kBpp <= 4 ? 4 : 8;
+}
+
+template <int kBpp>
+__m128i LoadBytes(const uint8_t* p) {
+  if (kBpp <= 4) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return _mm_cvtsi32_si128(value);
+  }
+  return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+}
+
+template <int kBpp>
+void StoreBytes(uint8_t* p, __m128i v) {
+  if (kBpp <= 4) {
+    uint32_t value = _mm_cvtsi128_si32(v);
+    memcpy(p, &value, kBpp);
+    return;
+  }
+  uint64_t value;
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(&value), v);
+  memcpy(p, &value, kBpp);
+}
+
+// Widens a pixel to one 16-bit lane per byte. The 8-bit adds used on these
+// lanes wrap within the low byte and leave the high byte zero.
+template <int kBpp>
+__m128i LoadPixel(const uint8_t* p) {
+  return _mm_unpacklo_epi8(LoadBytes<kBpp>(p), _mm_setzero_si128());
+}
+
+template <int kBpp>
+void StorePixel(uint8_t* p, __m128i v) {
+  StoreBytes<kBpp>(p, _mm_packus_epi16(v, v));
+}
+
+__m128i AbsInt16(__m128i v) {
+  __m128i negative = _mm_cmplt_epi16(v, _mm_setzero_si128());
+  return _mm_sub_epi16(_mm_xor_si128(v, negative), negative);
+}
+
+__m128i Select(__m128i mask, __m128i a, __m128i b) {
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+template <int kBpp>
+int PNG_SubSSE2(uint8_t* pDest, const uint8_t* pRaw, int size) {
+  __m128i left = _mm_setzero_si128();
+  int i = 0;
+  for (; i + LoadSize<kBpp>() <= size; i += kBpp) {
+    left = _mm_add_epi8(LoadPixel<kBpp>(pRaw + i), left);
+    StorePixel<kBpp>(pDest + i, left);
+  }
+  return i;
+}
+
+int PNG_UpSSE2(uint8_t* pDest,
+               const uint8_t* pRaw,
+               const uint8_t* pPrev,
+               int size) {
+  int i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRaw + i));
+    __m128i up = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pPrev + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + i),
+                     _mm_add_epi8(raw, up));
+  }
+  return i;
+}
+
+template <int kBpp>
+int PNG_AverageSSE2(uint8_t* pDest,
+                    const uint8_t* pRaw,
+                    const uint8_t* pPrev,
+                    int size) {
+  const __m128i one = _mm_set1_epi16(1);
+  __m128i left = _mm_setzero_si128();
+  int i = 0;
+  for (; i + LoadSize<kBpp>() <= size; i += kBpp) {
+    __m128i up = LoadPixel<kBpp>(pPrev + i);
+    // _mm_avg_epu8() rounds up; drop the odd bit to get (left + up) / 2.
+    __m128i avg = _mm_sub_epi8(_mm_avg_epu8(left, up),
+                               _mm_and_si128(_mm_xor_si128(left, up), one));
+    left = _mm_add_epi8(LoadPixel<kBpp>(pRaw + i), avg);
+    StorePixel<kBpp>(pDest + i, left);
+  }
+  return i;
+}
+
+template <int kBpp>
+int PNG_PaethSSE2(uint8_t* pDest,
+                  const uint8_t* pRaw,
+                  const uint8_t* pPrev,
+                  int size) {
+  __m128i left = _mm_setzero_si128();
+  __m128i upper_left = _mm_setzero_si128();
+  int i = 0;
+  for (; i + LoadSize<kBpp>() <= size; i += kBpp) {
+    __m128i up = LoadPixel<kBpp>(pPrev + i);
+    // With p = left + up - upper_left, as in PathPredictor().
+    __m128i pa = _mm_sub_epi16(up, upper_left);
+    __m128i pb = _mm_sub_epi16(left, upper_left);
+    __m128i pc = _mm_add_epi16(pa, pb);
+    pa = AbsInt16(pa);
+    pb = AbsInt16(pb);
+    pc = AbsInt16(pc);
+    __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+    __m128i nearest =
+        Select(_mm_cmpeq_epi16(pa, smallest), left,
+               Select(_mm_cmpeq_epi16(pb, smallest), up, upper_left));
+    left = _mm_add_epi8(LoadPixel<kBpp>(pRaw + i), nearest);
+    StorePixel<kBpp>(pDest + i, left);
+    upper_left = up;
+  }
+  return i;
+}
+
+// TIFF 16-bit samples are big-endian, so swap each lane around the add.
+template <int kBpp>
+int TIFF_Predict16SSE2(uint8_t* dest_buf, int size) {
+  __m128i left = _mm_setzero_si128();
+  int i = 0;
+  for (; i + LoadSize<kBpp>() <= size; i += kBpp) {
+    __m128i pixel = LoadBytes<kBpp>(dest_buf + i);
+    pixel = _mm_or_si128(_mm_slli_epi16(pixel, 8), _mm_srli_epi16(pixel, 8));
+    left = _mm_add_epi16(pixel, left);
+    StoreBytes<kBpp>(dest_buf + i, _mm_or_si128(_mm_slli_epi16(left, 8),
+                                                _mm_srli_epi16(left, 8)));
+  }
+  return i;
+}
+
+#endif  // defined(PREDICTOR_USE_SSE2)
+
+void PNG_SubRow(uint8_t* pDest, const uint8_t* pRaw, int size, int bpp) {
+  int i = 0;
+#if defined(PREDICTOR_USE_SSE2)
+  switch (bpp) {
+    case 3:
+      i = PNG_SubSSE2<3>(pDest, pRaw, size);
+      break;
+    case 4:
+      i = PNG_SubSSE2<4>(pDest, pRaw, size);
+      break;
+    case 6:
+      i = PNG_SubSSE2<6>(pDest, pRaw, size);
+      break;
+    case 8:
+      i = PNG_SubSSE2<8>(pDest, pRaw, size);
+      break;
+  }
+#endif
+  for (; i < std::min(bpp, size); ++i)
+    pDest[i] = pRaw[i];
+  for (; i < size; ++i)
+    pDest[i] = pRaw[i] + pDest[i - bpp];
+}
+
+void PNG_UpRow(uint8_t* pDest,
+               const uint8_t* pRaw,
+               const uint8_t* pPrev,
+               int size) {
+  int i = 0;
+#if defined(PREDICTOR_USE_SSE2)
+  i = PNG_UpSSE2(pDest, pRaw, pPrev, size);
+#endif
+  for (; i < size; ++i)
+    pDest[i] = pRaw[i] + pPrev[i];
+}
+
+void PNG_AverageRow(uint8_t* pDest,
+                    const uint8_t* pRaw,
+                    const uint8_t* pPrev,
+                    int size,
+                    int bpp) {
+  int i = 0;
+  if (!pPrev) {
+    for (; i < std::min(bpp, size); ++i)
+      pDest[i] = pRaw[i];
+    for (; i < size; ++i)
+      pDest[i] = pRaw[i] + pDest[i - bpp] / 2;
+    return;
+  }
+#if defined(PREDICTOR_USE_SSE2)
+  switch (bpp) {
+    case 3:
+      i = PNG_AverageSSE2<3>(pDest, pRaw, pPrev, size);
+      break;
+    case 4:
+      i = PNG_AverageSSE2<4>(pDest, pRaw, pPrev, size);
+      break;
+    case 6:
+      i = PNG_AverageSSE2<6>(pDest, pRaw, pPrev, size);
+      break;
+    case 8:
+      i = PNG_AverageSSE2<8>(pDest, pRaw, pPrev, size);
+      break;
+  }
+#endif
+  for (; i < std::min(bpp, size); ++i)
+    pDest[i] = pRaw[i] + pPrev[i] / 2;
+  for (; i < size; ++i)
+    pDest[i] = pRaw[i] + (pDest[i - bpp] + pPrev[i]) / 2;
+}
+
+void PNG_PaethRow(uint8_t* pDest,
+                  const uint8_t* pRaw,
+                  const uint8_t* pPrev,
+                  int size,
+                  int bpp) {
+  int i = 0;
+#if defined(PREDICTOR_USE_SSE2)
+  switch (bpp) {
+    case 3:
+      i = PNG_PaethSSE2<3>(pDest, pRaw, pPrev, size);
+      break;
+    case 4:
+      i = PNG_PaethSSE2<4>(pDest, pRaw, pPrev, size);
+      break;
+    case 6:
+      i = PNG_PaethSSE2<6>(pDest, pRaw, pPrev, size);
+      break;
+    case 8:
+      i = PNG_PaethSSE2<8>(pDest, pRaw, pPrev, size);
+      break;
+  }
+#endif
+  // With no left or upper left neighbour the prediction is always up.
+  for (; i < std::min(bpp, size); ++i)
+    pDest[i] = pRaw[i] + pPrev[i];
+  for (; i < size; ++i) {
+    pDest[i] = pRaw[i] + PathPredictor(pDest[i - bpp], pPrev[i],
+                                       pPrev[i - bpp]);
+  }
+}
+
+// Reconstructs |size| bytes of a row filtered with |tag|. |pPrev| is the
+// previous reconstructed row, or null for the first row of the image.
+void PNG_ReconstructRow(uint8_t tag,
+                        uint8_t* pDest,
+                        const uint8_t* pRaw,
+                        const uint8_t* pPrev,
+                        int size,
+                        int bpp) {
+  // A missing row above reads as zeros: Up becomes None and Paeth becomes Sub.
+  switch (tag) {
+    case 1:
+      PNG_SubRow(pDest, pRaw, size, bpp);
+      return;
+    case 2:
+      if (pPrev) {
+        PNG_UpRow(pDest, pRaw, pPrev, size);
+        return;
+      }
+      break;
+    case 3:
+      PNG_AverageRow(pDest, pRaw, pPrev, size, bpp);
+      return;
+    case 4:
+      if (pPrev)
+        PNG_PaethRow(pDest, pRaw, pPrev, size, bpp);
+      else
+        PNG_SubRow(pDest, pRaw, size, bpp);
+      return;
+  }
+  memmove(pDest, pRaw, size);
+}
+
 void PNG_PredictLine(uint8_t* pDestData,
                      const uint8_t* pSrcData,
                      const uint8_t* pLastLine,
@@ -293,63 +580,8 @@ void PNG_PredictLine(uint8_t* pDestData,
                      int nPixels) {
   int row_size = (nPixels * bpc * nColors + 7) / 8;
   int BytesPerPixel = (bpc * nColors + 7) / 8;
-  uint8_t tag = pSrcData[0];
-  if (tag == 0) {
-    memmove(pDestData, pSrcData + 1, row_size);
-    return;
-  }
-  for (int byte = 0; byte < row_size; byte++) {
-    uint8_t raw_byte = pSrcData[byte + 1];
-    switch (tag) {
-      case 1: {
-        uint8_t left = 0;
-        if (byte >= BytesPerPixel) {
-          left = pDestData[byte - BytesPerPixel];
-        }
-        pDestData[byte] = raw_byte + left;
-        break;
-      }
-      case 2: {
-        uint8_t up = 0;
-        if (pLastLine) {
-          up = pLastLine[byte];
-        }
-        pDestData[byte] = raw_byte + up;
-        break;
-      }
-      case 3: {
-        uint8_t left = 0;
-        if (byte >= BytesPerPixel) {
-          left = pDestData[byte - BytesPerPixel];
-        }
-        uint8_t up = 0;
-        if (pLastLine) {
-          up = pLastLine[byte];
-        }
-        pDestData[byte] = raw_byte + (up + left) / 2;
-        break;
-      }
-      case 4: {
-        uint8_t left = 0;
-        if (byte >= BytesPerPixel) {
-          left = pDestData[byte - BytesPerPixel];
-        }
-        uint8_t up = 0;
-        if (pLastLine) {
-          up = pLastLine[byte];
-        }
-        uint8_t upper_left = 0;
-        if (byte >= BytesPerPixel && pLastLine) {
-          upper_left = pLastLine[byte - BytesPerPixel];
-        }
-        pDestData[byte] = raw_byte + PathPredictor(left, up, upper_left);
-        break;
-      }
-      default:
-        pDestData[byte] = raw_byte;
-        break;
-    }
-  }
+  PNG_ReconstructRow(pSrcData[0], pDestData, pSrcData + 1, pLastLine, row_size,
+                     BytesPerPixel);
 }
 
 bool PNG_Predictor(uint8_t*& data_buf,
@@ -366,76 +598,16 @@ bool PNG_Predictor(uint8_t*& data_buf,
     return false;
   const int last_row_size = data_size % (row_size + 1);
   uint8_t* dest_buf = FX_Alloc2D(uint8_t, row_size, row_count);
-  int byte_cnt = 0;
-  uint8_t* pSrcData = data_buf;
+  const uint8_t* pSrcData = data_buf;
   uint8_t* pDestData = dest_buf;
   for (int row = 0; row < row_count; row++) {
-    uint8_t tag = pSrcData[0];
-    byte_cnt++;
-    if (tag == 0) {
-      int move_size = row_size;
-      if ((row + 1) * (move_size + 1) > (int)data_size) {
-        move_size = last_row_size - 1;
-      }
-      memmove(pDestData, pSrcData + 1, move_size);
-      pSrcData += move_size + 1;
-      pDestData += move_size;
-      byte_cnt += move_size;
-      continue;
-    }
-    for (int byte = 0; byte < row_size && byte_cnt < (int)data_size; byte++) {
-      uint8_t raw_byte = pSrcData[byte + 1];
-      switch (tag) {
-        case 1: {
-          uint8_t left = 0;
-          if (byte >= BytesPerPixel) {
-            left = pDestData[byte - BytesPerPixel];
-          }
-          pDestData[byte] = raw_byte + left;
-          break;
-        }
-        case 2: {
-          uint8_t up = 0;
-          if (row) {
-            up = pDestData[byte - row_size];
-          }
-          pDestData[byte] = raw_byte + up;
-          break;
-        }
-        case 3: {
-          uint8_t left = 0;
-          if (byte >= BytesPerPixel) {
-            left = pDestData[byte - BytesPerPixel];
-          }
-          uint8_t up = 0;
-          if (row) {
-            up = pDestData[byte - row_size];
-          }
-          pDestData[byte] = raw_byte + (up + left) / 2;
-          break;
-        }
-        case 4: {
-          uint8_t left = 0;
-          if (byte >= BytesPerPixel) {
-            left = pDestData[byte - BytesPerPixel];
-          }
-          uint8_t up = 0;
-          if (row) {
-            up = pDestData[byte - row_size];
-          }
-          uint8_t upper_left = 0;
-          if (byte >= BytesPerPixel && row) {
-            upper_left = pDestData[byte - row_size - BytesPerPixel];
-          }
-          pDestData[byte] = raw_byte + PathPredictor(left, up, upper_left);
-          break;
-        }
-        default:
-          pDestData[byte] = raw_byte;
-          break;
-      }
-      byte_cnt++;
-    }
+    // Only the last row can be short, when the data ends part way through it.
+    int move_size = row_size;
+    if ((row + 1) * (move_size + 1) > (int)data_size)
+      move_size = last_row_size - 1;
+    PNG_ReconstructRow(pSrcData[0], pDestData, pSrcData + 1,
+                       row ? pDestData - row_size : nullptr, move_size,
+                       BytesPerPixel);
     pSrcData += row_size + 1;
     pDestData += row_size;
   }
@@ -454,25 +626,60 @@ void TIFF_PredictLine(uint8_t* dest_buf,
   if (BitsPerComponent == 1) {
     int row_bits = std::min(BitsPerComponent * Colors * Columns,
                             pdfium::base::checked_cast<int>(row_size * 8));
-    int index_pre = 0;
-    int col_pre = 0;
-    for (int i = 1; i < row_bits; i++) {
+    // Each bit becomes the XOR of itself and every bit before it, so whole
+    // bytes take a prefix XOR, inverted when the previous byte ended in 1.
+    int full_bytes = row_bits / 8;
+    uint8_t carry = 0;
+    for (int index = 0; index < full_bytes; index++) {
+      uint8_t byte = dest_buf[index];
+      byte ^= byte >> 1;
+      byte ^= byte >> 2;
+      byte ^= byte >> 4;
+      if (carry)
+        byte = ~byte;
+      dest_buf[index] = byte;
+      carry = byte & 1;
+    }
+    for (int i = std::max(full_bytes * 8, 1); i < row_bits; i++) {
       int col = i % 8;
       int index = i / 8;
+      int col_pre = (i - 1) % 8;
+      int index_pre = (i - 1) / 8;
       if (((dest_buf[index] >> (7 - col)) & 1) ^
           ((dest_buf[index_pre] >> (7 - col_pre)) & 1)) {
         dest_buf[index] |= 1 << (7 - col);
       } else {
         dest_buf[index] &= ~(1 << (7 - col));
       }
-      index_pre = index;
-      col_pre = col;
     }
     return;
   }
   int BytesPerPixel = BitsPerComponent * Colors / 8;
+  if (BitsPerComponent == 8) {
+    PNG_SubRow(dest_buf, dest_buf, row_size, BytesPerPixel);
+    return;
+  }
   if (BitsPerComponent == 16) {
-    for (uint32_t i = BytesPerPixel; i < row_size; i += 2) {
+    uint32_t i = BytesPerPixel;
+#if defined(PREDICTOR_USE_SSE2)
+    uint32_t done = 0;
+    switch (BytesPerPixel) {
+      case 2:
+        done = TIFF_Predict16SSE2<2>(dest_buf, row_size);
+        break;
+      case 4:
+        done = TIFF_Predict16SSE2<4>(dest_buf, row_size);
+        break;
+      case 6:
+        done = TIFF_Predict16SSE2<6>(dest_buf, row_size);
+        break;
+      case 8:
+        done = TIFF_Predict16SSE2<8>(dest_buf, row_size);
+        break;
+    }
+    i = std::max(i, done);
+#endif
+    for (; i < row_size; i += 2) {
       uint16_t pixel =
           (dest_buf[i - BytesPerPixel] << 8) | dest_buf[i - BytesPerPixel + 1];
       pixel += (dest_buf[i] << 8) | dest_buf[i + 1];
@@ -506,72 +713,99 @@ bool TIFF_Predictor(uint8_t*& data_buf,
   return true;
 }
 
+// An inflate context kept by each thread for FlateUncompress(), since
+// setting one up allocates and initializes its whole state and window.
+class CFlateContextCache {
+ public:
+  CFlateContextCache() : m_pContext(nullptr), m_bInUse(false) {}
+  ~CFlateContextCache() {
+    if (m_pContext)
+      FlateEnd(m_pContext);
+  }
+
+  // Returns a reset context, or a new one if the cached one is taken.
+  void* Acquire() {
+    if (m_bInUse)
+      return FlateInit();
+
+    m_bInUse = true;
+    if (!m_pContext)
+      m_pContext = FlateInit();
+    else
+      inflateReset(static_cast<z_stream*>(m_pContext));
+    return m_pContext;
+  }
+
+  void Release(void* context) {
+    if (context != m_pContext) {
+      FlateEnd(context);
+      return;
+    }
+    m_bInUse = false;
+  }
+
+ private:
+  void* m_pContext;
+  bool m_bInUse;
+};
+
 void FlateUncompress(const uint8_t* src_buf,
                      uint32_t src_size,
                      uint32_t orig_size,
                      uint8_t*& dest_buf,
                      uint32_t& dest_size,
                      uint32_t& offset) {
+  static thread_local CFlateContextCache s_ContextCache;
+
   dest_buf = nullptr;
   dest_size = 0;
-  void* context = FlateInit();
+  void* context = s_ContextCache.Acquire();
   if (!context)
     return;
 
+  z_stream* stream = static_cast<z_stream*>(context);
   FlateInput(context, src_buf, src_size);
 
+  // Inflate straight into one buffer that grows geometrically, instead of
+  // collecting fixed size chunks and copying them together at the end.
   const uint32_t kMaxInitialAllocSize = 10000000;
-  uint32_t guess_size = orig_size ? orig_size : src_size * 2;
-  guess_size = std::min(guess_size, kMaxInitialAllocSize);
-
-  uint32_t buf_size = guess_size;
-  uint32_t last_buf_size = buf_size;
-  std::unique_ptr<uint8_t, FxFreeDeleter> guess_buf(
-      FX_Alloc(uint8_t, guess_size + 1));
-  guess_buf.get()[guess_size] = '\0';
-
-  std::vector<uint8_t*> result_tmp_bufs;
-  uint8_t* cur_buf = guess_buf.release();
+  uint32_t guess_size = orig_size;
+  if (!guess_size) {
+    FX_SAFE_UINT32 safe_guess_size = src_size;
+    safe_guess_size *= 2;
+    guess_size = safe_guess_size.ValueOrDefault(kMaxInitialAllocSize);
+  }
+  uint32_t buf_size =
+      std::max<uint32_t>(std::min(guess_size, kMaxInitialAllocSize), 1);
+  uint8_t* buf = FX_Alloc(uint8_t, buf_size + 1);
+  uint32_t total = 0;
   while (1) {
-    uint32_t ret = FlateOutput(context, cur_buf, buf_size);
-    uint32_t avail_buf_size = FlateGetAvailOut(context);
-    if (ret != Z_OK || avail_buf_size != 0) {
-      last_buf_size = buf_size - avail_buf_size;
-      result_tmp_bufs.push_back(cur_buf);
+    stream->next_out = buf + total;
+    stream->avail_out = buf_size - total;
+    int ret = inflate(stream, Z_SYNC_FLUSH);
+    total = buf_size - stream->avail_out;
+    if (ret != Z_OK || stream->avail_out != 0)
       break;
-    }
-    result_tmp_bufs.push_back(cur_buf);
-    cur_buf = FX_Alloc(uint8_t, buf_size + 1);
-    cur_buf[buf_size] = '\0';
+
+    FX_SAFE_UINT32 safe_buf_size = buf_size;
+    safe_buf_size *= 2;
+    if (!safe_buf_size.IsValid())
+      break;
+
+    buf_size = safe_buf_size.ValueOrDie();
+    buf = FX_Realloc(uint8_t, buf, buf_size + 1);
   }
 
-  // The TotalOut size returned from the library may not be big enough to
-  // handle the content the library returns. We can only handle items
-  // up to 4GB in size.
-  dest_size = FlateGetPossiblyTruncatedTotalOut(context);
+  // Give back what a generous guess left unused. Shrinking normally happens
+  // in place.
+  if (buf_size - total > buf_size / 8)
+    buf = FX_Realloc(uint8_t, buf, total + 1);
+  buf[total] = '\0';
+
+  dest_buf = buf;
+  dest_size = total;
   offset = FlateGetPossiblyTruncatedTotalIn(context);
-  if (result_tmp_bufs.size() == 1) {
-    dest_buf = result_tmp_bufs[0];
-  } else {
-    uint8_t* result_buf = FX_Alloc(uint8_t, dest_size);
-    uint32_t result_pos = 0;
-    uint32_t remaining = dest_size;
-    for (size_t i = 0; i < result_tmp_bufs.size(); i++) {
-      uint8_t* tmp_buf = result_tmp_bufs[i];
-      uint32_t tmp_buf_size = buf_size;
-      if (i == result_tmp_bufs.size() - 1)
-        tmp_buf_size = last_buf_size;
-
-      uint32_t cp_size = std::min(tmp_buf_size, remaining);
-      memcpy(result_buf + result_pos, tmp_buf, cp_size);
-      result_pos += cp_size;
-      remaining -= cp_size;
-
-      FX_Free(result_tmp_bufs[i]);
-    }
-    dest_buf = result_buf;
-  }
-  FlateEnd(context);
+  s_ContextCache.Release(context);
 }
 
 }  // namespace
@@ -0,0 +1,313 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/fxcodec/codec/ccodec_flatemodule.h"
+#include "core/fxcodec/codec/ccodec_scanlinedecoder.h"
+#include "core/fxcodec/fx_codec.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+struct PredictorParams {
+  int colors;
+  int bits_per_component;
+};
+
+// Covers the pixel sizes with vectorized predictors as well as the ones
+// without, including sub-byte samples.
+const PredictorParams kPredictorParams[] = {
+    {1, 1}, {3, 4}, {1, 8}, {2, 8}, {3, 8}, {4, 8}, {1, 16}, {3, 16}, {4, 16},
+};
+
+const int kColumnCounts[] = {1, 5, 37};
+const int kRowCount = 7;
+
+std::vector<uint8_t> MakeData(size_t size, uint32_t seed) {
+  std::vector<uint8_t> data(size);
+  for (uint8_t& byte : data) {
+    seed = seed * 1103515245 + 12345;
+    byte = static_cast<uint8_t>(seed >> 16);
+  }
+  return data;
+}
+
+uint8_t ReferencePaeth(int a, int b, int c) {
+  int p = a + b - c;
+  int pa = abs(p - a);
+  int pb = abs(p - b);
+  int pc = abs(p - c);
+  if (pa <= pb && pa <= pc)
+    return a;
+  return pb <= pc ? b : c;
+}
+
+// Undoes the PNG filters one byte at a time.
+std::vector<uint8_t> ReferencePNGDecode(const std::vector<uint8_t>& data,
+                                        int colors,
+                                        int bpc,
+                                        int columns) {
+  const int bpp = (colors * bpc + 7) / 8;
+  const int row_size = (colors * bpc * columns + 7) / 8;
+  std::vector<uint8_t> result;
+  for (size_t pos = 0; pos < data.size(); pos += row_size + 1) {
+    const int size =
+        std::min(row_size, static_cast<int>(data.size() - pos - 1));
+    const size_t start = result.size();
+    result.resize(start + size);
+    uint8_t* dest = result.data() + start;
+    const uint8_t* raw = data.data() + pos + 1;
+    const uint8_t* prev = start ? dest - row_size : nullptr;
+    for (int i = 0; i < size; ++i) {
+      uint8_t left = i >= bpp ? dest[i - bpp] : 0;
+      uint8_t up = prev ? prev[i] : 0;
+      uint8_t upper_left = prev && i >= bpp ? prev[i - bpp] : 0;
+      switch (data[pos]) {
+        case 1:
+          dest[i] = raw[i] + left;
+          break;
+        case 2:
+          dest[i] = raw[i] + up;
+          break;
+        case 3:
+          dest[i] = raw[i] + (left + up) / 2;
+          break;
+        case 4:
+          dest[i] = raw[i] + ReferencePaeth(left, up, upper_left);
+          break;
+        default:
+          dest[i] = raw[i];
+          break;
+      }
+    }
+  }
+  return result;
+}
+
+// Undoes TIFF horizontal differencing one sample at a time.
+std::vector<uint8_t> ReferenceTIFFDecode(std::vector<uint8_t> data,
+                                         int colors,
+                                         int bpc,
+                                         int columns) {
+  const int bpp = colors * bpc / 8;
+  const int row_size = (colors * bpc * columns + 7) / 8;
+  for (size_t pos = 0; pos < data.size(); pos += row_size) {
+    const int size = std::min(row_size, static_cast<int>(data.size() - pos));
+    uint8_t* row = data.data() + pos;
+    if (bpc == 1) {
+      for (int i = 1; i < std::min(colors * columns, size * 8); ++i) {
+        int prev_bit = (row[(i - 1) / 8] >> (7 - (i - 1) % 8)) & 1;
+        if (prev_bit)
+          row[i / 8] ^= 1 << (7 - i % 8);
+      }
+    } else if (bpc == 16) {
+      for (int i = bpp; i + 1 < size; i += 2) {
+        uint16_t sample = (row[i - bpp] << 8) | row[i - bpp + 1];
+        sample += (row[i] << 8) | row[i + 1];
+        row[i] = sample >> 8;
+        row[i + 1] = static_cast<uint8_t>(sample);
+      }
+    } else {
+      for (int i = bpp; i < size; ++i)
+        row[i] += row[i - bpp];
+    }
+  }
+  return data;
+}
+
+std::vector<uint8_t> Compress(const std::vector<uint8_t>& data) {
+  uint8_t* encoded = nullptr;
+  uint32_t encoded_size = 0;
+  CCodec_ModuleMgr().GetFlateModule()->Encode(data.data(), data.size(),
+                                              &encoded, &encoded_size);
+  std::vector<uint8_t> result(encoded, encoded + encoded_size);
+  FX_Free(encoded);
+  return result;
+}
+
+std::vector<uint8_t> Decode(const std::vector<uint8_t>& encoded,
+                            int predictor,
+                            int colors,
+                            int bpc,
+                            int columns,
+                            uint32_t estimated_size = 0) {
+  uint8_t* decoded = nullptr;
+  uint32_t decoded_size = 0;
+  CCodec_ModuleMgr().GetFlateModule()->FlateOrLZWDecode(
+      false, encoded.data(), encoded.size(), false, predictor, colors, bpc,
+      columns, estimated_size, decoded, decoded_size);
+  std::vector<uint8_t> result(decoded, decoded + decoded_size);
+  FX_Free(decoded);
+  return result;
+}
+
+// Returns |lines| lines of made up content stream operators.
+std::vector<uint8_t> MakeContentStream(int lines) {
+  std::string content;
+  for (int i = 0; i < lines; ++i) {
+    char buf[100];
+    snprintf(buf, sizeof(buf), "%d.%d %d m %d %d l S %d g\n", i % 613,
+             (i * 7) % 10, (i * 13) % 797, (i * 17) % 613, (i * 3) % 797,
+             i % 2);
+    content += buf;
+  }
+  return std::vector<uint8_t>(content.begin(), content.end());
+}
+
+}  // namespace
+
+TEST(fxcodec, FlatePNGPredictor) {
+  uint32_t seed = 1;
+  for (const PredictorParams& params : kPredictorParams) {
+    for (int columns : kColumnCounts) {
+      const int row_size =
+          (params.colors * params.bits_per_component * columns + 7) / 8;
+      std::vector<uint8_t> data =
+          MakeData((row_size + 1) * kRowCount, ++seed);
+      // Use every filter, plus an invalid one, on the first and later rows.
+      for (int row = 0; row < kRowCount; ++row)
+        data[row * (row_size + 1)] = (row + seed) % 6;
+
+      // Also drop part of the last row, which is decoded up to the cut.
+      for (size_t cut : {size_t{0}, size_t{1}, size_t{row_size / 2 + 1}}) {
+        std::vector<uint8_t> input(data.begin(), data.end() - cut);
+        std::vector<uint8_t> expected = ReferencePNGDecode(
+            input, params.colors, params.bits_per_component, columns);
+        EXPECT_EQ(expected,
+                  Decode(Compress(input), 12, params.colors,
+                         params.bits_per_component, columns))
+            << params.colors << " " << params.bits_per_component << " "
+            << columns << " " << cut;
+      }
+    }
+  }
+}
+
+TEST(fxcodec, FlatePNGPredictorScanlines) {
+  uint32_t seed = 100;
+  for (const PredictorParams& params : kPredictorParams) {
+    for (int columns : kColumnCounts) {
+      const int row_size =
+          (params.colors * params.bits_per_component * columns + 7) / 8;
+      std::vector<uint8_t> data =
+          MakeData((row_size + 1) * kRowCount, ++seed);
+      for (int row = 0; row < kRowCount; ++row)
+        data[row * (row_size + 1)] = (row + seed) % 6;
+      std::vector<uint8_t> expected = ReferencePNGDecode(
+          data, params.colors, params.bits_per_component, columns);
+
+      std::vector<uint8_t> encoded = Compress(data);
+      std::unique_ptr<CCodec_ScanlineDecoder> decoder =
+          CCodec_ModuleMgr().GetFlateModule()->CreateDecoder(
+              encoded.data(), encoded.size(), columns, kRowCount,
+              params.colors, params.bits_per_component, 12, params.colors,
+              params.bits_per_component, columns);
+      ASSERT_TRUE(decoder);
+      for (int row = 0; row < kRowCount; ++row) {
+        const uint8_t* scanline = decoder->GetScanline(row);
+        ASSERT_TRUE(scanline);
+        EXPECT_EQ(std::vector<uint8_t>(expected.begin() + row * row_size,
+                                       expected.begin() + (row + 1) * row_size),
+                  std::vector<uint8_t>(scanline, scanline + row_size))
+            << params.colors << " " << params.bits_per_component << " "
+            << columns << " " << row;
+      }
+    }
+  }
+}
+
+TEST(fxcodec, FlateTIFFPredictor) {
+  uint32_t seed = 200;
+  for (const PredictorParams& params : kPredictorParams) {
+    for (int columns : kColumnCounts) {
+      const int row_size =
+          (params.colors * params.bits_per_component * columns + 7) / 8;
+      std::vector<uint8_t> data = MakeData(row_size * kRowCount, ++seed);
+      // Keep a cut into the last row to whole 16-bit samples.
+      for (size_t cut : {size_t{0}, size_t{row_size / 2 & ~1}}) {
+        std::vector<uint8_t> input(data.begin(), data.end() - cut);
+        std::vector<uint8_t> expected = ReferenceTIFFDecode(
+            input, params.colors, params.bits_per_component, columns);
+        EXPECT_EQ(expected,
+                  Decode(Compress(input), 2, params.colors,
+                         params.bits_per_component, columns))
+            << params.colors << " " << params.bits_per_component << " "
+            << columns << " " << cut;
+      }
+    }
+  }
+}
+
+TEST(fxcodec, FlateDecodeEstimatedSize) {
+  // Compresses about 30:1, so the default guess of twice the input size has
+  // to grow several times.
+  const std::vector<uint8_t> data = MakeContentStream(20000);
+  const std::vector<uint8_t> encoded = Compress(data);
+  const uint32_t size = data.size();
+  // Too small, exact, too large and absurd guesses decode the same.
+  for (uint32_t estimate : {0u, 1u, 1000u, size - 1, size, size + 1,
+                            size * 3, 0xFFFFFFFFu}) {
+    EXPECT_EQ(data, Decode(encoded, 0, 1, 8, 1, estimate)) << estimate;
+  }
+
+  // A truncated stream decodes as far as it goes.
+  std::vector<uint8_t> truncated(encoded.begin(),
+                                 encoded.begin() + encoded.size() / 2);
+  const std::vector<uint8_t> partial = Decode(truncated, 0, 1, 8, 1);
+  ASSERT_LT(0u, partial.size());
+  ASSERT_GT(data.size(), partial.size());
+  EXPECT_TRUE(std::equal(partial.begin(), partial.end(), data.begin()));
+  for (uint32_t estimate : {1u, size, size * 3})
+    EXPECT_EQ(partial, Decode(truncated, 0, 1, 8, 1, estimate)) << estimate;
+}
+
+// Decodes 400 content streams of mixed sizes, with and without knowing their
+// decoded sizes up front, and prints the throughput of each. Run it with
+// --gtest_also_run_disabled_tests --gtest_filter=*FlateDecodeSpeed.
+TEST(fxcodec, DISABLED_FlateDecodeSpeed) {
+  std::vector<std::vector<uint8_t>> streams;
+  std::vector<uint32_t> sizes;
+  double megabytes = 0;
+  for (int i = 0; i < 400; ++i) {
+    std::vector<uint8_t> data =
+        MakeContentStream(i % 20 == 0 ? 40000 : 50 + (i * 37) % 2000);
+    megabytes += static_cast<double>(data.size()) / 1048576;
+    sizes.push_back(data.size());
+    streams.push_back(Compress(data));
+  }
+
+  CCodec_ModuleMgr codec_module;
+  CCodec_FlateModule* pFlateModule = codec_module.GetFlateModule();
+  for (bool bKnownSize : {false, true}) {
+    double best = 0;
+    for (int run = 0; run < 7; ++run) {
+      auto start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < streams.size(); ++i) {
+        uint8_t* decoded = nullptr;
+        uint32_t decoded_size = 0;
+        pFlateModule->FlateOrLZWDecode(false, streams[i].data(),
+                                       streams[i].size(), false, 0, 1, 8, 1,
+                                       bKnownSize ? sizes[i] : 0, decoded,
+                                       decoded_size);
+        EXPECT_EQ(sizes[i], decoded_size);
+        FX_Free(decoded);
+      }
+      std::chrono::duration<double> seconds =
+          std::chrono::steady_clock::now() - start;
+      if (run == 0 || seconds.count() < best)
+        best = seconds.count();
+    }
+    printf("FlateDecode, %s size: %.1f MB/s\n",
+           bKnownSize ? "known" : "unknown", megabytes / best);
+  }
+}
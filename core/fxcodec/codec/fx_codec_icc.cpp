@@ -4,6 +4,10 @@
 
 // Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
 
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
 #include "core/fxcodec/codec/codec_int.h"
 #include "core/fxcodec/fx_codec.h"
 #include "third_party/lcms2-2.6/include/lcms2.h"
@@ -13,7 +17,234 @@ struct CLcmsCmm {
   int m_nSrcComponents;
   int m_nDstComponents;
   bool m_bLab;
+  bool m_bMatrixShaper;
+  // Set for transforms from CreateSharedTransform_sRGB(). The module's lock
+  // guards the user count.
+  bool m_bShared = false;
+  int m_nUsers = 0;
+  // Lookup table for TranslateScanline(), built on first use. Empty when the
+  // transform has no table. For each channel and input value, the offset of
+  // the grid cell holding it, and its position in the cell out of 256.
+  std::once_flag m_LutOnce;
+  std::vector<uint8_t> m_Lut;
+  int m_LutStrides[4];
+  int m_LutOffsets[4][256];
+  int m_LutFractions[4][256];
 };
+
+namespace {
+
+// Grid points per input channel for the scanline lookup tables. Gray has an
+// entry for every input value.
+const int kRgbGridPoints = 33;
+const int kCmykGridPoints = 17;
+
+int LutGridPoints(int nComponents) {
+  switch (nComponents) {
+    case 1:
+      return 256;
+    case 3:
+      return kRgbGridPoints;
+    case 4:
+      return kCmykGridPoints;
+    default:
+      return 0;
+  }
+}
+
+// Picks the input values of |channel| to sample the grid at. They are spread
+// by how much the output changes along that channel, with the others at
+// zero, so that steep parts of the transform get more of the grid.
+void PlaceGridPoints(const CLcmsCmm* pCmm,
+                     int channel,
+                     int nPoints,
+                     uint8_t* pPositions) {
+  const int nComps = pCmm->m_nSrcComponents;
+  uint8_t inputs[256 * 4] = {};
+  uint8_t outputs[256 * 3];
+  for (int value = 0; value < 256; ++value)
+    inputs[value * nComps + channel] = value;
+  cmsDoTransform(pCmm->m_hTransform, inputs, outputs, 256);
+
+  // Count every step as at least one level, so flat stretches still get
+  // some points.
+  int distance[256];
+  distance[0] = 0;
+  for (int value = 1; value < 256; ++value) {
+    int change = 1;
+    for (int i = 0; i < 3; ++i)
+      change += abs(outputs[value * 3 + i] - outputs[value * 3 + i - 3]);
+    distance[value] = distance[value - 1] + change;
+  }
+
+  int value = 0;
+  for (int point = 0; point < nPoints; ++point) {
+    const int target = distance[255] * point / (nPoints - 1);
+    // Leave room for a distinct value for each point on either side.
+    value = std::max(value, point);
+    while (distance[value] < target)
+      ++value;
+    pPositions[point] = std::min(value, 255 - (nPoints - 1 - point));
+    value = pPositions[point] + 1;
+  }
+}
+
+// Samples the transform on a grid over its 8-bit inputs, with the first
+// channel varying slowest. Transforms from Lab, or to anything but sRGB, keep
+// going through lcms. So do RGB matrix/shaper profiles: lcms has a fast
+// fixed-point path for those, and interpolating a table would only add error
+// where colors get clipped to the sRGB gamut.
+void BuildLut(CLcmsCmm* pCmm) {
+  const int nComps = pCmm->m_nSrcComponents;
+  const int nPoints = LutGridPoints(nComps);
+  if (pCmm->m_bLab || pCmm->m_nDstComponents != 3 || !nPoints)
+    return;
+  if (nComps == 3 && pCmm->m_bMatrixShaper)
+    return;
+
+  uint8_t positions[4][256];
+  int nEntries = 1;
+  int stride = 3;
+  for (int c = nComps - 1; c >= 0; --c) {
+    PlaceGridPoints(pCmm, c, nPoints, positions[c]);
+    // Values past the last point stay in the last cell, so the cell's far
+    // corners always exist.
+    int index = 0;
+    for (int value = 0; value < 256; ++value) {
+      while (index < nPoints - 2 && value >= positions[c][index + 1])
+        ++index;
+      const int start = positions[c][index];
+      const int width = positions[c][index + 1] - start;
+      pCmm->m_LutOffsets[c][value] = index * stride;
+      pCmm->m_LutFractions[c][value] = (value - start) * 256 / width;
+    }
+    pCmm->m_LutStrides[c] = stride;
+    nEntries *= nPoints;
+    stride *= nPoints;
+  }
+
+  std::vector<uint8_t> inputs(nEntries * nComps);
+  for (int entry = 0; entry < nEntries; ++entry) {
+    int index = entry;
+    for (int c = nComps - 1; c >= 0; --c) {
+      inputs[entry * nComps + c] = positions[c][index % nPoints];
+      index /= nPoints;
+    }
+  }
+  pCmm->m_Lut.resize(nEntries * 3);
+  cmsDoTransform(pCmm->m_hTransform, inputs.data(), pCmm->m_Lut.data(),
+                 nEntries);
+}
+
+// Interpolates the cell at |pCell| in a 3D table, whose corners are |s0|,
+// |s1| and |s2| bytes apart along each axis. The fractions and the results
+// are scaled by 256.
+void InterpolateTetrahedral(const uint8_t* pCell,
+                            int s0,
+                            int s1,
+                            int s2,
+                            int f0,
+                            int f1,
+                            int f2,
+                            int* pResult) {
+  // Walk from the near corner to the far one along the axes in order of
+  // decreasing fraction; the four corners visited span the tetrahedron
+  // containing the point.
+  int fa, fb, fc, sa, sb, sc;
+  if (f0 >= f1) {
+    if (f1 >= f2) {
+      fa = f0, fb = f1, fc = f2, sa = s0, sb = s1, sc = s2;
+    } else if (f0 >= f2) {
+      fa = f0, fb = f2, fc = f1, sa = s0, sb = s2, sc = s1;
+    } else {
+      fa = f2, fb = f0, fc = f1, sa = s2, sb = s0, sc = s1;
+    }
+  } else {
+    if (f0 >= f2) {
+      fa = f1, fb = f0, fc = f2, sa = s1, sb = s0, sc = s2;
+    } else if (f1 >= f2) {
+      fa = f1, fb = f2, fc = f0, sa = s1, sb = s2, sc = s0;
+    } else {
+      fa = f2, fb = f1, fc = f0, sa = s2, sb = s1, sc = s0;
+    }
+  }
+  const uint8_t* p1 = pCell + sa;
+  const uint8_t* p2 = p1 + sb;
+  const uint8_t* p3 = p2 + sc;
+  for (int i = 0; i < 3; ++i) {
+    pResult[i] = pCell[i] * (256 - fa) + p1[i] * (fa - fb) +
+                 p2[i] * (fb - fc) + p3[i] * fc;
+  }
+}
+
+void TranslateScanlineWithLut(const CLcmsCmm* pCmm,
+                              uint8_t* pDest,
+                              const uint8_t* pSrc,
+                              int pixels) {
+  const uint8_t* pLut = pCmm->m_Lut.data();
+  const int(*fractions)[256] = pCmm->m_LutFractions;
+  switch (pCmm->m_nSrcComponents) {
+    case 1:
+      for (int i = 0; i < pixels; ++i) {
+        const uint8_t* pEntry = pLut + pSrc[i] * 3;
+        pDest[0] = pEntry[0];
+        pDest[1] = pEntry[1];
+        pDest[2] = pEntry[2];
+        pDest += 3;
+      }
+      break;
+    case 3: {
+      const int s0 = pCmm->m_LutStrides[0];
+      const int s1 = pCmm->m_LutStrides[1];
+      const int s2 = pCmm->m_LutStrides[2];
+      int result[3];
+      for (int i = 0; i < pixels; ++i) {
+        const uint8_t* pCell = pLut + pCmm->m_LutOffsets[0][pSrc[0]] +
+                               pCmm->m_LutOffsets[1][pSrc[1]] +
+                               pCmm->m_LutOffsets[2][pSrc[2]];
+        InterpolateTetrahedral(pCell, s0, s1, s2, fractions[0][pSrc[0]],
+                               fractions[1][pSrc[1]], fractions[2][pSrc[2]],
+                               result);
+        pDest[0] = (result[0] + 128) >> 8;
+        pDest[1] = (result[1] + 128) >> 8;
+        pDest[2] = (result[2] + 128) >> 8;
+        pSrc += 3;
+        pDest += 3;
+      }
+      break;
+    }
+    case 4: {
+      const int s0 = pCmm->m_LutStrides[0];
+      const int s1 = pCmm->m_LutStrides[1];
+      const int s2 = pCmm->m_LutStrides[2];
+      const int s3 = pCmm->m_LutStrides[3];
+      int near_k[3];
+      int far_k[3];
+      for (int i = 0; i < pixels; ++i) {
+        const uint8_t* pCell = pLut + pCmm->m_LutOffsets[0][pSrc[0]] +
+                               pCmm->m_LutOffsets[1][pSrc[1]] +
+                               pCmm->m_LutOffsets[2][pSrc[2]] +
+                               pCmm->m_LutOffsets[3][pSrc[3]];
+        const int f0 = fractions[0][pSrc[0]];
+        const int f1 = fractions[1][pSrc[1]];
+        const int f2 = fractions[2][pSrc[2]];
+        const int fk = fractions[3][pSrc[3]];
+        // Interpolate within the two K slices around the pixel, then
+        // linearly between them.
+        InterpolateTetrahedral(pCell, s0, s1, s2, f0, f1, f2, near_k);
+        InterpolateTetrahedral(pCell + s3, s0, s1, s2, f0, f1, f2, far_k);
+        for (int c = 0; c < 3; ++c)
+          pDest[c] = (near_k[c] * (256 - fk) + far_k[c] * fk + 32768) >> 16;
+        pSrc += 4;
+        pDest += 3;
+      }
+      break;
+    }
+  }
+}
+
+}  // namespace
+
 bool CheckComponents(cmsColorSpaceSignature cs, int nComponents, bool bDst) {
   if (nComponents <= 0 || nComponents > 15) {
     return false;
@@ -134,6 +365,7 @@ void* IccLib_CreateTransform(const unsigned char* pSrcProfileData,
   pCmm->m_nDstComponents = nDstComponents;
   pCmm->m_hTransform = hTransform;
   pCmm->m_bLab = bLab;
+  pCmm->m_bMatrixShaper = !!cmsIsMatrixShaper(srcProfile);
   cmsCloseProfile(srcProfile);
   cmsCloseProfile(dstProfile);
   return pCmm;
@@ -155,13 +387,13 @@ void IccLib_DestroyTransform(void* pTransform) {
 }
 
 void IccLib_Translate(void* pTransform,
-                      uint32_t nSrcComponents,
                       const float* pSrcValues,
                       float* pDestValues) {
   if (!pTransform)
     return;
 
   CLcmsCmm* p = (CLcmsCmm*)pTransform;
+  uint32_t nSrcComponents = p->m_nSrcComponents;
   uint8_t output[4];
   if (p->m_bLab) {
     CFX_FixedBufGrow<double, 16> inputs(nSrcComponents);
@@ -206,13 +438,23 @@ void IccLib_TranslateImage(void* pTransform,
                            int32_t pixels) {
   if (!pTransform)
     return;
-  cmsDoTransform(((CLcmsCmm*)pTransform)->m_hTransform, pSrc, pDest, pixels);
+
+  CLcmsCmm* pCmm = static_cast<CLcmsCmm*>(pTransform);
+  std::call_once(pCmm->m_LutOnce, BuildLut, pCmm);
+  if (!pCmm->m_Lut.empty()) {
+    TranslateScanlineWithLut(pCmm, pDest, pSrc, pixels);
+    return;
+  }
+  cmsDoTransform(pCmm->m_hTransform, pSrc, pDest, pixels);
 }
 
-CCodec_IccModule::CCodec_IccModule() : m_nComponents(0) {}
+CCodec_IccModule::CCodec_IccModule() {}
 
 CCodec_IccModule::~CCodec_IccModule() {
+  for (const auto& it : m_SharedTransforms)
+    IccLib_DestroyTransform(it.second);
 }
+
 void* CCodec_IccModule::CreateTransform_sRGB(const uint8_t* pProfileData,
                                              uint32_t dwProfileSize,
                                              uint32_t& nComponents,
@@ -222,14 +464,73 @@ void* CCodec_IccModule::CreateTransform_sRGB(const uint8_t* pProfileData,
                                      intent, dwSrcFormat);
 }
 
+void* CCodec_IccModule::CreateSharedTransform_sRGB(
+    const CFX_ByteStringC& bsDigest,
+    const uint8_t* pProfileData,
+    uint32_t dwProfileSize,
+    uint32_t& nComponents,
+    int32_t intent,
+    uint32_t dwSrcFormat) {
+  // The key gets its own copy of the digest, since byte string reference
+  // counts may not be shared across threads.
+  TransformKey key(CFX_ByteString(bsDigest), intent, dwSrcFormat);
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  auto it = m_SharedTransforms.find(key);
+  if (it != m_SharedTransforms.end()) {
+    CLcmsCmm* pCmm = it->second;
+    if (pCmm->m_nUsers++ == 0)
+      m_IdleTransforms.remove(pCmm);
+    nComponents = pCmm->m_nSrcComponents;
+    return pCmm;
+  }
+
+  // Build under the lock, so each profile is only compiled once even when
+  // several threads ask for it together.
+  CLcmsCmm* pCmm = static_cast<CLcmsCmm*>(IccLib_CreateTransform_sRGB(
+      pProfileData, dwProfileSize, nComponents, intent, dwSrcFormat));
+  if (!pCmm)
+    return nullptr;
+
+  pCmm->m_bShared = true;
+  pCmm->m_nUsers = 1;
+  m_SharedTransforms[key] = pCmm;
+  return pCmm;
+}
+
 void CCodec_IccModule::DestroyTransform(void* pTransform) {
+  CLcmsCmm* pCmm = static_cast<CLcmsCmm*>(pTransform);
+  if (pCmm && pCmm->m_bShared) {
+    ReleaseSharedTransform(pCmm);
+    return;
+  }
   IccLib_DestroyTransform(pTransform);
 }
 
+void CCodec_IccModule::ReleaseSharedTransform(CLcmsCmm* pCmm) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if (--pCmm->m_nUsers > 0)
+    return;
+
+  m_IdleTransforms.push_back(pCmm);
+  if (m_IdleTransforms.size() <= kMaxIdleTransforms)
+    return;
+
+  CLcmsCmm* pOldest = m_IdleTransforms.front();
+  m_IdleTransforms.pop_front();
+  auto it = std::find_if(m_SharedTransforms.begin(), m_SharedTransforms.end(),
+                         [pOldest](const std::pair<const TransformKey,
+                                                   CLcmsCmm*>& entry) {
+                           return entry.second == pOldest;
+                         });
+  if (it != m_SharedTransforms.end())
+    m_SharedTransforms.erase(it);
+  IccLib_DestroyTransform(pOldest);
+}
+
 void CCodec_IccModule::Translate(void* pTransform,
                                  const float* pSrcValues,
                                  float* pDestValues) {
-  IccLib_Translate(pTransform, m_nComponents, pSrcValues, pDestValues);
+  IccLib_Translate(pTransform, pSrcValues, pDestValues);
 }
 
 void CCodec_IccModule::TranslateScanline(void* pTransform,
@@ -0,0 +1,250 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "core/fxcodec/codec/ccodec_iccmodule.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/lcms2-2.6/include/lcms2.h"
+
+namespace {
+
+std::vector<uint8_t> MakeGrayProfile(double gamma) {
+  cmsToneCurve* curve = cmsBuildGamma(nullptr, gamma);
+  cmsHPROFILE profile = cmsCreateGrayProfile(cmsD50_xyY(), curve);
+  cmsUInt32Number size = 0;
+  cmsSaveProfileToMem(profile, nullptr, &size);
+  std::vector<uint8_t> data(size);
+  cmsSaveProfileToMem(profile, data.data(), &size);
+  cmsCloseProfile(profile);
+  cmsFreeToneCurve(curve);
+  return data;
+}
+
+std::vector<uint8_t> SaveProfile(cmsHPROFILE profile) {
+  cmsUInt32Number size = 0;
+  cmsSaveProfileToMem(profile, nullptr, &size);
+  std::vector<uint8_t> data(size);
+  cmsSaveProfileToMem(profile, data.data(), &size);
+  cmsCloseProfile(profile);
+  return data;
+}
+
+std::vector<uint8_t> MakeRgbProfile() {
+  // Adobe RGB (1998) primaries with a 2.2 gamma.
+  const cmsCIExyYTRIPLE kPrimaries = {
+      {0.64, 0.33, 1}, {0.21, 0.71, 1}, {0.15, 0.06, 1}};
+  cmsCIExyY white_point;
+  cmsWhitePointFromTemp(&white_point, 6504);
+  cmsToneCurve* curve = cmsBuildGamma(nullptr, 2.2);
+  cmsToneCurve* curves[3] = {curve, curve, curve};
+  std::vector<uint8_t> data =
+      SaveProfile(cmsCreateRGBProfile(&white_point, &kPrimaries, curves));
+  cmsFreeToneCurve(curve);
+  return data;
+}
+
+void EncodeLinearRgbAsLab(const double rgb[3], cmsUInt16Number out[3]) {
+  cmsCIEXYZ xyz;
+  // The sRGB primaries, adapted to D50.
+  xyz.X = 0.4361 * rgb[0] + 0.3851 * rgb[1] + 0.1431 * rgb[2];
+  xyz.Y = 0.2225 * rgb[0] + 0.7169 * rgb[1] + 0.0606 * rgb[2];
+  xyz.Z = 0.0139 * rgb[0] + 0.0971 * rgb[1] + 0.7141 * rgb[2];
+  cmsCIELab lab;
+  cmsXYZ2Lab(cmsD50_XYZ(), &lab, &xyz);
+  cmsFloat2LabEncoded(out, &lab);
+}
+
+// Decodes RGB with a 1.8 gamma, within the sRGB gamut.
+cmsInt32Number SampleRgb(const cmsUInt16Number in[],
+                         cmsUInt16Number out[],
+                         void* cargo) {
+  double rgb[3];
+  for (int i = 0; i < 3; ++i)
+    rgb[i] = pow(in[i] / 65535.0, 1.8);
+  EncodeLinearRgbAsLab(rgb, out);
+  return TRUE;
+}
+
+// Treats each ink as removing its share of linear sRGB.
+cmsInt32Number SampleCmyk(const cmsUInt16Number in[],
+                          cmsUInt16Number out[],
+                          void* cargo) {
+  const double k = 1 - in[3] / 65535.0;
+  double rgb[3];
+  for (int i = 0; i < 3; ++i)
+    rgb[i] = (1 - in[i] / 65535.0) * k;
+  EncodeLinearRgbAsLab(rgb, out);
+  return TRUE;
+}
+
+// Makes a profile that converts to Lab through a color table, like most
+// CMYK profiles and some RGB ones do.
+std::vector<uint8_t> MakeClutProfile(cmsColorSpaceSignature color_space,
+                                     int channels,
+                                     cmsSAMPLER16 sampler) {
+  cmsHPROFILE profile = cmsCreateProfilePlaceholder(nullptr);
+  cmsSetProfileVersion(profile, 4.3);
+  cmsSetDeviceClass(profile, cmsSigOutputClass);
+  cmsSetColorSpace(profile, color_space);
+  cmsSetPCS(profile, cmsSigLabData);
+  cmsPipeline* pipeline = cmsPipelineAlloc(nullptr, channels, 3);
+  cmsStage* clut = cmsStageAllocCLut16bit(nullptr, 9, channels, 3, nullptr);
+  cmsStageSampleCLut16bit(clut, sampler, nullptr, 0);
+  cmsPipelineInsertStage(pipeline, cmsAT_END,
+                         cmsStageAllocToneCurves(nullptr, channels, nullptr));
+  cmsPipelineInsertStage(pipeline, cmsAT_END, clut);
+  cmsPipelineInsertStage(pipeline, cmsAT_END,
+                         cmsStageAllocToneCurves(nullptr, 3, nullptr));
+  cmsWriteTag(profile, cmsSigAToB0Tag, pipeline);
+  cmsWriteTag(profile, cmsSigMediaWhitePointTag, cmsD50_XYZ());
+  cmsPipelineFree(pipeline);
+  return SaveProfile(profile);
+}
+
+// Checks TranslateScanline() against converting every pixel with lcms.
+void CheckTranslateScanline(const std::vector<uint8_t>& profile,
+                            uint32_t channels,
+                            int max_channel_error,
+                            double max_delta_e,
+                            double max_mean_delta_e) {
+  CCodec_IccModule module;
+  uint32_t components = 0;
+  void* transform =
+      module.CreateTransform_sRGB(profile.data(), profile.size(), components);
+  ASSERT_TRUE(transform);
+  ASSERT_EQ(channels, components);
+
+  const int kPixels = 50000;
+  std::vector<uint8_t> src(kPixels * components);
+  uint32_t seed = 1;
+  for (uint8_t& value : src) {
+    seed = seed * 1103515245 + 12345;
+    value = static_cast<uint8_t>(seed >> 16);
+  }
+  // Include the extremes of every channel.
+  for (uint32_t i = 0; i < (1u << components); ++i) {
+    for (uint32_t c = 0; c < components; ++c)
+      src[i * components + c] = (i >> c) & 1 ? 255 : 0;
+  }
+
+  std::vector<uint8_t> actual(kPixels * 3);
+  module.TranslateScanline(transform, actual.data(), src.data(), kPixels);
+  module.DestroyTransform(transform);
+
+  cmsHPROFILE src_profile =
+      cmsOpenProfileFromMem(profile.data(), profile.size());
+  cmsHPROFILE srgb = cmsCreate_sRGBProfile();
+  cmsHPROFILE lab = cmsCreateLab4Profile(nullptr);
+  // Same input format as the module, which lcms optimizes differently from
+  // the typed formats.
+  cmsHTRANSFORM reference = cmsCreateTransform(
+      src_profile, COLORSPACE_SH(PT_ANY) | CHANNELS_SH(channels) | BYTES_SH(1),
+      srgb, TYPE_BGR_8, 0, 0);
+  cmsHTRANSFORM to_lab =
+      cmsCreateTransform(srgb, TYPE_BGR_8, lab, TYPE_Lab_DBL, 0, 0);
+  std::vector<uint8_t> expected(kPixels * 3);
+  cmsDoTransform(reference, src.data(), expected.data(), kPixels);
+  std::vector<cmsCIELab> actual_lab(kPixels);
+  std::vector<cmsCIELab> expected_lab(kPixels);
+  cmsDoTransform(to_lab, actual.data(), actual_lab.data(), kPixels);
+  cmsDoTransform(to_lab, expected.data(), expected_lab.data(), kPixels);
+  cmsDeleteTransform(reference);
+  cmsDeleteTransform(to_lab);
+  cmsCloseProfile(src_profile);
+  cmsCloseProfile(srgb);
+  cmsCloseProfile(lab);
+
+  int channel_error = 0;
+  double delta_e = 0;
+  double total_delta_e = 0;
+  for (int i = 0; i < kPixels; ++i) {
+    for (int c = 0; c < 3; ++c) {
+      channel_error = std::max(
+          channel_error, abs(actual[i * 3 + c] - expected[i * 3 + c]));
+    }
+    double pixel_delta_e = cmsDeltaE(&actual_lab[i], &expected_lab[i]);
+    delta_e = std::max(delta_e, pixel_delta_e);
+    total_delta_e += pixel_delta_e;
+  }
+  EXPECT_LE(channel_error, max_channel_error);
+  EXPECT_LE(delta_e, max_delta_e);
+  EXPECT_LE(total_delta_e / kPixels, max_mean_delta_e);
+}
+
+}  // namespace
+
+TEST(CCodec_IccModule, SharedTransforms) {
+  CCodec_IccModule module;
+  std::vector<uint8_t> profile = MakeGrayProfile(2.2);
+  uint32_t components = 0;
+  void* transform = module.CreateSharedTransform_sRGB(
+      "digest", profile.data(), profile.size(), components);
+  ASSERT_TRUE(transform);
+  EXPECT_EQ(1u, components);
+
+  // The same digest reuses the transform, even for data that would not parse.
+  const uint8_t kJunk[] = {1, 2, 3, 4};
+  components = 0;
+  EXPECT_EQ(transform, module.CreateSharedTransform_sRGB(
+                           "digest", kJunk, sizeof(kJunk), components));
+  EXPECT_EQ(1u, components);
+
+  // A different intent needs its own transform.
+  void* perceptual = module.CreateSharedTransform_sRGB(
+      "digest", profile.data(), profile.size(), components, 1);
+  ASSERT_TRUE(perceptual);
+  EXPECT_NE(transform, perceptual);
+
+  // Unused transforms stay cached.
+  module.DestroyTransform(transform);
+  module.DestroyTransform(transform);
+  module.DestroyTransform(perceptual);
+  EXPECT_EQ(transform, module.CreateSharedTransform_sRGB(
+                           "digest", kJunk, sizeof(kJunk), components));
+  module.DestroyTransform(transform);
+
+  // Until enough other profiles have been released after them.
+  for (int i = 0; i < 16; ++i) {
+    CFX_ByteString digest = CFX_ByteString::FormatInteger(i);
+    void* other = module.CreateSharedTransform_sRGB(
+        digest.AsStringC(), profile.data(), profile.size(), components);
+    ASSERT_TRUE(other);
+    module.DestroyTransform(other);
+  }
+  EXPECT_FALSE(module.CreateSharedTransform_sRGB("digest", kJunk,
+                                                 sizeof(kJunk), components));
+}
+
+TEST(CCodec_IccModule, UnsharedTransforms) {
+  CCodec_IccModule module;
+  std::vector<uint8_t> profile = MakeGrayProfile(1.8);
+  uint32_t components = 0;
+  void* transform =
+      module.CreateTransform_sRGB(profile.data(), profile.size(), components);
+  ASSERT_TRUE(transform);
+  EXPECT_EQ(1u, components);
+  EXPECT_NE(transform, module.CreateSharedTransform_sRGB(
+                           "digest", profile.data(), profile.size(),
+                           components));
+  module.DestroyTransform(transform);
+}
+
+// Gray goes through a table with an entry for every input value, and RGB
+// matrix/shaper profiles through lcms, so both match lcms exactly. Tables for
+// other RGB and CMYK profiles are interpolated. They stay within 6 levels
+// per channel and a CIE76 color difference of 3 from lcms, and average
+// under 0.5.
+TEST(CCodec_IccModule, TranslateScanline) {
+  CheckTranslateScanline(MakeGrayProfile(2.2), 1, 0, 0, 0);
+  CheckTranslateScanline(MakeRgbProfile(), 3, 0, 0, 0);
+  CheckTranslateScanline(MakeClutProfile(cmsSigRgbData, 3, SampleRgb), 3, 6,
+                         3, 0.5);
+  CheckTranslateScanline(MakeClutProfile(cmsSigCmykData, 4, SampleCmyk), 4, 6,
+                         3, 0.5);
+}
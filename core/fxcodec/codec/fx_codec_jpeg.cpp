@@ -157,7 +157,8 @@ class CCodec_JpegDecoder : public CCodec_ScanlineDecoder {
               int width,
               int height,
               int nComps,
-              bool ColorTransform);
+              bool ColorTransform,
+              int down_scale);
 
   // CCodec_ScanlineDecoder
   bool v_Rewind() override;
@@ -180,6 +181,8 @@ class CCodec_JpegDecoder : public CCodec_ScanlineDecoder {
 
  protected:
   uint32_t m_nDefaultScaleDenom;
+  // Output is 1/m_nDownScale of the image size, rounded up.
+  int m_nDownScale;
 };
 
 CCodec_JpegDecoder::CCodec_JpegDecoder() {
@@ -190,6 +193,7 @@ CCodec_JpegDecoder::CCodec_JpegDecoder() {
   memset(&jerr, 0, sizeof(jerr));
   memset(&src, 0, sizeof(src));
   m_nDefaultScaleDenom = 1;
+  m_nDownScale = 1;
 }
 
 CCodec_JpegDecoder::~CCodec_JpegDecoder() {
@@ -228,8 +232,8 @@ bool CCodec_JpegDecoder::InitDecode() {
 
   m_OrigWidth = cinfo.image_width;
   m_OrigHeight = cinfo.image_height;
-  m_OutputWidth = m_OrigWidth;
-  m_OutputHeight = m_OrigHeight;
+  m_OutputWidth = (m_OrigWidth + m_nDownScale - 1) / m_nDownScale;
+  m_OutputHeight = (m_OrigHeight + m_nDownScale - 1) / m_nDownScale;
   m_nDefaultScaleDenom = cinfo.scale_denom;
   return true;
 }
@@ -239,7 +243,11 @@ bool CCodec_JpegDecoder::Create(const uint8_t* src_buf,
                                 int width,
                                 int height,
                                 int nComps,
-                                bool ColorTransform) {
+                                bool ColorTransform,
+                                int down_scale) {
+  // libjpeg only scales by these, and they keep the IDCT cheap.
+  ASSERT(down_scale == 1 || down_scale == 2 || down_scale == 4 ||
+         down_scale == 8);
   JpegScanSOI(&src_buf, &src_size);
   m_SrcBuf = src_buf;
   m_SrcSize = src_size;
@@ -254,12 +262,13 @@ bool CCodec_JpegDecoder::Create(const uint8_t* src_buf,
   src.fill_input_buffer = _src_fill_buffer;
   src.resync_to_restart = _src_resync;
   m_bJpegTransform = ColorTransform;
+  m_nDownScale = down_scale;
   if (src_size > 1 && memcmp(src_buf + src_size - 2, "\xFF\xD9", 2) != 0) {
     ((uint8_t*)src_buf)[src_size - 2] = 0xFF;
     ((uint8_t*)src_buf)[src_size - 1] = 0xD9;
   }
-  m_OutputWidth = m_OrigWidth = width;
-  m_OutputHeight = m_OrigHeight = height;
+  m_OrigWidth = width;
+  m_OrigHeight = height;
   if (!InitDecode())
     return false;
 
@@ -289,14 +298,13 @@ bool CCodec_JpegDecoder::v_Rewind() {
   if (setjmp(m_JmpBuf) == -1) {
     return false;
   }
-  cinfo.scale_denom = m_nDefaultScaleDenom;
-  m_OutputWidth = m_OrigWidth;
-  m_OutputHeight = m_OrigHeight;
+  cinfo.scale_denom = m_nDefaultScaleDenom * m_nDownScale;
   if (!jpeg_start_decompress(&cinfo)) {
     jpeg_destroy_decompress(&cinfo);
     return false;
   }
-  if ((int)cinfo.output_width > m_OrigWidth) {
+  if ((int)cinfo.output_width > m_OrigWidth ||
+      (int)cinfo.output_width < m_OutputWidth) {
     ASSERT(false);
     return false;
   }
@@ -322,13 +330,14 @@ std::unique_ptr<CCodec_ScanlineDecoder> CCodec_JpegModule::CreateDecoder(
     int width,
     int height,
     int nComps,
-    bool ColorTransform) {
+    bool ColorTransform,
+    int down_scale) {
   if (!src_buf || src_size == 0)
     return nullptr;
 
   auto pDecoder = pdfium::MakeUnique<CCodec_JpegDecoder>();
   if (!pDecoder->Create(src_buf, src_size, width, height, nComps,
-                        ColorTransform)) {
+                        ColorTransform, down_scale)) {
     return nullptr;
   }
   return std::move(pDecoder);
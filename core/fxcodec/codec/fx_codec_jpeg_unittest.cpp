@@ -0,0 +1,98 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "core/fxcodec/codec/ccodec_jpegmodule.h"
+#include "core/fxcodec/codec/ccodec_scanlinedecoder.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// A 27x19 grayscale JPEG of a diagonal gradient.
+const uint8_t kGradientJpeg[] = {
+    0xff, 0xd8, 0xff, 0xe0, 0x00, 0x10, 0x4a, 0x46, 0x49, 0x46, 0x00, 0x01,
+    0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0xff, 0xdb, 0x00, 0x43,
+    0x00, 0x10, 0x0b, 0x0c, 0x0e, 0x0c, 0x0a, 0x10, 0x0e, 0x0d, 0x0e, 0x12,
+    0x11, 0x10, 0x13, 0x18, 0x28, 0x1a, 0x18, 0x16, 0x16, 0x18, 0x31, 0x23,
+    0x25, 0x1d, 0x28, 0x3a, 0x33, 0x3d, 0x3c, 0x39, 0x33, 0x38, 0x37, 0x40,
+    0x48, 0x5c, 0x4e, 0x40, 0x44, 0x57, 0x45, 0x37, 0x38, 0x50, 0x6d, 0x51,
+    0x57, 0x5f, 0x62, 0x67, 0x68, 0x67, 0x3e, 0x4d, 0x71, 0x79, 0x70, 0x64,
+    0x78, 0x5c, 0x65, 0x67, 0x63, 0xff, 0xc0, 0x00, 0x0b, 0x08, 0x00, 0x13,
+    0x00, 0x1b, 0x01, 0x01, 0x11, 0x00, 0xff, 0xc4, 0x00, 0x16, 0x00, 0x01,
+    0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x05, 0x04, 0x06, 0xff, 0xc4, 0x00, 0x1b, 0x10, 0x00,
+    0x02, 0x03, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x04, 0x21, 0x00, 0x02, 0x31, 0x01, 0x22, 0x12, 0xff,
+    0xda, 0x00, 0x08, 0x01, 0x01, 0x00, 0x00, 0x3f, 0x00, 0xc9, 0x0e, 0x2e,
+    0x28, 0x98, 0xe2, 0xe2, 0x89, 0x8e, 0x2e, 0x29, 0x7d, 0x45, 0xf3, 0xc5,
+    0x05, 0x1c, 0x5c, 0x51, 0x31, 0xc5, 0xc5, 0x13, 0x1c, 0x5c, 0x52, 0xea,
+    0x8b, 0xe7, 0x8a, 0x00, 0x3d, 0x6a, 0x94, 0x4c, 0x7a, 0xd5, 0x28, 0x90,
+    0xf5, 0xaa, 0x52, 0xfa, 0xd6, 0xbf, 0x3c, 0x53, 0xff, 0xd9,
+};
+
+const int kGradientWidth = 27;
+const int kGradientHeight = 19;
+
+std::vector<std::vector<uint8_t>> DecodeAll(CCodec_ScanlineDecoder* pDecoder) {
+  std::vector<std::vector<uint8_t>> rows;
+  for (int y = 0; y < pDecoder->GetHeight(); ++y) {
+    const uint8_t* scanline = pDecoder->GetScanline(y);
+    if (!scanline)
+      break;
+    rows.emplace_back(scanline, scanline + pDecoder->GetWidth());
+  }
+  return rows;
+}
+
+}  // namespace
+
+TEST(fxcodec, JpegDecoderDownScale) {
+  CCodec_JpegModule module;
+  std::unique_ptr<CCodec_ScanlineDecoder> pFull = module.CreateDecoder(
+      kGradientJpeg, sizeof(kGradientJpeg), kGradientWidth, kGradientHeight,
+      1, true, 1);
+  ASSERT_TRUE(pFull);
+  EXPECT_EQ(kGradientWidth, pFull->GetWidth());
+  EXPECT_EQ(kGradientHeight, pFull->GetHeight());
+  std::vector<std::vector<uint8_t>> full = DecodeAll(pFull.get());
+  ASSERT_EQ(static_cast<size_t>(kGradientHeight), full.size());
+
+  for (int scale : {2, 4, 8}) {
+    std::unique_ptr<CCodec_ScanlineDecoder> pDecoder = module.CreateDecoder(
+        kGradientJpeg, sizeof(kGradientJpeg), kGradientWidth, kGradientHeight,
+        1, true, scale);
+    ASSERT_TRUE(pDecoder) << scale;
+    // Each dimension is rounded up.
+    const int width = (kGradientWidth + scale - 1) / scale;
+    const int height = (kGradientHeight + scale - 1) / scale;
+    EXPECT_EQ(width, pDecoder->GetWidth()) << scale;
+    EXPECT_EQ(height, pDecoder->GetHeight()) << scale;
+    EXPECT_EQ(1, pDecoder->CountComps()) << scale;
+    EXPECT_EQ(8, pDecoder->GetBPC()) << scale;
+
+    std::vector<std::vector<uint8_t>> rows = DecodeAll(pDecoder.get());
+    ASSERT_EQ(static_cast<size_t>(height), rows.size()) << scale;
+    // Every output pixel stands for a block of the full image, and is close
+    // to the pixel of that block nearest to its centre.
+    for (int y = 0; y < height; ++y) {
+      int full_y = std::min(y * scale + scale / 2, kGradientHeight - 1);
+      for (int x = 0; x < width; ++x) {
+        int full_x = std::min(x * scale + scale / 2, kGradientWidth - 1);
+        EXPECT_NEAR(full[full_y][full_x], rows[y][x], 24)
+            << scale << " " << x << "," << y;
+      }
+    }
+
+    // Going back to the first line gives the same pixels again.
+    EXPECT_EQ(rows[0], std::vector<uint8_t>(
+                           pDecoder->GetScanline(0),
+                           pDecoder->GetScanline(0) + pDecoder->GetWidth()))
+        << scale;
+  }
+}
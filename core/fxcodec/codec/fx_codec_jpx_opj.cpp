@@ -19,6 +19,17 @@
 #include "third_party/lcms2-2.6/include/lcms2.h"
 #include "third_party/libopenjpeg20/openjpeg.h"
 
+namespace {
+
+// The size of an image dimension with |discard_levels| resolution levels left
+// out, as OpenJPEG computes it.
+uint32_t ReducedSize(uint32_t size, uint32_t discard_levels) {
+  uint64_t scale = static_cast<uint64_t>(1) << discard_levels;
+  return static_cast<uint32_t>((size + scale - 1) / scale);
+}
+
+}  // namespace
+
 static void fx_error_callback(const char* msg, void* client_data) {
   (void)client_data;
 }
@@ -674,7 +685,11 @@ void color_apply_conversion(opj_image_t* image) {
 }
 
 CJPX_Decoder::CJPX_Decoder(CPDF_ColorSpace* cs)
-    : image(nullptr), l_codec(nullptr), l_stream(nullptr), m_ColorSpace(cs) {}
+    : m_nDiscardLevels(0),
+      image(nullptr),
+      l_codec(nullptr),
+      l_stream(nullptr),
+      m_ColorSpace(cs) {}
 
 CJPX_Decoder::~CJPX_Decoder() {
   if (l_codec) {
@@ -688,7 +703,9 @@ CJPX_Decoder::~CJPX_Decoder() {
   }
 }
 
-bool CJPX_Decoder::Init(const unsigned char* src_data, uint32_t src_size) {
+bool CJPX_Decoder::Init(const unsigned char* src_data,
+                        uint32_t src_size,
+                        uint32_t discard_levels) {
   static const unsigned char szJP2Header[] = {
       0x00, 0x00, 0x00, 0x0c, 0x6a, 0x50, 0x20, 0x20, 0x0d, 0x0a, 0x87, 0x0a};
   if (!src_data || src_size < sizeof(szJP2Header))
@@ -730,6 +747,22 @@ bool CJPX_Decoder::Init(const unsigned char* src_data, uint32_t src_size) {
   }
   image->pdfium_use_colorspace = !!m_ColorSpace;
 
+  // OpenJPEG refuses to leave out more levels than the main header has, so
+  // settle for as many as there are.
+  if (discard_levels) {
+    while (!opj_set_decoded_resolution_factor(l_codec, discard_levels) &&
+           discard_levels > 0) {
+      --discard_levels;
+    }
+    m_nDiscardLevels = discard_levels;
+    // The component sizes only take the factor into account when they are
+    // worked out for a decode area, so ask for the whole image as one.
+    for (uint32_t i = 0; i < image->numcomps; ++i)
+      image->comps[i].factor = discard_levels;
+    parameters.DA_x1 = image->x1;
+    parameters.DA_y1 = image->y1;
+  }
+
   if (!parameters.nb_tile_to_decode) {
     if (!opj_set_decode_area(l_codec, image, parameters.DA_x0, parameters.DA_y0,
                              parameters.DA_x1, parameters.DA_y1)) {
@@ -774,21 +807,23 @@ bool CJPX_Decoder::Init(const unsigned char* src_data, uint32_t src_size) {
 void CJPX_Decoder::GetInfo(uint32_t* width,
                            uint32_t* height,
                            uint32_t* components) {
-  *width = (uint32_t)image->x1;
-  *height = (uint32_t)image->y1;
+  *width = ReducedSize(image->x1, m_nDiscardLevels);
+  *height = ReducedSize(image->y1, m_nDiscardLevels);
   *components = (uint32_t)image->numcomps;
 }
 
 bool CJPX_Decoder::Decode(uint8_t* dest_buf,
                           int pitch,
                           const std::vector<uint8_t>& offsets) {
-  if (image->comps[0].w != image->x1 || image->comps[0].h != image->y1)
+  if (image->comps[0].w != ReducedSize(image->x1, m_nDiscardLevels) ||
+      image->comps[0].h != ReducedSize(image->y1, m_nDiscardLevels)) {
     return false;
+  }
 
   if (pitch<(int)(image->comps[0].w * 8 * image->numcomps + 31)>> 5 << 2)
     return false;
 
-  memset(dest_buf, 0xff, image->y1 * pitch);
+  memset(dest_buf, 0xff, image->comps[0].h * pitch);
   std::vector<uint8_t*> channel_bufs(image->numcomps);
   std::vector<int> adjust_comps(image->numcomps);
   for (uint32_t i = 0; i < image->numcomps; i++) {
@@ -863,9 +898,11 @@ CCodec_JpxModule::~CCodec_JpxModule() {}
 std::unique_ptr<CJPX_Decoder> CCodec_JpxModule::CreateDecoder(
     const uint8_t* src_buf,
     uint32_t src_size,
-    CPDF_ColorSpace* cs) {
+    CPDF_ColorSpace* cs,
+    uint32_t discard_levels) {
   auto decoder = pdfium::MakeUnique<CJPX_Decoder>(cs);
-  return decoder->Init(src_buf, src_size) ? std::move(decoder) : nullptr;
+  return decoder->Init(src_buf, src_size, discard_levels) ? std::move(decoder)
+                                                          : nullptr;
 }
 
 void CCodec_JpxModule::GetImageInfo(CJPX_Decoder* pDecoder,
@@ -875,6 +912,10 @@ void CCodec_JpxModule::GetImageInfo(CJPX_Decoder* pDecoder,
   pDecoder->GetInfo(width, height, components);
 }
 
+uint32_t CCodec_JpxModule::GetDiscardLevels(CJPX_Decoder* pDecoder) {
+  return pDecoder->GetDiscardLevels();
+}
+
 bool CCodec_JpxModule::Decode(CJPX_Decoder* pDecoder,
                               uint8_t* dest_data,
                               int pitch,
@@ -5,7 +5,11 @@
 #include <stdint.h>
 
 #include <limits>
+#include <memory>
+#include <vector>
 
+#include "core/fxcodec/codec/ccodec_jpxmodule.h"
+#include "core/fxcodec/codec/cjpx_decoder.h"
 #include "core/fxcodec/codec/codec_int.h"
 #include "testing/fx_string_testhelpers.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -18,6 +22,22 @@ static const uint8_t stream_data[] = {
     0x84, 0x85, 0x86, 0x87,  // Include some hi-bytes, too.
 };
 
+// A 32x32 grayscale codestream with 4 resolution levels, where each pixel is 8
+// times its x coordinate.
+static const uint8_t kRampJ2k[] = {
+    0xff, 0x4f, 0xff, 0x51, 0x00, 0x29, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20,
+    0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x01, 0x01, 0xff, 0x52, 0x00,
+    0x0c, 0x00, 0x00, 0x00, 0x01, 0x00, 0x03, 0x04, 0x04, 0x00, 0x01, 0xff,
+    0x5c, 0x00, 0x0d, 0x40, 0x40, 0x48, 0x48, 0x50, 0x48, 0x48, 0x50, 0x48,
+    0x48, 0x50, 0xff, 0x90, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x37,
+    0x00, 0x01, 0xff, 0x93, 0xdf, 0x78, 0x48, 0x11, 0x62, 0x34, 0xf9, 0x55,
+    0xfd, 0xb1, 0xf2, 0x95, 0xc3, 0xe6, 0x0a, 0x00, 0x22, 0x1a, 0x08, 0x5d,
+    0x8f, 0xc1, 0xf3, 0x07, 0x00, 0x36, 0xa1, 0x99, 0xae, 0x63, 0xa3, 0x5f,
+    0xc0, 0xf8, 0xc2, 0x80, 0x5f, 0xa7, 0xc7, 0x88, 0xb7, 0xff, 0xd9,
+};
+
 union Float_t {
   Float_t(float num = 0.0f) : f(num) {}
 
@@ -463,3 +483,41 @@ TEST(fxcodec, YUV420ToRGB) {
   }
   FX_Free(img.comps);
 }
+
+TEST(fxcodec, DecodeReducedResolution) {
+  const struct {
+    uint32_t discard_levels;
+    uint32_t expected_levels;
+    uint32_t expected_size;
+  } cases[] = {{0, 0, 32}, {1, 1, 16}, {3, 3, 4}, {5, 3, 4}};
+  CCodec_JpxModule module;
+  for (const auto& test_case : cases) {
+    std::unique_ptr<CJPX_Decoder> decoder = module.CreateDecoder(
+        kRampJ2k, sizeof(kRampJ2k), nullptr, test_case.discard_levels);
+    ASSERT_TRUE(decoder);
+    EXPECT_EQ(test_case.expected_levels,
+              module.GetDiscardLevels(decoder.get()));
+
+    uint32_t width;
+    uint32_t height;
+    uint32_t components;
+    module.GetImageInfo(decoder.get(), &width, &height, &components);
+    EXPECT_EQ(test_case.expected_size, width);
+    EXPECT_EQ(test_case.expected_size, height);
+    EXPECT_EQ(1u, components);
+
+    const int pitch = (width + 3) / 4 * 4;
+    std::vector<uint8_t> buffer(pitch * height);
+    ASSERT_TRUE(module.Decode(decoder.get(), buffer.data(), pitch, {0}));
+    // Each pixel stands for the one at the same place in the full image, give
+    // or take what the filters do at the image edge.
+    for (uint32_t y = 0; y < height; ++y) {
+      for (uint32_t x = 0; x < width; ++x) {
+        EXPECT_NEAR(static_cast<int>(x * 8 << test_case.expected_levels),
+                    buffer[y * pitch + x], 16)
+            << "discard " << test_case.discard_levels << " at " << x << ","
+            << y;
+      }
+    }
+  }
+}
@@ -6,8 +6,11 @@
 
 #include "core/fxcodec/jbig2/JBig2_ArithDecoder.h"
 
+#include <algorithm>
+
 #include "core/fxcodec/jbig2/JBig2_BitStream.h"
 #include "core/fxcrt/fx_basic.h"
+#include "third_party/base/bits.h"
 
 namespace {
 
@@ -113,11 +116,15 @@ void CJBig2_ArithDecoder::BYTEIN() {
 }
 
 void CJBig2_ArithDecoder::ReadValueA() {
+  // Shift A back up to kDefaultAValue, as many bits at a time as C has left
+  // before it needs the next byte.
   do {
     if (m_CT == 0)
       BYTEIN();
-    m_A <<= 1;
-    m_C <<= 1;
-    --m_CT;
+    unsigned int shift = std::min<unsigned int>(
+        pdfium::base::bits::CountLeadingZeroBits32(m_A) - 16, m_CT);
+    m_A <<= shift;
+    m_C <<= shift;
+    m_CT -= shift;
   } while ((m_A & kDefaultAValue) == 0);
 }
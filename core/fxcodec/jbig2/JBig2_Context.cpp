@@ -7,7 +7,6 @@
 #include "core/fxcodec/jbig2/JBig2_Context.h"
 
 #include <algorithm>
-#include <list>
 #include <utility>
 #include <vector>
 
@@ -21,6 +20,7 @@
 #include "core/fxcodec/jbig2/JBig2_HuffmanTable_Standard.h"
 #include "core/fxcodec/jbig2/JBig2_PddProc.h"
 #include "core/fxcodec/jbig2/JBig2_SddProc.h"
+#include "core/fxcodec/jbig2/JBig2_SymbolDictCache.h"
 #include "core/fxcodec/jbig2/JBig2_TrdProc.h"
 #include "third_party/base/ptr_util.h"
 #include "third_party/base/stl_util.h"
@@ -37,19 +37,10 @@ size_t GetRefAggContextSize(bool val) {
 
 }  // namespace
 
-// Implement a very small least recently used (LRU) cache. It is very
-// common for a JBIG2 dictionary to span multiple pages in a PDF file,
-// and we do not want to decode the same dictionary over and over
-// again. We key off of the memory location of the dictionary. The
-// list keeps track of the freshness of entries, with freshest ones
-// at the front. Even a tiny cache size like 2 makes a dramatic
-// difference for typical JBIG2 documents.
-static const int kSymbolDictCacheMaxSize = 2;
-
 CJBig2_Context::CJBig2_Context(
     const CFX_RetainPtr<CPDF_StreamAcc>& pGlobalStream,
     const CFX_RetainPtr<CPDF_StreamAcc>& pSrcStream,
-    std::list<CJBig2_CachePair>* pSymbolDictCache,
+    CJBig2_SymbolDictCache* pSymbolDictCache,
     IFX_Pause* pPause,
     bool bIsGlobal)
     : m_nSegmentDecoded(0),
@@ -585,17 +576,10 @@ int32_t CJBig2_Context::parseSymbolDict(CJBig2_Segment* pSegment) {
   bool cache_hit = false;
   pSegment->m_nResultType = JBIG2_SYMBOL_DICT_POINTER;
   if (m_bIsGlobal && key.first != 0) {
-    for (auto it = m_pSymbolDictCache->begin(); it != m_pSymbolDictCache->end();
-         ++it) {
-      if (it->first == key) {
-        std::unique_ptr<CJBig2_SymbolDict> copy(it->second->DeepCopy());
-        pSegment->m_Result.sd = copy.release();
-        m_pSymbolDictCache->push_front(
-            CJBig2_CachePair(key, std::move(it->second)));
-        m_pSymbolDictCache->erase(it);
-        cache_hit = true;
-        break;
-      }
+    std::unique_ptr<CJBig2_SymbolDict> cached = m_pSymbolDictCache->Find(key);
+    if (cached) {
+      pSegment->m_Result.sd = cached.release();
+      cache_hit = true;
     }
   }
   if (!cache_hit) {
@@ -616,16 +600,8 @@ int32_t CJBig2_Context::parseSymbolDict(CJBig2_Segment* pSegment) {
         return JBIG2_ERROR_FATAL;
       m_pStream->alignByte();
     }
-    if (m_bIsGlobal) {
-      std::unique_ptr<CJBig2_SymbolDict> value =
-          pSegment->m_Result.sd->DeepCopy();
-      int size = pdfium::CollectionSize<int>(*m_pSymbolDictCache);
-      while (size >= kSymbolDictCacheMaxSize) {
-        m_pSymbolDictCache->pop_back();
-        --size;
-      }
-      m_pSymbolDictCache->push_front(CJBig2_CachePair(key, std::move(value)));
-    }
+    if (m_bIsGlobal && key.first != 0)
+      m_pSymbolDictCache->Add(key, pSegment->m_Result.sd->DeepCopy());
   }
   if (wFlags & 0x0200) {
     if (bUseGbContext)
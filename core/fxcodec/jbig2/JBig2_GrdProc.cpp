@@ -6,6 +6,7 @@
 
 #include "core/fxcodec/jbig2/JBig2_GrdProc.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "core/fxcodec/fx_codec.h"
@@ -14,6 +15,239 @@
 #include "core/fxcodec/jbig2/JBig2_Image.h"
 #include "third_party/base/ptr_util.h"
 
+namespace {
+
+// The pixels of a generic region template besides its AT pixels, per 6.2.5.3
+// of the JBIG2 spec. The context holds |line_count| pixels to the left on the
+// current row from bit 0 up, and |row_count| pixels of each of the rows
+// above, ending at column |row_dx| from the pixel being decoded, from bit
+// |row_shift| up. The AT pixels go in at |at_shift|.
+struct GenericTemplate {
+  uint32_t tpgd_context;
+  int32_t line_count;
+  int32_t row_dx[2];
+  int32_t row_count[2];
+  int32_t row_shift[2];
+  size_t num_at;
+  int32_t at_shift[4];
+};
+
+const GenericTemplate kGenericTemplates[] = {
+    {0x9b25, 4, {2, 1}, {5, 3}, {5, 12}, 4, {4, 10, 11, 15}},
+    {0x0795, 3, {2, 2}, {5, 4}, {4, 9}, 1, {3}},
+    {0x00e5, 2, {1, 1}, {4, 3}, {3, 7}, 1, {2}},
+    {0x0195, 4, {1, 0}, {5, 0}, {5, 0}, 1, {4}},
+};
+
+struct GenericContextLayout {
+  uint8_t gbtemplate;
+  uint32_t tpgd_context;
+  int8_t at[8];
+  // Whether an AT pixel is among the last few decoded on the current row.
+  bool has_line_at;
+};
+
+// Whether AT pixel (|dx|, |dy|) lies in the byte of the row being decoded,
+// or the one before it, at the time it is needed.
+bool IsLineAT(int32_t dx, int32_t dy) {
+  return dy == 0 && dx < 0 && dx > -8;
+}
+
+GenericContextLayout GetGenericContextLayout(uint8_t gbtemplate,
+                                             const int8_t* gbat) {
+  GenericContextLayout layout;
+  layout.gbtemplate = std::min<uint8_t>(gbtemplate, 3);
+  layout.tpgd_context = kGenericTemplates[layout.gbtemplate].tpgd_context;
+  layout.has_line_at = false;
+  for (size_t i = 0; i < kGenericTemplates[layout.gbtemplate].num_at; ++i) {
+    layout.at[2 * i] = gbat[2 * i];
+    layout.at[2 * i + 1] = gbat[2 * i + 1];
+    if (IsLineAT(gbat[2 * i], gbat[2 * i + 1]))
+      layout.has_line_at = true;
+  }
+  return layout;
+}
+
+int GetRowPixel(const uint8_t* row, int32_t width, int32_t x) {
+  if (!row || x < 0 || x >= width)
+    return 0;
+  return (row[x >> 3] >> (7 - (x & 7))) & 1;
+}
+
+// Returns bytes |index| to |index| + 2 of |row| as one big-endian value,
+// reading bytes outside the row as 0.
+uint32_t LoadRowWindow(const uint8_t* row, int32_t row_bytes, int32_t index) {
+  if (!row)
+    return 0;
+
+  if (index >= 0 && index + 2 < row_bytes)
+    return (row[index] << 16) | (row[index + 1] << 8) | row[index + 2];
+
+  uint32_t window = 0;
+  for (int32_t i = index; i < index + 3; ++i) {
+    window <<= 8;
+    if (i >= 0 && i < row_bytes)
+      window |= row[i];
+  }
+  return window;
+}
+
+// Returns the 8 pixels of |row| from column |x|, lined up so pixel k lands on
+// bit |shift| when shifted down by 7 - k.
+uint32_t LoadPixels(const uint8_t* row,
+                    int32_t row_bytes,
+                    int32_t x,
+                    int32_t shift) {
+  return (LoadRowWindow(row, row_bytes, x >> 3) << 8) >>
+         (24 - (x & 7) - shift);
+}
+
+// Adds bit |shift| of |pixels| shifted down by 7 - k to |contexts|[k].
+void SpreadPixels(uint32_t pixels, int32_t shift, uint32_t* contexts) {
+  const uint32_t mask = 1 << shift;
+  contexts[0] |= (pixels >> 7) & mask;
+  contexts[1] |= (pixels >> 6) & mask;
+  contexts[2] |= (pixels >> 5) & mask;
+  contexts[3] |= (pixels >> 4) & mask;
+  contexts[4] |= (pixels >> 3) & mask;
+  contexts[5] |= (pixels >> 2) & mask;
+  contexts[6] |= (pixels >> 1) & mask;
+  contexts[7] |= pixels & mask;
+}
+
+// Decodes row |y| of |image| with template |kTemplate|. The fixed pixels of
+// the template shift along the context as in the _opt3 decoders. The rest of
+// the context for each pixel of a byte is worked out from a few words loaded
+// once for the byte. Pixels set in |skip| stay 0 without being decoded.
+// Returns false if the decoder runs out of data.
+template <uint8_t kTemplate, bool kLineAT>
+bool DecodeGenericRow(const GenericContextLayout& layout,
+                      CJBig2_Image* image,
+                      int32_t y,
+                      CJBig2_Image* skip,
+                      CJBig2_ArithDecoder* pArithDecoder,
+                      JBig2ArithCtx* gbContext) {
+  const GenericTemplate& tmpl = kGenericTemplates[kTemplate];
+  const size_t kNumRows = kTemplate == 3 ? 1 : 2;
+  const size_t kNumAT = kTemplate == 0 ? 4 : 1;
+  const int32_t width = image->width();
+  const int32_t stride = image->stride();
+  const int32_t row_bytes = (width + 7) >> 3;
+  uint8_t* pLine = image->m_pData + y * stride;
+
+  // Start with the context of the first pixel, and keep the bits that shift
+  // along to the next one.
+  uint32_t CONTEXT = 0;
+  uint32_t keep = (1 << (tmpl.line_count - 1)) - 1;
+  const uint8_t* rows[kNumRows];
+  for (size_t i = 0; i < kNumRows; ++i) {
+    rows[i] = y > static_cast<int32_t>(i)
+                  ? image->m_pData + (y - 1 - i) * stride
+                  : nullptr;
+    for (int32_t j = 0; j < tmpl.row_count[i]; ++j) {
+      CONTEXT |= GetRowPixel(rows[i], width, tmpl.row_dx[i] - j)
+                 << (tmpl.row_shift[i] + j);
+    }
+    keep |= ((1 << (tmpl.row_count[i] - 1)) - 1) << tmpl.row_shift[i];
+  }
+
+  const uint8_t* at_rows[kNumAT];
+  int32_t at_dx[kNumAT];
+  for (size_t i = 0; i < kNumAT; ++i) {
+    const int32_t dx = layout.at[2 * i];
+    const int32_t dy = layout.at[2 * i + 1];
+    at_dx[i] = dx;
+    at_rows[i] = nullptr;
+    // Pixels from the current one on have not been decoded yet, and are 0.
+    if (y + dy >= 0 && (dy < 0 || (dy == 0 && dx < 0)))
+      at_rows[i] = image->m_pData + (y + dy) * stride;
+  }
+
+  // The pixels decoded so far on this row, the latest in the lowest bit.
+  uint32_t line = 0;
+  for (int32_t cc = 0; cc < row_bytes; ++cc) {
+    const int32_t x0 = cc << 3;
+    // The AT pixels for each pixel of the byte, and the pixels that shift
+    // into the context after it.
+    uint32_t at_context[8] = {};
+    uint32_t row_context[8] = {};
+    for (size_t i = 0; i < kNumAT; ++i) {
+      SpreadPixels(
+          LoadPixels(at_rows[i], row_bytes, x0 + at_dx[i], tmpl.at_shift[i]),
+          tmpl.at_shift[i], at_context);
+    }
+    for (size_t i = 0; i < kNumRows; ++i) {
+      SpreadPixels(LoadPixels(rows[i], row_bytes, x0 + tmpl.row_dx[i] + 1,
+                              tmpl.row_shift[i]),
+                   tmpl.row_shift[i], row_context);
+    }
+
+    const int32_t nPixels = std::min(8, width - x0);
+    uint8_t cVal = 0;
+    for (int32_t k = 0; k < nPixels; ++k) {
+      int bVal = 0;
+      if (!skip || !skip->getPixel(x0 + k, y)) {
+        uint32_t context = CONTEXT | at_context[k];
+        if (kLineAT) {
+          // Pixels of this byte were not there when it was loaded.
+          for (size_t i = 0; i < kNumAT; ++i) {
+            if (IsLineAT(at_dx[i], layout.at[2 * i + 1]))
+              context |= ((line >> (-at_dx[i] - 1)) & 1) << tmpl.at_shift[i];
+          }
+        }
+        if (pArithDecoder->IsComplete())
+          return false;
+
+        bVal = pArithDecoder->DECODE(&gbContext[context]);
+        cVal |= bVal << (7 - k);
+      }
+      line = (line << 1) | bVal;
+      CONTEXT = ((CONTEXT & keep) << 1) | bVal | row_context[k];
+    }
+    pLine[cc] = cVal;
+  }
+  return true;
+}
+
+template <uint8_t kTemplate>
+bool DecodeGenericRow(const GenericContextLayout& layout,
+                      CJBig2_Image* image,
+                      int32_t y,
+                      CJBig2_Image* skip,
+                      CJBig2_ArithDecoder* pArithDecoder,
+                      JBig2ArithCtx* gbContext) {
+  if (layout.has_line_at) {
+    return DecodeGenericRow<kTemplate, true>(layout, image, y, skip,
+                                             pArithDecoder, gbContext);
+  }
+  return DecodeGenericRow<kTemplate, false>(layout, image, y, skip,
+                                            pArithDecoder, gbContext);
+}
+
+bool DecodeGenericRow(const GenericContextLayout& layout,
+                      CJBig2_Image* image,
+                      int32_t y,
+                      CJBig2_Image* skip,
+                      CJBig2_ArithDecoder* pArithDecoder,
+                      JBig2ArithCtx* gbContext) {
+  switch (layout.gbtemplate) {
+    case 0:
+      return DecodeGenericRow<0>(layout, image, y, skip, pArithDecoder,
+                                 gbContext);
+    case 1:
+      return DecodeGenericRow<1>(layout, image, y, skip, pArithDecoder,
+                                 gbContext);
+    case 2:
+      return DecodeGenericRow<2>(layout, image, y, skip, pArithDecoder,
+                                 gbContext);
+    default:
+      return DecodeGenericRow<3>(layout, image, y, skip, pArithDecoder,
+                                 gbContext);
+  }
+}
+
+}  // namespace
+
 CJBig2_GRDProc::CJBig2_GRDProc()
     : m_loopIndex(0),
       m_pLine(nullptr),
@@ -47,21 +281,19 @@ CJBig2_Image* CJBig2_GRDProc::decode_Arith(CJBig2_ArithDecoder* pArithDecoder,
   if (GBTEMPLATE == 0) {
     if (UseTemplate0Opt3())
       return decode_Arith_Template0_opt3(pArithDecoder, gbContext);
-    return decode_Arith_Template0_unopt(pArithDecoder, gbContext);
   } else if (GBTEMPLATE == 1) {
     if (UseTemplate1Opt3())
       return decode_Arith_Template1_opt3(pArithDecoder, gbContext);
-    return decode_Arith_Template1_unopt(pArithDecoder, gbContext);
   } else if (GBTEMPLATE == 2) {
     if (UseTemplate23Opt3())
       return decode_Arith_Template2_opt3(pArithDecoder, gbContext);
-    return decode_Arith_Template2_unopt(pArithDecoder, gbContext);
   } else {
     if (UseTemplate23Opt3())
       return decode_Arith_Template3_opt3(pArithDecoder, gbContext);
-    return decode_Arith_Template3_unopt(pArithDecoder, gbContext);
   }
+  return decode_Arith_Generic(pArithDecoder, gbContext);
 }
+
 CJBig2_Image* CJBig2_GRDProc::decode_Arith_Template0_opt3(
     CJBig2_ArithDecoder* pArithDecoder,
     JBig2ArithCtx* gbContext) {
@@ -160,57 +392,6 @@ CJBig2_Image* CJBig2_GRDProc::decode_Arith_Template0_opt3(
   return GBREG.release();
 }
 
-CJBig2_Image* CJBig2_GRDProc::decode_Arith_Template0_unopt(
-    CJBig2_ArithDecoder* pArithDecoder,
-    JBig2ArithCtx* gbContext) {
-  int LTP = 0;
-  auto GBREG = pdfium::MakeUnique<CJBig2_Image>(GBW, GBH);
-  GBREG->fill(0);
-  for (uint32_t h = 0; h < GBH; h++) {
-    if (TPGDON) {
-      if (pArithDecoder->IsComplete())
-        return nullptr;
-
-      LTP = LTP ^ pArithDecoder->DECODE(&gbContext[0x9b25]);
-    }
-    if (LTP) {
-      GBREG->copyLine(h, h - 1);
-    } else {
-      uint32_t line1 = GBREG->getPixel(1, h - 2);
-      line1 |= GBREG->getPixel(0, h - 2) << 1;
-      uint32_t line2 = GBREG->getPixel(2, h - 1);
-      line2 |= GBREG->getPixel(1, h - 1) << 1;
-      line2 |= GBREG->getPixel(0, h - 1) << 2;
-      uint32_t line3 = 0;
-      for (uint32_t w = 0; w < GBW; w++) {
-        int bVal;
-        if (USESKIP && SKIP->getPixel(w, h)) {
-          bVal = 0;
-        } else {
-          uint32_t CONTEXT = line3;
-          CONTEXT |= GBREG->getPixel(w + GBAT[0], h + GBAT[1]) << 4;
-          CONTEXT |= line2 << 5;
-          CONTEXT |= GBREG->getPixel(w + GBAT[2], h + GBAT[3]) << 10;
-          CONTEXT |= GBREG->getPixel(w + GBAT[4], h + GBAT[5]) << 11;
-          CONTEXT |= line1 << 12;
-          CONTEXT |= GBREG->getPixel(w + GBAT[6], h + GBAT[7]) << 15;
-          if (pArithDecoder->IsComplete())
-            return nullptr;
-
-          bVal = pArithDecoder->DECODE(&gbContext[CONTEXT]);
-        }
-        if (bVal) {
-          GBREG->setPixel(w, h, bVal);
-        }
-        line1 = ((line1 << 1) | GBREG->getPixel(w + 2, h - 2)) & 0x07;
-        line2 = ((line2 << 1) | GBREG->getPixel(w + 3, h - 1)) & 0x1f;
-        line3 = ((line3 << 1) | bVal) & 0x0f;
-      }
-    }
-  }
-  return GBREG.release();
-}
-
 CJBig2_Image* CJBig2_GRDProc::decode_Arith_Template1_opt3(
     CJBig2_ArithDecoder* pArithDecoder,
     JBig2ArithCtx* gbContext) {
@@ -308,55 +489,6 @@ CJBig2_Image* CJBig2_GRDProc::decode_Arith_Template1_opt3(
   return GBREG.release();
 }
 
-CJBig2_Image* CJBig2_GRDProc::decode_Arith_Template1_unopt(
-    CJBig2_ArithDecoder* pArithDecoder,
-    JBig2ArithCtx* gbContext) {
-  int LTP = 0;
-  auto GBREG = pdfium::MakeUnique<CJBig2_Image>(GBW, GBH);
-  GBREG->fill(0);
-  for (uint32_t h = 0; h < GBH; h++) {
-    if (TPGDON) {
-      if (pArithDecoder->IsComplete())
-        return nullptr;
-
-      LTP = LTP ^ pArithDecoder->DECODE(&gbContext[0x0795]);
-    }
-    if (LTP) {
-      GBREG->copyLine(h, h - 1);
-    } else {
-      uint32_t line1 = GBREG->getPixel(2, h - 2);
-      line1 |= GBREG->getPixel(1, h - 2) << 1;
-      line1 |= GBREG->getPixel(0, h - 2) << 2;
-      uint32_t line2 = GBREG->getPixel(2, h - 1);
-      line2 |= GBREG->getPixel(1, h - 1) << 1;
-      line2 |= GBREG->getPixel(0, h - 1) << 2;
-      uint32_t line3 = 0;
-      for (uint32_t w = 0; w < GBW; w++) {
-        int bVal;
-        if (USESKIP && SKIP->getPixel(w, h)) {
-          bVal = 0;
-        } else {
-          uint32_t CONTEXT = line3;
-          CONTEXT |= GBREG->getPixel(w + GBAT[0], h + GBAT[1]) << 3;
-          CONTEXT |= line2 << 4;
-          CONTEXT |= line1 << 9;
-          if (pArithDecoder->IsComplete())
-            return nullptr;
-
-          bVal = pArithDecoder->DECODE(&gbContext[CONTEXT]);
-        }
-        if (bVal) {
-          GBREG->setPixel(w, h, bVal);
-        }
-        line1 = ((line1 << 1) | GBREG->getPixel(w + 3, h - 2)) & 0x0f;
-        line2 = ((line2 << 1) | GBREG->getPixel(w + 3, h - 1)) & 0x1f;
-        line3 = ((line3 << 1) | bVal) & 0x07;
-      }
-    }
-  }
-  return GBREG.release();
-}
-
 CJBig2_Image* CJBig2_GRDProc::decode_Arith_Template2_opt3(
     CJBig2_ArithDecoder* pArithDecoder,
     JBig2ArithCtx* gbContext) {
@@ -454,53 +586,6 @@ CJBig2_Image* CJBig2_GRDProc::decode_Arith_Template2_opt3(
   return GBREG.release();
 }
 
-CJBig2_Image* CJBig2_GRDProc::decode_Arith_Template2_unopt(
-    CJBig2_ArithDecoder* pArithDecoder,
-    JBig2ArithCtx* gbContext) {
-  int LTP = 0;
-  auto GBREG = pdfium::MakeUnique<CJBig2_Image>(GBW, GBH);
-  GBREG->fill(0);
-  for (uint32_t h = 0; h < GBH; h++) {
-    if (TPGDON) {
-      if (pArithDecoder->IsComplete())
-        return nullptr;
-
-      LTP = LTP ^ pArithDecoder->DECODE(&gbContext[0x00e5]);
-    }
-    if (LTP) {
-      GBREG->copyLine(h, h - 1);
-    } else {
-      uint32_t line1 = GBREG->getPixel(1, h - 2);
-      line1 |= GBREG->getPixel(0, h - 2) << 1;
-      uint32_t line2 = GBREG->getPixel(1, h - 1);
-      line2 |= GBREG->getPixel(0, h - 1) << 1;
-      uint32_t line3 = 0;
-      for (uint32_t w = 0; w < GBW; w++) {
-        int bVal;
-        if (USESKIP && SKIP->getPixel(w, h)) {
-          bVal = 0;
-        } else {
-          uint32_t CONTEXT = line3;
-          CONTEXT |= GBREG->getPixel(w + GBAT[0], h + GBAT[1]) << 2;
-          CONTEXT |= line2 << 3;
-          CONTEXT |= line1 << 7;
-          if (pArithDecoder->IsComplete())
-            return nullptr;
-
-          bVal = pArithDecoder->DECODE(&gbContext[CONTEXT]);
-        }
-        if (bVal) {
-          GBREG->setPixel(w, h, bVal);
-        }
-        line1 = ((line1 << 1) | GBREG->getPixel(w + 2, h - 2)) & 0x07;
-        line2 = ((line2 << 1) | GBREG->getPixel(w + 2, h - 1)) & 0x0f;
-        line3 = ((line3 << 1) | bVal) & 0x03;
-      }
-    }
-  }
-  return GBREG.release();
-}
-
 CJBig2_Image* CJBig2_GRDProc::decode_Arith_Template3_opt3(
     CJBig2_ArithDecoder* pArithDecoder,
     JBig2ArithCtx* gbContext) {
@@ -586,44 +671,30 @@ CJBig2_Image* CJBig2_GRDProc::decode_Arith_Template3_opt3(
   return GBREG.release();
 }
 
-CJBig2_Image* CJBig2_GRDProc::decode_Arith_Template3_unopt(
+CJBig2_Image* CJBig2_GRDProc::decode_Arith_Generic(
     CJBig2_ArithDecoder* pArithDecoder,
     JBig2ArithCtx* gbContext) {
-  int LTP = 0;
   auto GBREG = pdfium::MakeUnique<CJBig2_Image>(GBW, GBH);
+  if (!GBREG->m_pData)
+    return nullptr;
+
   GBREG->fill(0);
+  const GenericContextLayout layout =
+      GetGenericContextLayout(GBTEMPLATE, GBAT);
+  CJBig2_Image* pSkip = USESKIP ? SKIP : nullptr;
+  int LTP = 0;
   for (uint32_t h = 0; h < GBH; h++) {
     if (TPGDON) {
       if (pArithDecoder->IsComplete())
         return nullptr;
 
-      LTP = LTP ^ pArithDecoder->DECODE(&gbContext[0x0195]);
+      LTP = LTP ^ pArithDecoder->DECODE(&gbContext[layout.tpgd_context]);
     }
-    if (LTP == 1) {
+    if (LTP) {
       GBREG->copyLine(h, h - 1);
-    } else {
-      uint32_t line1 = GBREG->getPixel(1, h - 1);
-      line1 |= GBREG->getPixel(0, h - 1) << 1;
-      uint32_t line2 = 0;
-      for (uint32_t w = 0; w < GBW; w++) {
-        int bVal;
-        if (USESKIP && SKIP->getPixel(w, h)) {
-          bVal = 0;
-        } else {
-          uint32_t CONTEXT = line2;
-          CONTEXT |= GBREG->getPixel(w + GBAT[0], h + GBAT[1]) << 4;
-          CONTEXT |= line1 << 5;
-          if (pArithDecoder->IsComplete())
-            return nullptr;
-
-          bVal = pArithDecoder->DECODE(&gbContext[CONTEXT]);
-        }
-        if (bVal) {
-          GBREG->setPixel(w, h, bVal);
-        }
-        line1 = ((line1 << 1) | GBREG->getPixel(w + 2, h - 1)) & 0x1f;
-        line2 = ((line2 << 1) | bVal) & 0x0f;
-      }
+    } else if (!DecodeGenericRow(layout, GBREG.get(), h, pSkip, pArithDecoder,
+                                 gbContext)) {
+      return nullptr;
     }
   }
   return GBREG.release();
@@ -661,38 +732,21 @@ FXCODEC_STATUS CJBig2_GRDProc::Start_decode_Arith(
 FXCODEC_STATUS CJBig2_GRDProc::decode_Arith(IFX_Pause* pPause) {
   int iline = m_loopIndex;
   CJBig2_Image* pImage = *m_pImage;
-  if (GBTEMPLATE == 0) {
-    if (UseTemplate0Opt3()) {
-      m_ProssiveStatus = decode_Arith_Template0_opt3(pImage, m_pArithDecoder,
-                                                     m_gbContext, pPause);
-    } else {
-      m_ProssiveStatus = decode_Arith_Template0_unopt(pImage, m_pArithDecoder,
-                                                      m_gbContext, pPause);
-    }
-  } else if (GBTEMPLATE == 1) {
-    if (UseTemplate1Opt3()) {
-      m_ProssiveStatus = decode_Arith_Template1_opt3(pImage, m_pArithDecoder,
-                                                     m_gbContext, pPause);
-    } else {
-      m_ProssiveStatus = decode_Arith_Template1_unopt(pImage, m_pArithDecoder,
-                                                      m_gbContext, pPause);
-    }
-  } else if (GBTEMPLATE == 2) {
-    if (UseTemplate23Opt3()) {
-      m_ProssiveStatus = decode_Arith_Template2_opt3(pImage, m_pArithDecoder,
-                                                     m_gbContext, pPause);
-    } else {
-      m_ProssiveStatus = decode_Arith_Template2_unopt(pImage, m_pArithDecoder,
-                                                      m_gbContext, pPause);
-    }
+  if (GBTEMPLATE == 0 && UseTemplate0Opt3()) {
+    m_ProssiveStatus = decode_Arith_Template0_opt3(pImage, m_pArithDecoder,
+                                                   m_gbContext, pPause);
+  } else if (GBTEMPLATE == 1 && UseTemplate1Opt3()) {
+    m_ProssiveStatus = decode_Arith_Template1_opt3(pImage, m_pArithDecoder,
+                                                   m_gbContext, pPause);
+  } else if (GBTEMPLATE == 2 && UseTemplate23Opt3()) {
+    m_ProssiveStatus = decode_Arith_Template2_opt3(pImage, m_pArithDecoder,
+                                                   m_gbContext, pPause);
+  } else if (GBTEMPLATE > 2 && UseTemplate23Opt3()) {
+    m_ProssiveStatus = decode_Arith_Template3_opt3(pImage, m_pArithDecoder,
+                                                   m_gbContext, pPause);
   } else {
-    if (UseTemplate23Opt3()) {
-      m_ProssiveStatus = decode_Arith_Template3_opt3(pImage, m_pArithDecoder,
-                                                     m_gbContext, pPause);
-    } else {
-      m_ProssiveStatus = decode_Arith_Template3_unopt(pImage, m_pArithDecoder,
-                                                      m_gbContext, pPause);
-    }
+    m_ProssiveStatus =
+        decode_Arith_Generic(pImage, m_pArithDecoder, m_gbContext, pPause);
   }
   m_ReplaceRect.left = 0;
   m_ReplaceRect.right = pImage->width();
@@ -841,64 +895,6 @@ FXCODEC_STATUS CJBig2_GRDProc::decode_Arith_Template0_opt3(
   return FXCODEC_STATUS_DECODE_FINISH;
 }
 
-FXCODEC_STATUS CJBig2_GRDProc::decode_Arith_Template0_unopt(
-    CJBig2_Image* pImage,
-    CJBig2_ArithDecoder* pArithDecoder,
-    JBig2ArithCtx* gbContext,
-    IFX_Pause* pPause) {
-  for (; m_loopIndex < GBH; m_loopIndex++) {
-    if (TPGDON) {
-      if (pArithDecoder->IsComplete())
-        return FXCODEC_STATUS_ERROR;
-
-      m_LTP = m_LTP ^ pArithDecoder->DECODE(&gbContext[0x9b25]);
-    }
-    if (m_LTP) {
-      pImage->copyLine(m_loopIndex, m_loopIndex - 1);
-    } else {
-      uint32_t line1 = pImage->getPixel(1, m_loopIndex - 2);
-      line1 |= pImage->getPixel(0, m_loopIndex - 2) << 1;
-      uint32_t line2 = pImage->getPixel(2, m_loopIndex - 1);
-      line2 |= pImage->getPixel(1, m_loopIndex - 1) << 1;
-      line2 |= pImage->getPixel(0, m_loopIndex - 1) << 2;
-      uint32_t line3 = 0;
-      for (uint32_t w = 0; w < GBW; w++) {
-        int bVal;
-        if (USESKIP && SKIP->getPixel(w, m_loopIndex)) {
-          bVal = 0;
-        } else {
-          uint32_t CONTEXT = line3;
-          CONTEXT |= pImage->getPixel(w + GBAT[0], m_loopIndex + GBAT[1]) << 4;
-          CONTEXT |= line2 << 5;
-          CONTEXT |= pImage->getPixel(w + GBAT[2], m_loopIndex + GBAT[3]) << 10;
-          CONTEXT |= pImage->getPixel(w + GBAT[4], m_loopIndex + GBAT[5]) << 11;
-          CONTEXT |= line1 << 12;
-          CONTEXT |= pImage->getPixel(w + GBAT[6], m_loopIndex + GBAT[7]) << 15;
-          if (pArithDecoder->IsComplete())
-            return FXCODEC_STATUS_ERROR;
-
-          bVal = pArithDecoder->DECODE(&gbContext[CONTEXT]);
-        }
-        if (bVal) {
-          pImage->setPixel(w, m_loopIndex, bVal);
-        }
-        line1 =
-            ((line1 << 1) | pImage->getPixel(w + 2, m_loopIndex - 2)) & 0x07;
-        line2 =
-            ((line2 << 1) | pImage->getPixel(w + 3, m_loopIndex - 1)) & 0x1f;
-        line3 = ((line3 << 1) | bVal) & 0x0f;
-      }
-    }
-    if (pPause && pPause->NeedToPauseNow()) {
-      m_loopIndex++;
-      m_ProssiveStatus = FXCODEC_STATUS_DECODE_TOBECONTINUE;
-      return FXCODEC_STATUS_DECODE_TOBECONTINUE;
-    }
-  }
-  m_ProssiveStatus = FXCODEC_STATUS_DECODE_FINISH;
-  return FXCODEC_STATUS_DECODE_FINISH;
-}
-
 FXCODEC_STATUS CJBig2_GRDProc::decode_Arith_Template1_opt3(
     CJBig2_Image* pImage,
     CJBig2_ArithDecoder* pArithDecoder,
@@ -1001,60 +997,6 @@ FXCODEC_STATUS CJBig2_GRDProc::decode_Arith_Template1_opt3(
   return FXCODEC_STATUS_DECODE_FINISH;
 }
 
-FXCODEC_STATUS CJBig2_GRDProc::decode_Arith_Template1_unopt(
-    CJBig2_Image* pImage,
-    CJBig2_ArithDecoder* pArithDecoder,
-    JBig2ArithCtx* gbContext,
-    IFX_Pause* pPause) {
-  for (uint32_t h = 0; h < GBH; h++) {
-    if (TPGDON) {
-      if (pArithDecoder->IsComplete())
-        return FXCODEC_STATUS_ERROR;
-
-      m_LTP = m_LTP ^ pArithDecoder->DECODE(&gbContext[0x0795]);
-    }
-    if (m_LTP) {
-      pImage->copyLine(h, h - 1);
-    } else {
-      uint32_t line1 = pImage->getPixel(2, h - 2);
-      line1 |= pImage->getPixel(1, h - 2) << 1;
-      line1 |= pImage->getPixel(0, h - 2) << 2;
-      uint32_t line2 = pImage->getPixel(2, h - 1);
-      line2 |= pImage->getPixel(1, h - 1) << 1;
-      line2 |= pImage->getPixel(0, h - 1) << 2;
-      uint32_t line3 = 0;
-      for (uint32_t w = 0; w < GBW; w++) {
-        int bVal;
-        if (USESKIP && SKIP->getPixel(w, h)) {
-          bVal = 0;
-        } else {
-          uint32_t CONTEXT = line3;
-          CONTEXT |= pImage->getPixel(w + GBAT[0], h + GBAT[1]) << 3;
-          CONTEXT |= line2 << 4;
-          CONTEXT |= line1 << 9;
-          if (pArithDecoder->IsComplete())
-            return FXCODEC_STATUS_ERROR;
-
-          bVal = pArithDecoder->DECODE(&gbContext[CONTEXT]);
-        }
-        if (bVal) {
-          pImage->setPixel(w, h, bVal);
-        }
-        line1 = ((line1 << 1) | pImage->getPixel(w + 3, h - 2)) & 0x0f;
-        line2 = ((line2 << 1) | pImage->getPixel(w + 3, h - 1)) & 0x1f;
-        line3 = ((line3 << 1) | bVal) & 0x07;
-      }
-    }
-    if (pPause && pPause->NeedToPauseNow()) {
-      m_loopIndex++;
-      m_ProssiveStatus = FXCODEC_STATUS_DECODE_TOBECONTINUE;
-      return FXCODEC_STATUS_DECODE_TOBECONTINUE;
-    }
-  }
-  m_ProssiveStatus = FXCODEC_STATUS_DECODE_FINISH;
-  return FXCODEC_STATUS_DECODE_FINISH;
-}
-
 FXCODEC_STATUS CJBig2_GRDProc::decode_Arith_Template2_opt3(
     CJBig2_Image* pImage,
     CJBig2_ArithDecoder* pArithDecoder,
@@ -1157,60 +1099,6 @@ FXCODEC_STATUS CJBig2_GRDProc::decode_Arith_Template2_opt3(
   return FXCODEC_STATUS_DECODE_FINISH;
 }
 
-FXCODEC_STATUS CJBig2_GRDProc::decode_Arith_Template2_unopt(
-    CJBig2_Image* pImage,
-    CJBig2_ArithDecoder* pArithDecoder,
-    JBig2ArithCtx* gbContext,
-    IFX_Pause* pPause) {
-  for (; m_loopIndex < GBH; m_loopIndex++) {
-    if (TPGDON) {
-      if (pArithDecoder->IsComplete())
-        return FXCODEC_STATUS_ERROR;
-
-      m_LTP = m_LTP ^ pArithDecoder->DECODE(&gbContext[0x00e5]);
-    }
-    if (m_LTP) {
-      pImage->copyLine(m_loopIndex, m_loopIndex - 1);
-    } else {
-      uint32_t line1 = pImage->getPixel(1, m_loopIndex - 2);
-      line1 |= pImage->getPixel(0, m_loopIndex - 2) << 1;
-      uint32_t line2 = pImage->getPixel(1, m_loopIndex - 1);
-      line2 |= pImage->getPixel(0, m_loopIndex - 1) << 1;
-      uint32_t line3 = 0;
-      for (uint32_t w = 0; w < GBW; w++) {
-        int bVal;
-        if (USESKIP && SKIP->getPixel(w, m_loopIndex)) {
-          bVal = 0;
-        } else {
-          uint32_t CONTEXT = line3;
-          CONTEXT |= pImage->getPixel(w + GBAT[0], m_loopIndex + GBAT[1]) << 2;
-          CONTEXT |= line2 << 3;
-          CONTEXT |= line1 << 7;
-          if (pArithDecoder->IsComplete())
-            return FXCODEC_STATUS_ERROR;
-
-          bVal = pArithDecoder->DECODE(&gbContext[CONTEXT]);
-        }
-        if (bVal) {
-          pImage->setPixel(w, m_loopIndex, bVal);
-        }
-        line1 =
-            ((line1 << 1) | pImage->getPixel(w + 2, m_loopIndex - 2)) & 0x07;
-        line2 =
-            ((line2 << 1) | pImage->getPixel(w + 2, m_loopIndex - 1)) & 0x0f;
-        line3 = ((line3 << 1) | bVal) & 0x03;
-      }
-    }
-    if (pPause && pPause->NeedToPauseNow()) {
-      m_loopIndex++;
-      m_ProssiveStatus = FXCODEC_STATUS_DECODE_TOBECONTINUE;
-      return FXCODEC_STATUS_DECODE_TOBECONTINUE;
-    }
-  }
-  m_ProssiveStatus = FXCODEC_STATUS_DECODE_FINISH;
-  return FXCODEC_STATUS_DECODE_FINISH;
-}
-
 FXCODEC_STATUS CJBig2_GRDProc::decode_Arith_Template3_opt3(
     CJBig2_Image* pImage,
     CJBig2_ArithDecoder* pArithDecoder,
@@ -1299,44 +1187,26 @@ FXCODEC_STATUS CJBig2_GRDProc::decode_Arith_Template3_opt3(
   return FXCODEC_STATUS_DECODE_FINISH;
 }
 
-FXCODEC_STATUS CJBig2_GRDProc::decode_Arith_Template3_unopt(
+FXCODEC_STATUS CJBig2_GRDProc::decode_Arith_Generic(
     CJBig2_Image* pImage,
     CJBig2_ArithDecoder* pArithDecoder,
     JBig2ArithCtx* gbContext,
     IFX_Pause* pPause) {
+  const GenericContextLayout layout =
+      GetGenericContextLayout(GBTEMPLATE, GBAT);
+  CJBig2_Image* pSkip = USESKIP ? SKIP : nullptr;
   for (; m_loopIndex < GBH; m_loopIndex++) {
     if (TPGDON) {
       if (pArithDecoder->IsComplete())
         return FXCODEC_STATUS_ERROR;
 
-      m_LTP = m_LTP ^ pArithDecoder->DECODE(&gbContext[0x0195]);
+      m_LTP = m_LTP ^ pArithDecoder->DECODE(&gbContext[layout.tpgd_context]);
     }
     if (m_LTP) {
       pImage->copyLine(m_loopIndex, m_loopIndex - 1);
-    } else {
-      uint32_t line1 = pImage->getPixel(1, m_loopIndex - 1);
-      line1 |= pImage->getPixel(0, m_loopIndex - 1) << 1;
-      uint32_t line2 = 0;
-      for (uint32_t w = 0; w < GBW; w++) {
-        int bVal;
-        if (USESKIP && SKIP->getPixel(w, m_loopIndex)) {
-          bVal = 0;
-        } else {
-          uint32_t CONTEXT = line2;
-          CONTEXT |= pImage->getPixel(w + GBAT[0], m_loopIndex + GBAT[1]) << 4;
-          CONTEXT |= line1 << 5;
-          if (pArithDecoder->IsComplete())
-            return FXCODEC_STATUS_ERROR;
-
-          bVal = pArithDecoder->DECODE(&gbContext[CONTEXT]);
-        }
-        if (bVal) {
-          pImage->setPixel(w, m_loopIndex, bVal);
-        }
-        line1 =
-            ((line1 << 1) | pImage->getPixel(w + 2, m_loopIndex - 1)) & 0x1f;
-        line2 = ((line2 << 1) | bVal) & 0x0f;
-      }
+    } else if (!DecodeGenericRow(layout, pImage, m_loopIndex, pSkip,
+                                 pArithDecoder, gbContext)) {
+      return FXCODEC_STATUS_ERROR;
     }
     if (pPause && pPause->NeedToPauseNow()) {
       m_loopIndex++;
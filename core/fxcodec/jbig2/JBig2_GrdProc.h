@@ -52,61 +52,37 @@ class CJBig2_GRDProc {
                                              CJBig2_ArithDecoder* pArithDecoder,
                                              JBig2ArithCtx* gbContext,
                                              IFX_Pause* pPause);
-  FXCODEC_STATUS decode_Arith_Template0_unopt(
-      CJBig2_Image* pImage,
-      CJBig2_ArithDecoder* pArithDecoder,
-      JBig2ArithCtx* gbContext,
-      IFX_Pause* pPause);
   FXCODEC_STATUS decode_Arith_Template1_opt3(CJBig2_Image* pImage,
                                              CJBig2_ArithDecoder* pArithDecoder,
                                              JBig2ArithCtx* gbContext,
                                              IFX_Pause* pPause);
-  FXCODEC_STATUS decode_Arith_Template1_unopt(
-      CJBig2_Image* pImage,
-      CJBig2_ArithDecoder* pArithDecoder,
-      JBig2ArithCtx* gbContext,
-      IFX_Pause* pPause);
   FXCODEC_STATUS decode_Arith_Template2_opt3(CJBig2_Image* pImage,
                                              CJBig2_ArithDecoder* pArithDecoder,
                                              JBig2ArithCtx* gbContext,
                                              IFX_Pause* pPause);
-  FXCODEC_STATUS decode_Arith_Template2_unopt(
-      CJBig2_Image* pImage,
-      CJBig2_ArithDecoder* pArithDecoder,
-      JBig2ArithCtx* gbContext,
-      IFX_Pause* pPause);
   FXCODEC_STATUS decode_Arith_Template3_opt3(CJBig2_Image* pImage,
                                              CJBig2_ArithDecoder* pArithDecoder,
                                              JBig2ArithCtx* gbContext,
                                              IFX_Pause* pPause);
-  FXCODEC_STATUS decode_Arith_Template3_unopt(
-      CJBig2_Image* pImage,
-      CJBig2_ArithDecoder* pArithDecoder,
-      JBig2ArithCtx* gbContext,
-      IFX_Pause* pPause);
+  // Handles any template and AT pixels the _opt3 versions do not.
+  FXCODEC_STATUS decode_Arith_Generic(CJBig2_Image* pImage,
+                                      CJBig2_ArithDecoder* pArithDecoder,
+                                      JBig2ArithCtx* gbContext,
+                                      IFX_Pause* pPause);
   CJBig2_Image* decode_Arith_Template0_opt3(CJBig2_ArithDecoder* pArithDecoder,
                                             JBig2ArithCtx* gbContext);
 
-  CJBig2_Image* decode_Arith_Template0_unopt(CJBig2_ArithDecoder* pArithDecoder,
-                                             JBig2ArithCtx* gbContext);
-
   CJBig2_Image* decode_Arith_Template1_opt3(CJBig2_ArithDecoder* pArithDecoder,
                                             JBig2ArithCtx* gbContext);
 
-  CJBig2_Image* decode_Arith_Template1_unopt(CJBig2_ArithDecoder* pArithDecoder,
-                                             JBig2ArithCtx* gbContext);
-
   CJBig2_Image* decode_Arith_Template2_opt3(CJBig2_ArithDecoder* pArithDecoder,
                                             JBig2ArithCtx* gbContext);
 
-  CJBig2_Image* decode_Arith_Template2_unopt(CJBig2_ArithDecoder* pArithDecoder,
-                                             JBig2ArithCtx* gbContext);
-
   CJBig2_Image* decode_Arith_Template3_opt3(CJBig2_ArithDecoder* pArithDecoder,
                                             JBig2ArithCtx* gbContext);
 
-  CJBig2_Image* decode_Arith_Template3_unopt(CJBig2_ArithDecoder* pArithDecoder,
-                                             JBig2ArithCtx* gbContext);
+  CJBig2_Image* decode_Arith_Generic(CJBig2_ArithDecoder* pArithDecoder,
+                                     JBig2ArithCtx* gbContext);
 
   uint32_t m_loopIndex;
   uint8_t* m_pLine;
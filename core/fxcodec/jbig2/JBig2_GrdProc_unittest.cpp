@@ -0,0 +1,313 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcodec/jbig2/JBig2_GrdProc.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "core/fpdfapi/parser/cpdf_stream.h"
+#include "core/fpdfapi/parser/cpdf_stream_acc.h"
+#include "core/fxcodec/jbig2/JBig2_ArithDecoder.h"
+#include "core/fxcodec/jbig2/JBig2_BitStream.h"
+#include "core/fxcodec/jbig2/JBig2_Image.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/jbig2_testhelpers.h"
+#include "third_party/base/ptr_util.h"
+
+namespace {
+
+const size_t kContextSize = 65536;
+const uint32_t kTpgdContexts[] = {0x9b25, 0x0795, 0x00e5, 0x0195};
+
+const int8_t kStandardAT[4][8] = {{3, -1, -3, -1, 2, -2, -2, -2},
+                                  {3, -1},
+                                  {2, -1},
+                                  {2, -1}};
+
+// Includes AT pixels that read pixels not decoded yet, and ones far enough
+// away to be outside the image.
+const int8_t kCustomAT[][8] = {{-1, 0, 0, -3, 4, -2, -5, -1},
+                               {-2, -1, 5, -1, -4, -4, 1, -3},
+                               {-32, 0, -33, 0, -8, 0, -9, 0},
+                               {-128, 0, 127, -128, 0, 0, 2, 1},
+                               {7, -2, -7, -1, 0, -1, 1, 0}};
+
+std::unique_ptr<CPDF_Stream> MakeStream(uint32_t seed, uint32_t size) {
+  std::unique_ptr<uint8_t, FxFreeDeleter> data(FX_Alloc(uint8_t, size));
+  for (uint32_t i = 0; i < size; ++i) {
+    seed = seed * 1103515245 + 12345;
+    data.get()[i] = static_cast<uint8_t>(seed >> 16);
+  }
+  return pdfium::MakeUnique<CPDF_Stream>(std::move(data), size, nullptr);
+}
+
+std::unique_ptr<CPDF_Stream> MakeStream(const std::vector<uint8_t>& bytes) {
+  std::unique_ptr<uint8_t, FxFreeDeleter> data(
+      FX_Alloc(uint8_t, bytes.size()));
+  memcpy(data.get(), bytes.data(), bytes.size());
+  return pdfium::MakeUnique<CPDF_Stream>(std::move(data), bytes.size(),
+                                         nullptr);
+}
+
+// Builds the context for each pixel straight from the template in the spec.
+uint32_t ReferenceContext(CJBig2_Image* image,
+                          uint8_t gbtemplate,
+                          const int8_t* gbat,
+                          int32_t x,
+                          int32_t y) {
+  auto pixel = [image, x, y](int32_t dx, int32_t dy) {
+    return static_cast<uint32_t>(image->getPixel(x + dx, y + dy));
+  };
+  uint32_t context = 0;
+  switch (gbtemplate) {
+    case 0:
+      for (int32_t i = 0; i < 4; ++i)
+        context |= pixel(-1 - i, 0) << i;
+      context |= pixel(gbat[0], gbat[1]) << 4;
+      for (int32_t i = 0; i < 5; ++i)
+        context |= pixel(2 - i, -1) << (5 + i);
+      context |= pixel(gbat[2], gbat[3]) << 10;
+      context |= pixel(gbat[4], gbat[5]) << 11;
+      for (int32_t i = 0; i < 3; ++i)
+        context |= pixel(1 - i, -2) << (12 + i);
+      context |= pixel(gbat[6], gbat[7]) << 15;
+      break;
+    case 1:
+      for (int32_t i = 0; i < 3; ++i)
+        context |= pixel(-1 - i, 0) << i;
+      context |= pixel(gbat[0], gbat[1]) << 3;
+      for (int32_t i = 0; i < 5; ++i)
+        context |= pixel(2 - i, -1) << (4 + i);
+      for (int32_t i = 0; i < 4; ++i)
+        context |= pixel(2 - i, -2) << (9 + i);
+      break;
+    case 2:
+      for (int32_t i = 0; i < 2; ++i)
+        context |= pixel(-1 - i, 0) << i;
+      context |= pixel(gbat[0], gbat[1]) << 2;
+      for (int32_t i = 0; i < 4; ++i)
+        context |= pixel(1 - i, -1) << (3 + i);
+      for (int32_t i = 0; i < 3; ++i)
+        context |= pixel(1 - i, -2) << (7 + i);
+      break;
+    default:
+      for (int32_t i = 0; i < 4; ++i)
+        context |= pixel(-1 - i, 0) << i;
+      context |= pixel(gbat[0], gbat[1]) << 4;
+      for (int32_t i = 0; i < 5; ++i)
+        context |= pixel(1 - i, -1) << (5 + i);
+      break;
+  }
+  return context;
+}
+
+// Encodes |image| as a generic region with the parameters in |grd|.
+std::vector<uint8_t> EncodeRegion(CJBig2_GRDProc* grd, CJBig2_Image* image) {
+  JBig2ArithEncoder encoder(kContextSize);
+  int ltp = 0;
+  for (int32_t y = 0; y < image->height(); ++y) {
+    if (grd->TPGDON) {
+      int same = y > 0 && memcmp(image->m_pData + y * image->stride(),
+                                 image->m_pData + (y - 1) * image->stride(),
+                                 image->stride()) == 0;
+      encoder.Encode(kTpgdContexts[grd->GBTEMPLATE], same ^ ltp);
+      ltp = same;
+      if (ltp)
+        continue;
+    }
+    for (int32_t x = 0; x < image->width(); ++x) {
+      encoder.Encode(ReferenceContext(image, grd->GBTEMPLATE, grd->GBAT, x, y),
+                     image->getPixel(x, y));
+    }
+  }
+  return encoder.Finish();
+}
+
+// Decodes a generic region one pixel at a time.
+std::unique_ptr<CJBig2_Image> ReferenceDecode(CJBig2_GRDProc* grd,
+                                              CJBig2_ArithDecoder* decoder) {
+  std::vector<JBig2ArithCtx> contexts(kContextSize);
+  auto image = pdfium::MakeUnique<CJBig2_Image>(grd->GBW, grd->GBH);
+  image->fill(false);
+  int ltp = 0;
+  for (int32_t y = 0; y < static_cast<int32_t>(grd->GBH); ++y) {
+    if (grd->TPGDON) {
+      if (decoder->IsComplete())
+        return nullptr;
+      ltp ^= decoder->DECODE(&contexts[kTpgdContexts[grd->GBTEMPLATE]]);
+    }
+    if (ltp) {
+      image->copyLine(y, y - 1);
+      continue;
+    }
+    for (int32_t x = 0; x < static_cast<int32_t>(grd->GBW); ++x) {
+      if (grd->USESKIP && grd->SKIP->getPixel(x, y))
+        continue;
+      uint32_t context =
+          ReferenceContext(image.get(), grd->GBTEMPLATE, grd->GBAT, x, y);
+      if (decoder->IsComplete())
+        return nullptr;
+      image->setPixel(x, y, decoder->DECODE(&contexts[context]));
+    }
+  }
+  return image;
+}
+
+void ExpectSameImage(CJBig2_Image* expected, CJBig2_Image* actual) {
+  ASSERT_TRUE(expected);
+  ASSERT_TRUE(actual);
+  ASSERT_EQ(expected->width(), actual->width());
+  ASSERT_EQ(expected->height(), actual->height());
+  EXPECT_EQ(0, memcmp(expected->m_pData, actual->m_pData,
+                      expected->stride() * expected->height()));
+}
+
+// Checks both ways of decoding a region against the reference.
+void CheckDecode(CJBig2_GRDProc* grd, uint32_t seed) {
+  std::unique_ptr<CPDF_Stream> stream_data = MakeStream(seed, 4096);
+  auto acc = pdfium::MakeRetain<CPDF_StreamAcc>(stream_data.get());
+  acc->LoadAllData();
+
+  CJBig2_BitStream reference_stream(acc);
+  CJBig2_ArithDecoder reference_decoder(&reference_stream);
+  std::unique_ptr<CJBig2_Image> expected =
+      ReferenceDecode(grd, &reference_decoder);
+
+  CJBig2_BitStream stream(acc);
+  CJBig2_ArithDecoder decoder(&stream);
+  std::vector<JBig2ArithCtx> contexts(kContextSize);
+  std::unique_ptr<CJBig2_Image> actual(
+      grd->decode_Arith(&decoder, contexts.data()));
+  ExpectSameImage(expected.get(), actual.get());
+
+  CJBig2_BitStream progressive_stream(acc);
+  CJBig2_ArithDecoder progressive_decoder(&progressive_stream);
+  std::vector<JBig2ArithCtx> progressive_contexts(kContextSize);
+  CJBig2_Image* image = nullptr;
+  EXPECT_EQ(FXCODEC_STATUS_DECODE_FINISH,
+            grd->Start_decode_Arith(&image, &progressive_decoder,
+                                    progressive_contexts.data(), nullptr));
+  std::unique_ptr<CJBig2_Image> progressive(image);
+  ExpectSameImage(expected.get(), progressive.get());
+}
+
+}  // namespace
+
+TEST(CJBig2_GRDProc, DecodeArith) {
+  const uint32_t kWidths[] = {1, 8, 9, 75};
+  auto skip = pdfium::MakeUnique<CJBig2_Image>(75, 12);
+  for (int32_t y = 0; y < skip->height(); ++y) {
+    for (int32_t x = 0; x < skip->width(); ++x)
+      skip->setPixel(x, y, (x * 7 + y * 3) % 5 == 0);
+  }
+
+  uint32_t seed = 0;
+  for (uint8_t gbtemplate = 0; gbtemplate < 4; ++gbtemplate) {
+    std::vector<const int8_t*> ats = {kStandardAT[gbtemplate]};
+    for (const auto& at : kCustomAT)
+      ats.push_back(at);
+    for (const int8_t* at : ats) {
+      for (uint32_t width : kWidths) {
+        for (int options = 0; options < 4; ++options) {
+          CJBig2_GRDProc grd;
+          grd.MMR = false;
+          grd.GBW = width;
+          grd.GBH = 12;
+          grd.GBTEMPLATE = gbtemplate;
+          grd.TPGDON = options & 1;
+          // The optimized decoders for the standard AT pixels do not skip.
+          grd.USESKIP = (options & 2) && at != kStandardAT[gbtemplate];
+          grd.SKIP = skip.get();
+          memcpy(grd.GBAT, at, sizeof(grd.GBAT));
+          SCOPED_TRACE(testing::Message()
+                       << "template " << static_cast<int>(gbtemplate)
+                       << " AT " << static_cast<int>(at[0]) << ","
+                       << static_cast<int>(at[1]) << " width " << width
+                       << " options " << options);
+          CheckDecode(&grd, ++seed);
+        }
+      }
+    }
+  }
+}
+
+TEST(CJBig2_GRDProc, DecodeArithEncodedPage) {
+  auto page = pdfium::MakeUnique<CJBig2_Image>(300, 200);
+  DrawJBig2TextPage(page.get(), 1);
+  for (uint8_t gbtemplate = 0; gbtemplate < 4; ++gbtemplate) {
+    for (const int8_t* at : {kStandardAT[gbtemplate], kCustomAT[1]}) {
+      for (bool tpgdon : {false, true}) {
+        CJBig2_GRDProc grd;
+        grd.MMR = false;
+        grd.GBW = page->width();
+        grd.GBH = page->height();
+        grd.GBTEMPLATE = gbtemplate;
+        grd.TPGDON = tpgdon;
+        grd.USESKIP = false;
+        memcpy(grd.GBAT, at, sizeof(grd.GBAT));
+        SCOPED_TRACE(testing::Message()
+                     << "template " << static_cast<int>(gbtemplate) << " AT "
+                     << static_cast<int>(at[0]) << " TPGDON " << tpgdon);
+        std::unique_ptr<CPDF_Stream> stream_data =
+            MakeStream(EncodeRegion(&grd, page.get()));
+        auto acc = pdfium::MakeRetain<CPDF_StreamAcc>(stream_data.get());
+        acc->LoadAllData();
+        CJBig2_BitStream stream(acc);
+        CJBig2_ArithDecoder decoder(&stream);
+        std::vector<JBig2ArithCtx> contexts(kContextSize);
+        std::unique_ptr<CJBig2_Image> actual(
+            grd.decode_Arith(&decoder, contexts.data()));
+        ExpectSameImage(page.get(), actual.get());
+      }
+    }
+  }
+}
+
+// Times decoding a text page of A4 at 300 dpi with the standard AT pixels and
+// with custom ones. Run with --gtest_also_run_disabled_tests.
+TEST(CJBig2_GRDProc, DISABLED_DecodeArithSpeed) {
+  const int8_t kPageCustomAT[8] = {2, -1, -4, -1, 3, -2, -2, -3};
+  const int kRuns = 20;
+  auto page = pdfium::MakeUnique<CJBig2_Image>(2480, 3508);
+  DrawJBig2TextPage(page.get(), 7);
+  for (const int8_t* at : {kStandardAT[0], kPageCustomAT}) {
+    CJBig2_GRDProc grd;
+    grd.MMR = false;
+    grd.GBW = page->width();
+    grd.GBH = page->height();
+    grd.GBTEMPLATE = 0;
+    grd.TPGDON = false;
+    grd.USESKIP = false;
+    memcpy(grd.GBAT, at, sizeof(grd.GBAT));
+    std::unique_ptr<CPDF_Stream> stream_data =
+        MakeStream(EncodeRegion(&grd, page.get()));
+    auto acc = pdfium::MakeRetain<CPDF_StreamAcc>(stream_data.get());
+    acc->LoadAllData();
+
+    std::chrono::duration<double, std::milli> best =
+        std::chrono::duration<double>::max();
+    for (int run = 0; run < kRuns; ++run) {
+      CJBig2_BitStream stream(acc);
+      CJBig2_ArithDecoder decoder(&stream);
+      std::vector<JBig2ArithCtx> contexts(kContextSize);
+      auto start = std::chrono::steady_clock::now();
+      std::unique_ptr<CJBig2_Image> actual(
+          grd.decode_Arith(&decoder, contexts.data()));
+      best = std::min<std::chrono::duration<double, std::milli>>(
+          best, std::chrono::steady_clock::now() - start);
+      ExpectSameImage(page.get(), actual.get());
+    }
+    printf("%s AT: %u bytes, best of %d %.1f ms\n",
+           at == kStandardAT[0] ? "standard" : "custom",
+           acc->GetSize(), kRuns, best.count());
+  }
+}
@@ -24,3 +24,17 @@ std::unique_ptr<CJBig2_SymbolDict> CJBig2_SymbolDict::DeepCopy() const {
   dst->m_grContext = m_grContext;
   return dst;
 }
+
+size_t CJBig2_SymbolDict::GetMemorySize() const {
+  size_t size = sizeof(*this) +
+                (m_gbContext.size() + m_grContext.size()) *
+                    sizeof(JBig2ArithCtx) +
+                m_SDEXSYMS.size() * sizeof(m_SDEXSYMS[0]);
+  for (const auto& image : m_SDEXSYMS) {
+    if (image) {
+      size += sizeof(CJBig2_Image) +
+              static_cast<size_t>(image->stride()) * image->height();
+    }
+  }
+  return size;
+}
@@ -23,6 +23,9 @@ class CJBig2_SymbolDict {
 
   std::unique_ptr<CJBig2_SymbolDict> DeepCopy() const;
 
+  // Returns roughly how many bytes the dictionary and its symbols take up.
+  size_t GetMemorySize() const;
+
   // Takes ownership of |image|.
   void AddImage(std::unique_ptr<CJBig2_Image> image) {
     m_SDEXSYMS.push_back(std::move(image));
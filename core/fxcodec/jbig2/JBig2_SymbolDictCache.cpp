@@ -0,0 +1,97 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcodec/jbig2/JBig2_SymbolDictCache.h"
+
+#include "core/fxcodec/jbig2/JBig2_Image.h"
+#include "core/fxcodec/jbig2/JBig2_SymbolDict.h"
+
+CJBig2_SymbolDictCache::CJBig2_SymbolDictCache(size_t max_bytes)
+    : m_nMaxBytes(max_bytes), m_nBytes(0), m_nHits(0),
+      m_nMisses(0),
+      m_nEvictions(0) {}
+
+CJBig2_SymbolDictCache::~CJBig2_SymbolDictCache() {}
+
+std::unique_ptr<CJBig2_SymbolDict> CJBig2_SymbolDictCache::Find(
+    const CJBig2_CacheKey& key) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  auto it = m_Index.find(key);
+  if (it == m_Index.end()) {
+    ++m_nMisses;
+    return nullptr;
+  }
+  ++m_nHits;
+  m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+  return it->second->dict->DeepCopy();
+}
+
+void CJBig2_SymbolDictCache::Add(const CJBig2_CacheKey& key,
+                                 std::unique_ptr<CJBig2_SymbolDict> dict) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  auto it = m_Index.find(key);
+  if (it != m_Index.end()) {
+    m_nBytes -= it->second->bytes;
+    m_Entries.erase(it->second);
+    m_Index.erase(it);
+  }
+
+  const size_t bytes = dict->GetMemorySize();
+  if (bytes > m_nMaxBytes)
+    return;
+
+  EvictTo(m_nMaxBytes - bytes);
+  m_Entries.push_front({key, std::move(dict), bytes});
+  m_Index[key] = m_Entries.begin();
+  m_nBytes += bytes;
+}
+
+void CJBig2_SymbolDictCache::SetMaxBytes(size_t max_bytes) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_nMaxBytes = max_bytes;
+  EvictTo(m_nMaxBytes);
+}
+
+size_t CJBig2_SymbolDictCache::size() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Entries.size();
+}
+
+size_t CJBig2_SymbolDictCache::size_in_bytes() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_nBytes;
+}
+
+size_t CJBig2_SymbolDictCache::max_bytes() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_nMaxBytes;
+}
+
+uint32_t CJBig2_SymbolDictCache::hits() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_nHits;
+}
+
+uint32_t CJBig2_SymbolDictCache::misses() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_nMisses;
+}
+
+uint32_t CJBig2_SymbolDictCache::evictions() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_nEvictions;
+}
+
+void CJBig2_SymbolDictCache::EvictTo(size_t max_bytes) {
+  while (!m_Entries.empty() && m_nBytes > max_bytes)
+    EvictOldest();
+}
+
+void CJBig2_SymbolDictCache::EvictOldest() {
+  const Entry& oldest = m_Entries.back();
+  m_nBytes -= oldest.bytes;
+  m_Index.erase(oldest.key);
+  m_Entries.pop_back();
+  ++m_nEvictions;
+}
@@ -0,0 +1,82 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FXCODEC_JBIG2_JBIG2_SYMBOLDICTCACHE_H_
+#define CORE_FXCODEC_JBIG2_JBIG2_SYMBOLDICTCACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+class CJBig2_SymbolDict;
+
+// Cache is keyed by the ObjNum of a stream and an index within the stream.
+using CJBig2_CacheKey = std::pair<uint32_t, uint32_t>;
+
+// A least recently used cache of decoded symbol dictionaries, bounded by the
+// memory their symbols take up. It is very common for a JBIG2 dictionary to
+// span many pages of a PDF file, and we do not want to decode the same
+// dictionary over and over again. It is safe to use from several threads.
+class CJBig2_SymbolDictCache {
+ public:
+  static const size_t kDefaultMaxBytes = 8 * 1024 * 1024;
+
+  explicit CJBig2_SymbolDictCache(size_t max_bytes = kDefaultMaxBytes);
+  ~CJBig2_SymbolDictCache();
+
+  // Returns a copy of the dictionary cached for |key| and makes it the most
+  // recently used, or returns nullptr. The copy is made under the cache lock,
+  // so another thread cannot evict the original meanwhile.
+  std::unique_ptr<CJBig2_SymbolDict> Find(const CJBig2_CacheKey& key);
+
+  // Caches |dict| under |key|, evicting the least recently used dictionaries
+  // to stay within budget. A dictionary bigger than the whole budget is not
+  // cached, and neither is anything when the budget is 0.
+  void Add(const CJBig2_CacheKey& key, std::unique_ptr<CJBig2_SymbolDict> dict);
+
+  // Changes the budget, evicting dictionaries down to it. 0 empties the cache
+  // and disables it.
+  void SetMaxBytes(size_t max_bytes);
+
+  size_t size() const;
+  size_t size_in_bytes() const;
+  size_t max_bytes() const;
+  uint32_t hits() const;
+  uint32_t misses() const;
+  uint32_t evictions() const;
+
+ private:
+  struct Entry {
+    CJBig2_CacheKey key;
+    std::unique_ptr<CJBig2_SymbolDict> dict;
+    size_t bytes;
+  };
+
+  struct KeyHash {
+    size_t operator()(const CJBig2_CacheKey& key) const {
+      return (static_cast<size_t>(key.first) * 31) ^ key.second;
+    }
+  };
+
+  void EvictTo(size_t max_bytes);
+  void EvictOldest();
+
+  mutable std::mutex m_Mutex;
+  size_t m_nMaxBytes;
+  size_t m_nBytes;
+  uint32_t m_nHits;
+  uint32_t m_nMisses;
+  uint32_t m_nEvictions;
+  // Most recently used first.
+  std::list<Entry> m_Entries;
+  std::unordered_map<CJBig2_CacheKey, std::list<Entry>::iterator, KeyHash>
+      m_Index;
+};
+
+#endif  // CORE_FXCODEC_JBIG2_JBIG2_SYMBOLDICTCACHE_H_
@@ -0,0 +1,136 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "core/fxcodec/jbig2/JBig2_Image.h"
+#include "core/fxcodec/jbig2/JBig2_SymbolDict.h"
+#include "core/fxcodec/jbig2/JBig2_SymbolDictCache.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/base/ptr_util.h"
+
+namespace {
+
+std::unique_ptr<CJBig2_SymbolDict> MakeDict(int32_t height) {
+  auto dict = pdfium::MakeUnique<CJBig2_SymbolDict>();
+  dict->AddImage(pdfium::MakeUnique<CJBig2_Image>(64, height));
+  return dict;
+}
+
+}  // namespace
+
+TEST(CJBig2_SymbolDictCache, FindAndAdd) {
+  CJBig2_SymbolDictCache cache;
+  const CJBig2_CacheKey key(1, 0);
+  EXPECT_FALSE(cache.Find(key));
+
+  std::unique_ptr<CJBig2_SymbolDict> dict = MakeDict(10);
+  const size_t bytes = dict->GetMemorySize();
+  CJBig2_SymbolDict* raw = dict.get();
+  cache.Add(key, std::move(dict));
+  // Lookups return copies, which other threads cannot evict.
+  std::unique_ptr<CJBig2_SymbolDict> found = cache.Find(key);
+  ASSERT_TRUE(found);
+  EXPECT_NE(raw, found.get());
+  ASSERT_EQ(1u, found->NumImages());
+  EXPECT_NE(raw->GetImage(0), found->GetImage(0));
+  EXPECT_EQ(10, found->GetImage(0)->height());
+  EXPECT_EQ(bytes, found->GetMemorySize());
+  EXPECT_FALSE(cache.Find(CJBig2_CacheKey(1, 1)));
+  EXPECT_EQ(1u, cache.size());
+  EXPECT_EQ(bytes, cache.size_in_bytes());
+  EXPECT_EQ(1u, cache.hits());
+  EXPECT_EQ(2u, cache.misses());
+
+  // Adding the same key again replaces the entry.
+  cache.Add(key, MakeDict(20));
+  EXPECT_EQ(1u, cache.size());
+  EXPECT_EQ(cache.Find(key)->GetMemorySize(), cache.size_in_bytes());
+}
+
+TEST(CJBig2_SymbolDictCache, EvictsLeastRecentlyUsed) {
+  const size_t bytes = MakeDict(100)->GetMemorySize();
+  CJBig2_SymbolDictCache cache(bytes * 3);
+  cache.Add(CJBig2_CacheKey(1, 0), MakeDict(100));
+  cache.Add(CJBig2_CacheKey(2, 0), MakeDict(100));
+  cache.Add(CJBig2_CacheKey(3, 0), MakeDict(100));
+  EXPECT_EQ(3u, cache.size());
+  EXPECT_EQ(0u, cache.evictions());
+
+  // Using the oldest entry keeps it alive over the next oldest one.
+  EXPECT_TRUE(cache.Find(CJBig2_CacheKey(1, 0)));
+  cache.Add(CJBig2_CacheKey(4, 0), MakeDict(100));
+  EXPECT_EQ(3u, cache.size());
+  EXPECT_EQ(1u, cache.evictions());
+  EXPECT_LE(cache.size_in_bytes(), cache.max_bytes());
+  EXPECT_TRUE(cache.Find(CJBig2_CacheKey(1, 0)));
+  EXPECT_FALSE(cache.Find(CJBig2_CacheKey(2, 0)));
+  EXPECT_TRUE(cache.Find(CJBig2_CacheKey(3, 0)));
+  EXPECT_TRUE(cache.Find(CJBig2_CacheKey(4, 0)));
+
+  // A large dictionary pushes out as many entries as it needs to.
+  cache.Add(CJBig2_CacheKey(5, 0), MakeDict(250));
+  EXPECT_EQ(1u, cache.size());
+  EXPECT_EQ(4u, cache.evictions());
+  EXPECT_LE(cache.size_in_bytes(), cache.max_bytes());
+  EXPECT_TRUE(cache.Find(CJBig2_CacheKey(5, 0)));
+}
+
+TEST(CJBig2_SymbolDictCache, SkipsOversizedDicts) {
+  const size_t bytes = MakeDict(100)->GetMemorySize();
+  CJBig2_SymbolDictCache cache(bytes);
+  cache.Add(CJBig2_CacheKey(1, 0), MakeDict(100));
+  EXPECT_EQ(bytes, cache.size_in_bytes());
+
+  // A dictionary over the budget leaves the cache as it was.
+  cache.Add(CJBig2_CacheKey(2, 0), MakeDict(101));
+  EXPECT_EQ(1u, cache.size());
+  EXPECT_EQ(0u, cache.evictions());
+  EXPECT_TRUE(cache.Find(CJBig2_CacheKey(1, 0)));
+  EXPECT_FALSE(cache.Find(CJBig2_CacheKey(2, 0)));
+
+  // One that fits takes the place of the older entry.
+  cache.Add(CJBig2_CacheKey(3, 0), MakeDict(50));
+  EXPECT_EQ(1u, cache.size());
+  EXPECT_EQ(1u, cache.evictions());
+  EXPECT_TRUE(cache.Find(CJBig2_CacheKey(3, 0)));
+}
+
+TEST(CJBig2_SymbolDictCache, SetMaxBytes) {
+  const size_t bytes = MakeDict(100)->GetMemorySize();
+  CJBig2_SymbolDictCache cache(bytes * 3);
+  cache.Add(CJBig2_CacheKey(1, 0), MakeDict(100));
+  cache.Add(CJBig2_CacheKey(2, 0), MakeDict(100));
+  cache.Add(CJBig2_CacheKey(3, 0), MakeDict(100));
+  EXPECT_TRUE(cache.Find(CJBig2_CacheKey(1, 0)));
+
+  cache.SetMaxBytes(bytes * 2);
+  EXPECT_EQ(bytes * 2, cache.max_bytes());
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_EQ(1u, cache.evictions());
+  EXPECT_TRUE(cache.Find(CJBig2_CacheKey(1, 0)));
+  EXPECT_FALSE(cache.Find(CJBig2_CacheKey(2, 0)));
+
+  // Below the size of a single dictionary, nothing stays.
+  cache.SetMaxBytes(bytes - 1);
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_EQ(0u, cache.size_in_bytes());
+  EXPECT_EQ(3u, cache.evictions());
+}
+
+TEST(CJBig2_SymbolDictCache, ZeroDisables) {
+  CJBig2_SymbolDictCache cache(0);
+  cache.Add(CJBig2_CacheKey(1, 0), MakeDict(1));
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_FALSE(cache.Find(CJBig2_CacheKey(1, 0)));
+
+  cache.SetMaxBytes(CJBig2_SymbolDictCache::kDefaultMaxBytes);
+  cache.Add(CJBig2_CacheKey(1, 0), MakeDict(1));
+  EXPECT_EQ(1u, cache.size());
+  cache.SetMaxBytes(0);
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_EQ(1u, cache.evictions());
+}
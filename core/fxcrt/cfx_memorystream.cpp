@@ -148,6 +148,10 @@ bool CFX_MemoryStream::WriteBlock(const void* buffer,
   return true;
 }
 
+const uint8_t* CFX_MemoryStream::GetDirectBuffer() {
+  return IsConsecutive() ? GetBuffer() : nullptr;
+}
+
 void CFX_MemoryStream::EstimateSize(size_t nInitSize, size_t nGrowSize) {
   if (m_dwFlags & Type::kConsecutive) {
     if (m_Blocks.empty()) {
@@ -27,6 +27,7 @@ class CFX_MemoryStream : public IFX_SeekableStream {
   size_t ReadBlock(void* buffer, size_t size) override;
   bool WriteBlock(const void* buffer, FX_FILESIZE offset, size_t size) override;
   bool Flush() override;
+  const uint8_t* GetDirectBuffer() override;
 
   bool IsConsecutive() const { return !!(m_dwFlags & Type::kConsecutive); }
 
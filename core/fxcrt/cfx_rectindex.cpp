@@ -0,0 +1,160 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcrt/cfx_rectindex.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Average number of rectangles to aim for in each cell.
+const double kRectsPerCell = 4;
+
+const int kMaxCellsPerAxis = 1024;
+
+// Rectangles covering more cells than this are returned by every query
+// rather than being copied into each cell.
+const int kMaxCellsPerRect = 64;
+
+bool IsFiniteRect(const CFX_FloatRect& rect) {
+  return std::isfinite(rect.left) && std::isfinite(rect.right) &&
+         std::isfinite(rect.bottom) && std::isfinite(rect.top);
+}
+
+int CellCount(int lo, int hi) {
+  return hi - lo + 1;
+}
+
+}  // namespace
+
+CFX_RectIndex::CFX_RectIndex(const std::vector<CFX_FloatRect>& rects)
+    : m_nRects(rects.size()),
+      m_Left(0),
+      m_Bottom(0),
+      m_ScaleX(1),
+      m_ScaleY(1),
+      m_nCols(1),
+      m_nRows(1) {
+  std::vector<CFX_FloatRect> normalized(rects);
+  size_t nFinite = 0;
+  CFX_FloatRect bounds;
+  for (CFX_FloatRect& rect : normalized) {
+    rect.Normalize();
+    if (!IsFiniteRect(rect))
+      continue;
+    if (nFinite++ == 0)
+      bounds = rect;
+    else
+      bounds.Union(rect);
+  }
+
+  if (nFinite) {
+    double width = static_cast<double>(bounds.right) - bounds.left;
+    double height = static_cast<double>(bounds.top) - bounds.bottom;
+    if (width <= 0 && height <= 0) {
+      width = 1;
+      height = 1;
+    }
+    double cells = std::max(1.0, nFinite / kRectsPerCell);
+    double cols = height > 0 ? sqrt(cells * width / height) : cells;
+    cols = std::min<double>(std::max(1.0, ceil(cols)), kMaxCellsPerAxis);
+    double rows = ceil(cells / cols);
+    m_nCols = static_cast<int>(cols);
+    m_nRows = static_cast<int>(std::min<double>(rows, kMaxCellsPerAxis));
+    m_Left = bounds.left;
+    m_Bottom = bounds.bottom;
+    m_ScaleX = width > 0 ? static_cast<float>(m_nCols / width) : 0;
+    m_ScaleY = height > 0 ? static_cast<float>(m_nRows / height) : 0;
+  }
+
+  m_CellStart.assign(m_nCols * m_nRows + 1, 0);
+  std::vector<CellRange> ranges(normalized.size());
+  for (size_t i = 0; i < normalized.size(); ++i) {
+    CellRange& range = ranges[i];
+    if (!IsFiniteRect(normalized[i])) {
+      range.x0 = -1;
+      continue;
+    }
+    range = GetCellRange(normalized[i]);
+    if (CellCount(range.x0, range.x1) * CellCount(range.y0, range.y1) >
+        kMaxCellsPerRect) {
+      range.x0 = -1;
+      continue;
+    }
+    for (int y = range.y0; y <= range.y1; ++y) {
+      for (int x = range.x0; x <= range.x1; ++x)
+        ++m_CellStart[y * m_nCols + x + 1];
+    }
+  }
+  for (size_t i = 1; i < m_CellStart.size(); ++i)
+    m_CellStart[i] += m_CellStart[i - 1];
+
+  m_CellObjects.resize(m_CellStart.back());
+  std::vector<uint32_t> fill(m_CellStart.begin(), m_CellStart.end() - 1);
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    const CellRange& range = ranges[i];
+    if (range.x0 < 0) {
+      m_Unbounded.push_back(static_cast<uint32_t>(i));
+      continue;
+    }
+    for (int y = range.y0; y <= range.y1; ++y) {
+      for (int x = range.x0; x <= range.x1; ++x)
+        m_CellObjects[fill[y * m_nCols + x]++] = static_cast<uint32_t>(i);
+    }
+  }
+}
+
+CFX_RectIndex::~CFX_RectIndex() {}
+
+bool CFX_RectIndex::GetCandidates(const CFX_FloatRect& rect,
+                                  std::vector<uint32_t>* indices) const {
+  indices->clear();
+  CFX_FloatRect query(rect);
+  query.Normalize();
+  if (!IsFiniteRect(query))
+    return false;
+
+  CellRange range = GetCellRange(query);
+  if (2 * CellCount(range.x0, range.x1) * CellCount(range.y0, range.y1) >
+      m_nCols * m_nRows) {
+    return false;
+  }
+
+  *indices = m_Unbounded;
+  const uint32_t* pCells = m_CellObjects.data();
+  for (int y = range.y0; y <= range.y1; ++y) {
+    int row = y * m_nCols;
+    indices->insert(indices->end(), pCells + m_CellStart[row + range.x0],
+                    pCells + m_CellStart[row + range.x1 + 1]);
+  }
+  std::sort(indices->begin(), indices->end());
+  indices->erase(std::unique(indices->begin(), indices->end()),
+                 indices->end());
+  return true;
+}
+
+int CFX_RectIndex::CellX(float x) const {
+  float cell = (x - m_Left) * m_ScaleX;
+  if (!(cell > 0))
+    return 0;
+  return cell < m_nCols ? static_cast<int>(cell) : m_nCols - 1;
+}
+
+int CFX_RectIndex::CellY(float y) const {
+  float cell = (y - m_Bottom) * m_ScaleY;
+  if (!(cell > 0))
+    return 0;
+  return cell < m_nRows ? static_cast<int>(cell) : m_nRows - 1;
+}
+
+CFX_RectIndex::CellRange CFX_RectIndex::GetCellRange(
+    const CFX_FloatRect& rect) const {
+  CellRange range;
+  range.x0 = CellX(rect.left);
+  range.y0 = CellY(rect.bottom);
+  range.x1 = CellX(rect.right);
+  range.y1 = CellY(rect.top);
+  return range;
+}
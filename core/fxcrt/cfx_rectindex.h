@@ -0,0 +1,61 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FXCRT_CFX_RECTINDEX_H_
+#define CORE_FXCRT_CFX_RECTINDEX_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "core/fxcrt/fx_coordinates.h"
+
+// Uniform grid over a fixed set of rectangles, answering "which rectangles
+// may intersect this one" without visiting all of them. Rectangles that span
+// many cells, or have non-finite coordinates, are kept aside and returned by
+// every query.
+class CFX_RectIndex {
+ public:
+  // Below this many rectangles, a linear scan is as fast as a grid lookup.
+  static const size_t kMinRects = 256;
+
+  explicit CFX_RectIndex(const std::vector<CFX_FloatRect>& rects);
+  ~CFX_RectIndex();
+
+  size_t size() const { return m_nRects; }
+
+  // Replaces |indices| with the sorted positions of all rectangles that
+  // intersect |rect| (edges included), plus possibly some that do not.
+  // Returns false when |rect| covers most of the grid, in which case the
+  // caller should scan every rectangle instead.
+  bool GetCandidates(const CFX_FloatRect& rect,
+                     std::vector<uint32_t>* indices) const;
+
+ private:
+  struct CellRange {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+  };
+
+  int CellX(float x) const;
+  int CellY(float y) const;
+  CellRange GetCellRange(const CFX_FloatRect& rect) const;
+
+  size_t m_nRects;
+  float m_Left;
+  float m_Bottom;
+  float m_ScaleX;
+  float m_ScaleY;
+  int m_nCols;
+  int m_nRows;
+  // |m_CellObjects| holds the rectangles of cell i from m_CellStart[i] up to
+  // m_CellStart[i + 1], with cells numbered row by row.
+  std::vector<uint32_t> m_CellStart;
+  std::vector<uint32_t> m_CellObjects;
+  std::vector<uint32_t> m_Unbounded;
+};
+
+#endif  // CORE_FXCRT_CFX_RECTINDEX_H_
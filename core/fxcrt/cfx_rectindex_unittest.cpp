@@ -0,0 +1,99 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcrt/cfx_rectindex.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// Deterministic values in [0, 1).
+float NextRandom(uint32_t* state) {
+  *state = *state * 1103515245 + 12345;
+  return ((*state >> 8) & 0xffff) / 65536.0f;
+}
+
+bool Intersects(const CFX_FloatRect& a, const CFX_FloatRect& b) {
+  return a.left <= b.right && a.right >= b.left && a.bottom <= b.top &&
+         a.top >= b.bottom;
+}
+
+}  // namespace
+
+TEST(CFX_RectIndex, FindsAllIntersectingRects) {
+  uint32_t state = 1;
+  std::vector<CFX_FloatRect> rects;
+  for (int i = 0; i < 2000; ++i) {
+    float x = NextRandom(&state) * 600;
+    float y = NextRandom(&state) * 800;
+    float w = NextRandom(&state) * 20;
+    float h = NextRandom(&state) * 20;
+    rects.push_back(CFX_FloatRect(x, y, x + w, y + h));
+  }
+  // A page-sized background, a rect stored upside down and a broken one.
+  rects.push_back(CFX_FloatRect(0, 0, 612, 792));
+  rects.push_back(CFX_FloatRect(300, 420, 290, 400));
+  rects.push_back(CFX_FloatRect(
+      0, 0, std::numeric_limits<float>::quiet_NaN(), 10));
+
+  CFX_RectIndex index(rects);
+  EXPECT_EQ(rects.size(), index.size());
+
+  std::vector<uint32_t> candidates;
+  for (int i = 0; i < 200; ++i) {
+    float x = NextRandom(&state) * 700 - 50;
+    float y = NextRandom(&state) * 900 - 50;
+    float size = NextRandom(&state) * 60;
+    CFX_FloatRect query(x, y, x + size, y + size);
+    ASSERT_TRUE(index.GetCandidates(query, &candidates));
+    EXPECT_TRUE(std::is_sorted(candidates.begin(), candidates.end()));
+    EXPECT_EQ(candidates.end(),
+              std::adjacent_find(candidates.begin(), candidates.end()));
+    EXPECT_LT(candidates.size(), rects.size() / 4);
+    for (size_t j = 0; j < rects.size(); ++j) {
+      CFX_FloatRect rect = rects[j];
+      rect.Normalize();
+      if (!Intersects(rect, query))
+        continue;
+      EXPECT_TRUE(std::binary_search(candidates.begin(), candidates.end(), j))
+          << "rect " << j << " query " << i;
+    }
+    EXPECT_TRUE(std::binary_search(candidates.begin(), candidates.end(),
+                                   rects.size() - 1));
+  }
+
+  // Touching edges count as intersecting.
+  ASSERT_TRUE(
+      index.GetCandidates(CFX_FloatRect(290, 420, 290, 420), &candidates));
+  EXPECT_TRUE(std::binary_search(candidates.begin(), candidates.end(),
+                                 rects.size() - 2));
+}
+
+TEST(CFX_RectIndex, LargeQueries) {
+  std::vector<CFX_FloatRect> rects;
+  for (int y = 0; y < 40; ++y) {
+    for (int x = 0; x < 40; ++x)
+      rects.push_back(CFX_FloatRect(x * 10, y * 10, x * 10 + 5, y * 10 + 5));
+  }
+  CFX_RectIndex index(rects);
+
+  std::vector<uint32_t> candidates;
+  EXPECT_FALSE(index.GetCandidates(CFX_FloatRect(0, 0, 400, 400), &candidates));
+  EXPECT_FALSE(index.GetCandidates(
+      CFX_FloatRect(0, 0, std::numeric_limits<float>::infinity(), 1),
+      &candidates));
+
+  // Queries outside the indexed area are clamped to the edge cells.
+  ASSERT_TRUE(
+      index.GetCandidates(CFX_FloatRect(-100, -100, -90, -90), &candidates));
+  EXPECT_LT(candidates.size(), 10u);
+  ASSERT_TRUE(index.GetCandidates(CFX_FloatRect(1000, 1000, 1001, 1001),
+                                  &candidates));
+  ASSERT_FALSE(candidates.empty());
+  EXPECT_EQ(rects.size() - 1, candidates.back());
+}
@@ -5,6 +5,7 @@
 #ifndef CORE_FXCRT_CFX_RETAIN_PTR_H_
 #define CORE_FXCRT_CFX_RETAIN_PTR_H_
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <utility>
@@ -76,7 +77,9 @@ class CFX_RetainPtr {
   std::unique_ptr<T, ReleaseDeleter<T>> m_pObj;
 };
 
-// Trivial implementation - internal ref count with virtual destructor.
+// Trivial implementation - internal ref count with virtual destructor. The
+// count is atomic since some objects, like the predefined CMaps and the file
+// behind a document, are shared by documents used on different threads.
 class CFX_Retainable {
  public:
   bool HasOneRef() const { return m_nRefCount == 1; }
@@ -98,7 +101,7 @@ class CFX_Retainable {
       delete this;
   }
 
-  intptr_t m_nRefCount = 0;
+  std::atomic<intptr_t> m_nRefCount{0};
 };
 
 namespace pdfium {
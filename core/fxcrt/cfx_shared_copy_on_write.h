@@ -7,6 +7,8 @@
 #ifndef CORE_FXCRT_CFX_SHARED_COPY_ON_WRITE_H_
 #define CORE_FXCRT_CFX_SHARED_COPY_ON_WRITE_H_
 
+#include <atomic>
+
 #include "core/fxcrt/cfx_retain_ptr.h"
 #include "core/fxcrt/fx_system.h"
 
@@ -75,8 +77,9 @@ class CFX_SharedCopyOnWrite {
     // the entire address space contains nothing but pointers to this object.
     // Since the count increments with each new pointer, the largest value is
     // the number of pointers that can fit into the address space. The size of
-    // the address space itself is a good upper bound on it.
-    intptr_t m_RefCount;
+    // the address space itself is a good upper bound on it. It is atomic, as
+    // the states of objects that pages share are copied from several threads.
+    std::atomic<intptr_t> m_RefCount;
   };
 
   CFX_RetainPtr<CountedObj> m_pObject;
@@ -7,6 +7,8 @@
 #ifndef CORE_FXCRT_CFX_STRING_DATA_TEMPLATE_H_
 #define CORE_FXCRT_CFX_STRING_DATA_TEMPLATE_H_
 
+#include <atomic>
+
 #include "core/fxcrt/fx_memory.h"
 #include "core/fxcrt/fx_system.h"
 #include "third_party/base/numerics/safe_math.h"
@@ -87,8 +89,9 @@ class CFX_StringDataTemplate {
   // the entire address space contains nothing but pointers to this object.
   // Since the count increments with each new pointer, the largest value is
   // the number of pointers that can fit into the address space. The size of
-  // the address space itself is a good upper bound on it.
-  intptr_t m_nRefs;
+  // the address space itself is a good upper bound on it. It is atomic, as
+  // strings of objects that pages share are copied from several threads.
+  std::atomic<intptr_t> m_nRefs;
 
   // |FX_STRSIZE| is currently typedef'd as |int|.
   // TODO(palmer): It should be a |size_t|, or at least unsigned.
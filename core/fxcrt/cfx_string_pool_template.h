@@ -7,17 +7,27 @@
 #ifndef CORE_FXCRT_CFX_STRING_POOL_TEMPLATE_H_
 #define CORE_FXCRT_CFX_STRING_POOL_TEMPLATE_H_
 
+#include <mutex>
 #include <unordered_set>
 
 #include "core/fxcrt/fx_string.h"
 
+// A pool that the objects of a document share, so it is safe to use from
+// several threads.
 template <typename StringType>
 class CFX_StringPoolTemplate {
  public:
-  StringType Intern(const StringType& str) { return *m_Pool.insert(str).first; }
-  void Clear() { m_Pool.clear(); }
+  StringType Intern(const StringType& str) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return *m_Pool.insert(str).first;
+  }
+  void Clear() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Pool.clear();
+  }
 
  private:
+  std::mutex m_Mutex;
   std::unordered_set<StringType> m_Pool;
 };
 
@@ -0,0 +1,82 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcrt/cfx_threadpool.h"
+
+#include <algorithm>
+
+// static
+size_t CFX_ThreadPool::GetDefaultThreadCount() {
+  return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+CFX_ThreadPool::CFX_ThreadPool(size_t nThreads)
+    : m_pTask(nullptr),
+      m_Count(0),
+      m_NextIndex(0),
+      m_Generation(0),
+      m_nBusy(0),
+      m_bQuit(false) {
+  for (size_t i = 1; i < nThreads; ++i)
+    m_Threads.emplace_back(&CFX_ThreadPool::WorkerMain, this, i);
+}
+
+CFX_ThreadPool::~CFX_ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_bQuit = true;
+  }
+  m_WorkCondition.notify_all();
+  for (std::thread& thread : m_Threads)
+    thread.join();
+}
+
+void CFX_ThreadPool::Run(size_t count, const Task& task) {
+  std::lock_guard<std::mutex> run_lock(m_RunMutex);
+  if (m_Threads.empty() || count <= 1) {
+    for (size_t i = 0; i < count; ++i)
+      task(i, 0);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_pTask = &task;
+    m_Count = count;
+    m_NextIndex = 0;
+    m_nBusy = m_Threads.size();
+    m_Generation++;
+  }
+  m_WorkCondition.notify_all();
+  Work(0);
+
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_DoneCondition.wait(lock, [this] { return m_nBusy == 0; });
+  m_pTask = nullptr;
+}
+
+void CFX_ThreadPool::WorkerMain(size_t worker) {
+  uint32_t generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_WorkCondition.wait(lock, [this, generation] {
+        return m_bQuit || m_Generation != generation;
+      });
+      if (m_bQuit)
+        return;
+      generation = m_Generation;
+    }
+    Work(worker);
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (--m_nBusy == 0)
+      m_DoneCondition.notify_one();
+  }
+}
+
+void CFX_ThreadPool::Work(size_t worker) {
+  size_t index;
+  while ((index = m_NextIndex++) < m_Count)
+    (*m_pTask)(index, worker);
+}
@@ -0,0 +1,57 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FXCRT_CFX_THREADPOOL_H_
+#define CORE_FXCRT_CFX_THREADPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of threads that run the iterations of a loop in parallel.
+// Iterations are handed out one at a time to whichever thread is free, so
+// uneven iterations still keep every thread busy.
+class CFX_ThreadPool {
+ public:
+  // Calls |task(index, worker)| for one iteration |index|. |worker| is in
+  // [0, GetThreadCount()) and is never used by two threads at once, so it can
+  // pick per-thread state.
+  using Task = std::function<void(size_t index, size_t worker)>;
+
+  // Returns the number of threads the hardware runs at once, at least 1.
+  static size_t GetDefaultThreadCount();
+
+  // |nThreads| includes the thread calling Run(), so 1 runs everything on it.
+  explicit CFX_ThreadPool(size_t nThreads);
+  ~CFX_ThreadPool();
+
+  size_t GetThreadCount() const { return m_Threads.size() + 1; }
+
+  // Runs |task| for every index in [0, count) and returns once all are done.
+  // Must not be called from within a task of the same pool.
+  void Run(size_t count, const Task& task);
+
+ private:
+  void WorkerMain(size_t worker);
+  void Work(size_t worker);
+
+  std::vector<std::thread> m_Threads;
+  std::mutex m_RunMutex;
+  std::mutex m_Mutex;
+  std::condition_variable m_WorkCondition;
+  std::condition_variable m_DoneCondition;
+  const Task* m_pTask;
+  size_t m_Count;
+  std::atomic<size_t> m_NextIndex;
+  // Bumped for every Run(), to wake the workers.
+  uint32_t m_Generation;
+  // Workers not yet done with the current Run().
+  size_t m_nBusy;
+  bool m_bQuit;
+};
+
+#endif  // CORE_FXCRT_CFX_THREADPOOL_H_
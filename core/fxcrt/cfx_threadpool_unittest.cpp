@@ -0,0 +1,41 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcrt/cfx_threadpool.h"
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+TEST(CFX_ThreadPool, RunsEveryIndexOnce) {
+  CFX_ThreadPool pool(4);
+  EXPECT_EQ(4u, pool.GetThreadCount());
+
+  // Run twice, so the workers are reused.
+  for (int pass = 0; pass < 2; ++pass) {
+    std::vector<int> runs(1000);
+    std::vector<int> busy(pool.GetThreadCount());
+    pool.Run(runs.size(), [&runs, &busy](size_t index, size_t worker) {
+      // Each worker only ever runs one task at a time.
+      EXPECT_EQ(0, busy[worker]++);
+      runs[index]++;
+      busy[worker]--;
+    });
+    for (int count : runs)
+      EXPECT_EQ(1, count);
+  }
+}
+
+TEST(CFX_ThreadPool, SingleThread) {
+  CFX_ThreadPool pool(1);
+  EXPECT_EQ(1u, pool.GetThreadCount());
+
+  std::vector<size_t> order;
+  pool.Run(3, [&order](size_t index, size_t worker) {
+    EXPECT_EQ(0u, worker);
+    order.push_back(index);
+  });
+  EXPECT_EQ((std::vector<size_t>{0, 1, 2}), order);
+  pool.Run(0, [](size_t index, size_t worker) { ADD_FAILURE(); });
+}
@@ -7,6 +7,7 @@
 #ifndef CORE_FXCRT_CFX_WEAK_PTR_H_
 #define CORE_FXCRT_CFX_WEAK_PTR_H_
 
+#include <atomic>
 #include <cstddef>
 #include <memory>
 #include <utility>
@@ -76,7 +77,7 @@ class CFX_WeakPtr {
    private:
     ~Handle() {}
 
-    intptr_t m_nCount;
+    std::atomic<intptr_t> m_nCount;
     std::unique_ptr<T, D> m_pObj;
   };
 
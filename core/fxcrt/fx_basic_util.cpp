@@ -4,15 +4,23 @@
 
 // Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
 
+#include <stdio.h>
+#include <stdlib.h>
+
 #include <algorithm>
 #include <cctype>
 #include <limits>
 #include <memory>
+#include <vector>
 
 #include "core/fxcrt/fx_basic.h"
 #include "core/fxcrt/fx_extension.h"
 #include "third_party/base/ptr_util.h"
 
+#if _FXM_PLATFORM_ != _FXM_PLATFORM_WINDOWS_
+#include <unistd.h>
+#endif
+
 bool FX_atonum(const CFX_ByteStringC& strc, void* pData) {
   if (strc.Find('.') != -1) {
     float* pFloat = static_cast<float*>(pData);
@@ -210,6 +218,34 @@ wchar_t FX_GetFolderSeparator() {
 #endif
 }
 
+bool FX_CreateUniqueFile(const CFX_ByteString& dir, CFX_ByteString* path) {
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+  char buffer[MAX_PATH];
+  if (!GetTempFileNameA(dir.c_str(), "pdf", 0, buffer))
+    return false;
+  *path = buffer;
+#else
+  CFX_ByteString name_template = dir + "pdfXXXXXX";
+  std::vector<char> buffer(name_template.c_str(),
+                           name_template.c_str() + name_template.GetLength() +
+                               1);
+  int fd = mkstemp(buffer.data());
+  if (fd < 0)
+    return false;
+  close(fd);
+  *path = buffer.data();
+#endif
+  return true;
+}
+
+bool FX_ReplaceFile(const char* from, const char* to) {
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+  return !!MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING);
+#else
+  return rename(from, to) == 0;
+#endif
+}
+
 uint32_t GetBits32(const uint8_t* pData, int bitpos, int nbits) {
   ASSERT(0 < nbits && nbits <= 32);
   const uint8_t* dataPtr = &pData[bitpos / 8];
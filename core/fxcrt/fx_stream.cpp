@@ -46,6 +46,35 @@ class CFX_CRTFileStream final : public IFX_SeekableStream {
   std::unique_ptr<IFXCRT_FileAccess> m_pFile;
 };
 
+class CFX_MappedFileReadStream final : public IFX_SeekableReadStream {
+ public:
+  template <typename T, typename... Args>
+  friend CFX_RetainPtr<T> pdfium::MakeRetain(Args&&... args);
+
+  // IFX_SeekableReadStream:
+  FX_FILESIZE GetSize() override { return m_Size; }
+  bool ReadBlock(void* buffer, FX_FILESIZE offset, size_t size) override {
+    // Like CFX_CRTFileStream, succeed on a short read at the end of the file.
+    if (offset < 0 || offset >= m_Size || !size)
+      return false;
+    size = std::min(size, static_cast<size_t>(m_Size - offset));
+    memcpy(buffer, m_pData + offset, size);
+    return true;
+  }
+  const uint8_t* GetDirectBuffer() override { return m_pData; }
+
+ private:
+  CFX_MappedFileReadStream(std::unique_ptr<IFXCRT_FileAccess> pFA,
+                           const uint8_t* pData)
+      : m_pFile(std::move(pFA)), m_pData(pData), m_Size(m_pFile->GetSize()) {}
+  ~CFX_MappedFileReadStream() override {}
+
+  // Owns the mapping, which goes away when |m_pFile| closes.
+  std::unique_ptr<IFXCRT_FileAccess> m_pFile;
+  const uint8_t* const m_pData;
+  const FX_FILESIZE m_Size;
+};
+
 }  // namespace
 
 // static
@@ -71,7 +100,14 @@ CFX_RetainPtr<IFX_SeekableStream> IFX_SeekableStream::CreateFromFilename(
 // static
 CFX_RetainPtr<IFX_SeekableReadStream>
 IFX_SeekableReadStream::CreateFromFilename(const char* filename) {
-  return IFX_SeekableStream::CreateFromFilename(filename, FX_FILEMODE_ReadOnly);
+  std::unique_ptr<IFXCRT_FileAccess> pFA = IFXCRT_FileAccess::Create();
+  if (!pFA->Open(filename, FX_FILEMODE_ReadOnly))
+    return nullptr;
+
+  const uint8_t* pData = pFA->MapReadOnly();
+  if (pData)
+    return pdfium::MakeRetain<CFX_MappedFileReadStream>(std::move(pFA), pData);
+  return pdfium::MakeRetain<CFX_CRTFileStream>(std::move(pFA));
 }
 
 bool IFX_SeekableWriteStream::WriteBlock(const void* pData, size_t size) {
@@ -90,6 +126,10 @@ size_t IFX_SeekableReadStream::ReadBlock(void* buffer, size_t size) {
   return 0;
 }
 
+const uint8_t* IFX_SeekableReadStream::GetDirectBuffer() {
+  return nullptr;
+}
+
 bool IFX_SeekableStream::WriteBlock(const void* buffer, size_t size) {
   return WriteBlock(buffer, GetSize(), size);
 }
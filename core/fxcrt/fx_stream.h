@@ -35,6 +35,13 @@ bool FX_GetNextFile(FX_FileHandle* handle,
 void FX_CloseFolder(FX_FileHandle* handle);
 wchar_t FX_GetFolderSeparator();
 
+// Creates a new empty file in |dir|, which ends with a separator, under a
+// name that no other caller gets, and sets |*path| to its path.
+bool FX_CreateUniqueFile(const CFX_ByteString& dir, CFX_ByteString* path);
+
+// Renames |from| to |to|, replacing any file already at |to|.
+bool FX_ReplaceFile(const char* from, const char* to);
+
 #define FX_FILEMODE_Write 0
 #define FX_FILEMODE_ReadOnly 1
 #define FX_FILEMODE_Truncate 2
@@ -75,6 +82,13 @@ class IFX_SeekableReadStream : public IFX_ReadStream {
 
   virtual bool ReadBlock(void* buffer, FX_FILESIZE offset, size_t size) = 0;
   virtual FX_FILESIZE GetSize() = 0;
+
+  // Returns the whole stream contents if they are resident in memory, e.g.
+  // for a memory-mapped file, so readers can scan them without copying
+  // through ReadBlock(). The buffer holds GetSize() bytes and stays valid for
+  // the lifetime of the stream, or until the next write to a writable stream.
+  // Returns nullptr otherwise.
+  virtual const uint8_t* GetDirectBuffer();
 };
 
 class IFX_SeekableStream : public IFX_SeekableReadStream,
@@ -6,6 +6,9 @@
 
 #include "core/fxcrt/fxcrt_posix.h"
 
+#include <sys/mman.h>
+
+#include <limits>
 #include <memory>
 
 #include "core/fxcrt/fx_basic.h"
@@ -43,7 +46,8 @@ void FXCRT_Posix_GetFileMode(uint32_t dwModes,
     nMasks = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
   }
 }
-CFXCRT_FileAccess_Posix::CFXCRT_FileAccess_Posix() : m_nFD(-1) {}
+CFXCRT_FileAccess_Posix::CFXCRT_FileAccess_Posix()
+    : m_nFD(-1), m_pMapped(nullptr), m_MappedSize(0) {}
 CFXCRT_FileAccess_Posix::~CFXCRT_FileAccess_Posix() {
   Close();
 }
@@ -69,6 +73,11 @@ void CFXCRT_FileAccess_Posix::Close() {
   if (m_nFD < 0) {
     return;
   }
+  if (m_pMapped) {
+    munmap(m_pMapped, m_MappedSize);
+    m_pMapped = nullptr;
+    m_MappedSize = 0;
+  }
   close(m_nFD);
   m_nFD = -1;
 }
@@ -145,4 +154,27 @@ bool CFXCRT_FileAccess_Posix::Truncate(FX_FILESIZE szFile) {
   return !ftruncate(m_nFD, szFile);
 }
 
+const uint8_t* CFXCRT_FileAccess_Posix::MapReadOnly() {
+  if (m_nFD < 0)
+    return nullptr;
+
+  if (m_pMapped)
+    return static_cast<const uint8_t*>(m_pMapped);
+
+  FX_FILESIZE size = GetSize();
+  if (size <= 0 ||
+      static_cast<uint64_t>(size) > std::numeric_limits<size_t>::max()) {
+    return nullptr;
+  }
+
+  void* pMapped = mmap(nullptr, static_cast<size_t>(size), PROT_READ,
+                       MAP_PRIVATE, m_nFD, 0);
+  if (pMapped == MAP_FAILED)
+    return nullptr;
+
+  m_pMapped = pMapped;
+  m_MappedSize = static_cast<size_t>(size);
+  return static_cast<const uint8_t*>(m_pMapped);
+}
+
 #endif
@@ -32,9 +32,12 @@ class CFXCRT_FileAccess_Posix : public IFXCRT_FileAccess {
                   FX_FILESIZE pos) override;
   bool Flush() override;
   bool Truncate(FX_FILESIZE szFile) override;
+  const uint8_t* MapReadOnly() override;
 
  protected:
   int32_t m_nFD;
+  void* m_pMapped;
+  size_t m_MappedSize;
 };
 #endif
 
@@ -80,6 +80,11 @@ bool CFXCRT_FileAccess_Win64::Open(const CFX_WideStringC& fileName,
   return !!m_hFile;
 }
 
+const uint8_t* CFXCRT_FileAccess_Win64::MapReadOnly() {
+  // Not implemented, callers read through ReadPos() instead.
+  return nullptr;
+}
+
 void CFXCRT_FileAccess_Win64::Close() {
   if (!m_hFile)
     return;
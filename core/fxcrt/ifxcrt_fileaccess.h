@@ -32,6 +32,11 @@ class IFXCRT_FileAccess {
                           FX_FILESIZE pos) = 0;
   virtual bool Flush() = 0;
   virtual bool Truncate(FX_FILESIZE szFile) = 0;
+
+  // Maps the whole file into memory for reading. The mapping covers
+  // GetSize() bytes and stays valid until Close(). Returns nullptr if the
+  // platform or the file does not support mapping.
+  virtual const uint8_t* MapReadOnly() = 0;
 };
 
 #endif  // CORE_FXCRT_IFXCRT_FILEACCESS_H_
@@ -10,20 +10,22 @@
 #include <map>
 #include <memory>
 
+#include "core/fxge/cfx_glyphcache.h"
 #include "core/fxge/fx_font.h"
 #include "core/fxge/fx_freetype.h"
 
 class CFX_FaceCache {
  public:
-  explicit CFX_FaceCache(FXFT_Face face);
+  // Rendered glyphs are kept in |pGlyphCache|, which must outlive this.
+  CFX_FaceCache(FXFT_Face face, CFX_GlyphCache* pGlyphCache);
   ~CFX_FaceCache();
-  const CFX_GlyphBitmap* LoadGlyphBitmap(const CFX_Font* pFont,
-                                         uint32_t glyph_index,
-                                         bool bFontStyle,
-                                         const CFX_Matrix* pMatrix,
-                                         int dest_width,
-                                         int anti_alias,
-                                         int& text_flags);
+  CFX_RetainPtr<CFX_GlyphBitmap> LoadGlyphBitmap(const CFX_Font* pFont,
+                                                 uint32_t glyph_index,
+                                                 bool bFontStyle,
+                                                 const CFX_Matrix* pMatrix,
+                                                 int dest_width,
+                                                 int anti_alias,
+                                                 int& text_flags);
   const CFX_PathData* LoadGlyphPath(const CFX_Font* pFont,
                                     uint32_t glyph_index,
                                     int dest_width);
@@ -33,30 +35,29 @@ class CFX_FaceCache {
 #endif
 
  private:
-  std::unique_ptr<CFX_GlyphBitmap> RenderGlyph(const CFX_Font* pFont,
-                                               uint32_t glyph_index,
-                                               bool bFontStyle,
-                                               const CFX_Matrix* pMatrix,
-                                               int dest_width,
-                                               int anti_alias);
-  std::unique_ptr<CFX_GlyphBitmap> RenderGlyph_Nativetext(
+  CFX_RetainPtr<CFX_GlyphBitmap> RenderGlyph(const CFX_Font* pFont,
+                                             uint32_t glyph_index,
+                                             bool bFontStyle,
+                                             const CFX_Matrix* pMatrix,
+                                             int dest_width,
+                                             int anti_alias);
+  CFX_RetainPtr<CFX_GlyphBitmap> RenderGlyph_Nativetext(
       const CFX_Font* pFont,
       uint32_t glyph_index,
       const CFX_Matrix* pMatrix,
       int dest_width,
       int anti_alias);
-  CFX_GlyphBitmap* LookUpGlyphBitmap(const CFX_Font* pFont,
-                                     const CFX_Matrix* pMatrix,
-                                     const CFX_ByteString& FaceGlyphsKey,
-                                     uint32_t glyph_index,
-                                     bool bFontStyle,
-                                     int dest_width,
-                                     int anti_alias);
+  CFX_RetainPtr<CFX_GlyphBitmap> LookUpGlyphBitmap(
+      const CFX_Font* pFont,
+      const CFX_Matrix* pMatrix,
+      const CFX_GlyphCache::Key& key,
+      bool bFontStyle);
   void InitPlatform();
   void DestroyPlatform();
 
   FXFT_Face const m_Face;
-  std::map<CFX_ByteString, std::unique_ptr<CFX_SizeGlyphCache>> m_SizeMap;
+  CFX_GlyphCache* const m_pGlyphCache;
+  const uint32_t m_FaceId;
   std::map<uint32_t, std::unique_ptr<CFX_PathData>> m_PathMap;
 #if defined _SKIA_SUPPORT_ || _SKIA_SUPPORT_PATHS_
   CFX_TypeFace* m_pTypeface;
@@ -9,8 +9,10 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 
 #include "core/fxcrt/fx_system.h"
+#include "core/fxge/cfx_glyphcache.h"
 #include "core/fxge/fx_font.h"
 #include "core/fxge/fx_freetype.h"
 
@@ -25,6 +27,7 @@ class CFX_FontCache {
 #ifdef _SKIA_SUPPORT_
   CFX_TypeFace* GetDeviceCache(const CFX_Font* pFont);
 #endif
+  CFX_GlyphCache* GetGlyphCache() { return &m_GlyphCache; }
 
  private:
   struct CountedFaceCache {
@@ -35,6 +38,10 @@ class CFX_FontCache {
   };
 
   using CFX_FTCacheMap = std::map<FXFT_Face, std::unique_ptr<CountedFaceCache>>;
+  // Declared first, since the face caches keep their glyphs in it.
+  CFX_GlyphCache m_GlyphCache;
+  // Guards the maps, which fonts of different documents share.
+  std::mutex m_Mutex;
   CFX_FTCacheMap m_FTFaceMap;
   CFX_FTCacheMap m_ExtFaceMap;
 };
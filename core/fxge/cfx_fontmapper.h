@@ -39,7 +39,6 @@ class CFX_FontMapper {
                                    int weight,
                                    int italic_angle);
 #endif  // PDF_ENABLE_XFA
-  bool IsBuiltinFace(const FXFT_Face face) const;
   int GetFaceSize() const;
   CFX_ByteString GetFaceName(int index) const {
     return m_FaceArray[index].name;
@@ -49,9 +48,6 @@ class CFX_FontMapper {
   std::vector<std::pair<CFX_ByteString, CFX_ByteString>> m_LocalizedTTFonts;
 
  private:
-  static const size_t MM_FACE_COUNT = 2;
-  static const size_t FOXIT_FACE_COUNT = 14;
-
   CFX_ByteString GetPSNameFromTT(void* hFont);
   CFX_ByteString MatchInstalledFonts(const CFX_ByteString& norm_name);
   FXFT_Face UseInternalSubst(CFX_SubstFont* pSubstFont,
@@ -75,11 +71,9 @@ class CFX_FontMapper {
   };
 
   bool m_bListLoaded;
-  FXFT_Face m_MMFaces[MM_FACE_COUNT];
   CFX_ByteString m_LastFamily;
   std::vector<FaceData> m_FaceArray;
   std::unique_ptr<IFX_SystemFontInfo> m_pFontInfo;
-  FXFT_Face m_FoxitFaces[FOXIT_FACE_COUNT];
   CFX_FontMgr* const m_pFontMgr;
 };
 
@@ -9,6 +9,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 
 #include "core/fxge/fx_font.h"
 
@@ -17,6 +18,8 @@ class CFX_FontMapper;
 class CFX_SubstFont;
 class CTTFontDesc;
 
+// Owns the FreeType library and the font data shared by all documents. Safe to
+// use from several threads; faces it hands out are each used by one font only.
 class CFX_FontMgr {
  public:
   CFX_FontMgr();
@@ -24,20 +27,21 @@ class CFX_FontMgr {
 
   void InitFTLibrary();
 
+  // Returns a new face over the font data cached for the given font, or
+  // nullptr if there is no such data.
   FXFT_Face GetCachedFace(const CFX_ByteString& face_name,
                           int weight,
                           bool bItalic,
-                          uint8_t*& pFontData);
+                          int face_index);
+  // Caches |pData|, unless data for the font is cached already, and returns a
+  // new face over the cached data.
   FXFT_Face AddCachedFace(const CFX_ByteString& face_name,
                           int weight,
                           bool bItalic,
                           uint8_t* pData,
                           uint32_t size,
                           int face_index);
-  FXFT_Face GetCachedTTCFace(int ttc_size,
-                             uint32_t checksum,
-                             int font_offset,
-                             uint8_t*& pFontData);
+  FXFT_Face GetCachedTTCFace(int ttc_size, uint32_t checksum, int font_offset);
   FXFT_Face AddCachedTTCFace(int ttc_size,
                              uint32_t checksum,
                              uint8_t* pData,
@@ -45,6 +49,9 @@ class CFX_FontMgr {
                              int font_offset);
   FXFT_Face GetFileFace(const char* filename, int face_index);
   FXFT_Face GetFixedFace(const uint8_t* pData, uint32_t size, int face_index);
+  // Destroys |face|, which may come from any of the methods above or from
+  // LoadEmbedded() fonts, and drops the cached data it was created over once
+  // no face uses it anymore.
   void ReleaseFace(FXFT_Face face);
   void SetSystemFontInfo(std::unique_ptr<IFX_SystemFontInfo> pFontInfo);
   FXFT_Face FindSubstFont(const CFX_ByteString& face_name,
@@ -60,6 +67,11 @@ class CFX_FontMgr {
   bool FTLibrarySupportsHinting() const { return m_FTLibrarySupportsHinting; }
 
  private:
+  FXFT_Face NewCachedFace(CTTFontDesc* pFontDesc, int face_index);
+
+  // Guards everything below. FreeType requires creating and destroying faces
+  // of one library to be serialized.
+  std::recursive_mutex m_Mutex;
   std::unique_ptr<CFX_FontMapper> m_pBuiltinMapper;
   std::map<CFX_ByteString, std::unique_ptr<CTTFontDesc>> m_FaceMap;
   FXFT_Library m_FTLibrary;
@@ -0,0 +1,85 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#ifndef CORE_FXGE_CFX_GLYPHCACHE_H_
+#define CORE_FXGE_CFX_GLYPHCACHE_H_
+
+#include <atomic>
+#include <memory>
+
+#include "core/fxcrt/cfx_retain_ptr.h"
+#include "core/fxcrt/fx_system.h"
+
+class CFX_GlyphBitmap;
+
+// Rendered glyph bitmaps of all faces, evicted in least recently used order
+// once their total size exceeds a byte limit.
+//
+// The cache is split into shards by key hash, each with its own lock, hash
+// table and LRU list, so renderers on different threads rarely contend. Each
+// shard gets an equal part of the limit.
+class CFX_GlyphCache {
+ public:
+  // Everything that selects a rendered glyph. Unused fields must be zero.
+  struct Key {
+    static const uint8_t kSubstFont = 1 << 0;
+    static const uint8_t kVertical = 1 << 1;
+    static const uint8_t kNativeText = 1 << 2;
+
+    bool operator==(const Key& that) const;
+    uint32_t Hash() const;
+
+    uint32_t face_id;
+    uint32_t glyph_index;
+    // The glyph matrix, in fixed point with four decimal places.
+    int32_t matrix[4];
+    int32_t dest_width;
+    int32_t anti_alias;
+    // Only set for substituted fonts.
+    int32_t weight;
+    int32_t italic_angle;
+    uint8_t flags;
+  };
+
+  static const size_t kDefaultLimit = 16 * 1024 * 1024;
+  static const size_t kShardCount = 8;
+
+  CFX_GlyphCache();
+  ~CFX_GlyphCache();
+
+  // Returns a new identifier for a face, for use in Key::face_id.
+  uint32_t NewFaceId();
+
+  // Looks up |key| and marks it as the most recently used. Returns false if
+  // it is missing. On success, |pBitmap| may be null for a glyph that could
+  // not be rendered.
+  bool Find(const Key& key, CFX_RetainPtr<CFX_GlyphBitmap>* pBitmap);
+
+  // Adds |pBitmap|, which may be null, as the most recently used glyph for
+  // |key|. Older glyphs are evicted to stay within the limit. Glyphs still
+  // referenced by a caller stay alive until it lets go of them.
+  void Add(const Key& key, const CFX_RetainPtr<CFX_GlyphBitmap>& pBitmap);
+
+  // Drops all glyphs of |face_id|, in time proportional to their number.
+  void RemoveFace(uint32_t face_id);
+
+  void SetLimit(size_t limit);
+  size_t GetLimit() const { return m_Limit; }
+  size_t GetSize() const;
+  size_t GetCount() const;
+
+ private:
+  class Shard;
+
+  Shard* ShardFor(uint32_t hash) const;
+  size_t ShardLimit() const { return m_Limit / kShardCount; }
+
+  std::atomic<size_t> m_Limit;
+  std::atomic<uint32_t> m_NextFaceId;
+  std::unique_ptr<Shard> m_Shards[kShardCount];
+};
+
+#endif  // CORE_FXGE_CFX_GLYPHCACHE_H_
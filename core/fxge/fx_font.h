@@ -23,7 +23,6 @@ typedef void* FXFT_Library;
 class CFX_FaceCache;
 class CFX_GlyphBitmap;
 class CFX_PathData;
-class CFX_SizeGlyphCache;
 
 #if defined _SKIA_SUPPORT_ || defined _SKIA_SUPPORT_PATHS_
 class SkTypeface;
@@ -109,12 +108,12 @@ class CFX_Font {
   }
 #endif  // PDF_ENABLE_XFA
 
-  const CFX_GlyphBitmap* LoadGlyphBitmap(uint32_t glyph_index,
-                                         bool bFontStyle,
-                                         const CFX_Matrix* pMatrix,
-                                         int dest_width,
-                                         int anti_alias,
-                                         int& text_flags) const;
+  CFX_RetainPtr<CFX_GlyphBitmap> LoadGlyphBitmap(uint32_t glyph_index,
+                                                 bool bFontStyle,
+                                                 const CFX_Matrix* pMatrix,
+                                                 int dest_width,
+                                                 int anti_alias,
+                                                 int& text_flags) const;
   const CFX_PathData* LoadGlyphPath(uint32_t glyph_index, int dest_width) const;
 
 #if defined _SKIA_SUPPORT_ || defined _SKIA_SUPPORT_PATHS_
@@ -202,14 +201,20 @@ class CFX_FontFaceInfo {
   uint32_t m_Charsets;
 };
 
-class CFX_GlyphBitmap {
+// Retained so a glyph stays valid while it is drawn, even if a cache evicts
+// it meanwhile.
+class CFX_GlyphBitmap : public CFX_Retainable {
  public:
-  CFX_GlyphBitmap();
-  ~CFX_GlyphBitmap();
+  template <typename T, typename... Args>
+  friend CFX_RetainPtr<T> pdfium::MakeRetain(Args&&... args);
 
   int m_Top;
   int m_Left;
   CFX_RetainPtr<CFX_DIBitmap> m_pBitmap;
+
+ private:
+  CFX_GlyphBitmap();
+  ~CFX_GlyphBitmap() override;
 };
 
 inline CFX_GlyphBitmap::CFX_GlyphBitmap()
@@ -223,7 +228,7 @@ class FXTEXT_GLYPHPOS {
   FXTEXT_GLYPHPOS(const FXTEXT_GLYPHPOS&);
   ~FXTEXT_GLYPHPOS();
 
-  const CFX_GlyphBitmap* m_pGlyph;
+  CFX_RetainPtr<CFX_GlyphBitmap> m_pGlyph;
   CFX_Point m_Origin;
   CFX_PointF m_fOrigin;
 };
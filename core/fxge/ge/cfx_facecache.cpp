@@ -12,7 +12,6 @@
 #include <utility>
 
 #include "core/fxcrt/fx_codepage.h"
-#include "core/fxge/cfx_fontmgr.h"
 #include "core/fxge/cfx_gemodule.h"
 #include "core/fxge/cfx_pathdata.h"
 #include "core/fxge/cfx_substfont.h"
@@ -84,8 +83,10 @@ void ContrastAdjust(uint8_t* pDataIn,
 }
 }  // namespace
 
-CFX_FaceCache::CFX_FaceCache(FXFT_Face face)
-    : m_Face(face)
+CFX_FaceCache::CFX_FaceCache(FXFT_Face face, CFX_GlyphCache* pGlyphCache)
+    : m_Face(face),
+      m_pGlyphCache(pGlyphCache),
+      m_FaceId(pGlyphCache->NewFaceId())
 #if defined _SKIA_SUPPORT_ || _SKIA_SUPPORT_PATHS_
       ,
       m_pTypeface(nullptr)
@@ -94,12 +95,13 @@ CFX_FaceCache::CFX_FaceCache(FXFT_Face face)
 }
 
 CFX_FaceCache::~CFX_FaceCache() {
+  m_pGlyphCache->RemoveFace(m_FaceId);
 #if defined _SKIA_SUPPORT_ || _SKIA_SUPPORT_PATHS_
   SkSafeUnref(m_pTypeface);
 #endif
 }
 
-std::unique_ptr<CFX_GlyphBitmap> CFX_FaceCache::RenderGlyph(
+CFX_RetainPtr<CFX_GlyphBitmap> CFX_FaceCache::RenderGlyph(
     const CFX_Font* pFont,
     uint32_t glyph_index,
     bool bFontStyle,
@@ -181,8 +183,6 @@ std::unique_ptr<CFX_GlyphBitmap> CFX_FaceCache::RenderGlyph(
     FXFT_Outline_Embolden(FXFT_Get_Glyph_Outline(m_Face),
                           level.ValueOrDefault(0));
   }
-  FXFT_Library_SetLcdFilter(CFX_GEModule::Get()->GetFontMgr()->GetFTLibrary(),
-                            FT_LCD_FILTER_DEFAULT);
   error = FXFT_Render_Glyph(m_Face, anti_alias);
   if (error)
     return nullptr;
@@ -191,7 +191,7 @@ std::unique_ptr<CFX_GlyphBitmap> CFX_FaceCache::RenderGlyph(
   if (bmwidth > 2048 || bmheight > 2048)
     return nullptr;
   int dib_width = bmwidth;
-  auto pGlyphBitmap = pdfium::MakeUnique<CFX_GlyphBitmap>();
+  auto pGlyphBitmap = pdfium::MakeRetain<CFX_GlyphBitmap>();
   pGlyphBitmap->m_pBitmap->Create(
       dib_width, bmheight,
       anti_alias == FXFT_RENDER_MODE_MONO ? FXDIB_1bppMask : FXDIB_8bppMask);
@@ -263,102 +263,57 @@ const CFX_PathData* CFX_FaceCache::LoadGlyphPath(const CFX_Font* pFont,
   return pGlyphPath;
 }
 
-const CFX_GlyphBitmap* CFX_FaceCache::LoadGlyphBitmap(const CFX_Font* pFont,
-                                                      uint32_t glyph_index,
-                                                      bool bFontStyle,
-                                                      const CFX_Matrix* pMatrix,
-                                                      int dest_width,
-                                                      int anti_alias,
-                                                      int& text_flags) {
+CFX_RetainPtr<CFX_GlyphBitmap> CFX_FaceCache::LoadGlyphBitmap(
+    const CFX_Font* pFont,
+    uint32_t glyph_index,
+    bool bFontStyle,
+    const CFX_Matrix* pMatrix,
+    int dest_width,
+    int anti_alias,
+    int& text_flags) {
   if (glyph_index == kInvalidGlyphIndex)
     return nullptr;
 
-  CFX_UniqueKeyGen keygen;
-  int nMatrixA = static_cast<int>(pMatrix->a * 10000);
-  int nMatrixB = static_cast<int>(pMatrix->b * 10000);
-  int nMatrixC = static_cast<int>(pMatrix->c * 10000);
-  int nMatrixD = static_cast<int>(pMatrix->d * 10000);
-#if _FXM_PLATFORM_ != _FXM_PLATFORM_APPLE_
-  if (pFont->GetSubstFont()) {
-    keygen.Generate(9, nMatrixA, nMatrixB, nMatrixC, nMatrixD, dest_width,
-                    anti_alias, pFont->GetSubstFont()->m_Weight,
-                    pFont->GetSubstFont()->m_ItalicAngle, pFont->IsVertical());
-  } else {
-    keygen.Generate(6, nMatrixA, nMatrixB, nMatrixC, nMatrixD, dest_width,
-                    anti_alias);
-  }
-#else
-  if (text_flags & FXTEXT_NO_NATIVETEXT) {
-    if (pFont->GetSubstFont()) {
-      keygen.Generate(9, nMatrixA, nMatrixB, nMatrixC, nMatrixD, dest_width,
-                      anti_alias, pFont->GetSubstFont()->m_Weight,
-                      pFont->GetSubstFont()->m_ItalicAngle,
-                      pFont->IsVertical());
-    } else {
-      keygen.Generate(6, nMatrixA, nMatrixB, nMatrixC, nMatrixD, dest_width,
-                      anti_alias);
-    }
-  } else {
-    if (pFont->GetSubstFont()) {
-      keygen.Generate(10, nMatrixA, nMatrixB, nMatrixC, nMatrixD, dest_width,
-                      anti_alias, pFont->GetSubstFont()->m_Weight,
-                      pFont->GetSubstFont()->m_ItalicAngle, pFont->IsVertical(),
-                      3);
-    } else {
-      keygen.Generate(7, nMatrixA, nMatrixB, nMatrixC, nMatrixD, dest_width,
-                      anti_alias, 3);
-    }
+  CFX_GlyphCache::Key key;
+  key.face_id = m_FaceId;
+  key.glyph_index = glyph_index;
+  key.matrix[0] = static_cast<int32_t>(pMatrix->a * 10000);
+  key.matrix[1] = static_cast<int32_t>(pMatrix->b * 10000);
+  key.matrix[2] = static_cast<int32_t>(pMatrix->c * 10000);
+  key.matrix[3] = static_cast<int32_t>(pMatrix->d * 10000);
+  key.dest_width = dest_width;
+  key.anti_alias = anti_alias;
+  key.weight = 0;
+  key.italic_angle = 0;
+  key.flags = 0;
+  if (const CFX_SubstFont* pSubstFont = pFont->GetSubstFont()) {
+    key.weight = pSubstFont->m_Weight;
+    key.italic_angle = pSubstFont->m_ItalicAngle;
+    key.flags |= CFX_GlyphCache::Key::kSubstFont;
+    if (pFont->IsVertical())
+      key.flags |= CFX_GlyphCache::Key::kVertical;
   }
-#endif
-  CFX_ByteString FaceGlyphsKey(keygen.m_Key, keygen.m_KeyLen);
 #if _FXM_PLATFORM_ != _FXM_PLATFORM_APPLE_ || defined _SKIA_SUPPORT_ || \
     defined _SKIA_SUPPORT_PATHS_
-  return LookUpGlyphBitmap(pFont, pMatrix, FaceGlyphsKey, glyph_index,
-                           bFontStyle, dest_width, anti_alias);
+  return LookUpGlyphBitmap(pFont, pMatrix, key, bFontStyle);
 #else
-  if (text_flags & FXTEXT_NO_NATIVETEXT) {
-    return LookUpGlyphBitmap(pFont, pMatrix, FaceGlyphsKey, glyph_index,
-                             bFontStyle, dest_width, anti_alias);
-  }
-  std::unique_ptr<CFX_GlyphBitmap> pGlyphBitmap;
-  auto it = m_SizeMap.find(FaceGlyphsKey);
-  if (it != m_SizeMap.end()) {
-    CFX_SizeGlyphCache* pSizeCache = it->second.get();
-    auto it2 = pSizeCache->m_GlyphMap.find(glyph_index);
-    if (it2 != pSizeCache->m_GlyphMap.end())
-      return it2->second.get();
+  if (text_flags & FXTEXT_NO_NATIVETEXT)
+    return LookUpGlyphBitmap(pFont, pMatrix, key, bFontStyle);
 
-    pGlyphBitmap = RenderGlyph_Nativetext(pFont, glyph_index, pMatrix,
-                                          dest_width, anti_alias);
-    if (pGlyphBitmap) {
-      CFX_GlyphBitmap* pResult = pGlyphBitmap.get();
-      pSizeCache->m_GlyphMap[glyph_index] = std::move(pGlyphBitmap);
-      return pResult;
-    }
-  } else {
-    pGlyphBitmap = RenderGlyph_Nativetext(pFont, glyph_index, pMatrix,
-                                          dest_width, anti_alias);
-    if (pGlyphBitmap) {
-      auto pNewCache = pdfium::MakeUnique<CFX_SizeGlyphCache>();
-      CFX_SizeGlyphCache* pSizeCache = pNewCache.get();
-      m_SizeMap[FaceGlyphsKey] = std::move(pNewCache);
-      CFX_GlyphBitmap* pResult = pGlyphBitmap.get();
-      pSizeCache->m_GlyphMap[glyph_index] = std::move(pGlyphBitmap);
-      return pResult;
-    }
-  }
-  if (pFont->GetSubstFont()) {
-    keygen.Generate(9, nMatrixA, nMatrixB, nMatrixC, nMatrixD, dest_width,
-                    anti_alias, pFont->GetSubstFont()->m_Weight,
-                    pFont->GetSubstFont()->m_ItalicAngle, pFont->IsVertical());
-  } else {
-    keygen.Generate(6, nMatrixA, nMatrixB, nMatrixC, nMatrixD, dest_width,
-                    anti_alias);
+  CFX_GlyphCache::Key native_key = key;
+  native_key.flags |= CFX_GlyphCache::Key::kNativeText;
+  CFX_RetainPtr<CFX_GlyphBitmap> pGlyphBitmap;
+  if (m_pGlyphCache->Find(native_key, &pGlyphBitmap))
+    return pGlyphBitmap;
+
+  pGlyphBitmap = RenderGlyph_Nativetext(pFont, glyph_index, pMatrix,
+                                        dest_width, anti_alias);
+  if (pGlyphBitmap) {
+    m_pGlyphCache->Add(native_key, pGlyphBitmap);
+    return pGlyphBitmap;
   }
-  CFX_ByteString FaceGlyphsKey2(keygen.m_Key, keygen.m_KeyLen);
   text_flags |= FXTEXT_NO_NATIVETEXT;
-  return LookUpGlyphBitmap(pFont, pMatrix, FaceGlyphsKey2, glyph_index,
-                           bFontStyle, dest_width, anti_alias);
+  return LookUpGlyphBitmap(pFont, pMatrix, key, bFontStyle);
 #endif
 }
 
@@ -385,30 +340,17 @@ CFX_TypeFace* CFX_FaceCache::GetDeviceCache(const CFX_Font* pFont) {
 void CFX_FaceCache::InitPlatform() {}
 #endif
 
-CFX_GlyphBitmap* CFX_FaceCache::LookUpGlyphBitmap(
+CFX_RetainPtr<CFX_GlyphBitmap> CFX_FaceCache::LookUpGlyphBitmap(
     const CFX_Font* pFont,
     const CFX_Matrix* pMatrix,
-    const CFX_ByteString& FaceGlyphsKey,
-    uint32_t glyph_index,
-    bool bFontStyle,
-    int dest_width,
-    int anti_alias) {
-  CFX_SizeGlyphCache* pSizeCache;
-  auto it = m_SizeMap.find(FaceGlyphsKey);
-  if (it == m_SizeMap.end()) {
-    auto pNewCache = pdfium::MakeUnique<CFX_SizeGlyphCache>();
-    pSizeCache = pNewCache.get();
-    m_SizeMap[FaceGlyphsKey] = std::move(pNewCache);
-  } else {
-    pSizeCache = it->second.get();
-  }
-  auto it2 = pSizeCache->m_GlyphMap.find(glyph_index);
-  if (it2 != pSizeCache->m_GlyphMap.end())
-    return it2->second.get();
+    const CFX_GlyphCache::Key& key,
+    bool bFontStyle) {
+  CFX_RetainPtr<CFX_GlyphBitmap> pGlyphBitmap;
+  if (m_pGlyphCache->Find(key, &pGlyphBitmap))
+    return pGlyphBitmap;
 
-  std::unique_ptr<CFX_GlyphBitmap> pGlyphBitmap = RenderGlyph(
-      pFont, glyph_index, bFontStyle, pMatrix, dest_width, anti_alias);
-  CFX_GlyphBitmap* pResult = pGlyphBitmap.get();
-  pSizeCache->m_GlyphMap[glyph_index] = std::move(pGlyphBitmap);
-  return pResult;
+  pGlyphBitmap = RenderGlyph(pFont, key.glyph_index, bFontStyle, pMatrix,
+                             key.dest_width, key.anti_alias);
+  m_pGlyphCache->Add(key, pGlyphBitmap);
+  return pGlyphBitmap;
 }
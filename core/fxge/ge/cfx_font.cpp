@@ -289,11 +289,7 @@ CFX_Font::~CFX_Font() {
 
 void CFX_Font::DeleteFace() {
   ClearFaceCache();
-  if (m_bEmbedded) {
-    FXFT_Done_Face(m_Face);
-  } else {
-    CFX_GEModule::Get()->GetFontMgr()->ReleaseFace(m_Face);
-  }
+  CFX_GEModule::Get()->GetFontMgr()->ReleaseFace(m_Face);
   m_Face = nullptr;
 }
 
@@ -676,12 +672,13 @@ CFX_PathData* CFX_Font::LoadGlyphPathImpl(uint32_t glyph_index,
   return pPath.release();
 }
 
-const CFX_GlyphBitmap* CFX_Font::LoadGlyphBitmap(uint32_t glyph_index,
-                                                 bool bFontStyle,
-                                                 const CFX_Matrix* pMatrix,
-                                                 int dest_width,
-                                                 int anti_alias,
-                                                 int& text_flags) const {
+CFX_RetainPtr<CFX_GlyphBitmap> CFX_Font::LoadGlyphBitmap(
+    uint32_t glyph_index,
+    bool bFontStyle,
+    const CFX_Matrix* pMatrix,
+    int dest_width,
+    int anti_alias,
+    int& text_flags) const {
   return GetFaceCache()->LoadGlyphBitmap(this, glyph_index, bFontStyle, pMatrix,
                                          dest_width, anti_alias, text_flags);
 }
@@ -26,6 +26,7 @@ CFX_FontCache::~CFX_FontCache() {
 }
 
 CFX_FaceCache* CFX_FontCache::GetCachedFace(const CFX_Font* pFont) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
   FXFT_Face face = pFont->GetFace();
   const bool bExternal = !face;
   CFX_FTCacheMap& map = bExternal ? m_ExtFaceMap : m_FTFaceMap;
@@ -38,8 +39,8 @@ CFX_FaceCache* CFX_FontCache::GetCachedFace(const CFX_Font* pFont) {
 
   auto counted_face_cache = pdfium::MakeUnique<CountedFaceCache>();
   counted_face_cache->m_nCount = 2;
-  auto new_cache =
-      pdfium::MakeUnique<CFX_FaceCache>(bExternal ? nullptr : face);
+  auto new_cache = pdfium::MakeUnique<CFX_FaceCache>(
+      bExternal ? nullptr : face, &m_GlyphCache);
   CFX_FaceCache* face_cache = new_cache.get();
   counted_face_cache->m_Obj = std::move(new_cache);
   map[face] = std::move(counted_face_cache);
@@ -53,6 +54,7 @@ CFX_TypeFace* CFX_FontCache::GetDeviceCache(const CFX_Font* pFont) {
 #endif
 
 void CFX_FontCache::ReleaseCachedFace(const CFX_Font* pFont) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
   FXFT_Face face = pFont->GetFace();
   const bool bExternal = !face;
   CFX_FTCacheMap& map = bExternal ? m_ExtFaceMap : m_FTFaceMap;
@@ -279,22 +279,9 @@ void UpdatePitchFamily(uint32_t flags, int& PitchFamily) {
 }  // namespace
 
 CFX_FontMapper::CFX_FontMapper(CFX_FontMgr* mgr)
-    : m_bListLoaded(false), m_pFontMgr(mgr) {
-  m_MMFaces[0] = nullptr;
-  m_MMFaces[1] = nullptr;
-  memset(m_FoxitFaces, 0, sizeof(m_FoxitFaces));
-}
+    : m_bListLoaded(false), m_pFontMgr(mgr) {}
 
-CFX_FontMapper::~CFX_FontMapper() {
-  for (size_t i = 0; i < FX_ArraySize(m_FoxitFaces); ++i) {
-    if (m_FoxitFaces[i])
-      FXFT_Done_Face(m_FoxitFaces[i]);
-  }
-  if (m_MMFaces[0])
-    FXFT_Done_Face(m_MMFaces[0]);
-  if (m_MMFaces[1])
-    FXFT_Done_Face(m_MMFaces[1]);
-}
+CFX_FontMapper::~CFX_FontMapper() {}
 
 void CFX_FontMapper::SetSystemFontInfo(
     std::unique_ptr<IFX_SystemFontInfo> pFontInfo) {
@@ -383,14 +370,10 @@ FXFT_Face CFX_FontMapper::UseInternalSubst(CFX_SubstFont* pSubstFont,
                                            int weight,
                                            int picthfamily) {
   if (iBaseFont < kNumStandardFonts) {
-    if (m_FoxitFaces[iBaseFont])
-      return m_FoxitFaces[iBaseFont];
     const uint8_t* pFontData = nullptr;
     uint32_t size = 0;
-    if (m_pFontMgr->GetBuiltinFont(iBaseFont, &pFontData, &size)) {
-      m_FoxitFaces[iBaseFont] = m_pFontMgr->GetFixedFace(pFontData, size, 0);
-      return m_FoxitFaces[iBaseFont];
-    }
+    if (m_pFontMgr->GetBuiltinFont(iBaseFont, &pFontData, &size))
+      return m_pFontMgr->GetFixedFace(pFontData, size, 0);
   }
   pSubstFont->m_SubstFlags |= FXFONT_SUBST_MM;
   pSubstFont->m_ItalicAngle = italic_angle;
@@ -399,22 +382,16 @@ FXFT_Face CFX_FontMapper::UseInternalSubst(CFX_SubstFont* pSubstFont,
   if (picthfamily & FXFONT_FF_ROMAN) {
     pSubstFont->m_Weight = pSubstFont->m_Weight * 4 / 5;
     pSubstFont->m_Family = "Chrome Serif";
-    if (m_MMFaces[1])
-      return m_MMFaces[1];
     const uint8_t* pFontData = nullptr;
     uint32_t size = 0;
     m_pFontMgr->GetBuiltinFont(14, &pFontData, &size);
-    m_MMFaces[1] = m_pFontMgr->GetFixedFace(pFontData, size, 0);
-    return m_MMFaces[1];
+    return m_pFontMgr->GetFixedFace(pFontData, size, 0);
   }
   pSubstFont->m_Family = "Chrome Sans";
-  if (m_MMFaces[0])
-    return m_MMFaces[0];
   const uint8_t* pFontData = nullptr;
   uint32_t size = 0;
   m_pFontMgr->GetBuiltinFont(15, &pFontData, &size);
-  m_MMFaces[0] = m_pFontMgr->GetFixedFace(pFontData, size, 0);
-  return m_MMFaces[0];
+  return m_pFontMgr->GetFixedFace(pFontData, size, 0);
 }
 
 FXFT_Face CFX_FontMapper::FindSubstFont(const CFX_ByteString& name,
@@ -692,7 +669,9 @@ FXFT_Face CFX_FontMapper::FindSubstFont(const CFX_ByteString& name,
     m_pFontInfo->DeleteFont(hFont);
     return nullptr;
   }
-  pSubstFont->m_Family = SubstName;
+  // Copy the name rather than share the buffer of the system font list, which
+  // other threads read while |pSubstFont| is in use.
+  pSubstFont->m_Family = CFX_ByteString(SubstName.AsStringC());
   pSubstFont->m_Charset = Charset;
   bool bNeedUpdateWeight = false;
   if (FXFT_Is_Face_Bold(face))
@@ -751,18 +730,6 @@ int CFX_FontMapper::GetFaceSize() const {
   return pdfium::CollectionSize<int>(m_FaceArray);
 }
 
-bool CFX_FontMapper::IsBuiltinFace(const FXFT_Face face) const {
-  for (size_t i = 0; i < MM_FACE_COUNT; ++i) {
-    if (m_MMFaces[i] == face)
-      return true;
-  }
-  for (size_t i = 0; i < FOXIT_FACE_COUNT; ++i) {
-    if (m_FoxitFaces[i] == face)
-      return true;
-  }
-  return false;
-}
-
 FXFT_Face CFX_FontMapper::GetCachedTTCFace(void* hFont,
                                            const uint32_t tableTTCF,
                                            uint32_t ttc_size,
@@ -774,11 +741,9 @@ FXFT_Face CFX_FontMapper::GetCachedTTCFace(void* hFont,
   uint32_t checksum = 0;
   for (int i = 0; i < 256; i++)
     checksum += pBuffer[i];
-  uint8_t* pFontData;
-  face = m_pFontMgr->GetCachedTTCFace(ttc_size, checksum, ttc_size - font_size,
-                                      pFontData);
+  face = m_pFontMgr->GetCachedTTCFace(ttc_size, checksum, ttc_size - font_size);
   if (!face) {
-    pFontData = FX_Alloc(uint8_t, ttc_size);
+    uint8_t* pFontData = FX_Alloc(uint8_t, ttc_size);
     m_pFontInfo->GetFontData(hFont, tableTTCF, pFontData, ttc_size);
     face = m_pFontMgr->AddCachedTTCFace(ttc_size, checksum, pFontData, ttc_size,
                                         ttc_size - font_size);
@@ -792,14 +757,13 @@ FXFT_Face CFX_FontMapper::GetCachedFace(void* hFont,
                                         bool bItalic,
                                         uint32_t font_size) {
   FXFT_Face face;
-  uint8_t* pFontData;
-  face = m_pFontMgr->GetCachedFace(SubstName, weight, bItalic, pFontData);
+  int face_index = m_pFontInfo->GetFaceIndex(hFont);
+  face = m_pFontMgr->GetCachedFace(SubstName, weight, bItalic, face_index);
   if (!face) {
-    pFontData = FX_Alloc(uint8_t, font_size);
+    uint8_t* pFontData = FX_Alloc(uint8_t, font_size);
     m_pFontInfo->GetFontData(hFont, 0, pFontData, font_size);
-    face =
-        m_pFontMgr->AddCachedFace(SubstName, weight, bItalic, pFontData,
-                                  font_size, m_pFontInfo->GetFaceIndex(hFont));
+    face = m_pFontMgr->AddCachedFace(SubstName, weight, bItalic, pFontData,
+                                     font_size, face_index);
   }
   return face;
 }
@@ -86,6 +86,9 @@ int GetTTCIndex(const uint8_t* pFontData,
 CFX_FontMgr::CFX_FontMgr()
     : m_FTLibrary(nullptr), m_FTLibrarySupportsHinting(false) {
   m_pBuiltinMapper = pdfium::MakeUnique<CFX_FontMapper>(this);
+  // Initialize FreeType up front, so that GetFTLibrary() and
+  // FTLibrarySupportsHinting() never race with it.
+  InitFTLibrary();
 }
 
 CFX_FontMgr::~CFX_FontMgr() {
@@ -97,6 +100,7 @@ CFX_FontMgr::~CFX_FontMgr() {
 }
 
 void CFX_FontMgr::InitFTLibrary() {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   if (m_FTLibrary)
     return;
   FXFT_Init_FreeType(&m_FTLibrary);
@@ -107,6 +111,7 @@ void CFX_FontMgr::InitFTLibrary() {
 
 void CFX_FontMgr::SetSystemFontInfo(
     std::unique_ptr<IFX_SystemFontInfo> pFontInfo) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   m_pBuiltinMapper->SetSystemFontInfo(std::move(pFontInfo));
 }
 
@@ -117,6 +122,7 @@ FXFT_Face CFX_FontMgr::FindSubstFont(const CFX_ByteString& face_name,
                                      int italic_angle,
                                      int CharsetCP,
                                      CFX_SubstFont* pSubstFont) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   InitFTLibrary();
   return m_pBuiltinMapper->FindSubstFont(face_name, bTrueType, flags, weight,
                                          italic_angle, CharsetCP, pSubstFont);
@@ -125,15 +131,13 @@ FXFT_Face CFX_FontMgr::FindSubstFont(const CFX_ByteString& face_name,
 FXFT_Face CFX_FontMgr::GetCachedFace(const CFX_ByteString& face_name,
                                      int weight,
                                      bool bItalic,
-                                     uint8_t*& pFontData) {
+                                     int face_index) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   auto it = m_FaceMap.find(KeyNameFromFace(face_name, weight, bItalic));
   if (it == m_FaceMap.end())
     return nullptr;
 
-  CTTFontDesc* pFontDesc = it->second.get();
-  pFontData = pFontDesc->m_pFontData;
-  pFontDesc->m_RefCount++;
-  return pFontDesc->m_SingleFace;
+  return NewCachedFace(it->second.get(), face_index);
 }
 
 FXFT_Face CFX_FontMgr::AddCachedFace(const CFX_ByteString& face_name,
@@ -142,45 +146,27 @@ FXFT_Face CFX_FontMgr::AddCachedFace(const CFX_ByteString& face_name,
                                      uint8_t* pData,
                                      uint32_t size,
                                      int face_index) {
-  auto pFontDesc = pdfium::MakeUnique<CTTFontDesc>();
-  pFontDesc->m_Type = 1;
-  pFontDesc->m_SingleFace = nullptr;
-  pFontDesc->m_pFontData = pData;
-  pFontDesc->m_RefCount = 1;
-
-  InitFTLibrary();
-  FXFT_Library library = m_FTLibrary;
-  int ret = FXFT_New_Memory_Face(library, pData, size, face_index,
-                                 &pFontDesc->m_SingleFace);
-  if (ret)
-    return nullptr;
-
-  ret = FXFT_Set_Pixel_Sizes(pFontDesc->m_SingleFace, 64, 64);
-  if (ret)
-    return nullptr;
-
-  CTTFontDesc* pResult = pFontDesc.get();
-  m_FaceMap[KeyNameFromFace(face_name, weight, bItalic)] = std::move(pFontDesc);
-  return pResult->m_SingleFace;
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+  std::unique_ptr<CTTFontDesc>& pFontDesc =
+      m_FaceMap[KeyNameFromFace(face_name, weight, bItalic)];
+  if (pFontDesc)
+    FX_Free(pData);
+  else
+    pFontDesc = pdfium::MakeUnique<CTTFontDesc>(pData, size);
+  return NewCachedFace(pFontDesc.get(), face_index);
 }
 
 FXFT_Face CFX_FontMgr::GetCachedTTCFace(int ttc_size,
                                         uint32_t checksum,
-                                        int font_offset,
-                                        uint8_t*& pFontData) {
+                                        int font_offset) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   auto it = m_FaceMap.find(KeyNameFromSize(ttc_size, checksum));
   if (it == m_FaceMap.end())
     return nullptr;
 
   CTTFontDesc* pFontDesc = it->second.get();
-  pFontData = pFontDesc->m_pFontData;
-  pFontDesc->m_RefCount++;
-  int face_index = GetTTCIndex(pFontDesc->m_pFontData, ttc_size, font_offset);
-  if (!pFontDesc->m_TTCFaces[face_index]) {
-    pFontDesc->m_TTCFaces[face_index] =
-        GetFixedFace(pFontDesc->m_pFontData, ttc_size, face_index);
-  }
-  return pFontDesc->m_TTCFaces[face_index];
+  return NewCachedFace(
+      pFontDesc, GetTTCIndex(pFontDesc->m_pFontData, ttc_size, font_offset));
 }
 
 FXFT_Face CFX_FontMgr::AddCachedTTCFace(int ttc_size,
@@ -188,32 +174,36 @@ FXFT_Face CFX_FontMgr::AddCachedTTCFace(int ttc_size,
                                         uint8_t* pData,
                                         uint32_t size,
                                         int font_offset) {
-  auto pFontDesc = pdfium::MakeUnique<CTTFontDesc>();
-  pFontDesc->m_Type = 2;
-  pFontDesc->m_pFontData = pData;
-  for (int i = 0; i < 16; i++)
-    pFontDesc->m_TTCFaces[i] = nullptr;
-  pFontDesc->m_RefCount++;
-  CTTFontDesc* pResult = pFontDesc.get();
-  m_FaceMap[KeyNameFromSize(ttc_size, checksum)] = std::move(pFontDesc);
-  int face_index = GetTTCIndex(pResult->m_pFontData, ttc_size, font_offset);
-  pResult->m_TTCFaces[face_index] =
-      GetFixedFace(pResult->m_pFontData, ttc_size, face_index);
-  return pResult->m_TTCFaces[face_index];
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+  std::unique_ptr<CTTFontDesc>& pFontDesc =
+      m_FaceMap[KeyNameFromSize(ttc_size, checksum)];
+  if (pFontDesc)
+    FX_Free(pData);
+  else
+    pFontDesc = pdfium::MakeUnique<CTTFontDesc>(pData, size);
+  return NewCachedFace(
+      pFontDesc.get(),
+      GetTTCIndex(pFontDesc->m_pFontData, ttc_size, font_offset));
 }
 
 FXFT_Face CFX_FontMgr::GetFixedFace(const uint8_t* pData,
                                     uint32_t size,
                                     int face_index) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   InitFTLibrary();
   FXFT_Library library = m_FTLibrary;
   FXFT_Face face = nullptr;
   if (FXFT_New_Memory_Face(library, pData, size, face_index, &face))
     return nullptr;
-  return FXFT_Set_Pixel_Sizes(face, 64, 64) ? nullptr : face;
+  if (FXFT_Set_Pixel_Sizes(face, 64, 64)) {
+    FXFT_Done_Face(face);
+    return nullptr;
+  }
+  return face;
 }
 
 FXFT_Face CFX_FontMgr::GetFileFace(const char* filename, int face_index) {
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
   InitFTLibrary();
   FXFT_Library library = m_FTLibrary;
   FXFT_Face face = nullptr;
@@ -225,20 +215,26 @@ FXFT_Face CFX_FontMgr::GetFileFace(const char* filename, int face_index) {
 void CFX_FontMgr::ReleaseFace(FXFT_Face face) {
   if (!face)
     return;
-  bool bNeedFaceDone = true;
-  auto it = m_FaceMap.begin();
-  while (it != m_FaceMap.end()) {
-    auto temp = it++;
-    int nRet = temp->second->ReleaseFace(face);
-    if (nRet == -1)
+
+  std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+  for (auto it = m_FaceMap.begin(); it != m_FaceMap.end(); ++it) {
+    if (!it->second->HasFace(face))
       continue;
-    bNeedFaceDone = false;
-    if (nRet == 0)
-      m_FaceMap.erase(temp);
-    break;
-  }
-  if (bNeedFaceDone && !m_pBuiltinMapper->IsBuiltinFace(face))
+
     FXFT_Done_Face(face);
+    if (--it->second->m_RefCount == 0)
+      m_FaceMap.erase(it);
+    return;
+  }
+  FXFT_Done_Face(face);
+}
+
+FXFT_Face CFX_FontMgr::NewCachedFace(CTTFontDesc* pFontDesc, int face_index) {
+  FXFT_Face face =
+      GetFixedFace(pFontDesc->m_pFontData, pFontDesc->m_dwSize, face_index);
+  if (face)
+    pFontDesc->m_RefCount++;
+  return face;
 }
 
 bool CFX_FontMgr::GetBuiltinFont(size_t index,
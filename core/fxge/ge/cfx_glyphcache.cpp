@@ -0,0 +1,379 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
+
+#include "core/fxge/cfx_glyphcache.h"
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "core/fxge/fx_font.h"
+#include "third_party/base/ptr_util.h"
+
+namespace {
+
+const int32_t kNone = -1;
+const size_t kMinSlots = 64;
+
+uint32_t HashWord(uint32_t hash, uint32_t word) {
+  hash ^= word;
+  return hash * 0x01000193;
+}
+
+// Spreads the bits of |hash|, since the low ones pick the slot and the high
+// ones pick the shard.
+uint32_t FinishHash(uint32_t hash) {
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6b;
+  hash ^= hash >> 13;
+  hash *= 0xc2b2ae35;
+  hash ^= hash >> 16;
+  return hash;
+}
+
+uint32_t EstimateSize(const CFX_RetainPtr<CFX_GlyphBitmap>& pBitmap) {
+  if (!pBitmap)
+    return 0;
+
+  const CFX_RetainPtr<CFX_DIBitmap>& pDIBitmap = pBitmap->m_pBitmap;
+  return sizeof(CFX_GlyphBitmap) + sizeof(CFX_DIBitmap) +
+         pDIBitmap->GetPitch() * pDIBitmap->GetHeight();
+}
+
+}  // namespace
+
+// An open addressing hash table with linear probing over a pool of nodes,
+// which are linked in least recently used order and, separately, per face.
+class CFX_GlyphCache::Shard {
+ public:
+  Shard();
+  ~Shard();
+
+  bool Find(const Key& key,
+            uint32_t hash,
+            CFX_RetainPtr<CFX_GlyphBitmap>* pBitmap);
+  void Add(const Key& key,
+           uint32_t hash,
+           const CFX_RetainPtr<CFX_GlyphBitmap>& pBitmap,
+           size_t limit);
+  void RemoveFace(uint32_t face_id);
+  void SetLimit(size_t limit);
+
+  size_t GetSize();
+  size_t GetCount();
+
+ private:
+  struct Node {
+    Key key;
+    uint32_t hash;
+    uint32_t size;
+    int32_t prev;
+    int32_t next;
+    int32_t face_prev;
+    int32_t face_next;
+    CFX_RetainPtr<CFX_GlyphBitmap> pBitmap;
+  };
+
+  // Returns the slot holding |key|, or the empty slot ending its probe
+  // sequence.
+  size_t FindSlot(const Key& key, uint32_t hash) const;
+  void Grow();
+  void EraseSlot(size_t slot);
+  void Erase(int32_t index);
+  void EvictToLimit(size_t limit, size_t nKeep);
+
+  void Link(int32_t index);
+  void Unlink(int32_t index);
+  void LinkFace(int32_t index);
+  void UnlinkFace(int32_t index);
+
+  std::mutex m_Mutex;
+  std::vector<Node> m_Nodes;
+  std::vector<int32_t> m_FreeNodes;
+  // Node indices, or kNone. The size is a power of two.
+  std::vector<int32_t> m_Slots;
+  // Most recently used.
+  int32_t m_Head;
+  // Least recently used.
+  int32_t m_Tail;
+  // The first node of each face with glyphs in this shard.
+  std::map<uint32_t, int32_t> m_FaceHeads;
+  size_t m_Count;
+  size_t m_Size;
+};
+
+CFX_GlyphCache::Shard::Shard()
+    : m_Slots(kMinSlots, kNone),
+      m_Head(kNone),
+      m_Tail(kNone),
+      m_Count(0),
+      m_Size(0) {}
+
+CFX_GlyphCache::Shard::~Shard() {}
+
+bool CFX_GlyphCache::Shard::Find(const Key& key,
+                                 uint32_t hash,
+                                 CFX_RetainPtr<CFX_GlyphBitmap>* pBitmap) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  int32_t index = m_Slots[FindSlot(key, hash)];
+  if (index == kNone)
+    return false;
+
+  if (index != m_Head) {
+    Unlink(index);
+    Link(index);
+  }
+  *pBitmap = m_Nodes[index].pBitmap;
+  return true;
+}
+
+void CFX_GlyphCache::Shard::Add(const Key& key,
+                                uint32_t hash,
+                                const CFX_RetainPtr<CFX_GlyphBitmap>& pBitmap,
+                                size_t limit) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  size_t slot = FindSlot(key, hash);
+  if (m_Slots[slot] != kNone) {
+    Erase(m_Slots[slot]);
+    slot = FindSlot(key, hash);
+  }
+  if ((m_Count + 1) * 4 > m_Slots.size() * 3) {
+    Grow();
+    slot = FindSlot(key, hash);
+  }
+
+  int32_t index;
+  if (m_FreeNodes.empty()) {
+    index = static_cast<int32_t>(m_Nodes.size());
+    m_Nodes.emplace_back();
+  } else {
+    index = m_FreeNodes.back();
+    m_FreeNodes.pop_back();
+  }
+  Node& node = m_Nodes[index];
+  node.key = key;
+  node.hash = hash;
+  node.size = sizeof(Node) + EstimateSize(pBitmap);
+  node.pBitmap = pBitmap;
+  m_Slots[slot] = index;
+  Link(index);
+  LinkFace(index);
+  m_Count++;
+  m_Size += node.size;
+  EvictToLimit(limit, 1);
+}
+
+void CFX_GlyphCache::Shard::RemoveFace(uint32_t face_id) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  auto it = m_FaceHeads.find(face_id);
+  if (it == m_FaceHeads.end())
+    return;
+
+  int32_t index = it->second;
+  while (index != kNone) {
+    int32_t next = m_Nodes[index].face_next;
+    Erase(index);
+    index = next;
+  }
+}
+
+void CFX_GlyphCache::Shard::SetLimit(size_t limit) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  EvictToLimit(limit, 0);
+}
+
+size_t CFX_GlyphCache::Shard::GetSize() {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Size;
+}
+
+size_t CFX_GlyphCache::Shard::GetCount() {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Count;
+}
+
+size_t CFX_GlyphCache::Shard::FindSlot(const Key& key, uint32_t hash) const {
+  size_t mask = m_Slots.size() - 1;
+  size_t slot = hash & mask;
+  while (m_Slots[slot] != kNone) {
+    const Node& node = m_Nodes[m_Slots[slot]];
+    if (node.hash == hash && node.key == key)
+      break;
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+void CFX_GlyphCache::Shard::Grow() {
+  std::vector<int32_t> old_slots(m_Slots.size() * 2, kNone);
+  m_Slots.swap(old_slots);
+  size_t mask = m_Slots.size() - 1;
+  for (int32_t index : old_slots) {
+    if (index == kNone)
+      continue;
+    size_t slot = m_Nodes[index].hash & mask;
+    while (m_Slots[slot] != kNone)
+      slot = (slot + 1) & mask;
+    m_Slots[slot] = index;
+  }
+}
+
+void CFX_GlyphCache::Shard::EraseSlot(size_t slot) {
+  // Shift later entries of the probe sequence back, so that no lookup stops
+  // early at the emptied slot.
+  size_t mask = m_Slots.size() - 1;
+  size_t next = slot;
+  while (true) {
+    next = (next + 1) & mask;
+    if (m_Slots[next] == kNone)
+      break;
+    size_t home = m_Nodes[m_Slots[next]].hash & mask;
+    if (((next - home) & mask) >= ((next - slot) & mask)) {
+      m_Slots[slot] = m_Slots[next];
+      slot = next;
+    }
+  }
+  m_Slots[slot] = kNone;
+}
+
+void CFX_GlyphCache::Shard::Erase(int32_t index) {
+  Node& node = m_Nodes[index];
+  EraseSlot(FindSlot(node.key, node.hash));
+  Unlink(index);
+  UnlinkFace(index);
+  m_Count--;
+  m_Size -= node.size;
+  node.pBitmap.Reset();
+  m_FreeNodes.push_back(index);
+}
+
+void CFX_GlyphCache::Shard::EvictToLimit(size_t limit, size_t nKeep) {
+  while (m_Size > limit && m_Count > nKeep)
+    Erase(m_Tail);
+}
+
+void CFX_GlyphCache::Shard::Link(int32_t index) {
+  Node& node = m_Nodes[index];
+  node.prev = kNone;
+  node.next = m_Head;
+  if (m_Head != kNone)
+    m_Nodes[m_Head].prev = index;
+  else
+    m_Tail = index;
+  m_Head = index;
+}
+
+void CFX_GlyphCache::Shard::Unlink(int32_t index) {
+  Node& node = m_Nodes[index];
+  if (node.prev != kNone)
+    m_Nodes[node.prev].next = node.next;
+  else
+    m_Head = node.next;
+  if (node.next != kNone)
+    m_Nodes[node.next].prev = node.prev;
+  else
+    m_Tail = node.prev;
+}
+
+void CFX_GlyphCache::Shard::LinkFace(int32_t index) {
+  Node& node = m_Nodes[index];
+  auto result = m_FaceHeads.insert(std::make_pair(node.key.face_id, index));
+  node.face_prev = kNone;
+  node.face_next = kNone;
+  if (!result.second) {
+    node.face_next = result.first->second;
+    m_Nodes[node.face_next].face_prev = index;
+    result.first->second = index;
+  }
+}
+
+void CFX_GlyphCache::Shard::UnlinkFace(int32_t index) {
+  Node& node = m_Nodes[index];
+  if (node.face_next != kNone)
+    m_Nodes[node.face_next].face_prev = node.face_prev;
+  if (node.face_prev != kNone) {
+    m_Nodes[node.face_prev].face_next = node.face_next;
+  } else if (node.face_next != kNone) {
+    m_FaceHeads[node.key.face_id] = node.face_next;
+  } else {
+    m_FaceHeads.erase(node.key.face_id);
+  }
+}
+
+bool CFX_GlyphCache::Key::operator==(const Key& that) const {
+  return face_id == that.face_id && glyph_index == that.glyph_index &&
+         matrix[0] == that.matrix[0] && matrix[1] == that.matrix[1] &&
+         matrix[2] == that.matrix[2] && matrix[3] == that.matrix[3] &&
+         dest_width == that.dest_width && anti_alias == that.anti_alias &&
+         weight == that.weight && italic_angle == that.italic_angle &&
+         flags == that.flags;
+}
+
+uint32_t CFX_GlyphCache::Key::Hash() const {
+  uint32_t hash = 0x811c9dc5;
+  hash = HashWord(hash, face_id);
+  hash = HashWord(hash, glyph_index);
+  for (int32_t value : matrix)
+    hash = HashWord(hash, value);
+  hash = HashWord(hash, dest_width);
+  hash = HashWord(hash, anti_alias);
+  hash = HashWord(hash, weight);
+  hash = HashWord(hash, italic_angle);
+  hash = HashWord(hash, flags);
+  return FinishHash(hash);
+}
+
+CFX_GlyphCache::CFX_GlyphCache() : m_Limit(kDefaultLimit), m_NextFaceId(0) {
+  for (std::unique_ptr<Shard>& pShard : m_Shards)
+    pShard = pdfium::MakeUnique<Shard>();
+}
+
+CFX_GlyphCache::~CFX_GlyphCache() {}
+
+uint32_t CFX_GlyphCache::NewFaceId() {
+  return m_NextFaceId++;
+}
+
+bool CFX_GlyphCache::Find(const Key& key,
+                          CFX_RetainPtr<CFX_GlyphBitmap>* pBitmap) {
+  uint32_t hash = key.Hash();
+  return ShardFor(hash)->Find(key, hash, pBitmap);
+}
+
+void CFX_GlyphCache::Add(const Key& key,
+                         const CFX_RetainPtr<CFX_GlyphBitmap>& pBitmap) {
+  uint32_t hash = key.Hash();
+  ShardFor(hash)->Add(key, hash, pBitmap, ShardLimit());
+}
+
+void CFX_GlyphCache::RemoveFace(uint32_t face_id) {
+  for (std::unique_ptr<Shard>& pShard : m_Shards)
+    pShard->RemoveFace(face_id);
+}
+
+void CFX_GlyphCache::SetLimit(size_t limit) {
+  m_Limit = limit;
+  for (std::unique_ptr<Shard>& pShard : m_Shards)
+    pShard->SetLimit(ShardLimit());
+}
+
+size_t CFX_GlyphCache::GetSize() const {
+  size_t size = 0;
+  for (const std::unique_ptr<Shard>& pShard : m_Shards)
+    size += pShard->GetSize();
+  return size;
+}
+
+size_t CFX_GlyphCache::GetCount() const {
+  size_t count = 0;
+  for (const std::unique_ptr<Shard>& pShard : m_Shards)
+    count += pShard->GetCount();
+  return count;
+}
+
+CFX_GlyphCache::Shard* CFX_GlyphCache::ShardFor(uint32_t hash) const {
+  return m_Shards[hash >> 29].get();
+}
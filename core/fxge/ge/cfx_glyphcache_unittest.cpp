@@ -0,0 +1,187 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxge/cfx_glyphcache.h"
+
+#include <stdio.h>
+
+#include <chrono>
+#include <map>
+
+#include "core/fxcrt/fx_string.h"
+#include "core/fxge/fx_font.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+CFX_GlyphCache::Key MakeKey(uint32_t face_id, uint32_t glyph_index) {
+  CFX_GlyphCache::Key key = {};
+  key.face_id = face_id;
+  key.glyph_index = glyph_index;
+  key.matrix[0] = 10000;
+  key.matrix[3] = 10000;
+  key.dest_width = 12;
+  return key;
+}
+
+CFX_RetainPtr<CFX_GlyphBitmap> MakeGlyph() {
+  auto pGlyph = pdfium::MakeRetain<CFX_GlyphBitmap>();
+  pGlyph->m_pBitmap->Create(16, 16, FXDIB_8bppMask);
+  return pGlyph;
+}
+
+// The string key the glyph cache used to be looked up with.
+CFX_ByteString MakeStringKey(const CFX_GlyphCache::Key& key) {
+  CFX_ByteString str;
+  str.Format("%d,%d,%d,%d,%d,%d", key.matrix[0], key.matrix[1], key.matrix[2],
+             key.matrix[3], key.dest_width, key.anti_alias);
+  return str;
+}
+
+double SecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+}  // namespace
+
+TEST(CFX_GlyphCache, FindAndAdd) {
+  CFX_GlyphCache cache;
+  CFX_RetainPtr<CFX_GlyphBitmap> pFound;
+  EXPECT_FALSE(cache.Find(MakeKey(1, 2), &pFound));
+
+  CFX_RetainPtr<CFX_GlyphBitmap> pGlyph = MakeGlyph();
+  cache.Add(MakeKey(1, 2), pGlyph);
+  ASSERT_TRUE(cache.Find(MakeKey(1, 2), &pFound));
+  EXPECT_EQ(pGlyph, pFound);
+  EXPECT_FALSE(cache.Find(MakeKey(1, 3), &pFound));
+  EXPECT_FALSE(cache.Find(MakeKey(2, 2), &pFound));
+
+  // Glyphs that fail to render are remembered too.
+  cache.Add(MakeKey(1, 3), nullptr);
+  ASSERT_TRUE(cache.Find(MakeKey(1, 3), &pFound));
+  EXPECT_FALSE(pFound);
+  EXPECT_EQ(2u, cache.GetCount());
+}
+
+TEST(CFX_GlyphCache, ManyGlyphs) {
+  CFX_GlyphCache cache;
+  CFX_RetainPtr<CFX_GlyphBitmap> pGlyph = MakeGlyph();
+  for (uint32_t i = 0; i < 5000; ++i)
+    cache.Add(MakeKey(i % 3, i), pGlyph);
+  EXPECT_EQ(5000u, cache.GetCount());
+
+  cache.RemoveFace(1);
+  CFX_RetainPtr<CFX_GlyphBitmap> pFound;
+  for (uint32_t i = 0; i < 5000; ++i)
+    EXPECT_EQ(i % 3 != 1, cache.Find(MakeKey(i % 3, i), &pFound)) << i;
+  EXPECT_EQ(3333u, cache.GetCount());
+}
+
+TEST(CFX_GlyphCache, EvictsLeastRecentlyUsed) {
+  CFX_GlyphCache cache;
+  for (uint32_t i = 0; i < 1000; ++i)
+    cache.Add(MakeKey(0, i), MakeGlyph());
+  size_t size = cache.GetSize();
+  EXPECT_LT(0u, size);
+
+  // Halving the limit drops old glyphs, not the most recently used ones.
+  CFX_RetainPtr<CFX_GlyphBitmap> pFound;
+  ASSERT_TRUE(cache.Find(MakeKey(0, 0), &pFound));
+  cache.SetLimit(size / 2);
+  EXPECT_GE(size / 2, cache.GetSize());
+  EXPECT_GT(1000u, cache.GetCount());
+  EXPECT_TRUE(cache.Find(MakeKey(0, 0), &pFound));
+  EXPECT_TRUE(cache.Find(MakeKey(0, 999), &pFound));
+
+  // An evicted glyph stays alive for whoever still holds it.
+  cache.SetLimit(0);
+  EXPECT_EQ(0u, cache.GetCount());
+  EXPECT_EQ(0u, cache.GetSize());
+  EXPECT_EQ(16, pFound->m_pBitmap->GetWidth());
+}
+
+TEST(CFX_GlyphCache, RemoveFaceAfterEviction) {
+  CFX_GlyphCache cache;
+  for (uint32_t i = 0; i < 3000; ++i)
+    cache.Add(MakeKey(i % 5, i), MakeGlyph());
+  // Replacing a glyph keeps a single entry for it.
+  for (uint32_t i = 0; i < 3000; i += 7)
+    cache.Add(MakeKey(i % 5, i), MakeGlyph());
+  EXPECT_EQ(3000u, cache.GetCount());
+
+  cache.SetLimit(cache.GetSize() / 3);
+  size_t count = cache.GetCount();
+  CFX_RetainPtr<CFX_GlyphBitmap> pFound;
+  size_t face_count = 0;
+  for (uint32_t i = 2; i < 3000; i += 5)
+    face_count += cache.Find(MakeKey(2, i), &pFound);
+  EXPECT_LT(0u, face_count);
+
+  cache.RemoveFace(2);
+  cache.RemoveFace(7);
+  EXPECT_EQ(count - face_count, cache.GetCount());
+  for (uint32_t i = 0; i < 3000; ++i) {
+    if (i % 5 == 2)
+      EXPECT_FALSE(cache.Find(MakeKey(2, i), &pFound)) << i;
+  }
+
+  // The face can be cached again after it was removed.
+  cache.Add(MakeKey(2, 2), MakeGlyph());
+  EXPECT_TRUE(cache.Find(MakeKey(2, 2), &pFound));
+  cache.RemoveFace(2);
+  EXPECT_FALSE(cache.Find(MakeKey(2, 2), &pFound));
+}
+
+// Compares glyph lookups against the string keyed map the cache replaced,
+// and times dropping one face from a full cache. Run with
+// --gtest_also_run_disabled_tests --gtest_filter=*GlyphCacheSpeed.
+TEST(CFX_GlyphCache, DISABLED_GlyphCacheSpeed) {
+  const uint32_t kFaces = 200;
+  const uint32_t kGlyphs = 100;
+  const int kRounds = 50;
+  CFX_GlyphCache cache;
+  cache.SetLimit(1024 * 1024 * 1024);
+  std::map<CFX_ByteString, std::map<uint32_t, CFX_RetainPtr<CFX_GlyphBitmap>>>
+      string_cache;
+  CFX_RetainPtr<CFX_GlyphBitmap> pGlyph = MakeGlyph();
+  for (uint32_t face = 0; face < kFaces; ++face) {
+    for (uint32_t glyph = 0; glyph < kGlyphs; ++glyph) {
+      CFX_GlyphCache::Key key = MakeKey(face, glyph);
+      cache.Add(key, pGlyph);
+      string_cache[MakeStringKey(key)][glyph] = pGlyph;
+    }
+  }
+
+  const double lookups = static_cast<double>(kFaces) * kGlyphs * kRounds;
+  CFX_RetainPtr<CFX_GlyphBitmap> pFound;
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < kRounds; ++round) {
+    for (uint32_t face = 0; face < kFaces; ++face) {
+      for (uint32_t glyph = 0; glyph < kGlyphs; ++glyph)
+        ASSERT_TRUE(cache.Find(MakeKey(face, glyph), &pFound));
+    }
+  }
+  printf("Glyph lookup, hashed key: %.1f ns\n",
+         SecondsSince(start) * 1e9 / lookups);
+
+  start = std::chrono::steady_clock::now();
+  for (int round = 0; round < kRounds; ++round) {
+    for (uint32_t face = 0; face < kFaces; ++face) {
+      for (uint32_t glyph = 0; glyph < kGlyphs; ++glyph) {
+        const auto& glyphs = string_cache[MakeStringKey(MakeKey(face, glyph))];
+        ASSERT_TRUE(glyphs.find(glyph) != glyphs.end());
+      }
+    }
+  }
+  printf("Glyph lookup, string key: %.1f ns\n",
+         SecondsSince(start) * 1e9 / lookups);
+
+  start = std::chrono::steady_clock::now();
+  for (uint32_t face = 0; face < kFaces; ++face)
+    cache.RemoveFace(face);
+  EXPECT_EQ(0u, cache.GetCount());
+  printf("RemoveFace of %u glyphs among %u: %.1f us\n", kGlyphs,
+         kFaces * kGlyphs, SecondsSince(start) * 1e6 / kFaces);
+}
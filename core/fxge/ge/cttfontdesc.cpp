@@ -8,31 +8,13 @@
 
 #include "core/fxge/fx_freetype.h"
 
+CTTFontDesc::CTTFontDesc(uint8_t* pFontData, uint32_t size)
+    : m_pFontData(pFontData), m_dwSize(size), m_RefCount(0) {}
+
 CTTFontDesc::~CTTFontDesc() {
-  if (m_Type == 1) {
-    if (m_SingleFace)
-      FXFT_Done_Face(m_SingleFace);
-  } else if (m_Type == 2) {
-    for (int i = 0; i < 16; i++) {
-      if (m_TTCFaces[i])
-        FXFT_Done_Face(m_TTCFaces[i]);
-    }
-  }
   FX_Free(m_pFontData);
 }
 
-int CTTFontDesc::ReleaseFace(FXFT_Face face) {
-  if (m_Type == 1) {
-    if (m_SingleFace != face)
-      return -1;
-  } else if (m_Type == 2) {
-    int i;
-    for (i = 0; i < 16; i++) {
-      if (m_TTCFaces[i] == face)
-        break;
-    }
-    if (i == 16)
-      return -1;
-  }
-  return --m_RefCount;
+bool CTTFontDesc::HasFace(FXFT_Face face) const {
+  return FXFT_Get_Face_Stream_Base(face) == m_pFontData;
 }
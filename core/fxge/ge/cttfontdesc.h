@@ -18,22 +18,21 @@
 #define FX_FONT_FLAG_SYMBOLIC_DINGBATS 0x20
 #define FX_FONT_FLAG_MULTIPLEMASTER 0x40
 
+// Font data loaded from the system, cached by CFX_FontMgr. Every user of the
+// font gets its own face over the shared data, so that faces are never used
+// by two documents at once.
 class CTTFontDesc {
  public:
-  CTTFontDesc() : m_Type(0), m_pFontData(nullptr), m_RefCount(0) {}
+  // Takes ownership of |pFontData|, which must come from FX_Alloc().
+  CTTFontDesc(uint8_t* pFontData, uint32_t size);
   ~CTTFontDesc();
-  // ret < 0, releaseface not appropriate for this object.
-  // ret == 0, object released
-  // ret > 0, object still alive, other referrers.
-  int ReleaseFace(FXFT_Face face);
-
-  int m_Type;
-
-  union {
-    FXFT_Face m_SingleFace;
-    FXFT_Face m_TTCFaces[16];
-  };
-  uint8_t* m_pFontData;
+
+  // Returns whether |face| was created over this font data.
+  bool HasFace(FXFT_Face face) const;
+
+  uint8_t* const m_pFontData;
+  const uint32_t m_dwSize;
+  // The number of faces created over the font data that are still alive.
   int m_RefCount;
 };
 
@@ -28,7 +28,7 @@ void ResetTransform(FT_Face face) {
 
 }  // namespace
 
-FXTEXT_GLYPHPOS::FXTEXT_GLYPHPOS() : m_pGlyph(nullptr) {}
+FXTEXT_GLYPHPOS::FXTEXT_GLYPHPOS() {}
 
 FXTEXT_GLYPHPOS::FXTEXT_GLYPHPOS(const FXTEXT_GLYPHPOS&) = default;
 
@@ -50,7 +50,7 @@ FX_RECT FXGE_GetGlyphsBBox(const std::vector<FXTEXT_GLYPHPOS>& glyphs,
   FX_RECT rect(0, 0, 0, 0);
   bool bStarted = false;
   for (const FXTEXT_GLYPHPOS& glyph : glyphs) {
-    const CFX_GlyphBitmap* pGlyph = glyph.m_pGlyph;
+    const CFX_GlyphBitmap* pGlyph = glyph.m_pGlyph.Get();
     if (!pGlyph)
       continue;
 
@@ -105,10 +105,6 @@ FX_RECT FXGE_GetGlyphsBBox(const std::vector<FXTEXT_GLYPHPOS>& glyphs,
   return rect;
 }
 
-CFX_SizeGlyphCache::CFX_SizeGlyphCache() {}
-
-CFX_SizeGlyphCache::~CFX_SizeGlyphCache() {}
-
 void CFX_UniqueKeyGen::Generate(int count, ...) {
   va_list argList;
   va_start(argList, count);
@@ -20,12 +20,4 @@ struct CFX_UniqueKeyGen {
   int m_KeyLen;
 };
 
-class CFX_SizeGlyphCache {
- public:
-  CFX_SizeGlyphCache();
-  ~CFX_SizeGlyphCache();
-
-  std::map<uint32_t, std::unique_ptr<CFX_GlyphBitmap>> m_GlyphMap;
-};
-
 #endif  // CORE_FXGE_GE_FX_TEXT_INT_H_
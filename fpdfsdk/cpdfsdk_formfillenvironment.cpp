@@ -234,6 +234,15 @@ CPDFSDK_FormFillEnvironment::GetInteractiveFormFiller() {
 
 void CPDFSDK_FormFillEnvironment::Invalidate(FPDF_PAGE page,
                                              const FX_RECT& rect) {
+  UnderlyingPageType* pPage = UnderlyingFromFPDFPage(page);
+  CPDFSDK_PageView* pPageView = pPage ? GetPageView(pPage, false) : nullptr;
+  if (pPageView) {
+    // |rect| has been truncated to whole page units, so widen it by one.
+    CFX_FloatRect rcPage(rect);
+    rcPage.Normalize();
+    rcPage.Inflate(1, 1);
+    pPageView->InvalidateRetainedBitmap(rcPage);
+  }
   if (m_pInfo && m_pInfo->FFI_Invalidate) {
     m_pInfo->FFI_Invalidate(m_pInfo, page, rect.left, rect.top, rect.right,
                             rect.bottom);
@@ -671,6 +680,11 @@ CPDFSDK_InterForm* CPDFSDK_FormFillEnvironment::GetInterForm() {
   return m_pInterForm.get();
 }
 
+void CPDFSDK_FormFillEnvironment::DiscardRetainedBitmaps() {
+  for (const auto& it : m_PageMap)
+    it.second->DiscardRetainedBitmap();
+}
+
 void CPDFSDK_FormFillEnvironment::UpdateAllViews(CPDFSDK_PageView* pSender,
                                                  CPDFSDK_Annot* pAnnot) {
   for (const auto& it : m_PageMap) {
@@ -41,6 +41,8 @@ class CPDFSDK_FormFillEnvironment
   CPDFSDK_PageView* GetCurrentView();
   void RemovePageView(UnderlyingPageType* pPage);
   void UpdateAllViews(CPDFSDK_PageView* pSender, CPDFSDK_Annot* pAnnot);
+  // Makes the next FORM_RenderPageBitmap() call draw every page in full.
+  void DiscardRetainedBitmaps();
 
   CPDFSDK_Annot* GetFocusAnnot() { return m_pFocusAnnot.Get(); }
   bool SetFocusAnnot(CPDFSDK_Annot::ObservedPtr* pAnnot);
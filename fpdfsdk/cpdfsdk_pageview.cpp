@@ -13,6 +13,8 @@
 #include "core/fpdfapi/render/cpdf_renderoptions.h"
 #include "core/fpdfdoc/cpdf_annotlist.h"
 #include "core/fpdfdoc/cpdf_interform.h"
+#include "core/fxge/cfx_renderdevice.h"
+#include "core/fxge/dib/cfx_dibitmap.h"
 #include "fpdfsdk/cpdfsdk_annot.h"
 #include "fpdfsdk/cpdfsdk_annothandlermgr.h"
 #include "fpdfsdk/cpdfsdk_annotiteration.h"
@@ -57,6 +59,11 @@ CPDFSDK_PageView::CPDFSDK_PageView(CPDFSDK_FormFillEnvironment* pFormFillEnv,
 #endif  // PDF_ENABLE_XFA
 }
 
+CPDFSDK_PageView::RetainedBitmap::RetainedBitmap()
+    : m_Rotate(0), m_Flags(0), m_EditGeneration(0) {}
+
+CPDFSDK_PageView::RetainedBitmap::~RetainedBitmap() {}
+
 CPDFSDK_PageView::~CPDFSDK_PageView() {
 #ifndef PDF_ENABLE_XFA
   // The call to |ReleaseAnnot| can cause the page pointed to by |m_page| to
@@ -120,10 +127,24 @@ void CPDFSDK_PageView::PageView_OnDraw(CFX_RenderDevice* pDevice,
 #endif  // PDF_ENABLE_XFA
 
   // for pdf/static xfa.
+  CPDFSDK_AnnotHandlerMgr* pAnnotHandlerMgr =
+      m_pFormFillEnv->GetAnnotHandlerMgr();
+  FX_RECT rcClip = pDevice->GetClipBox();
   CPDFSDK_AnnotIteration annotIteration(this, true);
   for (const auto& pSDKAnnot : annotIteration) {
-    m_pFormFillEnv->GetAnnotHandlerMgr()->Annot_OnDraw(
-        this, pSDKAnnot.Get(), pDevice, pUser2Device, pOptions->m_bDrawAnnots);
+    // Skip annotations entirely outside the clip, such as when only an
+    // invalidated area is being drawn.
+    CFX_FloatRect rcView =
+        pAnnotHandlerMgr->Annot_OnGetViewBBox(this, pSDKAnnot.Get());
+    pUser2Device->TransformRect(rcView);
+    rcView.Inflate(1, 1);
+    FX_RECT rcDevice = rcView.GetOuterRect();
+    rcDevice.Intersect(rcClip);
+    if (rcDevice.IsEmpty())
+      continue;
+
+    pAnnotHandlerMgr->Annot_OnDraw(this, pSDKAnnot.Get(), pDevice,
+                                   pUser2Device, pOptions->m_bDrawAnnots);
   }
 }
 
@@ -439,6 +460,16 @@ void CPDFSDK_PageView::UpdateView(CPDFSDK_Annot* pAnnot) {
   m_pFormFillEnv->Invalidate(m_page, rcWindow.ToFxRect());
 }
 
+void CPDFSDK_PageView::InvalidateRetainedBitmap(const CFX_FloatRect& rect) {
+  if (!m_RetainedBitmap.m_pBitmap || rect.IsEmpty())
+    return;
+
+  if (m_RetainedBitmap.m_DirtyRect.IsEmpty())
+    m_RetainedBitmap.m_DirtyRect = rect;
+  else
+    m_RetainedBitmap.m_DirtyRect.Union(rect);
+}
+
 int CPDFSDK_PageView::GetPageIndex() const {
   if (!m_page)
     return -1;
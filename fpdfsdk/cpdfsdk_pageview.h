@@ -11,9 +11,11 @@
 #include <vector>
 
 #include "core/fpdfapi/page/cpdf_page.h"
+#include "core/fxcrt/cfx_retain_ptr.h"
 #include "core/fxcrt/fx_system.h"
 #include "fpdfsdk/cpdfsdk_annot.h"
 
+class CFX_DIBitmap;
 class CFX_RenderDevice;
 class CPDF_AnnotList;
 class CPDF_RenderOptions;
@@ -76,6 +78,25 @@ class CPDFSDK_PageView final : public CPDF_Page::View {
   void UpdateRects(const std::vector<CFX_FloatRect>& rects);
   void UpdateView(CPDFSDK_Annot* pAnnot);
 
+  // The page image that FORM_RenderPageBitmap() keeps between calls, the
+  // arguments it was drawn with, and the part of it that has gone stale.
+  struct RetainedBitmap {
+    RetainedBitmap();
+    ~RetainedBitmap();
+
+    CFX_RetainPtr<CFX_DIBitmap> m_pBitmap;
+    FX_RECT m_PageRect;
+    int m_Rotate;
+    int m_Flags;
+    uint32_t m_EditGeneration;  // Of the page when last drawn in full.
+    CFX_FloatRect m_DirtyRect;  // In page space.
+  };
+  RetainedBitmap* GetRetainedBitmap() { return &m_RetainedBitmap; }
+  // Adds |rect|, in page space, to the area of the retained bitmap to draw
+  // again.
+  void InvalidateRetainedBitmap(const CFX_FloatRect& rect);
+  void DiscardRetainedBitmap() { m_RetainedBitmap.m_pBitmap.Reset(); }
+
   int GetPageIndex() const;
 
   void SetValid(bool bValid) { m_bValid = bValid; }
@@ -104,6 +125,7 @@ class CPDFSDK_PageView final : public CPDF_Page::View {
   std::vector<CPDFSDK_Annot*> m_SDKAnnotArray;
   CPDFSDK_FormFillEnvironment* const m_pFormFillEnv;  // Not owned.
   CPDFSDK_Annot::ObservedPtr m_pCaptureWidget;
+  RetainedBitmap m_RetainedBitmap;
 #ifndef PDF_ENABLE_XFA
   bool m_bOwnsPage;
 #endif  // PDF_ENABLE_XFA
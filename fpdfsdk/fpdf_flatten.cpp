@@ -276,6 +276,7 @@ DLLEXPORT int STDCALL FPDFPage_Flatten(FPDF_PAGE page, int nFlag) {
   else
     rcOriginalCB = rcOriginalMB;
 
+  pPage->SetEdited();
   if (!rcOriginalMB.IsEmpty()) {
     CPDF_Array* pMediaBox = pPageDict->SetNewFor<CPDF_Array>("MediaBox");
     pMediaBox->AddNew<CPDF_Number>(rcOriginalMB.left);
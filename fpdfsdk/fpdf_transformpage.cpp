@@ -33,6 +33,7 @@ void SetBoundingBox(CPDF_Page* page,
   pBoundingBoxArray->AddNew<CPDF_Number>(bottom);
   pBoundingBoxArray->AddNew<CPDF_Number>(right);
   pBoundingBoxArray->AddNew<CPDF_Number>(top);
+  page->SetEdited();
 }
 
 bool GetBoundingBox(CPDF_Page* page,
@@ -192,6 +193,7 @@ DLLEXPORT FPDF_BOOL STDCALL FPDFPage_TransFormWithClip(FPDF_PAGE page,
     }
   }
 
+  pPage->SetEdited();
   return true;
 }
 
@@ -213,6 +215,7 @@ FPDFPageObj_TransformClipPath(FPDF_PAGEOBJECT page_object,
   if (!pPageObj->IsShading())
     pPageObj->TransformClipPath(matrix);
   pPageObj->TransformGeneralState(matrix);
+  pPageObj->SetEdited();
 }
 
 DLLEXPORT FPDF_CLIPPATH STDCALL FPDF_CreateClipPath(float left,
@@ -307,6 +310,7 @@ DLLEXPORT void STDCALL FPDFPage_InsertClipPath(FPDF_PAGE page,
       nullptr, 0,
       pdfium::MakeUnique<CPDF_Dictionary>(pDoc->GetByteStringPool()));
   pStream->SetData(strClip.GetBuffer(), strClip.GetSize());
+  pPage->SetEdited();
 
   CPDF_Array* pArray = ToArray(pContentObj);
   if (pArray) {
@@ -9,6 +9,7 @@
 #include "core/fpdfapi/cpdf_modulemgr.h"
 #include "core/fpdfapi/page/cpdf_image.h"
 #include "core/fpdfapi/page/cpdf_imageobject.h"
+#include "core/fpdfapi/page/cpdf_page.h"
 #include "core/fpdfapi/page/cpdf_pageobject.h"
 #include "fpdfsdk/fsdk_define.h"
 #include "third_party/base/ptr_util.h"
@@ -28,8 +29,10 @@ bool LoadJpegHelper(FPDF_PAGE* pages,
   CPDF_ImageObject* pImgObj = reinterpret_cast<CPDF_ImageObject*>(image_object);
   for (int index = 0; index < nCount; index++) {
     CPDF_Page* pPage = CPDFPageFromFPDFPage(pages[index]);
-    if (pPage)
+    if (pPage) {
       pImgObj->GetImage()->ResetCache(pPage, nullptr);
+      pPage->SetEdited();
+    }
   }
 
   if (inlineJpeg)
@@ -89,6 +92,7 @@ DLLEXPORT FPDF_BOOL STDCALL FPDFImageObj_SetMatrix(FPDF_PAGEOBJECT image_object,
                                  static_cast<float>(c), static_cast<float>(d),
                                  static_cast<float>(e), static_cast<float>(f)));
   pImgObj->CalcBoundingBox();
+  pImgObj->SetEdited();
   return true;
 }
 
@@ -102,11 +106,14 @@ DLLEXPORT FPDF_BOOL STDCALL FPDFImageObj_SetBitmap(FPDF_PAGE* pages,
   CPDF_ImageObject* pImgObj = reinterpret_cast<CPDF_ImageObject*>(image_object);
   for (int index = 0; index < nCount; index++) {
     CPDF_Page* pPage = CPDFPageFromFPDFPage(pages[index]);
-    if (pPage)
+    if (pPage) {
       pImgObj->GetImage()->ResetCache(pPage, nullptr);
+      pPage->SetEdited();
+    }
   }
   CFX_RetainPtr<CFX_DIBitmap> holder(CFXBitmapFromFPDFBitmap(bitmap));
   pImgObj->GetImage()->SetImage(holder);
   pImgObj->CalcBoundingBox();
+  pImgObj->SetEdited();
   return true;
 }
@@ -147,7 +147,8 @@ DLLEXPORT void STDCALL FPDFPage_InsertObject(FPDF_PAGE page,
   if (!IsPageObject(pPage))
     return;
 
-  pPage->GetPageObjectList()->push_back(std::move(pPageObjHolder));
+  pPage->AppendPageObject(std::move(pPageObjHolder));
+  pPage->SetEdited();
   switch (pPageObj->GetType()) {
     case CPDF_PageObject::TEXT: {
       break;
@@ -191,6 +192,7 @@ DLLEXPORT FPDF_PAGEOBJECT STDCALL FPDFPage_GetObject(FPDF_PAGE page,
   CPDF_Page* pPage = CPDFPageFromFPDFPage(page);
   if (!IsPageObject(pPage))
     return nullptr;
+
   return pPage->GetPageObjectList()->GetPageObjectByIndex(index);
 }
 
@@ -248,6 +250,7 @@ DLLEXPORT FPDF_BOOL STDCALL FPDFPage_GenerateContent(FPDF_PAGE page) {
 
   CPDF_PageContentGenerator CG(pPage);
   CG.GenerateContent();
+  pPage->SetEdited();
   return true;
 }
 
@@ -264,6 +267,7 @@ DLLEXPORT void STDCALL FPDFPageObj_Transform(FPDF_PAGEOBJECT page_object,
 
   CFX_Matrix matrix((float)a, (float)b, (float)c, (float)d, (float)e, (float)f);
   pPageObj->Transform(matrix);
+  pPageObj->SetEdited();
 }
 
 DLLEXPORT void STDCALL FPDFPage_TransformAnnots(FPDF_PAGE page,
@@ -277,6 +281,7 @@ DLLEXPORT void STDCALL FPDFPage_TransformAnnots(FPDF_PAGE page,
   if (!pPage)
     return;
 
+  pPage->SetEdited();
   CPDF_AnnotList AnnotList(pPage);
   for (size_t i = 0; i < AnnotList.Count(); ++i) {
     CPDF_Annot* pAnnot = AnnotList.GetAt(i);
@@ -306,4 +311,5 @@ DLLEXPORT void STDCALL FPDFPage_SetRotation(FPDF_PAGE page, int rotate) {
   CPDF_Dictionary* pDict = pPage->m_pFormDict;
   rotate %= 4;
   pDict->SetNewFor<CPDF_Number>("Rotate", rotate * 90);
+  pPage->SetEdited();
 }
@@ -9,6 +9,7 @@
 #include <memory>
 #include <vector>
 
+#include "core/fpdfapi/cpdf_pagerendercontext.h"
 #include "core/fpdfapi/page/cpdf_page.h"
 #include "core/fpdfapi/parser/cpdf_document.h"
 #include "core/fpdfapi/render/cpdf_renderoptions.h"
@@ -17,6 +18,7 @@
 #include "core/fpdfdoc/cpdf_interform.h"
 #include "core/fpdfdoc/cpdf_occontext.h"
 #include "core/fxge/cfx_fxgedevice.h"
+#include "core/fxge/dib/cfx_dibitmap.h"
 #include "fpdfsdk/cpdfsdk_formfillenvironment.h"
 #include "fpdfsdk/cpdfsdk_interform.h"
 #include "fpdfsdk/cpdfsdk_pageview.h"
@@ -75,6 +77,58 @@ FPDF_STRINGHANDLE ToFPDFStringHandle(std::vector<CFX_ByteString>* strings) {
 }
 #endif  // PDF_ENABLE_XFA
 
+// Draws the form fields of |pPage| onto |pDevice|, within |clip|.
+void DrawFormFields(FPDF_FORMHANDLE hHandle,
+                    UnderlyingPageType* pPage,
+                    CFX_RenderDevice* pDevice,
+                    const CFX_Matrix& matrix,
+                    const FX_RECT& clip,
+                    int flags) {
+#ifdef PDF_ENABLE_XFA
+  CPDFXFA_Context* pContext = pPage->GetContext();
+  if (!pContext)
+    return;
+  CPDF_Document* pPDFDoc = pContext->GetPDFDoc();
+  if (!pPDFDoc)
+    return;
+  CPDFSDK_FormFillEnvironment* pFormFillEnv =
+      HandleToCPDFSDKEnvironment(hHandle);
+  if (!pFormFillEnv)
+    return;
+#endif  // PDF_ENABLE_XFA
+
+  CFX_Matrix user2device = matrix;
+  CFX_RenderDevice::StateRestorer restorer(pDevice);
+  pDevice->SetClip_Rect(clip);
+
+  CPDF_RenderOptions options;
+  if (flags & FPDF_LCD_TEXT)
+    options.m_Flags |= RENDER_CLEARTYPE;
+  else
+    options.m_Flags &= ~RENDER_CLEARTYPE;
+
+  // Grayscale output
+  if (flags & FPDF_GRAYSCALE) {
+    options.m_ColorMode = RENDER_COLOR_GRAY;
+    options.m_ForeColor = 0;
+    options.m_BackColor = 0xffffff;
+  }
+  options.m_AddFlags = flags >> 8;
+  options.m_bDrawAnnots = flags & FPDF_ANNOT;
+
+#ifdef PDF_ENABLE_XFA
+  options.m_pOCContext =
+      pdfium::MakeRetain<CPDF_OCContext>(pPDFDoc, CPDF_OCContext::View);
+  if (CPDFSDK_PageView* pPageView = pFormFillEnv->GetPageView(pPage, true))
+    pPageView->PageView_OnDraw(pDevice, &user2device, &options, clip);
+#else   // PDF_ENABLE_XFA
+  options.m_pOCContext = pdfium::MakeRetain<CPDF_OCContext>(
+      pPage->m_pDocument, CPDF_OCContext::View);
+  if (CPDFSDK_PageView* pPageView = FormHandleToPageView(hHandle, pPage))
+    pPageView->PageView_OnDraw(pDevice, &user2device, &options);
+#endif  // PDF_ENABLE_XFA
+}
+
 void FFLCommon(FPDF_FORMHANDLE hHandle,
                FPDF_BITMAP bitmap,
                FPDF_RECORDER recorder,
@@ -92,19 +146,6 @@ void FFLCommon(FPDF_FORMHANDLE hHandle,
   if (!pPage)
     return;
 
-#ifdef PDF_ENABLE_XFA
-  CPDFXFA_Context* pContext = pPage->GetContext();
-  if (!pContext)
-    return;
-  CPDF_Document* pPDFDoc = pContext->GetPDFDoc();
-  if (!pPDFDoc)
-    return;
-  CPDFSDK_FormFillEnvironment* pFormFillEnv =
-      HandleToCPDFSDKEnvironment(hHandle);
-  if (!pFormFillEnv)
-    return;
-#endif  // PDF_ENABLE_XFA
-
   CFX_Matrix matrix =
       pPage->GetDisplayMatrix(start_x, start_y, size_x, size_y, rotate);
   FX_RECT clip(start_x, start_y, start_x + size_x, start_y + size_y);
@@ -115,37 +156,7 @@ void FFLCommon(FPDF_FORMHANDLE hHandle,
 #endif
   CFX_RetainPtr<CFX_DIBitmap> holder(CFXBitmapFromFPDFBitmap(bitmap));
   pDevice->Attach(holder, false, nullptr, false);
-  {
-    CFX_RenderDevice::StateRestorer restorer(pDevice.get());
-    pDevice->SetClip_Rect(clip);
-
-    CPDF_RenderOptions options;
-    if (flags & FPDF_LCD_TEXT)
-      options.m_Flags |= RENDER_CLEARTYPE;
-    else
-      options.m_Flags &= ~RENDER_CLEARTYPE;
-
-    // Grayscale output
-    if (flags & FPDF_GRAYSCALE) {
-      options.m_ColorMode = RENDER_COLOR_GRAY;
-      options.m_ForeColor = 0;
-      options.m_BackColor = 0xffffff;
-    }
-    options.m_AddFlags = flags >> 8;
-    options.m_bDrawAnnots = flags & FPDF_ANNOT;
-
-#ifdef PDF_ENABLE_XFA
-    options.m_pOCContext =
-        pdfium::MakeRetain<CPDF_OCContext>(pPDFDoc, CPDF_OCContext::View);
-    if (CPDFSDK_PageView* pPageView = pFormFillEnv->GetPageView(pPage, true))
-      pPageView->PageView_OnDraw(pDevice.get(), &matrix, &options, clip);
-#else   // PDF_ENABLE_XFA
-    options.m_pOCContext = pdfium::MakeRetain<CPDF_OCContext>(
-        pPage->m_pDocument, CPDF_OCContext::View);
-    if (CPDFSDK_PageView* pPageView = FormHandleToPageView(hHandle, pPage))
-      pPageView->PageView_OnDraw(pDevice.get(), &matrix, &options);
-#endif  // PDF_ENABLE_XFA
-  }
+  DrawFormFields(hHandle, pPage, pDevice.get(), matrix, clip, flags);
 #ifdef _SKIA_SUPPORT_PATHS_
   pDevice->Flush();
   holder->UnPreMultiply();
@@ -424,6 +435,101 @@ DLLEXPORT void STDCALL FPDF_FFLRecord(FPDF_FORMHANDLE hHandle,
 }
 #endif
 
+DLLEXPORT void STDCALL FORM_RenderPageBitmap(FPDF_FORMHANDLE hHandle,
+                                             FPDF_BITMAP bitmap,
+                                             FPDF_PAGE page,
+                                             int start_x,
+                                             int start_y,
+                                             int size_x,
+                                             int size_y,
+                                             int rotate,
+                                             int flags) {
+  if (!bitmap)
+    return;
+
+  CPDFSDK_PageView* pPageView = FormHandleToPageView(hHandle, page);
+  if (!pPageView)
+    return;
+
+  UnderlyingPageType* pPage = UnderlyingFromFPDFPage(page);
+  CPDF_Page* pPDFPage = CPDFPageFromFPDFPage(page);
+  uint32_t edit_generation = pPDFPage ? pPDFPage->GetEditGeneration() : 0;
+  CFX_RetainPtr<CFX_DIBitmap> pBitmap(CFXBitmapFromFPDFBitmap(bitmap));
+  FX_RECT page_rect(start_x, start_y, start_x + size_x, start_y + size_y);
+  FX_RECT visible_rect = page_rect;
+  visible_rect.Intersect(0, 0, pBitmap->GetWidth(), pBitmap->GetHeight());
+  if (visible_rect.IsEmpty())
+    return;
+
+  CFX_Matrix matrix =
+      pPage->GetDisplayMatrix(start_x, start_y, size_x, size_y, rotate);
+  CPDFSDK_PageView::RetainedBitmap* pRetained = pPageView->GetRetainedBitmap();
+  FX_RECT draw_rect = visible_rect;
+  if (!pRetained->m_pBitmap ||
+      pRetained->m_pBitmap->GetWidth() != pBitmap->GetWidth() ||
+      pRetained->m_pBitmap->GetHeight() != pBitmap->GetHeight() ||
+      pRetained->m_pBitmap->GetFormat() != pBitmap->GetFormat() ||
+      !(pRetained->m_PageRect == page_rect) || pRetained->m_Rotate != rotate ||
+      pRetained->m_Flags != flags ||
+      pRetained->m_EditGeneration != edit_generation) {
+    pRetained->m_pBitmap = pdfium::MakeRetain<CFX_DIBitmap>();
+    if (!pRetained->m_pBitmap->Create(pBitmap->GetWidth(),
+                                      pBitmap->GetHeight(),
+                                      pBitmap->GetFormat())) {
+      pRetained->m_pBitmap.Reset();
+      return;
+    }
+    pRetained->m_PageRect = page_rect;
+    pRetained->m_Rotate = rotate;
+    pRetained->m_Flags = flags;
+    pRetained->m_EditGeneration = edit_generation;
+  } else if (pRetained->m_DirtyRect.IsEmpty()) {
+    draw_rect = FX_RECT();
+  } else {
+    CFX_FloatRect dirty_rect = pRetained->m_DirtyRect;
+    matrix.TransformRect(dirty_rect);
+    dirty_rect.Inflate(1, 1);
+    draw_rect.Intersect(dirty_rect.GetOuterRect());
+  }
+  pRetained->m_DirtyRect.Reset();
+
+  CFX_RetainPtr<CFX_DIBitmap> pRetainedBitmap = pRetained->m_pBitmap;
+  if (!draw_rect.IsEmpty()) {
+    CFX_FxgeDevice device;
+    device.Attach(pRetainedBitmap, false, nullptr, false);
+    device.FillRect(&draw_rect, 0xFFFFFFFF);
+
+    if (pPDFPage) {
+      CPDF_PageRenderContext* pContext = new CPDF_PageRenderContext;
+      pPDFPage->SetRenderContext(pdfium::WrapUnique(pContext));
+      CFX_FxgeDevice* pDevice = new CFX_FxgeDevice;
+      pContext->m_pDevice.reset(pDevice);
+      pDevice->Attach(pRetainedBitmap, !!(flags & FPDF_REVERSE_BYTE_ORDER),
+                      nullptr, false);
+      // The page is drawn clipped to both this and the page rect.
+      pDevice->SetClip_Rect(draw_rect);
+      FPDF_RenderPage_Retail(pContext, page, start_x, start_y, size_x, size_y,
+                             rotate, flags, true, nullptr);
+#ifdef _SKIA_SUPPORT_PATHS_
+      pDevice->Flush();
+      pRetainedBitmap->UnPreMultiply();
+#endif
+      pPDFPage->SetRenderContext(nullptr);
+    }
+
+    DrawFormFields(hHandle, pPage, &device, matrix, draw_rect, flags);
+#ifdef _SKIA_SUPPORT_PATHS_
+    device.Flush();
+    pRetainedBitmap->UnPreMultiply();
+#endif
+  }
+
+  pBitmap->TransferBitmap(visible_rect.left, visible_rect.top,
+                          visible_rect.Width(), visible_rect.Height(),
+                          pRetainedBitmap, visible_rect.left,
+                          visible_rect.top);
+}
+
 #ifdef PDF_ENABLE_XFA
 DLLEXPORT void STDCALL FPDF_Widget_Undo(FPDF_DOCUMENT document,
                                         FPDF_WIDGET hWidget) {
@@ -640,19 +746,25 @@ FPDF_StringHandleAddString(FPDF_STRINGHANDLE stringHandle,
 DLLEXPORT void STDCALL FPDF_SetFormFieldHighlightColor(FPDF_FORMHANDLE hHandle,
                                                        int fieldType,
                                                        unsigned long color) {
-  if (CPDFSDK_InterForm* pInterForm = FormHandleToInterForm(hHandle))
+  if (CPDFSDK_InterForm* pInterForm = FormHandleToInterForm(hHandle)) {
     pInterForm->SetHighlightColor(color, fieldType);
+    pInterForm->GetFormFillEnv()->DiscardRetainedBitmaps();
+  }
 }
 
 DLLEXPORT void STDCALL FPDF_SetFormFieldHighlightAlpha(FPDF_FORMHANDLE hHandle,
                                                        unsigned char alpha) {
-  if (CPDFSDK_InterForm* pInterForm = FormHandleToInterForm(hHandle))
+  if (CPDFSDK_InterForm* pInterForm = FormHandleToInterForm(hHandle)) {
     pInterForm->SetHighlightAlpha(alpha);
+    pInterForm->GetFormFillEnv()->DiscardRetainedBitmaps();
+  }
 }
 
 DLLEXPORT void STDCALL FPDF_RemoveFormFieldHighlight(FPDF_FORMHANDLE hHandle) {
-  if (CPDFSDK_InterForm* pInterForm = FormHandleToInterForm(hHandle))
+  if (CPDFSDK_InterForm* pInterForm = FormHandleToInterForm(hHandle)) {
     pInterForm->RemoveAllHighLight();
+    pInterForm->GetFormFillEnv()->DiscardRetainedBitmaps();
+  }
 }
 
 DLLEXPORT void STDCALL FORM_OnAfterLoadPage(FPDF_PAGE page,
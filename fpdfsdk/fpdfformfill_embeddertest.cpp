@@ -2,11 +2,17 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <cstring>
 #include <memory>
 #include <string>
 
 #include "core/fxcrt/fx_system.h"
+#include "core/fxge/fx_dib.h"
+#include "fpdfsdk/cpdfsdk_formfillenvironment.h"
+#include "fpdfsdk/cpdfsdk_pageview.h"
+#include "fpdfsdk/fsdk_define.h"
 #include "public/cpp/fpdf_deleters.h"
+#include "public/fpdf_edit.h"
 #include "public/fpdf_formfill.h"
 #include "testing/embedder_test.h"
 #include "testing/embedder_test_mock_delegate.h"
@@ -19,6 +25,66 @@ using testing::Return;
 
 class FPDFFormFillEmbeddertest : public EmbedderTest, public TestSaver {};
 
+namespace {
+
+bool BitmapsMatch(FPDF_BITMAP bitmap1, FPDF_BITMAP bitmap2) {
+  int height = FPDFBitmap_GetHeight(bitmap1);
+  int stride = FPDFBitmap_GetStride(bitmap1);
+  return height == FPDFBitmap_GetHeight(bitmap2) &&
+         stride == FPDFBitmap_GetStride(bitmap2) &&
+         memcmp(FPDFBitmap_GetBuffer(bitmap1), FPDFBitmap_GetBuffer(bitmap2),
+                stride * height) == 0;
+}
+
+// Paints |color| over the copy of |page| that FORM_RenderPageBitmap() keeps,
+// so that the areas it does not draw again show up in its output.
+void MarkRetainedBitmap(FPDF_FORMHANDLE form_handle,
+                        FPDF_PAGE page,
+                        uint32_t color) {
+  CPDFSDK_FormFillEnvironment* pFormFillEnv =
+      static_cast<CPDFSDK_FormFillEnvironment*>(form_handle);
+  CPDFSDK_PageView* pPageView =
+      pFormFillEnv->GetPageView(UnderlyingFromFPDFPage(page), false);
+  ASSERT_TRUE(pPageView);
+  ASSERT_TRUE(pPageView->GetRetainedBitmap()->m_pBitmap);
+  pPageView->GetRetainedBitmap()->m_pBitmap->Clear(color);
+}
+
+// Returns how many pixels of |bitmap| have the colour of |color|, after
+// checking that all the others match |expected|. Both bitmaps are BGRx.
+int CountMarkedPixels(FPDF_BITMAP bitmap,
+                      FPDF_BITMAP expected,
+                      uint32_t color) {
+  int width = FPDFBitmap_GetWidth(bitmap);
+  int height = FPDFBitmap_GetHeight(bitmap);
+  int stride = FPDFBitmap_GetStride(bitmap);
+  EXPECT_EQ(width, FPDFBitmap_GetWidth(expected));
+  EXPECT_EQ(height, FPDFBitmap_GetHeight(expected));
+  EXPECT_EQ(stride, FPDFBitmap_GetStride(expected));
+  const uint8_t* buffer =
+      static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bitmap));
+  const uint8_t* expected_buffer =
+      static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(expected));
+  int marked = 0;
+  int mismatched = 0;
+  for (int row = 0; row < height; ++row) {
+    for (int col = 0; col < width; ++col) {
+      const uint8_t* pixel = buffer + row * stride + col * 4;
+      const uint8_t* expected_pixel = expected_buffer + row * stride + col * 4;
+      if (pixel[0] == FXARGB_B(color) && pixel[1] == FXARGB_G(color) &&
+          pixel[2] == FXARGB_R(color)) {
+        ++marked;
+      } else if (memcmp(pixel, expected_pixel, 3) != 0) {
+        ++mismatched;
+      }
+    }
+  }
+  EXPECT_EQ(0, mismatched);
+  return marked;
+}
+
+}  // namespace
+
 TEST_F(FPDFFormFillEmbeddertest, FirstTest) {
   EmbedderTestMockDelegate mock;
   EXPECT_CALL(mock, Alert(_, _, _, _)).Times(0);
@@ -203,6 +269,120 @@ TEST_F(FPDFFormFillEmbeddertest, BUG_679649) {
 
 #endif  // PDF_ENABLE_V8
 
+TEST_F(FPDFFormFillEmbeddertest, RenderPageBitmapRetained) {
+  EXPECT_TRUE(OpenDocument("text_form.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_TRUE(page);
+  auto check_render = [this, page]() {
+    std::unique_ptr<void, FPDFBitmapDeleter> expected(RenderPage(page));
+    std::unique_ptr<void, FPDFBitmapDeleter> bitmap(
+        FPDFBitmap_Create(300, 300, 0));
+    FORM_RenderPageBitmap(form_handle(), bitmap.get(), page, 0, 0, 300, 300,
+                          0, 0);
+    EXPECT_TRUE(BitmapsMatch(expected.get(), bitmap.get()));
+  };
+  check_render();
+  // Nothing has changed, so this comes from the retained bitmap alone.
+  check_render();
+
+  // Click on the textfield and write "ABC", which only redraws the field.
+  FORM_OnMouseMove(form_handle(), page, 0, 120.0, 120.0);
+  FORM_OnLButtonDown(form_handle(), page, 0, 120.0, 120.0);
+  FORM_OnLButtonUp(form_handle(), page, 0, 120.0, 120.0);
+  FORM_OnChar(form_handle(), page, 65, 0);
+  FORM_OnChar(form_handle(), page, 66, 0);
+  FORM_OnChar(form_handle(), page, 67, 0);
+  check_render();
+
+  // Take out focus by clicking out of the textfield.
+  FORM_OnMouseMove(form_handle(), page, 0, 15.0, 15.0);
+  FORM_OnLButtonDown(form_handle(), page, 0, 15.0, 15.0);
+  FORM_OnLButtonUp(form_handle(), page, 0, 15.0, 15.0);
+  check_render();
+
+  UnloadPage(page);
+}
+
+TEST_F(FPDFFormFillEmbeddertest, RenderPageBitmapRedrawsInvalidatedAreas) {
+  const uint32_t kMark = 0xFF00FF00;
+  const int kPixels = 300 * 300;
+  EXPECT_TRUE(OpenDocument("text_form.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_TRUE(page);
+  std::unique_ptr<void, FPDFBitmapDeleter> bitmap(
+      FPDFBitmap_Create(300, 300, 0));
+  FORM_RenderPageBitmap(form_handle(), bitmap.get(), page, 0, 0, 300, 300, 0,
+                        0);
+
+  // Nothing has changed, so nothing is drawn again.
+  MarkRetainedBitmap(form_handle(), page, kMark);
+  FORM_RenderPageBitmap(form_handle(), bitmap.get(), page, 0, 0, 300, 300, 0,
+                        0);
+  {
+    std::unique_ptr<void, FPDFBitmapDeleter> expected(RenderPage(page));
+    EXPECT_EQ(kPixels,
+              CountMarkedPixels(bitmap.get(), expected.get(), kMark));
+  }
+
+  // Writing "ABC" into the textfield draws the field again, and only that.
+  MarkRetainedBitmap(form_handle(), page, kMark);
+  FORM_OnMouseMove(form_handle(), page, 0, 120.0, 120.0);
+  FORM_OnLButtonDown(form_handle(), page, 0, 120.0, 120.0);
+  FORM_OnLButtonUp(form_handle(), page, 0, 120.0, 120.0);
+  FORM_OnChar(form_handle(), page, 65, 0);
+  FORM_OnChar(form_handle(), page, 66, 0);
+  FORM_OnChar(form_handle(), page, 67, 0);
+  FORM_RenderPageBitmap(form_handle(), bitmap.get(), page, 0, 0, 300, 300, 0,
+                        0);
+  {
+    std::unique_ptr<void, FPDFBitmapDeleter> expected(RenderPage(page));
+    int marked = CountMarkedPixels(bitmap.get(), expected.get(), kMark);
+    EXPECT_GT(marked, kPixels * 3 / 4);
+    EXPECT_LT(marked, kPixels);
+  }
+
+  UnloadPage(page);
+}
+
+TEST_F(FPDFFormFillEmbeddertest, RenderPageBitmapAfterEdit) {
+  const uint32_t kMark = 0xFF00FF00;
+  EXPECT_TRUE(OpenDocument("text_form.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_TRUE(page);
+  std::unique_ptr<void, FPDFBitmapDeleter> bitmap(
+      FPDFBitmap_Create(300, 300, 0));
+  FORM_RenderPageBitmap(form_handle(), bitmap.get(), page, 0, 0, 300, 300, 0,
+                        0);
+  std::unique_ptr<void, FPDFBitmapDeleter> original(RenderPage(page));
+
+  // Edits do not go through FFI_Invalidate, but still draw the whole page.
+  MarkRetainedBitmap(form_handle(), page, kMark);
+  FPDF_PAGEOBJECT rect = FPDFPageObj_CreateNewRect(20, 20, 60, 60);
+  ASSERT_TRUE(rect);
+  EXPECT_TRUE(FPDFPath_SetFillColor(rect, 0, 0, 255, 255));
+  EXPECT_TRUE(FPDFPath_SetDrawMode(rect, FPDF_FILLMODE_ALTERNATE, 0));
+  FPDFPage_InsertObject(page, rect);
+  FORM_RenderPageBitmap(form_handle(), bitmap.get(), page, 0, 0, 300, 300, 0,
+                        0);
+  {
+    std::unique_ptr<void, FPDFBitmapDeleter> expected(RenderPage(page));
+    EXPECT_FALSE(BitmapsMatch(original.get(), expected.get()));
+    EXPECT_TRUE(BitmapsMatch(expected.get(), bitmap.get()));
+  }
+
+  // So does moving an object that is already on the page.
+  MarkRetainedBitmap(form_handle(), page, kMark);
+  FPDFPageObj_Transform(rect, 1, 0, 0, 1, 150, 0);
+  FORM_RenderPageBitmap(form_handle(), bitmap.get(), page, 0, 0, 300, 300, 0,
+                        0);
+  {
+    std::unique_ptr<void, FPDFBitmapDeleter> expected(RenderPage(page));
+    EXPECT_TRUE(BitmapsMatch(expected.get(), bitmap.get()));
+  }
+
+  UnloadPage(page);
+}
+
 TEST_F(FPDFFormFillEmbeddertest, FormText) {
 #if _FXM_PLATFORM_ == _FXM_PLATFORM_APPLE_
   const char md5_1[] = "5f11dbe575fe197a37c3fb422559f8ff";
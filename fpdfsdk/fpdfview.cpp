@@ -6,7 +6,9 @@
 
 #include "public/fpdfview.h"
 
+#include <algorithm>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <vector>
 
@@ -18,14 +20,20 @@
 #include "core/fpdfapi/page/cpdf_pageobject.h"
 #include "core/fpdfapi/parser/cpdf_array.h"
 #include "core/fpdfapi/parser/cpdf_document.h"
+#include "core/fpdfapi/parser/cpdf_parser.h"
+#include "core/fpdfapi/parser/cpdf_xref_cache.h"
 #include "core/fpdfapi/parser/fpdf_parser_decode.h"
+#include "core/fpdfapi/render/cpdf_docrenderdata.h"
+#include "core/fpdfapi/render/cpdf_imagecache.h"
 #include "core/fpdfapi/render/cpdf_progressiverenderer.h"
 #include "core/fpdfapi/render/cpdf_renderoptions.h"
 #include "core/fpdfdoc/cpdf_annotlist.h"
 #include "core/fpdfdoc/cpdf_nametree.h"
 #include "core/fpdfdoc/cpdf_occontext.h"
 #include "core/fpdfdoc/cpdf_viewerpreferences.h"
+#include "core/fxcodec/JBig2_DocumentContext.h"
 #include "core/fxcodec/fx_codec.h"
+#include "core/fxcrt/cfx_threadpool.h"
 #include "core/fxcrt/fx_memory.h"
 #include "core/fxcrt/fx_safe_types.h"
 #include "core/fxge/cfx_fxgedevice.h"
@@ -411,6 +419,9 @@ FPDF_InitLibraryWithConfig(const FPDF_LIBRARY_CONFIG* cfg) {
 #endif  // PDF_ENABLE_XFA
   if (cfg && cfg->version >= 2)
     IJS_Runtime::Initialize(cfg->m_v8EmbedderSlot, cfg->m_pIsolate);
+
+  if (cfg && cfg->version >= 3 && cfg->m_pXRefCacheDir)
+    pModuleMgr->SetXRefCacheDir(cfg->m_pXRefCacheDir);
 }
 
 DLLEXPORT void STDCALL FPDF_DestroyLibrary() {
@@ -502,6 +513,10 @@ DLLEXPORT FPDF_DOCUMENT STDCALL FPDF_LoadDocument(FPDF_STRING file_path,
   auto pParser = pdfium::MakeUnique<CPDF_Parser>();
   pParser->SetPassword(password);
 
+  const CFX_ByteString& cache_dir = CPDF_ModuleMgr::Get()->GetXRefCacheDir();
+  if (!cache_dir.IsEmpty())
+    pParser->SetXRefCache(pdfium::MakeUnique<CPDF_XRefCache>(cache_dir));
+
   auto pDocument = pdfium::MakeUnique<CPDF_Document>(std::move(pParser));
   CPDF_Parser::Error error =
       pDocument->GetParser()->StartParse(pFileAccess, pDocument.get());
@@ -564,6 +579,7 @@ class CMemFile final : public IFX_SeekableReadStream {
     memcpy(buffer, m_pBuf + offset, size);
     return true;
   }
+  const uint8_t* GetDirectBuffer() override { return m_pBuf; }
 
  private:
   CMemFile(uint8_t* pBuf, FX_FILESIZE size) : m_pBuf(pBuf), m_size(size) {}
@@ -656,6 +672,58 @@ DLLEXPORT int STDCALL FPDF_GetPageCount(FPDF_DOCUMENT document) {
   return pDoc ? pDoc->GetPageCount() : 0;
 }
 
+DLLEXPORT void STDCALL FPDF_SetImageCacheLimit(FPDF_DOCUMENT document,
+                                               unsigned long limit) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (pDoc)
+    pDoc->GetRenderData()->GetImageCache()->SetLimit(limit);
+}
+
+DLLEXPORT FPDF_BOOL STDCALL
+FPDF_GetImageCacheStats(FPDF_DOCUMENT document, FPDF_IMAGE_CACHE_STATS* stats) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pDoc || !stats)
+    return false;
+
+  CPDF_ImageCache* pImageCache = pDoc->GetRenderData()->GetImageCache();
+  stats->hits = pImageCache->GetHitCount();
+  stats->misses = pImageCache->GetMissCount();
+  stats->evictions = pImageCache->GetEvictionCount();
+  stats->count = pImageCache->GetCount();
+  stats->size = pImageCache->GetSize();
+  return true;
+}
+
+DLLEXPORT void STDCALL FPDF_SetJBig2CacheLimit(FPDF_DOCUMENT document,
+                                               unsigned long limit) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pDoc)
+    return;
+
+  std::unique_ptr<JBig2_DocumentContext>* pContext = pDoc->CodecContext();
+  if (!*pContext)
+    *pContext = pdfium::MakeUnique<JBig2_DocumentContext>();
+  (*pContext)->GetSymbolDictCache()->SetMaxBytes(limit);
+}
+
+DLLEXPORT FPDF_BOOL STDCALL
+FPDF_GetJBig2CacheStats(FPDF_DOCUMENT document, FPDF_IMAGE_CACHE_STATS* stats) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pDoc || !stats)
+    return false;
+
+  std::unique_ptr<JBig2_DocumentContext>* pContext = pDoc->CodecContext();
+  if (!*pContext)
+    *pContext = pdfium::MakeUnique<JBig2_DocumentContext>();
+  const CJBig2_SymbolDictCache* pCache = (*pContext)->GetSymbolDictCache();
+  stats->hits = pCache->hits();
+  stats->misses = pCache->misses();
+  stats->evictions = pCache->evictions();
+  stats->count = pCache->size();
+  stats->size = pCache->size_in_bytes();
+  return true;
+}
+
 DLLEXPORT FPDF_PAGE STDCALL FPDF_LoadPage(FPDF_DOCUMENT document,
                                           int page_index) {
   UnderlyingDocumentType* pDoc = UnderlyingFromFPDFDocument(document);
@@ -987,6 +1055,346 @@ DLLEXPORT void STDCALL FPDF_RenderPageBitmapWithMatrix(FPDF_BITMAP bitmap,
   pPage->SetRenderContext(nullptr);
 }
 
+namespace {
+
+// Serializes reads from a stream shared by several documents, since streams
+// themselves are not thread-safe.
+class CLockedReadStream final : public IFX_SeekableReadStream {
+ public:
+  template <typename T, typename... Args>
+  friend CFX_RetainPtr<T> pdfium::MakeRetain(Args&&... args);
+
+  // IFX_SeekableReadStream
+  FX_FILESIZE GetSize() override { return m_Size; }
+  bool ReadBlock(void* buffer, FX_FILESIZE offset, size_t size) override {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_pFile->ReadBlock(buffer, offset, size);
+  }
+  const uint8_t* GetDirectBuffer() override { return m_pDirectBuf; }
+
+ private:
+  explicit CLockedReadStream(
+      const CFX_RetainPtr<IFX_SeekableReadStream>& pFile)
+      : m_pFile(pFile),
+        m_Size(pFile->GetSize()),
+        m_pDirectBuf(pFile->GetDirectBuffer()) {}
+
+  std::mutex m_Mutex;
+  CFX_RetainPtr<IFX_SeekableReadStream> m_pFile;
+  const FX_FILESIZE m_Size;
+  const uint8_t* const m_pDirectBuf;
+};
+
+size_t GetRenderThreadCount(int thread_count) {
+  return thread_count > 0 ? static_cast<size_t>(thread_count)
+                          : CFX_ThreadPool::GetDefaultThreadCount();
+}
+
+// Opens |count| copies of |pDoc| in |pCopies|, one for each rendering thread,
+// so that the threads do not contend for the locks on its objects and caches.
+// They reuse the cross reference table of |pDoc|, so opening them costs little
+// more than reading the page tree. Returns false if |pDoc| was not loaded from
+// a file.
+bool CopyDocument(CPDF_Document* pDoc,
+                  size_t count,
+                  std::vector<std::unique_ptr<CPDF_Document>>* pCopies) {
+  CPDF_Parser* pParser = pDoc->GetParser();
+  if (!pParser)
+    return false;
+
+  auto pFile = pdfium::MakeRetain<CLockedReadStream>(pParser->GetFileAccess());
+  for (size_t i = 0; i < count; ++i) {
+    auto pCopy =
+        pdfium::MakeUnique<CPDF_Document>(pdfium::MakeUnique<CPDF_Parser>());
+    // Other threads may be loading objects of |pDoc| through |pParser|, so
+    // it is locked while each copy reads its tables, and no longer.
+    std::lock_guard<std::recursive_mutex> lock(*pDoc->GetObjectMutex());
+    if (pCopy->GetParser()->StartParseFrom(*pParser, pFile, pCopy.get()) !=
+        CPDF_Parser::SUCCESS) {
+      return false;
+    }
+    pCopies->push_back(std::move(pCopy));
+  }
+  return true;
+}
+
+FPDF_BITMAP RenderPageOfCopy(CPDF_Document* pDoc,
+                             int page_index,
+                             const FPDF_PAGE_RENDER_PARAMS& params,
+                             FPDF_RENDER_PAGES_SINK* sink) {
+  if (params.size_x <= 0 || params.size_y <= 0)
+    return nullptr;
+
+  CPDF_Dictionary* pDict = pDoc->GetPage(page_index);
+  if (!pDict)
+    return nullptr;
+
+  FPDF_BITMAP bitmap;
+  if (sink->AllocBitmap) {
+    bitmap = sink->AllocBitmap(sink, page_index, params.size_x, params.size_y);
+  } else {
+    bitmap = FPDFBitmap_Create(params.size_x, params.size_y, 0);
+    if (bitmap)
+      FPDFBitmap_FillRect(bitmap, 0, 0, params.size_x, params.size_y,
+                          0xFFFFFFFF);
+  }
+  if (!bitmap)
+    return nullptr;
+
+  CPDF_Page page(pDoc, pDict, true);
+  page.ParseContent();
+
+  CPDF_PageRenderContext context;
+  CFX_FxgeDevice* pDevice = new CFX_FxgeDevice;
+  context.m_pDevice.reset(pDevice);
+  // Every thread of the pool is busy with a page already.
+  context.m_pOptions = pdfium::MakeUnique<CPDF_RenderOptions>();
+  context.m_pOptions->m_Flags |= RENDER_NO_THREADS;
+
+  CFX_RetainPtr<CFX_DIBitmap> pBitmap(CFXBitmapFromFPDFBitmap(bitmap));
+  pDevice->Attach(pBitmap, !!(params.flags & FPDF_REVERSE_BYTE_ORDER), nullptr,
+                  false);
+  RenderPageImpl(&context, &page,
+                 page.GetDisplayMatrix(0, 0, params.size_x, params.size_y,
+                                       params.rotate),
+                 FX_RECT(0, 0, params.size_x, params.size_y), params.flags,
+                 true, nullptr);
+
+#ifdef _SKIA_SUPPORT_PATHS_
+  pDevice->Flush();
+  pBitmap->UnPreMultiply();
+#endif
+  return bitmap;
+}
+
+}  // namespace
+
+DLLEXPORT FPDF_BOOL STDCALL
+FPDF_RenderPagesParallel(FPDF_DOCUMENT document,
+                         int start_page,
+                         int page_count,
+                         const FPDF_PAGE_RENDER_PARAMS* params,
+                         int thread_count,
+                         FPDF_RENDER_PAGES_SINK* sink) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pDoc || !params || !sink || sink->version != 1 || !sink->PageRendered)
+    return false;
+
+  if (!pDoc->GetParser() || start_page < 0 || page_count < 0 ||
+      start_page > pDoc->GetPageCount() - page_count) {
+    return false;
+  }
+
+  size_t nThreads = std::min(GetRenderThreadCount(thread_count),
+                             static_cast<size_t>(page_count));
+  if (nThreads == 0)
+    return true;
+
+  std::vector<std::unique_ptr<CPDF_Document>> copies;
+  if (!CopyDocument(pDoc, nThreads, &copies))
+    return false;
+
+  CFX_ThreadPool pool(nThreads);
+  pool.Run(page_count, [start_page, params, sink, &copies](size_t index,
+                                                           size_t worker) {
+    int page_index = start_page + static_cast<int>(index);
+    FPDF_BITMAP bitmap = RenderPageOfCopy(copies[worker].get(), page_index,
+                                          params[index], sink);
+    sink->PageRendered(sink, page_index, bitmap);
+  });
+  return true;
+}
+
+namespace {
+
+const int kTileSize = 512;
+
+// Renders the |tile| part of |pBitmap| in place. Tiles are rendered with the
+// matrix of the whole bitmap and clipped to their part of it, so that glyphs
+// and paths that cross the seams land on the same pixels as when rendering
+// everything at once.
+void RenderTile(CPDF_Page* pPage,
+                const CFX_RetainPtr<CFX_DIBitmap>& pBitmap,
+                const CFX_Matrix& matrix,
+                const FX_RECT& tile,
+                int flags) {
+  CFX_RetainPtr<CFX_DIBitmap> pTarget = pBitmap;
+  CFX_Matrix tile_matrix = matrix;
+  FX_RECT clip = tile;
+#ifdef _SKIA_SUPPORT_PATHS_
+  // Skia premultiplies all of the bitmap it draws to, so every tile gets a
+  // bitmap of its own that shares the buffer.
+  pTarget = pdfium::MakeRetain<CFX_DIBitmap>();
+  pTarget->Create(tile.Width(), tile.Height(), pBitmap->GetFormat(),
+                  pBitmap->GetBuffer() + tile.top * pBitmap->GetPitch() +
+                      tile.left * pBitmap->GetBPP() / 8,
+                  pBitmap->GetPitch());
+  tile_matrix.Translate(static_cast<float>(-tile.left),
+                        static_cast<float>(-tile.top));
+  clip = FX_RECT(0, 0, tile.Width(), tile.Height());
+#endif
+
+  CPDF_PageRenderContext context;
+  CFX_FxgeDevice* pDevice = new CFX_FxgeDevice;
+  context.m_pDevice.reset(pDevice);
+  // Every thread of the pool is busy with a tile already.
+  context.m_pOptions = pdfium::MakeUnique<CPDF_RenderOptions>();
+  context.m_pOptions->m_Flags |= RENDER_NO_THREADS;
+  pDevice->Attach(pTarget, !!(flags & FPDF_REVERSE_BYTE_ORDER), nullptr,
+                  false);
+  RenderPageImpl(&context, pPage, tile_matrix, clip, flags, true, nullptr);
+
+#ifdef _SKIA_SUPPORT_PATHS_
+  pDevice->Flush();
+  pTarget->UnPreMultiply();
+#endif
+}
+
+// Marks the tiles of |clip| that |rect| overlaps in |pNeeded|, which has
+// |cols| tiles per row.
+void MarkTiles(CFX_FloatRect rect,
+               const CFX_Matrix& matrix,
+               const FX_RECT& clip,
+               int cols,
+               std::vector<bool>* pNeeded) {
+  matrix.TransformRect(rect);
+  FX_RECT device_rect = rect.GetOuterRect();
+  // Allow for anti-aliasing and bounding boxes that are slightly off.
+  device_rect.left -= 2;
+  device_rect.top -= 2;
+  device_rect.right += 2;
+  device_rect.bottom += 2;
+  device_rect.Intersect(clip);
+  if (device_rect.IsEmpty())
+    return;
+
+  int first_col = (device_rect.left - clip.left) / kTileSize;
+  int last_col = (device_rect.right - 1 - clip.left) / kTileSize;
+  int first_row = (device_rect.top - clip.top) / kTileSize;
+  int last_row = (device_rect.bottom - 1 - clip.top) / kTileSize;
+  for (int row = first_row; row <= last_row; ++row) {
+    for (int col = first_col; col <= last_col; ++col)
+      (*pNeeded)[row * cols + col] = true;
+  }
+}
+
+// Whether |pPage| still renders the same when loaded again from the file, so
+// that threads can render it from copies of its document.
+bool IsPageAsInFile(CPDF_Page* pPage, int flags) {
+  if (pPage->IsEdited())
+    return false;
+
+  // Generated contents, imported pages and other additions all get new
+  // object numbers.
+  CPDF_Document* pDoc = pPage->m_pDocument;
+  CPDF_Parser* pParser = pDoc->GetParser();
+  if (!pParser || pDoc->GetLastObjNum() > pParser->GetLastObjNum())
+    return false;
+
+  // Form filling rewrites widget appearances in place.
+  return !(flags & FPDF_ANNOT) || !pDoc->GetRoot() ||
+         !pDoc->GetRoot()->KeyExist("AcroForm");
+}
+
+}  // namespace
+
+DLLEXPORT void STDCALL
+FPDF_RenderPageBitmapWithMatrixTiled(FPDF_BITMAP bitmap,
+                                     FPDF_PAGE page,
+                                     const FS_MATRIX* matrix,
+                                     const FS_RECTF* clipping,
+                                     int flags,
+                                     int thread_count) {
+  if (!bitmap || !clipping)
+    return;
+
+  CPDF_Page* pPage = CPDFPageFromFPDFPage(page);
+  if (!pPage)
+    return;
+
+  CFX_RetainPtr<CFX_DIBitmap> pBitmap(CFXBitmapFromFPDFBitmap(bitmap));
+  if (pBitmap->GetBPP() % 8 != 0)
+    return;
+
+  CFX_Matrix transform_matrix = pPage->GetPageMatrix();
+  if (matrix) {
+    transform_matrix.Concat(CFX_Matrix(matrix->a, matrix->b, matrix->c,
+                                       matrix->d, matrix->e, matrix->f));
+  }
+
+  FX_RECT clip = CFX_FloatRect(clipping->left, clipping->bottom,
+                               clipping->right, clipping->top)
+                     .ToFxRect();
+  clip.Intersect(FX_RECT(0, 0, pBitmap->GetWidth(), pBitmap->GetHeight()));
+  if (clip.IsEmpty())
+    return;
+
+  // Tiles that no page object or annotation reaches are left alone.
+  int cols = (clip.Width() + kTileSize - 1) / kTileSize;
+  int rows = (clip.Height() + kTileSize - 1) / kTileSize;
+  std::vector<bool> needed(cols * rows);
+  for (const auto& pPageObj : *pPage->GetPageObjectList())
+    MarkTiles(pPageObj->GetRect(), transform_matrix, clip, cols, &needed);
+  CPDF_Array* pAnnots = pPage->m_pFormDict->GetArrayFor("Annots");
+  if ((flags & FPDF_ANNOT) && pAnnots) {
+    for (size_t i = 0; i < pAnnots->GetCount(); ++i) {
+      CPDF_Dictionary* pAnnot = pAnnots->GetDictAt(i);
+      if (pAnnot) {
+        MarkTiles(pAnnot->GetRectFor("Rect"), transform_matrix, clip, cols,
+                  &needed);
+      }
+    }
+  }
+
+  std::vector<FX_RECT> tiles;
+  for (int row = 0; row < rows; ++row) {
+    for (int col = 0; col < cols; ++col) {
+      if (!needed[row * cols + col])
+        continue;
+
+      int left = clip.left + col * kTileSize;
+      int top = clip.top + row * kTileSize;
+      tiles.push_back(FX_RECT(left, top, std::min(left + kTileSize, clip.right),
+                              std::min(top + kTileSize, clip.bottom)));
+    }
+  }
+
+  size_t nThreads =
+      std::min(GetRenderThreadCount(thread_count), tiles.size());
+  CPDF_Document* pDoc = pPage->m_pDocument;
+  int page_index = pDoc->GetPageIndex(pPage->m_pFormDict->GetObjNum());
+  std::vector<std::unique_ptr<CPDF_Document>> copies;
+  bool bCopied = nThreads > 1 && page_index >= 0 &&
+                 IsPageAsInFile(pPage, flags) &&
+                 CopyDocument(pDoc, nThreads, &copies);
+  // Pages that were moved or deleted since loading are elsewhere in the file.
+  for (size_t i = 0; bCopied && i < copies.size(); ++i) {
+    CPDF_Dictionary* pDict = copies[i]->GetPage(page_index);
+    bCopied = pDict && pDict->GetObjNum() == pPage->m_pFormDict->GetObjNum();
+  }
+  if (!bCopied) {
+    for (const FX_RECT& tile : tiles)
+      RenderTile(pPage, pBitmap, transform_matrix, tile, flags);
+    return;
+  }
+
+  // Every thread parses the page of its own document copy once, then renders
+  // whichever tiles it picks up.
+  std::vector<std::unique_ptr<CPDF_Page>> pages(nThreads);
+  CFX_ThreadPool pool(nThreads);
+  pool.Run(tiles.size(), [&](size_t index, size_t worker) {
+    std::unique_ptr<CPDF_Page>& pWorkerPage = pages[worker];
+    if (!pWorkerPage) {
+      CPDF_Document* pCopy = copies[worker].get();
+      pWorkerPage = pdfium::MakeUnique<CPDF_Page>(
+          pCopy, pCopy->GetPage(page_index), true);
+      pWorkerPage->ParseContent();
+    }
+    RenderTile(pWorkerPage.get(), pBitmap, transform_matrix, tiles[index],
+               flags);
+  });
+}
+
 #ifdef _SKIA_SUPPORT_
 DLLEXPORT FPDF_RECORDER STDCALL FPDF_RenderPageSkp(FPDF_PAGE page,
                                                    int size_x,
@@ -141,6 +141,7 @@ int CheckPDFiumCApi() {
     CHK(FPDF_SetFormFieldHighlightAlpha);
     CHK(FPDF_RemoveFormFieldHighlight);
     CHK(FPDF_FFLDraw);
+    CHK(FORM_RenderPageBitmap);
 #ifdef PDF_ENABLE_XFA
     CHK(FPDF_HasXFAField);
     CHK(FPDF_LoadXFA);
@@ -241,12 +242,18 @@ int CheckPDFiumCApi() {
     CHK(FPDF_GetDocPermissions);
     CHK(FPDF_GetSecurityHandlerRevision);
     CHK(FPDF_GetPageCount);
+    CHK(FPDF_SetImageCacheLimit);
+    CHK(FPDF_GetImageCacheStats);
+    CHK(FPDF_SetJBig2CacheLimit);
+    CHK(FPDF_GetJBig2CacheStats);
     CHK(FPDF_LoadPage);
     CHK(FPDF_GetPageWidth);
     CHK(FPDF_GetPageHeight);
     CHK(FPDF_GetPageSizeByIndex);
     CHK(FPDF_RenderPageBitmap);
     CHK(FPDF_RenderPageBitmapWithMatrix);
+    CHK(FPDF_RenderPageBitmapWithMatrixTiled);
+    CHK(FPDF_RenderPagesParallel);
     CHK(FPDF_ClosePage);
     CHK(FPDF_CloseDocument);
     CHK(FPDF_DeviceToPage);
@@ -2,13 +2,21 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <cstring>
 #include <limits>
+#include <map>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "fpdfsdk/fpdfview_c_api_test.h"
+#include "public/fpdf_edit.h"
+#include "public/fpdf_progressive.h"
 #include "public/fpdfview.h"
 #include "testing/embedder_test.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "testing/utils/path_service.h"
 
 TEST(fpdf, CApiTest) {
   EXPECT_TRUE(CheckPDFiumCApi());
@@ -378,3 +386,596 @@ TEST_F(FPDFViewEmbeddertest, FPDF_RenderPageBitmapWithMatrix) {
 
   UnloadPage(page);
 }
+
+TEST_F(FPDFViewEmbeddertest, ImageCacheSharedAcrossPageLoads) {
+  EXPECT_TRUE(OpenDocument("tagged_alt_text.pdf"));
+
+  FPDF_IMAGE_CACHE_STATS stats;
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_EQ(0u, stats.hits);
+  EXPECT_EQ(0u, stats.misses);
+  EXPECT_EQ(0u, stats.count);
+
+  // The second load of the page reuses the image decoded for the first.
+  for (int i = 0; i < 2; ++i) {
+    FPDF_PAGE page = LoadPage(0);
+    ASSERT_TRUE(page);
+    FPDF_BITMAP bitmap = RenderPage(page);
+    FPDFBitmap_Destroy(bitmap);
+    UnloadPage(page);
+  }
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(1u, stats.misses);
+  EXPECT_EQ(1u, stats.count);
+  EXPECT_LT(0u, stats.size);
+
+  // A zero limit empties the cache.
+  FPDF_SetImageCacheLimit(document(), 0);
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_EQ(0u, stats.count);
+  EXPECT_EQ(0u, stats.size);
+  EXPECT_EQ(1u, stats.evictions);
+}
+
+TEST_F(FPDFViewEmbeddertest, ImageCacheSkipsHugeImages) {
+  // An 8000x8000 8-bit image, which decodes rows as they are drawn and so
+  // cannot be shared between pages.
+  EXPECT_TRUE(OpenDocument("huge_image.pdf"));
+  for (int i = 0; i < 2; ++i) {
+    FPDF_PAGE page = LoadPage(0);
+    ASSERT_TRUE(page);
+    FPDF_BITMAP bitmap = RenderPage(page);
+    FPDFBitmap_Destroy(bitmap);
+    UnloadPage(page);
+  }
+
+  FPDF_IMAGE_CACHE_STATS stats;
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_EQ(0u, stats.hits);
+  EXPECT_EQ(2u, stats.misses);
+  EXPECT_EQ(0u, stats.count);
+  EXPECT_EQ(0u, stats.size);
+}
+
+TEST_F(FPDFViewEmbeddertest, ImageCacheReplacesDownScaledJpeg) {
+  // A 512x512 DCTDecode image covering the whole 512x512 page.
+  EXPECT_TRUE(OpenDocument("jpeg_gradient.pdf"));
+  auto render_page = [this](int size) {
+    FPDF_PAGE page = LoadPage(0);
+    ASSERT_TRUE(page);
+    FPDF_BITMAP bitmap = FPDFBitmap_Create(size, size, 0);
+    FPDFBitmap_FillRect(bitmap, 0, 0, size, size, 0xFFFFFFFF);
+    FPDF_RenderPageBitmap(bitmap, page, 0, 0, size, size, 0, 0);
+    FPDFBitmap_Destroy(bitmap);
+    UnloadPage(page);
+  };
+
+  // Drawn at 50x50, the image is decoded at 64x64.
+  render_page(50);
+  FPDF_IMAGE_CACHE_STATS stats;
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_EQ(1u, stats.misses);
+  EXPECT_EQ(1u, stats.count);
+  const unsigned long small_size = stats.size;
+  EXPECT_LT(0u, small_size);
+
+  // That is too small for a 512x512 rendering, so the image is decoded again
+  // at full size, and the new 8 bpp bitmap replaces the old one.
+  render_page(512);
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_EQ(0u, stats.hits);
+  EXPECT_EQ(2u, stats.misses);
+  EXPECT_EQ(1u, stats.count);
+  const unsigned long full_size = small_size + 512 * 512 - 64 * 64;
+  EXPECT_EQ(full_size, stats.size);
+
+  // The full size bitmap serves smaller renderings too.
+  render_page(50);
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(2u, stats.misses);
+  EXPECT_EQ(1u, stats.count);
+  EXPECT_EQ(full_size, stats.size);
+}
+
+TEST_F(FPDFViewEmbeddertest, JBig2CacheLimit) {
+  // Each page draws a JBIG2 image with its own global symbol dictionary.
+  EXPECT_TRUE(OpenDocument("jbig2_globals.pdf"));
+  // Decode the images again every time they are drawn.
+  FPDF_SetImageCacheLimit(document(), 0);
+  auto render_page = [this](int index) {
+    FPDF_PAGE page = LoadPage(index);
+    ASSERT_TRUE(page);
+    FPDF_BITMAP bitmap = RenderPage(page);
+    FPDFBitmap_Destroy(bitmap);
+    UnloadPage(page);
+  };
+  for (int i = 0; i < 3; ++i)
+    render_page(i);
+  render_page(0);
+
+  FPDF_IMAGE_CACHE_STATS stats;
+  ASSERT_TRUE(FPDF_GetJBig2CacheStats(document(), &stats));
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(3u, stats.misses);
+  EXPECT_EQ(0u, stats.evictions);
+  EXPECT_EQ(3u, stats.count);
+  ASSERT_LT(0u, stats.size);
+  const unsigned long dict_size = stats.size / 3;
+
+  // Room for two dictionaries drops the one of page 1, used least recently.
+  FPDF_SetJBig2CacheLimit(document(), dict_size * 2);
+  ASSERT_TRUE(FPDF_GetJBig2CacheStats(document(), &stats));
+  EXPECT_EQ(1u, stats.evictions);
+  EXPECT_EQ(2u, stats.count);
+  EXPECT_EQ(dict_size * 2, stats.size);
+  render_page(0);
+  render_page(1);
+  ASSERT_TRUE(FPDF_GetJBig2CacheStats(document(), &stats));
+  EXPECT_EQ(2u, stats.hits);
+  EXPECT_EQ(4u, stats.misses);
+  EXPECT_EQ(2u, stats.evictions);
+  EXPECT_EQ(2u, stats.count);
+
+  // Dictionaries over the limit are decoded every time and not kept.
+  FPDF_SetJBig2CacheLimit(document(), dict_size - 1);
+  ASSERT_TRUE(FPDF_GetJBig2CacheStats(document(), &stats));
+  EXPECT_EQ(4u, stats.evictions);
+  EXPECT_EQ(0u, stats.count);
+  EXPECT_EQ(0u, stats.size);
+  render_page(2);
+  render_page(2);
+  ASSERT_TRUE(FPDF_GetJBig2CacheStats(document(), &stats));
+  EXPECT_EQ(2u, stats.hits);
+  EXPECT_EQ(6u, stats.misses);
+  EXPECT_EQ(0u, stats.count);
+
+  // A zero limit disables the cache.
+  FPDF_SetJBig2CacheLimit(document(), 0);
+  render_page(2);
+  ASSERT_TRUE(FPDF_GetJBig2CacheStats(document(), &stats));
+  EXPECT_EQ(0u, stats.count);
+  EXPECT_EQ(0u, stats.size);
+}
+
+namespace {
+
+// Loads, renders and closes page |page_index| of |doc|, returning the pixels.
+std::vector<uint8_t> RenderPageToBytes(FPDF_DOCUMENT doc, int page_index) {
+  FPDF_PAGE page = FPDF_LoadPage(doc, page_index);
+  if (!page)
+    return std::vector<uint8_t>();
+
+  int width = static_cast<int>(FPDF_GetPageWidth(page));
+  int height = static_cast<int>(FPDF_GetPageHeight(page));
+  FPDF_BITMAP bitmap = FPDFBitmap_Create(width, height, 0);
+  FPDFBitmap_FillRect(bitmap, 0, 0, width, height, 0xFFFFFFFF);
+  FPDF_RenderPageBitmap(bitmap, page, 0, 0, width, height, 0, 0);
+  const uint8_t* buffer =
+      static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bitmap));
+  std::vector<uint8_t> pixels(buffer,
+                              buffer + FPDFBitmap_GetStride(bitmap) * height);
+  FPDFBitmap_Destroy(bitmap);
+  FPDF_ClosePage(page);
+  return pixels;
+}
+
+}  // namespace
+
+TEST_F(FPDFViewEmbeddertest, RenderFromSeveralThreads) {
+  EXPECT_TRUE(OpenDocument("hello_world.pdf"));
+  FPDF_DOCUMENT other_doc =
+      FPDF_LoadMemDocument(file_contents_.get(), file_length_, nullptr);
+  ASSERT_TRUE(other_doc);
+
+  std::vector<uint8_t> expected = RenderPageToBytes(document(), 0);
+  ASSERT_FALSE(expected.empty());
+
+  // Half of the threads share one document, the other half another one.
+  const size_t kThreads = 4;
+  std::vector<std::vector<uint8_t>> results(kThreads);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kThreads; ++i) {
+    FPDF_DOCUMENT doc = i % 2 ? other_doc : document();
+    threads.emplace_back([doc, &results, i]() {
+      for (int j = 0; j < 3; ++j)
+        results[i] = RenderPageToBytes(doc, 0);
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (size_t i = 0; i < kThreads; ++i)
+    EXPECT_TRUE(expected == results[i]) << i;
+
+  FPDF_CloseDocument(other_doc);
+}
+
+// Meant to be run under ThreadSanitizer (is_tsan = true). The pages share
+// their resources: standard and Type 3 fonts, images in colour spaces with
+// tint transforms, tiling and shading patterns, and a transfer function.
+TEST_F(FPDFViewEmbeddertest, RenderPagesOfOneDocumentFromSeveralThreads) {
+  EXPECT_TRUE(OpenDocument("shared_resources.pdf"));
+  const int kPages = 4;
+  ASSERT_EQ(kPages, FPDF_GetPageCount(document()));
+
+  std::vector<uint8_t> expected[kPages];
+  for (int i = 0; i < kPages; ++i) {
+    expected[i] = RenderPageToBytes(document(), i);
+    ASSERT_FALSE(expected[i].empty());
+  }
+  EXPECT_FALSE(expected[0] == expected[1]);
+
+  // A fresh copy of the document, so that the threads also race to parse
+  // the objects and to fill the caches.
+  FPDF_DOCUMENT doc =
+      FPDF_LoadMemDocument(file_contents_.get(), file_length_, nullptr);
+  ASSERT_TRUE(doc);
+
+  const int kThreads = 4;
+  bool matches[kThreads];
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    matches[i] = true;
+    threads.emplace_back([doc, &expected, &matches, i]() {
+      for (int j = 0; j < 8; ++j) {
+        int page_index = (i + j) % kPages;
+        if (RenderPageToBytes(doc, page_index) != expected[page_index])
+          matches[i] = false;
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (int i = 0; i < kThreads; ++i)
+    EXPECT_TRUE(matches[i]) << i;
+
+  FPDF_CloseDocument(doc);
+}
+
+// Meant to be run under ThreadSanitizer (is_tsan = true). The two documents
+// draw the same DeviceCMYK image, one with the standard conversion used for
+// soft masks, while sharing the stock CMYK colour space.
+TEST_F(FPDFViewEmbeddertest, RenderDifferentDocumentsFromSeveralThreads) {
+  EXPECT_TRUE(OpenDocument("cmyk_image.pdf"));
+  std::string smask_path;
+  ASSERT_TRUE(PathService::GetTestFilePath("cmyk_image_smask.pdf",
+                                           &smask_path));
+  FPDF_DOCUMENT smask_doc = FPDF_LoadDocument(smask_path.c_str(), nullptr);
+  ASSERT_TRUE(smask_doc);
+
+  // Keep the images from being cached so that every render decodes them.
+  FPDF_SetImageCacheLimit(document(), 0);
+  FPDF_SetImageCacheLimit(smask_doc, 0);
+
+  FPDF_DOCUMENT docs[] = {document(), smask_doc};
+  std::vector<uint8_t> expected[2];
+  for (size_t i = 0; i < 2; ++i) {
+    expected[i] = RenderPageToBytes(docs[i], 0);
+    ASSERT_FALSE(expected[i].empty());
+  }
+  EXPECT_FALSE(expected[0] == expected[1]);
+
+  const size_t kThreads = 4;
+  bool matches[kThreads];
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kThreads; ++i) {
+    FPDF_DOCUMENT doc = docs[i % 2];
+    const std::vector<uint8_t>* want = &expected[i % 2];
+    matches[i] = true;
+    threads.emplace_back([doc, want, &matches, i]() {
+      for (int j = 0; j < 20; ++j) {
+        if (RenderPageToBytes(doc, 0) != *want)
+          matches[i] = false;
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (size_t i = 0; i < kThreads; ++i)
+    EXPECT_TRUE(matches[i]) << i;
+
+  FPDF_CloseDocument(smask_doc);
+}
+
+namespace {
+
+struct RenderedPages {
+  FPDF_RENDER_PAGES_SINK sink;
+  std::mutex mutex;
+  std::map<int, std::vector<uint8_t>> pixels;
+};
+
+void CollectRenderedPage(FPDF_RENDER_PAGES_SINK* pThis,
+                         int page_index,
+                         FPDF_BITMAP bitmap) {
+  RenderedPages* pages = static_cast<RenderedPages*>(pThis->user);
+  std::vector<uint8_t> pixels;
+  if (bitmap) {
+    const uint8_t* buffer =
+        static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bitmap));
+    pixels.assign(buffer, buffer + FPDFBitmap_GetStride(bitmap) *
+                                       FPDFBitmap_GetHeight(bitmap));
+    FPDFBitmap_Destroy(bitmap);
+  }
+  std::lock_guard<std::mutex> lock(pages->mutex);
+  EXPECT_EQ(0u, pages->pixels.count(page_index));
+  pages->pixels[page_index] = pixels;
+}
+
+}  // namespace
+
+TEST_F(FPDFViewEmbeddertest, RenderPagesParallel) {
+  EXPECT_TRUE(OpenDocument("annotiter.pdf"));
+  const int kPageCount = 3;
+  ASSERT_EQ(kPageCount, GetPageCount());
+
+  FPDF_PAGE_RENDER_PARAMS params[kPageCount];
+  std::vector<uint8_t> expected[kPageCount];
+  for (int i = 0; i < kPageCount; ++i) {
+    params[i].size_x = 100 + 10 * i;
+    params[i].size_y = 120;
+    params[i].rotate = i;
+    params[i].flags = FPDF_ANNOT;
+
+    FPDF_PAGE page = LoadPage(i);
+    ASSERT_TRUE(page);
+    FPDF_BITMAP bitmap = FPDFBitmap_Create(params[i].size_x, 120, 0);
+    FPDFBitmap_FillRect(bitmap, 0, 0, params[i].size_x, 120, 0xFFFFFFFF);
+    FPDF_RenderPageBitmap(bitmap, page, 0, 0, params[i].size_x, 120, i,
+                          FPDF_ANNOT);
+    const uint8_t* buffer =
+        static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bitmap));
+    expected[i].assign(buffer, buffer + FPDFBitmap_GetStride(bitmap) * 120);
+    FPDFBitmap_Destroy(bitmap);
+    UnloadPage(page);
+  }
+
+  RenderedPages pages;
+  pages.sink.version = 1;
+  pages.sink.AllocBitmap = nullptr;
+  pages.sink.PageRendered = CollectRenderedPage;
+  pages.sink.user = &pages;
+  EXPECT_FALSE(FPDF_RenderPagesParallel(document(), 1, kPageCount, params, 2,
+                                        &pages.sink));
+  EXPECT_TRUE(pages.pixels.empty());
+
+  ASSERT_TRUE(FPDF_RenderPagesParallel(document(), 0, kPageCount, params, 2,
+                                       &pages.sink));
+  ASSERT_EQ(static_cast<size_t>(kPageCount), pages.pixels.size());
+  for (int i = 0; i < kPageCount; ++i)
+    EXPECT_TRUE(expected[i] == pages.pixels[i]) << i;
+
+  // Only the last page, with one thread per processor.
+  pages.pixels.clear();
+  ASSERT_TRUE(FPDF_RenderPagesParallel(document(), 2, 1, &params[2], 0,
+                                       &pages.sink));
+  ASSERT_EQ(1u, pages.pixels.size());
+  EXPECT_TRUE(expected[2] == pages.pixels[2]);
+}
+
+TEST_F(FPDFViewEmbeddertest, RenderPageBitmapWithMatrixTiled) {
+  EXPECT_TRUE(OpenDocument("annotiter.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_TRUE(page);
+
+  // Large enough for several tiles, some of them empty.
+  const int kWidth = 1300;
+  const int kHeight = 1100;
+  FS_MATRIX matrix = {2.5, 0, 0, 2.5, 10, -20};
+  FS_RECTF clipping = {0, 0, kWidth, kHeight};
+  FPDF_BITMAP expected = FPDFBitmap_Create(kWidth, kHeight, 0);
+  FPDFBitmap_FillRect(expected, 0, 0, kWidth, kHeight, 0xFFFFFFFF);
+  FPDF_RenderPageBitmapWithMatrix(expected, page, &matrix, &clipping,
+                                  FPDF_ANNOT);
+  const uint8_t* expected_buffer =
+      static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(expected));
+  size_t size = FPDFBitmap_GetStride(expected) * kHeight;
+
+  for (int threads : {1, 3}) {
+    FPDF_BITMAP bitmap = FPDFBitmap_Create(kWidth, kHeight, 0);
+    FPDFBitmap_FillRect(bitmap, 0, 0, kWidth, kHeight, 0xFFFFFFFF);
+    FPDF_RenderPageBitmapWithMatrixTiled(bitmap, page, &matrix, &clipping,
+                                         FPDF_ANNOT, threads);
+    const uint8_t* buffer =
+        static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bitmap));
+    EXPECT_EQ(0, memcmp(expected_buffer, buffer, size)) << threads;
+    FPDFBitmap_Destroy(bitmap);
+  }
+
+  FPDFBitmap_Destroy(expected);
+  UnloadPage(page);
+}
+
+namespace {
+
+// Renders |page| with and without tiling on several threads, and checks that
+// both give the same pixels.
+void CheckTiledRenderMatches(FPDF_PAGE page) {
+  const int kWidth = 1100;
+  const int kHeight = 1100;
+  FS_MATRIX matrix = {3, 0, 0, 3, 0, 0};
+  FS_RECTF clipping = {0, 0, kWidth, kHeight};
+  FPDF_BITMAP expected = FPDFBitmap_Create(kWidth, kHeight, 0);
+  FPDFBitmap_FillRect(expected, 0, 0, kWidth, kHeight, 0xFFFFFFFF);
+  FPDF_RenderPageBitmapWithMatrix(expected, page, &matrix, &clipping, 0);
+
+  FPDF_BITMAP bitmap = FPDFBitmap_Create(kWidth, kHeight, 0);
+  FPDFBitmap_FillRect(bitmap, 0, 0, kWidth, kHeight, 0xFFFFFFFF);
+  FPDF_RenderPageBitmapWithMatrixTiled(bitmap, page, &matrix, &clipping, 0, 3);
+  EXPECT_EQ(0, memcmp(FPDFBitmap_GetBuffer(expected),
+                      FPDFBitmap_GetBuffer(bitmap),
+                      FPDFBitmap_GetStride(expected) * kHeight));
+  FPDFBitmap_Destroy(bitmap);
+  FPDFBitmap_Destroy(expected);
+}
+
+}  // namespace
+
+TEST_F(FPDFViewEmbeddertest, RenderTextBitmapWithMatrixTiled) {
+  EXPECT_TRUE(OpenDocument("hello_world.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_TRUE(page);
+
+  // Moves the text across the tile seams at 512 and 1024 pixels in small
+  // steps, so that glyphs get cut at different places.
+  const int kWidth = 1100;
+  const int kHeight = 1100;
+  FS_RECTF clipping = {0, 0, kWidth, kHeight};
+  for (int step = 0; step < 12; ++step) {
+    FS_MATRIX matrix = {3.5f, 0, 0, 3.5f, 41.3f * step, 7.7f * step - 40};
+    FPDF_BITMAP expected = FPDFBitmap_Create(kWidth, kHeight, 0);
+    FPDFBitmap_FillRect(expected, 0, 0, kWidth, kHeight, 0xFFFFFFFF);
+    FPDF_RenderPageBitmapWithMatrix(expected, page, &matrix, &clipping, 0);
+    size_t size = FPDFBitmap_GetStride(expected) * kHeight;
+
+    for (int threads : {1, 3}) {
+      FPDF_BITMAP bitmap = FPDFBitmap_Create(kWidth, kHeight, 0);
+      FPDFBitmap_FillRect(bitmap, 0, 0, kWidth, kHeight, 0xFFFFFFFF);
+      FPDF_RenderPageBitmapWithMatrixTiled(bitmap, page, &matrix, &clipping, 0,
+                                           threads);
+      EXPECT_EQ(0, memcmp(FPDFBitmap_GetBuffer(expected),
+                          FPDFBitmap_GetBuffer(bitmap), size))
+          << step << " " << threads;
+      FPDFBitmap_Destroy(bitmap);
+    }
+    FPDFBitmap_Destroy(expected);
+  }
+  UnloadPage(page);
+}
+
+TEST_F(FPDFViewEmbeddertest, RenderEditedPageBitmapWithMatrixTiled) {
+  EXPECT_TRUE(OpenDocument("hello_world.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_TRUE(page);
+
+  // A new object that is not in the file.
+  FPDF_PAGEOBJECT rect = FPDFPageObj_CreateNewRect(10, 10, 100, 100);
+  EXPECT_TRUE(FPDFPath_SetFillColor(rect, 255, 0, 0, 255));
+  EXPECT_TRUE(FPDFPath_SetDrawMode(rect, FPDF_FILLMODE_ALTERNATE, 0));
+  FPDFPage_InsertObject(page, rect);
+  CheckTiledRenderMatches(page);
+  UnloadPage(page);
+
+  // An object of the file that has been moved into another tile.
+  FPDF_DOCUMENT other_doc =
+      FPDF_LoadMemDocument(file_contents_.get(), file_length_, nullptr);
+  ASSERT_TRUE(other_doc);
+  FPDF_PAGE other_page = FPDF_LoadPage(other_doc, 0);
+  ASSERT_TRUE(other_page);
+  FPDF_PAGEOBJECT text = FPDFPage_GetObject(other_page, 0);
+  ASSERT_TRUE(text);
+  FPDFPageObj_Transform(text, 1, 0, 0, 1, 180, 0);
+  CheckTiledRenderMatches(other_page);
+  FPDF_ClosePage(other_page);
+  FPDF_CloseDocument(other_doc);
+}
+
+namespace {
+
+// Checks that |bitmap| matches |expected| inside |clip| and is still white
+// outside it. Both are |size| pixels square.
+void CheckClippedRender(FPDF_BITMAP expected,
+                        FPDF_BITMAP bitmap,
+                        const FS_RECTF& clip,
+                        int size) {
+  int stride = FPDFBitmap_GetStride(expected);
+  const uint8_t* expected_buffer =
+      static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(expected));
+  const uint8_t* buffer =
+      static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bitmap));
+  std::vector<uint8_t> white(stride, 0xFF);
+  for (int y = 0; y < size; ++y) {
+    const uint8_t* row = buffer + y * stride;
+    if (y < clip.top || y >= clip.bottom) {
+      EXPECT_EQ(0, memcmp(white.data(), row, stride)) << y;
+      continue;
+    }
+    int left = static_cast<int>(clip.left) * 4;
+    int right = static_cast<int>(clip.right) * 4;
+    EXPECT_EQ(0, memcmp(white.data(), row, left)) << y;
+    EXPECT_EQ(0, memcmp(expected_buffer + y * stride + left, row + left,
+                        right - left))
+        << y;
+    EXPECT_EQ(0, memcmp(white.data(), row + right, size * 4 - right)) << y;
+  }
+}
+
+}  // namespace
+
+TEST_F(FPDFViewEmbeddertest, RenderPageBitmapWithMatrixClippedByIndex) {
+  // Over 400 objects, so that small clip rects only visit those nearby.
+  EXPECT_TRUE(OpenDocument("rect_grid.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_TRUE(page);
+  ASSERT_LE(400, FPDFPage_CountObject(page));
+
+  const int kSize = 800;
+  FS_MATRIX matrix = {4, 0, 0, 4, 0, 0};
+  FS_RECTF page_rect = {0, 0, kSize, kSize};
+  const FS_RECTF kClips[] = {{0, 0, 100, 100},
+                             {350, 370, 470, 430},
+                             {700, 10, 800, 790}};
+  for (int pass = 0; pass < 2; ++pass) {
+    if (pass == 1) {
+      // Moves the last square into the second clip rect, on top of others,
+      // which must be noticed without reloading the page.
+      FPDF_PAGEOBJECT square = FPDFPage_GetObject(page, 399);
+      ASSERT_TRUE(square);
+      FPDFPageObj_Transform(square, 1, 0, 0, 1, -96, -96);
+    }
+    // Large clip rects do not use the index.
+    FPDF_BITMAP expected = FPDFBitmap_Create(kSize, kSize, 0);
+    FPDFBitmap_FillRect(expected, 0, 0, kSize, kSize, 0xFFFFFFFF);
+    FPDF_RenderPageBitmapWithMatrix(expected, page, &matrix, &page_rect, 0);
+
+    for (const FS_RECTF& clip : kClips) {
+      FPDF_BITMAP bitmap = FPDFBitmap_Create(kSize, kSize, 0);
+      FPDFBitmap_FillRect(bitmap, 0, 0, kSize, kSize, 0xFFFFFFFF);
+      FPDF_RenderPageBitmapWithMatrix(bitmap, page, &matrix, &clip, 0);
+      CheckClippedRender(expected, bitmap, clip, kSize);
+      FPDFBitmap_Destroy(bitmap);
+    }
+    FPDFBitmap_Destroy(expected);
+  }
+  UnloadPage(page);
+}
+
+TEST_F(FPDFViewEmbeddertest, RenderPageBitmapProgressivelyWithIndex) {
+  EXPECT_TRUE(OpenDocument("rect_grid.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_TRUE(page);
+
+  // The bitmap shows a quarter of the page, so the index is used.
+  const int kSize = 440;
+  FPDF_BITMAP expected = FPDFBitmap_Create(kSize, kSize, 0);
+  FPDFBitmap_FillRect(expected, 0, 0, kSize, kSize, 0xFFFFFFFF);
+  FPDF_RenderPageBitmap(expected, page, -180, -200, 800, 800, 0, 0);
+
+  IFSDK_PAUSE pause;
+  pause.version = 1;
+  pause.NeedToPauseNow = [](IFSDK_PAUSE* pThis) -> FPDF_BOOL { return true; };
+  pause.user = nullptr;
+  FPDF_BITMAP bitmap = FPDFBitmap_Create(kSize, kSize, 0);
+  FPDFBitmap_FillRect(bitmap, 0, 0, kSize, kSize, 0xFFFFFFFF);
+  int status = FPDF_RenderPageBitmap_Start(bitmap, page, -180, -200, 800, 800,
+                                           0, 0, &pause);
+  int pauses = 0;
+  while (status == FPDF_RENDER_TOBECOUNTINUED) {
+    ++pauses;
+    status = FPDF_RenderPage_Continue(page, &pause);
+  }
+  EXPECT_EQ(FPDF_RENDER_DONE, status);
+  EXPECT_LT(0, pauses);
+  FPDF_RenderPage_Close(page);
+  EXPECT_EQ(0, memcmp(FPDFBitmap_GetBuffer(expected),
+                      FPDFBitmap_GetBuffer(bitmap),
+                      FPDFBitmap_GetStride(expected) * kSize));
+
+  FPDFBitmap_Destroy(bitmap);
+  FPDFBitmap_Destroy(expected);
+  UnloadPage(page);
+}
@@ -7,6 +7,7 @@
 #ifndef FPDFSDK_FSDK_DEFINE_H_
 #define FPDFSDK_FSDK_DEFINE_H_
 
+
 #include "core/fpdfapi/parser/cpdf_parser.h"
 #include "core/fxge/dib/cfx_dibitmap.h"
 #include "core/fxge/fx_dib.h"
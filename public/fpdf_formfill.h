@@ -1542,6 +1542,54 @@ DLLEXPORT void STDCALL FPDF_FFLRecord(FPDF_FORMHANDLE hHandle,
                                       int flags);
 #endif
 
+/**
+ * Function: FORM_RenderPageBitmap
+ *          Render the page contents and the form fields of a page to a device
+ *          independent bitmap, as FPDF_RenderPageBitmap followed by
+ *          FPDF_FFLDraw would.
+ * Parameters:
+ *          hHandle     -   Handle to the form fill module. Returned by
+ *                          FPDFDOC_InitFormFillEnvironment.
+ *          bitmap      -   Handle to the device independent bitmap (as the
+ *                          output buffer).
+ *          page        -   Handle to the page. Returned by FPDF_LoadPage.
+ *          start_x     -   Left pixel position of the display area in the
+ *                          device coordinate.
+ *          start_y     -   Top pixel position of the display area in the
+ *                          device coordinate.
+ *          size_x      -   Horizontal size (in pixels) for displaying the page.
+ *          size_y      -   Vertical size (in pixels) for displaying the page.
+ *          rotate      -   Page orientation: 0 (normal), 1 (rotated 90 degrees
+ *                          clockwise), 2 (rotated 180 degrees), 3 (rotated 90
+ *                          degrees counter-clockwise).
+ *          flags       -   0 for normal display, or combination of flags
+ *                          defined in fpdfview.h.
+ * Return Value:
+ *          None.
+ * Comments:
+ *          The display area is filled with white before the page is drawn.
+ *          The form fill module keeps a copy of the rendered page. Later calls
+ *          for the same page, with the same bitmap size and format and the
+ *          same other arguments, only draw again the areas reported through
+ *          FFI_Invalidate since, and copy the rest from that copy. This makes
+ *          redrawing a page while the user edits a form field cost about as
+ *          much as the field itself.
+ *          The copy is dropped by FORM_OnBeforeClosePage. Any edit made to
+ *          the page with the functions in fpdf_edit.h, fpdf_transformpage.h
+ *          or fpdf_flatten.h makes the next call draw the whole page again.
+ *          Like the other functions of the form fill module, this must not be
+ *          called while another thread uses the same document.
+ **/
+DLLEXPORT void STDCALL FORM_RenderPageBitmap(FPDF_FORMHANDLE hHandle,
+                                             FPDF_BITMAP bitmap,
+                                             FPDF_PAGE page,
+                                             int start_x,
+                                             int start_y,
+                                             int size_x,
+                                             int size_y,
+                                             int rotate,
+                                             int flags);
+
 #ifdef PDF_ENABLE_XFA
 /**
  * Function: FPDF_HasXFAField
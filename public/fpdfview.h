@@ -149,7 +149,7 @@ DLLEXPORT void STDCALL FPDF_InitLibrary();
 
 // Process-wide options for initializing the library.
 typedef struct FPDF_LIBRARY_CONFIG_ {
-  // Version number of the interface. Currently must be 2.
+  // Version number of the interface. Currently must be 2 or 3.
   int version;
 
   // Array of paths to scan in place of the defaults when using built-in
@@ -168,6 +168,14 @@ typedef struct FPDF_LIBRARY_CONFIG_ {
   // v8::Internals::kNumIsolateDataLots (exclusive). Note that 0 is fine
   // for most embedders.
   unsigned int m_v8EmbedderSlot;
+
+  // Version 3.
+
+  // Path to an existing, writable directory where FPDF_LoadDocument() keeps
+  // the parsed cross reference table of each document it opens, so later
+  // loads of the same unmodified file skip parsing it. Looking a document up
+  // reads the whole file once. NULL disables the cache.
+  const char* m_pXRefCacheDir;
 } FPDF_LIBRARY_CONFIG;
 
 // Function: FPDF_InitLibraryWithConfig
@@ -479,6 +487,73 @@ DLLEXPORT int STDCALL FPDF_GetSecurityHandlerRevision(FPDF_DOCUMENT document);
 //          Total number of pages in the document.
 DLLEXPORT int STDCALL FPDF_GetPageCount(FPDF_DOCUMENT document);
 
+// Statistics of the decoded image cache of a document.
+typedef struct _FPDF_IMAGE_CACHE_STATS {
+  // Number of image lookups served from the cache.
+  unsigned long hits;
+  // Number of image lookups that had to decode the image.
+  unsigned long misses;
+  // Number of images dropped to stay within the cache size limit.
+  unsigned long evictions;
+  // Number of images currently cached.
+  unsigned long count;
+  // Estimated number of bytes used by the cached images.
+  unsigned long size;
+} FPDF_IMAGE_CACHE_STATS;
+
+// Function: FPDF_SetImageCacheLimit
+//          Set how many bytes of decoded images the document keeps for reuse.
+//          The cache is shared by all pages of the document, so an image
+//          used on several pages is only decoded once. Experimental API.
+// Parameters:
+//          document    -   Handle to document. Returned by FPDF_LoadDocument.
+//          limit       -   Cache size limit, in bytes. 0 disables the cache.
+//                          The default is 100 MB.
+// Return value:
+//          None.
+// Comments:
+//          Images least recently used are evicted first.
+DLLEXPORT void STDCALL FPDF_SetImageCacheLimit(FPDF_DOCUMENT document,
+                                               unsigned long limit);
+
+// Function: FPDF_GetImageCacheStats
+//          Get statistics of the decoded image cache of the document.
+//          Experimental API.
+// Parameters:
+//          document    -   Handle to document. Returned by FPDF_LoadDocument.
+//          stats       -   Receives the statistics.
+// Return value:
+//          True if successful, false if |document| or |stats| is NULL.
+DLLEXPORT FPDF_BOOL STDCALL
+FPDF_GetImageCacheStats(FPDF_DOCUMENT document, FPDF_IMAGE_CACHE_STATS* stats);
+
+// Function: FPDF_SetJBig2CacheLimit
+//          Set how many bytes of decoded JBIG2 symbol dictionaries the document
+//          keeps for reuse. Experimental API.
+// Parameters:
+//          document    -   Handle to document. Returned by FPDF_LoadDocument.
+//          limit       -   Cache size limit, in bytes. 0 disables the cache.
+//                          The default is 8 MB.
+// Return value:
+//          None.
+// Comments:
+//          Dictionaries least recently used are evicted first. A dictionary
+//          bigger than the limit is not cached.
+DLLEXPORT void STDCALL FPDF_SetJBig2CacheLimit(FPDF_DOCUMENT document,
+                                               unsigned long limit);
+
+// Function: FPDF_GetJBig2CacheStats
+//          Get statistics of the JBIG2 symbol dictionary cache of the document.
+//          Experimental API.
+// Parameters:
+//          document    -   Handle to document. Returned by FPDF_LoadDocument.
+//          stats       -   Receives the statistics, counting symbol
+//                          dictionaries rather than images.
+// Return value:
+//          True if successful, false if |document| or |stats| is NULL.
+DLLEXPORT FPDF_BOOL STDCALL
+FPDF_GetJBig2CacheStats(FPDF_DOCUMENT document, FPDF_IMAGE_CACHE_STATS* stats);
+
 // Function: FPDF_LoadPage
 //          Load a page inside the document.
 // Parameters:
@@ -489,6 +564,12 @@ DLLEXPORT int STDCALL FPDF_GetPageCount(FPDF_DOCUMENT document);
 // Comments:
 //          The loaded page can be rendered to devices using FPDF_RenderPage.
 //          The loaded page can be closed using FPDF_ClosePage.
+//
+//          Pages of one document may be loaded, rendered and closed from
+//          different threads at the same time, and so may pages of different
+//          documents. A single page must still be used by one thread at a
+//          time, and other functions must not be called on a document
+//          concurrently.
 DLLEXPORT FPDF_PAGE STDCALL FPDF_LoadPage(FPDF_DOCUMENT document,
                                           int page_index);
 
@@ -613,6 +694,9 @@ DLLEXPORT void STDCALL FPDF_RenderPage(HDC dc,
 //                          widget and popup annotations.
 // Return value:
 //          None.
+// Comments:
+//          Different pages, of the same document or not, may be rendered
+//          from different threads at the same time (see FPDF_LoadPage).
 DLLEXPORT void STDCALL FPDF_RenderPageBitmap(FPDF_BITMAP bitmap,
                                              FPDF_PAGE page,
                                              int start_x,
@@ -644,6 +728,134 @@ DLLEXPORT void STDCALL FPDF_RenderPageBitmapWithMatrix(FPDF_BITMAP bitmap,
                                                        const FS_RECTF* clipping,
                                                        int flags);
 
+// Function: FPDF_RenderPageBitmapWithMatrixTiled
+//          Render contents of a page to a device independent bitmap, on
+//          several threads at once. Experimental API.
+// Parameters:
+//          bitmap        -   Handle to the device independent bitmap (as the
+//                            output buffer). The bitmap handle can be created
+//                            by FPDFBitmap_Create.
+//          page          -   Handle to the page. Returned by FPDF_LoadPage
+//          matrix        -   The transform matrix.
+//          clipping      -   The rect to clip to.
+//          flags         -   0 for normal display, or combination of the Page
+//                            Rendering flags defined above.
+//          thread_count  -   Number of threads to render with, including the
+//                            calling one. 0 or less uses one per processor.
+// Return value:
+//          None.
+// Comments:
+//          Renders like FPDF_RenderPageBitmapWithMatrix, but splits the
+//          bitmap into tiles that are rendered in parallel, which pays off
+//          for very large bitmaps. Tiles that no page object reaches are
+//          skipped. Text, paths and images come out the same pixel for pixel.
+//          Shadings and tiling patterns are computed for the part of them in
+//          each tile, so they may differ slightly along the tile seams.
+//          The threads render from copies of the page that are loaded from
+//          the file, so a page that was changed since through the editing
+//          functions is rendered on the calling thread alone.
+DLLEXPORT void STDCALL
+FPDF_RenderPageBitmapWithMatrixTiled(FPDF_BITMAP bitmap,
+                                     FPDF_PAGE page,
+                                     const FS_MATRIX* matrix,
+                                     const FS_RECTF* clipping,
+                                     int flags,
+                                     int thread_count);
+
+// How to render one page with FPDF_RenderPagesParallel.
+typedef struct _FPDF_PAGE_RENDER_PARAMS {
+  // Size of the bitmap, in pixels. The page fills all of it.
+  int size_x;
+  int size_y;
+  // Page orientation, as for FPDF_RenderPageBitmap.
+  int rotate;
+  // 0 for normal display, or combination of the Page Rendering flags.
+  int flags;
+} FPDF_PAGE_RENDER_PARAMS;
+
+// Receives the pages rendered by FPDF_RenderPagesParallel.
+//
+// The callbacks are invoked on worker threads, possibly several at once, so
+// they must be thread-safe.
+typedef struct _FPDF_RENDER_PAGES_SINK {
+  // Version number of the interface. Currently must be 1.
+  int version;
+
+  // Method: AllocBitmap
+  //          Creates the bitmap a page is rendered into. Optional: if NULL,
+  //          a bitmap is created with FPDFBitmap_Create() and filled white.
+  // Interface Version:
+  //          1
+  // Implementation Required:
+  //          no
+  // Parameters:
+  //          pThis       -   Pointer to the interface structure itself.
+  //          page_index  -   Index number of the page.
+  //          size_x      -   Width of the bitmap, from the render params.
+  //          size_y      -   Height of the bitmap, from the render params.
+  // Return Value:
+  //          A bitmap of at least the given size, with its background
+  //          already filled, or NULL to skip the page.
+  FPDF_BITMAP (*AllocBitmap)(struct _FPDF_RENDER_PAGES_SINK* pThis,
+                             int page_index,
+                             int size_x,
+                             int size_y);
+
+  // Method: PageRendered
+  //          Called once for every page of the range, as soon as it is done.
+  //          Pages complete in no particular order.
+  // Interface Version:
+  //          1
+  // Implementation Required:
+  //          yes
+  // Parameters:
+  //          pThis       -   Pointer to the interface structure itself.
+  //          page_index  -   Index number of the page.
+  //          bitmap      -   The rendered page, or NULL if the page could not
+  //                          be loaded or no bitmap was allocated. The
+  //                          embedder owns it and must release it with
+  //                          FPDFBitmap_Destroy().
+  // Return Value:
+  //          None.
+  void (*PageRendered)(struct _FPDF_RENDER_PAGES_SINK* pThis,
+                       int page_index,
+                       FPDF_BITMAP bitmap);
+
+  // A user defined data pointer, used by user's application. Can be NULL.
+  void* user;
+} FPDF_RENDER_PAGES_SINK;
+
+// Function: FPDF_RenderPagesParallel
+//          Render a range of pages on several threads at once.
+//          Experimental API.
+// Parameters:
+//          document      -   Handle to document. Returned by
+//                            FPDF_LoadDocument.
+//          start_page    -   Index number of the first page to render.
+//          page_count    -   Number of pages to render.
+//          params        -   Array of |page_count| render params, one for each
+//                            page of the range.
+//          thread_count  -   Number of threads to render with, including the
+//                            calling one. 0 or less uses one per processor.
+//          sink          -   Receives the rendered pages.
+// Return value:
+//          True if the pages were rendered, false if the arguments are
+//          invalid or the document was not loaded from a file.
+// Comments:
+//          Returns once every page of the range has been passed to
+//          |sink|. Each thread works on its own copy of the document that
+//          shares the file with |document|, so unsaved edits to |document|
+//          and form fields filled in are not rendered. These copies parse
+//          fonts and images separately, which costs memory in proportion to
+//          |thread_count|.
+DLLEXPORT FPDF_BOOL STDCALL
+FPDF_RenderPagesParallel(FPDF_DOCUMENT document,
+                         int start_page,
+                         int page_count,
+                         const FPDF_PAGE_RENDER_PARAMS* params,
+                         int thread_count,
+                         FPDF_RENDER_PAGES_SINK* sink);
+
 #ifdef _SKIA_SUPPORT_
 DLLEXPORT FPDF_RECORDER STDCALL FPDF_RenderPageSkp(FPDF_PAGE page,
                                                    int size_x,
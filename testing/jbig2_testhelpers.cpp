@@ -0,0 +1,168 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "testing/jbig2_testhelpers.h"
+
+#include <algorithm>
+
+#include "core/fxcodec/jbig2/JBig2_Image.h"
+
+namespace {
+
+struct QeEntry {
+  uint16_t qe;
+  uint8_t nmps;
+  uint8_t nlps;
+  bool switch_mps;
+};
+
+// Table E.1 of the spec, the same one CJBig2_ArithDecoder uses.
+const QeEntry kQeTable[] = {
+    {0x5601, 1, 1, true},    {0x3401, 2, 6, false},   {0x1801, 3, 9, false},
+    {0x0AC1, 4, 12, false},  {0x0521, 5, 29, false},  {0x0221, 38, 33, false},
+    {0x5601, 7, 6, true},    {0x5401, 8, 14, false},  {0x4801, 9, 14, false},
+    {0x3801, 10, 14, false}, {0x3001, 11, 17, false}, {0x2401, 12, 18, false},
+    {0x1C01, 13, 20, false}, {0x1601, 29, 21, false}, {0x5601, 15, 14, true},
+    {0x5401, 16, 14, false}, {0x5101, 17, 15, false}, {0x4801, 18, 16, false},
+    {0x3801, 19, 17, false}, {0x3401, 20, 18, false}, {0x3001, 21, 19, false},
+    {0x2801, 22, 19, false}, {0x2401, 23, 20, false}, {0x2201, 24, 21, false},
+    {0x1C01, 25, 22, false}, {0x1801, 26, 23, false}, {0x1601, 27, 24, false},
+    {0x1401, 28, 25, false}, {0x1201, 29, 26, false}, {0x1101, 30, 27, false},
+    {0x0AC1, 31, 28, false}, {0x09C1, 32, 29, false}, {0x08A1, 33, 30, false},
+    {0x0521, 34, 31, false}, {0x0441, 35, 32, false}, {0x02A1, 36, 33, false},
+    {0x0221, 37, 34, false}, {0x0141, 38, 35, false}, {0x0111, 39, 36, false},
+    {0x0085, 40, 37, false}, {0x0049, 41, 38, false}, {0x0025, 42, 39, false},
+    {0x0015, 43, 40, false}, {0x0009, 44, 41, false}, {0x0005, 45, 42, false},
+    {0x0001, 45, 43, false}, {0x5601, 46, 46, false}};
+
+}  // namespace
+
+JBig2ArithEncoder::JBig2ArithEncoder(size_t context_count)
+    : m_Index(context_count),
+      m_MPS(context_count),
+      m_A(0x8000),
+      m_C(0),
+      m_B(0),
+      m_CT(12),
+      m_bHaveByte(false) {}
+
+JBig2ArithEncoder::~JBig2ArithEncoder() {}
+
+void JBig2ArithEncoder::Encode(uint32_t context, int bit) {
+  const QeEntry& qe = kQeTable[m_Index[context]];
+  m_A -= qe.qe;
+  if (bit != m_MPS[context]) {
+    // CODELPS
+    if (m_A < qe.qe)
+      m_C += qe.qe;
+    else
+      m_A = qe.qe;
+    if (qe.switch_mps)
+      m_MPS[context] = 1 - m_MPS[context];
+    m_Index[context] = qe.nlps;
+    RenormE();
+    return;
+  }
+  // CODEMPS
+  if (m_A & 0x8000) {
+    m_C += qe.qe;
+    return;
+  }
+  if (m_A < qe.qe)
+    m_A = qe.qe;
+  else
+    m_C += qe.qe;
+  m_Index[context] = qe.nmps;
+  RenormE();
+}
+
+std::vector<uint8_t> JBig2ArithEncoder::Finish() {
+  // SETBITS
+  uint32_t temp = m_C + m_A;
+  m_C |= 0xFFFF;
+  if (m_C >= temp)
+    m_C -= 0x8000;
+  m_C <<= m_CT;
+  ByteOut();
+  m_C <<= m_CT;
+  ByteOut();
+  if (m_B != 0xFF)
+    m_Output.push_back(m_B);
+  m_Output.push_back(0xFF);
+  m_Output.push_back(0xAC);
+  return std::move(m_Output);
+}
+
+void JBig2ArithEncoder::ByteOut() {
+  bool carry_stuffed = m_B == 0xFF;
+  if (!carry_stuffed && m_C >= 0x8000000) {
+    ++m_B;
+    if (m_B == 0xFF) {
+      m_C &= 0x7FFFFFF;
+      carry_stuffed = true;
+    }
+  }
+  if (m_bHaveByte)
+    m_Output.push_back(m_B);
+  m_bHaveByte = true;
+  if (carry_stuffed) {
+    // A bit is stuffed after an 0xFF byte.
+    m_B = m_C >> 20;
+    m_C &= 0xFFFFF;
+    m_CT = 7;
+  } else {
+    m_B = m_C >> 19;
+    m_C &= 0x7FFFF;
+    m_CT = 8;
+  }
+}
+
+void JBig2ArithEncoder::RenormE() {
+  do {
+    m_A <<= 1;
+    m_C <<= 1;
+    if (--m_CT == 0)
+      ByteOut();
+  } while (!(m_A & 0x8000));
+}
+
+void DrawJBig2TextPage(CJBig2_Image* image, uint32_t seed) {
+  auto next = [&seed]() {
+    seed = seed * 1103515245 + 12345;
+    return static_cast<int32_t>(seed >> 16);
+  };
+  const int32_t kMargin = image->width() / 12;
+  const int32_t kLineHeight = 40;
+  const int32_t kLineSpacing = 55;
+  image->fill(false);
+  for (int32_t line = kMargin; line + kLineHeight < image->height() - kMargin;
+       line += kLineSpacing) {
+    int32_t x = kMargin;
+    while (x < image->width() - kMargin) {
+      int32_t glyph_width = 12 + next() % 16;
+      if (next() % 7 == 0) {
+        // A space between words.
+        x += glyph_width;
+        continue;
+      }
+      // Each glyph is a few overlapping strokes.
+      int32_t glyph_height = 20 + next() % 12;
+      for (int i = 0; i < 3; ++i) {
+        int32_t x0 = x + next() % glyph_width;
+        int32_t y0 = line + 32 - glyph_height + next() % glyph_height;
+        int32_t stroke_width = 2 + next() % 4;
+        int32_t stroke_height = 2 + next() % glyph_height;
+        if (next() & 1)
+          std::swap(stroke_width, stroke_height);
+        int32_t y1 = std::min(y0 + stroke_height, line + kLineHeight);
+        int32_t x1 = std::min(x0 + stroke_width, x + glyph_width);
+        for (int32_t y = y0; y < y1; ++y) {
+          for (int32_t xx = x0; xx < x1; ++xx)
+            image->setPixel(xx, y, 1);
+        }
+      }
+      x += glyph_width + 3;
+    }
+  }
+}
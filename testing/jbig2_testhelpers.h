@@ -0,0 +1,47 @@
+// Copyright 2017 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TESTING_JBIG2_TESTHELPERS_H_
+#define TESTING_JBIG2_TESTHELPERS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+class CJBig2_Image;
+
+// The arithmetic encoder from ITU-T T.88 Annex E, the counterpart of
+// CJBig2_ArithDecoder. Lets tests and benchmarks build real encoded regions
+// instead of decoding random bytes.
+class JBig2ArithEncoder {
+ public:
+  explicit JBig2ArithEncoder(size_t context_count);
+  ~JBig2ArithEncoder();
+
+  void Encode(uint32_t context, int bit);
+
+  // Terminates the data with the 0xFFAC marker and returns it. The encoder
+  // must not be used afterwards.
+  std::vector<uint8_t> Finish();
+
+ private:
+  void ByteOut();
+  void RenormE();
+
+  std::vector<uint8_t> m_Output;
+  std::vector<uint8_t> m_Index;
+  std::vector<uint8_t> m_MPS;
+  uint32_t m_A;
+  uint32_t m_C;
+  uint32_t m_B;
+  int m_CT;
+  bool m_bHaveByte;
+};
+
+// Fills |image| with rows of made up glyphs, like a scanned page of text, so
+// that it codes to a size and a mix of contexts close to a real document.
+void DrawJBig2TextPage(CJBig2_Image* image, uint32_t seed);
+
+#endif  // TESTING_JBIG2_TESTHELPERS_H_
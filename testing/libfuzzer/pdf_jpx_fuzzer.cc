@@ -15,7 +15,7 @@ CCodec_JpxModule g_module;
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
   std::unique_ptr<CJPX_Decoder> decoder =
-      g_module.CreateDecoder(data, size, nullptr);
+      g_module.CreateDecoder(data, size, nullptr, 0);
   if (!decoder)
     return 0;
 
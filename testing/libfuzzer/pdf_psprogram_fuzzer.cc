@@ -0,0 +1,60 @@
+// Copyright 2017 The PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <cmath>
+#include <cstdint>
+
+#include "core/fpdfapi/page/cpdf_psengine.h"
+#include "third_party/base/logging.h"
+
+// Differential fuzzer: a program that compiles has to give the results of
+// the interpreter, whether it runs on one set of inputs or on a batch.
+
+static bool IsSameResult(float a, float b) {
+  return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  const uint32_t kMaxInputs = 4;
+  const uint32_t kMaxOutputs = 4;
+  const uint32_t kInputSets = 8;
+  const size_t kParameterSize = 2 + kInputSets * kMaxInputs;
+  if (size < kParameterSize)
+    return 0;
+
+  uint32_t nInputs = 1 + data[0] % kMaxInputs;
+  uint32_t nOutputs = 1 + data[1] % kMaxOutputs;
+  float inputs[kInputSets * kMaxInputs];
+  for (uint32_t i = 0; i < kInputSets * nInputs; i++)
+    inputs[i] = static_cast<float>(data[2 + i]) / 64 - 1;
+  data += kParameterSize;
+  size -= kParameterSize;
+
+  CPDF_PSEngine engine;
+  if (!engine.Parse(reinterpret_cast<const char*>(data), size))
+    return 0;
+
+  CPDF_PSProgram program;
+  if (!program.Compile(engine.GetMainProc(), nInputs, nOutputs))
+    return 0;
+
+  float batch_results[kInputSets * kMaxOutputs];
+  bool batch_ok = program.RunBatch(inputs, batch_results, kInputSets);
+  for (uint32_t i = 0; i < kInputSets; i++) {
+    float expected[kMaxOutputs];
+    float results[kMaxOutputs];
+    bool expected_ok =
+        engine.Run(&inputs[i * nInputs], nInputs, expected, nOutputs);
+    CHECK(expected_ok == program.Run(&inputs[i * nInputs], results));
+    CHECK(expected_ok == batch_ok);
+    if (!expected_ok)
+      continue;
+
+    for (uint32_t j = 0; j < nOutputs; j++) {
+      CHECK(IsSameResult(expected[j], results[j]));
+      CHECK(IsSameResult(expected[j], batch_results[i * nOutputs + j]));
+    }
+  }
+  return 0;
+}
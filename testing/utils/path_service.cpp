@@ -13,6 +13,8 @@
 #include <unistd.h>
 #endif  // _WIN32
 
+#include <stdlib.h>
+
 #include <string>
 
 #include "core/fxcrt/fx_system.h"
@@ -105,3 +107,21 @@ bool PathService::GetTestFilePath(const std::string& file_name,
   path->append(file_name);
   return true;
 }
+
+// static
+bool PathService::GetTempDir(std::string* path) {
+#ifdef _WIN32
+  char path_buffer[MAX_PATH];
+  DWORD length = GetTempPathA(MAX_PATH, path_buffer);
+  if (length == 0 || length >= MAX_PATH)
+    return false;
+  *path = std::string(path_buffer, length);
+#else
+  const char* tmpdir = getenv("TMPDIR");
+  *path = tmpdir && *tmpdir ? tmpdir : "/tmp";
+#endif  // _WIN32
+
+  if (EndsWithSeparator(*path))
+    path->resize(path->size() - 1);
+  return !path->empty();
+}
@@ -33,5 +33,8 @@ class PathService {
 
   // Get the full path for a test file under the test data directory.
   static bool GetTestFilePath(const std::string& file_name, std::string* path);
+
+  // Retrieve the directory for temporary files, without a trailing separator.
+  static bool GetTempDir(std::string* path);
 };
 #endif  // TESTING_UTILS_PATH_SERVICE_H_
@@ -1682,7 +1682,9 @@ static OPJ_BOOL opj_tcd_mct_decode ( opj_tcd_t *p_tcd, opj_event_mgr_t *p_manage
         opj_tcd_tile_t * l_tile = p_tcd->tcd_image->tiles;
         opj_tcp_t * l_tcp = p_tcd->tcp;
         opj_tcd_tilecomp_t * l_tile_comp = l_tile->comps;
-        OPJ_UINT32 l_samples,i;
+        opj_tcd_resolution_t* l_res;
+        OPJ_UINT32 l_samples,i,j;
+        OPJ_UINT32 l_width,l_height,l_stride;
 
         if (! l_tcp->mct) {
                 return OPJ_TRUE;
@@ -1690,6 +1692,18 @@ static OPJ_BOOL opj_tcd_mct_decode ( opj_tcd_t *p_tcd, opj_event_mgr_t *p_manage
 
         l_samples = (OPJ_UINT32)((l_tile_comp->x1 - l_tile_comp->x0) * (l_tile_comp->y1 - l_tile_comp->y0));
 
+        /* Only the decoded resolution, in the top left corner of each tile
+           component, needs the transform. Rows must stay 16-byte aligned for
+           the SSE versions. */
+        l_res = l_tile_comp->resolutions + p_tcd->image->comps[0].resno_decoded;
+        l_width = (OPJ_UINT32)(l_res->x1 - l_res->x0);
+        l_height = (OPJ_UINT32)(l_res->y1 - l_res->y0);
+        l_stride = (OPJ_UINT32)(l_tile_comp->x1 - l_tile_comp->x0);
+        if (l_width == l_stride || (l_stride & 3) != 0) {
+                l_width = l_samples;
+                l_height = 1;
+        }
+
         if (l_tile->numcomps >= 3 ){
                 /* testcase 1336.pdf.asan.47.376 */
                 if ((l_tile->comps[0].x1 - l_tile->comps[0].x0) * (l_tile->comps[0].y1 - l_tile->comps[0].y0) < (OPJ_INT32)l_samples ||
@@ -1710,39 +1724,42 @@ static OPJ_BOOL opj_tcd_mct_decode ( opj_tcd_t *p_tcd, opj_event_mgr_t *p_manage
                                 return OPJ_FALSE;
                         }
 
-                        for (i=0;i<l_tile->numcomps;++i) {
-                                l_data[i] = (OPJ_BYTE*) l_tile_comp->data;
-                                ++l_tile_comp;
-                        }
+                        for (j=0;j<l_height;++j) {
+                                for (i=0;i<l_tile->numcomps;++i) {
+                                        l_data[i] = (OPJ_BYTE*) (l_tile->comps[i].data + j * l_stride);
+                                }
 
-                        if (! opj_mct_decode_custom(/* MCT data */
-                                                                        (OPJ_BYTE*) l_tcp->m_mct_decoding_matrix,
-                                                                        /* size of components */
-                                                                        l_samples,
-                                                                        /* components */
-                                                                        l_data,
-                                                                        /* nb of components (i.e. size of pData) */
-                                                                        l_tile->numcomps,
-                                                                        /* tells if the data is signed */
-                                                                        p_tcd->image->comps->sgnd)) {
-                                opj_free(l_data);
-                                return OPJ_FALSE;
+                                if (! opj_mct_decode_custom(/* MCT data */
+                                                                                (OPJ_BYTE*) l_tcp->m_mct_decoding_matrix,
+                                                                                /* size of components */
+                                                                                l_width,
+                                                                                /* components */
+                                                                                l_data,
+                                                                                /* nb of components (i.e. size of pData) */
+                                                                                l_tile->numcomps,
+                                                                                /* tells if the data is signed */
+                                                                                p_tcd->image->comps->sgnd)) {
+                                        opj_free(l_data);
+                                        return OPJ_FALSE;
+                                }
                         }
 
                         opj_free(l_data);
                 }
                 else {
-                        if (l_tcp->tccps->qmfbid == 1) {
-                                opj_mct_decode(     l_tile->comps[0].data,
-                                                        l_tile->comps[1].data,
-                                                        l_tile->comps[2].data,
-                                                        l_samples);
-                        }
-                        else {
-                            opj_mct_decode_real((OPJ_FLOAT32*)l_tile->comps[0].data,
-                                                (OPJ_FLOAT32*)l_tile->comps[1].data,
-                                                (OPJ_FLOAT32*)l_tile->comps[2].data,
-                                                l_samples);
+                        for (j=0;j<l_height;++j) {
+                                if (l_tcp->tccps->qmfbid == 1) {
+                                        opj_mct_decode(     l_tile->comps[0].data + j * l_stride,
+                                                                l_tile->comps[1].data + j * l_stride,
+                                                                l_tile->comps[2].data + j * l_stride,
+                                                                l_width);
+                                }
+                                else {
+                                    opj_mct_decode_real((OPJ_FLOAT32*)l_tile->comps[0].data + j * l_stride,
+                                                        (OPJ_FLOAT32*)l_tile->comps[1].data + j * l_stride,
+                                                        (OPJ_FLOAT32*)l_tile->comps[2].data + j * l_stride,
+                                                        l_width);
+                                }
                         }
                 }
         }